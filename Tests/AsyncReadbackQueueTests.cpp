@@ -0,0 +1,82 @@
+#include <vector>
+
+#include "AsyncReadbackQueue.h"
+
+#include "TestFramework.h"
+
+WOLF_TEST(AsyncReadbackQueue, readbacksCompleteAfterFrameLatency)
+{
+	AsyncReadbackQueue asyncReadbackQueue(4, 2);
+	std::vector<uint32_t> completedSlots;
+	auto callback = [&completedSlots](uint32_t slotIdx) { completedSlots.push_back(slotIdx); };
+
+	WOLF_CHECK(asyncReadbackQueue.reserveSlot(10, callback) == 0);
+	WOLF_CHECK(asyncReadbackQueue.reserveSlot(11, callback) == 1);
+
+	asyncReadbackQueue.processCompletedReadbacks(11);
+	WOLF_CHECK(completedSlots.empty());
+
+	asyncReadbackQueue.processCompletedReadbacks(12);
+	WOLF_CHECK(completedSlots == std::vector<uint32_t>({ 0 }));
+
+	asyncReadbackQueue.processCompletedReadbacks(20);
+	WOLF_CHECK(completedSlots == std::vector<uint32_t>({ 0, 1 }));
+	WOLF_CHECK(!asyncReadbackQueue.hasPendingReadbacks());
+}
+
+WOLF_TEST(AsyncReadbackQueue, slotsAreReusedOnceCompleted)
+{
+	AsyncReadbackQueue asyncReadbackQueue(2, 1);
+	uint32_t completedCount = 0;
+	auto callback = [&completedCount](uint32_t) { completedCount++; };
+
+	WOLF_CHECK(asyncReadbackQueue.reserveSlot(0, callback) == 0);
+	WOLF_CHECK(asyncReadbackQueue.reserveSlot(0, callback) == 1);
+	WOLF_CHECK(!asyncReadbackQueue.isSlotAvailable());
+	WOLF_CHECK(asyncReadbackQueue.reserveSlot(0, callback) == AsyncReadbackQueue::NO_SLOT_AVAILABLE);
+
+	asyncReadbackQueue.processCompletedReadbacks(1);
+	WOLF_CHECK(completedCount == 2);
+	WOLF_CHECK(asyncReadbackQueue.reserveSlot(1, callback) == 0);
+
+	asyncReadbackQueue.clear();
+	WOLF_CHECK(!asyncReadbackQueue.hasPendingReadbacks());
+	WOLF_CHECK(completedCount == 2); // cleared readbacks are not completed
+	WOLF_CHECK(asyncReadbackQueue.reserveSlot(2, callback) == 0);
+}
+
+WOLF_TEST(AsyncReadbackQueue, callbacksCanReserveReadbacks)
+{
+	AsyncReadbackQueue asyncReadbackQueue(2, 1); // slot of the completed readback is released after its callback
+	std::vector<uint32_t> completedFrames;
+
+	std::function<void(uint32_t)> reserveNext;
+	uint32_t frameNumber = 0;
+	reserveNext = [&](uint32_t)
+		{
+			completedFrames.push_back(frameNumber);
+			if (completedFrames.size() < 3)
+				WOLF_CHECK(asyncReadbackQueue.reserveSlot(frameNumber, reserveNext) != AsyncReadbackQueue::NO_SLOT_AVAILABLE);
+		};
+
+	WOLF_CHECK(asyncReadbackQueue.reserveSlot(frameNumber, reserveNext) == 0);
+	for (frameNumber = 1; frameNumber < 5; ++frameNumber)
+		asyncReadbackQueue.processCompletedReadbacks(frameNumber);
+
+	WOLF_CHECK(completedFrames == std::vector<uint32_t>({ 1, 2, 3 }));
+	WOLF_CHECK(!asyncReadbackQueue.hasPendingReadbacks());
+}
+
+WOLF_TEST(AsyncReadbackQueue, processAllReadbacksCompletesInOrder)
+{
+	AsyncReadbackQueue asyncReadbackQueue(3, 3);
+	std::vector<uint32_t> completedSlots;
+	auto callback = [&completedSlots](uint32_t slotIdx) { completedSlots.push_back(slotIdx); };
+
+	for (uint32_t frameNumber = 0; frameNumber < 3; ++frameNumber)
+		WOLF_CHECK(asyncReadbackQueue.reserveSlot(frameNumber, callback) == frameNumber);
+	asyncReadbackQueue.processAllReadbacks();
+
+	WOLF_CHECK(completedSlots == std::vector<uint32_t>({ 0, 1, 2 }));
+	WOLF_CHECK(asyncReadbackQueue.isSlotAvailable());
+}
@@ -0,0 +1,98 @@
+#include <cmath>
+#include <cstring>
+
+#include "BandedImageCompressor.h"
+
+#include "TestFramework.h"
+
+using Wolf::ImageCompression::RG32F;
+using Wolf::ImageCompression::RGBA8;
+
+namespace
+{
+	RGBA8 computeColor(uint32_t x, uint32_t y)
+	{
+		return { static_cast<uint8_t>(x * 3 + y), static_cast<uint8_t>(x ^ y), static_cast<uint8_t>(127.5f + 127.5f * std::sin(0.05f * static_cast<float>(x + 2 * y))), static_cast<uint8_t>(y) };
+	}
+
+	RG32F computeNormal(uint32_t x, uint32_t y)
+	{
+		return RG32F(0.6f * std::sin(0.1f * static_cast<float>(x)), 0.6f * std::cos(0.07f * static_cast<float>(y)));
+	}
+
+	// Reference: whole levels, mipped by MipChainBuilder and compressed by BlockEncoder
+	template <typename PixelType, typename CompressionType, typename PixelFunction>
+	void checkBandsMatchFullLevels(const Wolf::Extent3D& extent, MipChainBuilder::Content content, PixelFunction pixelFunction)
+	{
+		using Compressor = BandedImageCompressor<PixelType, CompressionType>;
+
+		const uint32_t mipCount = Compressor::computeMipCount(extent, 16);
+		const uint64_t memoryBudget = 2ull * Compressor::GROUP_ROW_COUNT * 2 * extent.width * sizeof(PixelType); // smallest band, the image is split in several bands
+		Compressor compressor(extent, mipCount, content, memoryBudget);
+		WOLF_CHECK(compressor.getBandRowCount() < extent.height);
+
+		compressor.compress([&](uint32_t firstRow, uint32_t rowCount, PixelType* outPixels)
+			{
+				for (uint32_t y = firstRow; y < firstRow + rowCount; ++y)
+				{
+					for (uint32_t x = 0; x < extent.width; ++x)
+						outPixels[static_cast<size_t>(y - firstRow) * extent.width + x] = pixelFunction(x, y);
+				}
+			}, 0);
+		WOLF_CHECK(compressor.getPeakWorkingMemory() <= memoryBudget);
+
+		std::vector<PixelType> levelPixels(static_cast<size_t>(extent.width) * extent.height);
+		for (uint32_t y = 0; y < extent.height; ++y)
+		{
+			for (uint32_t x = 0; x < extent.width; ++x)
+				levelPixels[static_cast<size_t>(y) * extent.width + x] = pixelFunction(x, y);
+		}
+
+		const std::vector<std::vector<CompressionType>>& levelBlocks = compressor.getLevelBlocks();
+		WOLF_CHECK(levelBlocks.size() == mipCount);
+		Wolf::Extent3D levelExtent = extent;
+		for (uint32_t mipLevel = 0; mipLevel < levelBlocks.size(); ++mipLevel)
+		{
+			std::vector<CompressionType> expectedBlocks;
+			BlockEncoder::compress(levelExtent, levelPixels, expectedBlocks);
+			WOLF_CHECK(levelBlocks[mipLevel].size() == expectedBlocks.size());
+			WOLF_CHECK(levelBlocks[mipLevel].size() == expectedBlocks.size() && memcmp(levelBlocks[mipLevel].data(), expectedBlocks.data(), expectedBlocks.size() * sizeof(CompressionType)) == 0);
+
+			std::vector<PixelType> nextLevelPixels(static_cast<size_t>(levelExtent.width / 2) * (levelExtent.height / 2));
+			MipChainBuilder::downsample(levelExtent, levelPixels.data(), { MipChainBuilder::Filter::BOX, content }, nextLevelPixels.data(), 0);
+			levelPixels = std::move(nextLevelPixels);
+			levelExtent = { levelExtent.width / 2, levelExtent.height / 2, 1 };
+		}
+	}
+}
+
+WOLF_TEST(BandedImageCompressor, mipCountKeepsLevelsMultipleOf4)
+{
+	using Compressor = BandedImageCompressor<RGBA8, Wolf::ImageCompression::BC1>;
+	WOLF_CHECK(Compressor::computeMipCount({ 128, 512, 1 }, 16) == 6);
+	WOLF_CHECK(Compressor::computeMipCount({ 128, 512, 1 }, 3) == 3);
+	WOLF_CHECK(Compressor::computeMipCount({ 12, 8, 1 }, 16) == 1);
+	WOLF_CHECK(Compressor::computeMipCount({ 6, 8, 1 }, 16) == 0);
+}
+
+WOLF_TEST(BandedImageCompressor, bandRowCountFitsBudget)
+{
+	using Compressor = BandedImageCompressor<RGBA8, Wolf::ImageCompression::BC1>;
+	constexpr uint32_t WIDTH = 1024;
+	constexpr uint64_t BAND_ROW_BYTES = 2ull * WIDTH * sizeof(RGBA8);
+
+	WOLF_CHECK(Compressor::computeBandRowCount(WIDTH, 256 * BAND_ROW_BYTES) == 256);
+	WOLF_CHECK(Compressor::computeBandRowCount(WIDTH, 300 * BAND_ROW_BYTES) == 256); // aligned on 2 groups
+	WOLF_CHECK(Compressor::computeBandRowCount(WIDTH, 1) == 2 * Compressor::GROUP_ROW_COUNT);
+}
+
+WOLF_TEST(BandedImageCompressor, colorBandsMatchFullLevels)
+{
+	checkBandsMatchFullLevels<RGBA8, Wolf::ImageCompression::BC1>({ 128, 512, 1 }, MipChainBuilder::Content::SRGB_COLOR, computeColor);
+	checkBandsMatchFullLevels<RGBA8, Wolf::ImageCompression::BC3>({ 64, 256, 1 }, MipChainBuilder::Content::COLOR, computeColor);
+}
+
+WOLF_TEST(BandedImageCompressor, normalBandsMatchFullLevels)
+{
+	checkBandsMatchFullLevels<RG32F, Wolf::ImageCompression::BC5>({ 64, 256, 1 }, MipChainBuilder::Content::NORMAL, computeNormal);
+}
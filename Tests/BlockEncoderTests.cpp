@@ -0,0 +1,184 @@
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "BlockEncoder.h"
+
+#include "TestFramework.h"
+
+using Wolf::ImageCompression::RGBA8;
+
+namespace
+{
+	uint32_t nextRandom(uint32_t& seed)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		return seed >> 8;
+	}
+
+	// Noise, gradients, flat blocks and two colour blocks, with and without alpha
+	void createBlock(uint32_t blockIdx, uint32_t& seed, RGBA8* outPixels)
+	{
+		const RGBA8 start = { static_cast<uint8_t>(nextRandom(seed)), static_cast<uint8_t>(nextRandom(seed)), static_cast<uint8_t>(nextRandom(seed)), static_cast<uint8_t>(nextRandom(seed)) };
+		const RGBA8 end = { static_cast<uint8_t>(nextRandom(seed)), static_cast<uint8_t>(nextRandom(seed)), static_cast<uint8_t>(nextRandom(seed)), static_cast<uint8_t>(nextRandom(seed)) };
+		for (uint32_t i = 0; i < BlockEncoder::BLOCK_PIXEL_COUNT; ++i)
+		{
+			switch (blockIdx % 4)
+			{
+				case 0:
+				{
+					const uint32_t value = nextRandom(seed);
+					memcpy(&outPixels[i], &value, sizeof(RGBA8));
+					break;
+				}
+				case 1:
+					outPixels[i] = { static_cast<uint8_t>(start.r + (end.r - start.r) * static_cast<int32_t>(i) / 15), static_cast<uint8_t>(start.g + (end.g - start.g) * static_cast<int32_t>(i) / 15),
+						static_cast<uint8_t>(start.b + (end.b - start.b) * static_cast<int32_t>(i) / 15), static_cast<uint8_t>(start.a + (end.a - start.a) * static_cast<int32_t>(i) / 15) };
+					break;
+				case 2:
+					outPixels[i] = start;
+					break;
+				default:
+					outPixels[i] = nextRandom(seed) % 2 ? start : end;
+					break;
+			}
+		}
+	}
+
+	// Smooth colours and alpha, as most texture areas are
+	std::vector<RGBA8> createGradientImage(const Wolf::Extent3D& extent)
+	{
+		std::vector<RGBA8> pixels(static_cast<size_t>(extent.width) * extent.height);
+		for (uint32_t y = 0; y < extent.height; ++y)
+		{
+			for (uint32_t x = 0; x < extent.width; ++x)
+			{
+				const float u = static_cast<float>(x) / static_cast<float>(extent.width);
+				const float v = static_cast<float>(y) / static_cast<float>(extent.height);
+				pixels[static_cast<size_t>(y) * extent.width + x] = { static_cast<uint8_t>(255.0f * u), static_cast<uint8_t>(255.0f * v),
+					static_cast<uint8_t>(127.5f + 127.5f * std::sin(6.0f * (u + v))), static_cast<uint8_t>(255.0f * (1.0f - u * v)) };
+			}
+		}
+		return pixels;
+	}
+}
+
+WOLF_TEST(BlockEncoder, simdMatchesScalar)
+{
+	std::vector<BlockEncoder::InstructionSet> instructionSets;
+	for (BlockEncoder::InstructionSet instructionSet : { BlockEncoder::InstructionSet::SSE41, BlockEncoder::InstructionSet::AVX2 })
+	{
+		if (instructionSet <= BlockEncoder::getSupportedInstructionSet())
+			instructionSets.push_back(instructionSet);
+	}
+
+	uint32_t seed = 1;
+	uint32_t mismatchCount = 0;
+	for (uint32_t blockIdx = 0; blockIdx < 2000; ++blockIdx)
+	{
+		RGBA8 pixels[BlockEncoder::BLOCK_PIXEL_COUNT];
+		createBlock(blockIdx, seed, pixels);
+		uint8_t redValues[BlockEncoder::BLOCK_PIXEL_COUNT];
+		uint8_t greenValues[BlockEncoder::BLOCK_PIXEL_COUNT];
+		for (uint32_t i = 0; i < BlockEncoder::BLOCK_PIXEL_COUNT; ++i)
+		{
+			redValues[i] = pixels[i].r;
+			greenValues[i] = pixels[i].g;
+		}
+
+		uint8_t scalarBlocks[4][16];
+		BlockEncoder::encodeBC1(pixels, scalarBlocks[0], BlockEncoder::InstructionSet::SCALAR);
+		BlockEncoder::encodeBC3(pixels, scalarBlocks[1], BlockEncoder::InstructionSet::SCALAR);
+		BlockEncoder::encodeBC4(redValues, scalarBlocks[2], BlockEncoder::InstructionSet::SCALAR);
+		BlockEncoder::encodeBC5(redValues, greenValues, scalarBlocks[3], BlockEncoder::InstructionSet::SCALAR);
+
+		for (BlockEncoder::InstructionSet instructionSet : instructionSets)
+		{
+			uint8_t blocks[4][16];
+			BlockEncoder::encodeBC1(pixels, blocks[0], instructionSet);
+			BlockEncoder::encodeBC3(pixels, blocks[1], instructionSet);
+			BlockEncoder::encodeBC4(redValues, blocks[2], instructionSet);
+			BlockEncoder::encodeBC5(redValues, greenValues, blocks[3], instructionSet);
+
+			mismatchCount += memcmp(blocks[0], scalarBlocks[0], 8) != 0;
+			mismatchCount += memcmp(blocks[1], scalarBlocks[1], 16) != 0;
+			mismatchCount += memcmp(blocks[2], scalarBlocks[2], 8) != 0;
+			mismatchCount += memcmp(blocks[3], scalarBlocks[3], 16) != 0;
+		}
+	}
+	WOLF_CHECK(mismatchCount == 0);
+}
+
+WOLF_TEST(BlockEncoder, bc7RoundTrip)
+{
+	const Wolf::Extent3D extent = { 64, 64, 1 };
+	const std::vector<RGBA8> pixels = createGradientImage(extent);
+
+	std::vector<BlockEncoder::BC7> blocks;
+	BlockEncoder::compress(extent, pixels, blocks);
+	WOLF_CHECK(blocks.size() == 16 * 16);
+
+	bool isEveryBlockDecoded = true;
+	RGBA8 blockPixels[BlockEncoder::BLOCK_PIXEL_COUNT];
+	for (const BlockEncoder::BC7& block : blocks)
+		isEveryBlockDecoded &= BlockEncoder::decodeBC7(block.m_data, blockPixels);
+	WOLF_CHECK(isEveryBlockDecoded);
+
+	std::vector<RGBA8> decodedPixels;
+	BlockEncoder::uncompress(extent, blocks.data(), decodedPixels);
+	WOLF_CHECK(BlockEncoder::computePSNR(pixels, decodedPixels, 4) > 40.0f);
+
+	// Flat block, mode 6 endpoints have 7 bits and a shared bit, interpolation reaches every 8 bits value within 1
+	const RGBA8 color = { 37, 140, 223, 90 };
+	const std::vector<RGBA8> flatPixels(16, color);
+	BlockEncoder::compress({ 4, 4, 1 }, flatPixels, blocks);
+	BlockEncoder::uncompress({ 4, 4, 1 }, blocks.data(), decodedPixels);
+	WOLF_CHECK(BlockEncoder::computePSNR(flatPixels, decodedPixels, 4) >= 48.0f);
+}
+
+WOLF_TEST(BlockEncoder, bc4RoundTrip)
+{
+	const Wolf::Extent3D extent = { 32, 32, 1 };
+	const std::vector<RGBA8> pixels = createGradientImage(extent);
+
+	std::vector<BlockEncoder::BC4> blocks;
+	BlockEncoder::compress(extent, pixels, blocks);
+	std::vector<RGBA8> decodedPixels;
+	BlockEncoder::uncompress(extent, blocks.data(), decodedPixels);
+
+	// Red channel only
+	WOLF_CHECK(BlockEncoder::computePSNR(pixels, decodedPixels, 1) > 45.0f);
+}
+
+WOLF_TEST(BlockEncoder, unalignedSizesAreRejectedForBC7)
+{
+	const std::vector<RGBA8> pixels(6 * 4, RGBA8{ 1, 2, 3, 4 });
+	std::vector<BlockEncoder::BC7> blocks(1);
+	BlockEncoder::compress({ 6, 4, 1 }, pixels, blocks);
+	WOLF_CHECK(blocks.empty());
+}
+
+WOLF_TEST(BlockEncoder, psnr)
+{
+	const std::vector<RGBA8> reference(64, RGBA8{ 100, 100, 100, 100 });
+	WOLF_CHECK(BlockEncoder::computePSNR(reference, reference, 4) == std::numeric_limits<float>::infinity());
+
+	// Squared error of 1 on every red value: 10 * log10(255^2)
+	const std::vector<RGBA8> compared(64, RGBA8{ 101, 100, 100, 100 });
+	WOLF_CHECK(std::abs(BlockEncoder::computePSNR(reference, compared, 1) - 48.1308f) < 1e-3f);
+	WOLF_CHECK(std::abs(BlockEncoder::computePSNR(reference, compared, 4) - (48.1308f + 10.0f * std::log10(4.0f))) < 1e-3f);
+}
+
+// Engine encoder is kept as the quality reference, the editor one must not fall behind it
+WOLF_TEST(BlockEncoder, qualityMatchesEngineEncoder)
+{
+	const Wolf::Extent3D extent = { 64, 64, 1 };
+	const std::vector<RGBA8> pixels = createGradientImage(extent);
+
+	for (Wolf::ImageCompression::Compression compression : { Wolf::ImageCompression::Compression::BC1, Wolf::ImageCompression::Compression::BC3 })
+	{
+		const BlockEncoder::EncoderComparison comparison = BlockEncoder::compareWithEngineEncoder(extent, pixels, compression);
+		WOLF_CHECK(comparison.m_editorPSNR > 30.0f);
+		WOLF_CHECK(comparison.m_editorPSNR >= comparison.m_enginePSNR - 1.0f);
+	}
+}
@@ -0,0 +1,101 @@
+#include <cmath>
+#include <cstring>
+
+#include "MipChainBuilder.h"
+
+#include "TestFramework.h"
+
+using Wolf::ImageCompression::RG32F;
+using Wolf::ImageCompression::RGBA8;
+
+namespace
+{
+	bool isEqual(const RGBA8& a, const RGBA8& b)
+	{
+		return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+	}
+}
+
+WOLF_TEST(MipChainBuilder, levelCountGoesDownTo1x1)
+{
+	WOLF_CHECK(MipChainBuilder::computeMipLevelCount({ 1, 1, 1 }) == 1);
+	WOLF_CHECK(MipChainBuilder::computeMipLevelCount({ 256, 64, 1 }) == 9);
+	WOLF_CHECK(MipChainBuilder::computeMipLevelCount({ 5, 3, 1 }) == 3);
+}
+
+WOLF_TEST(MipChainBuilder, boxFilterAveragesTexels)
+{
+	const RGBA8 pixels[4] = { { 0, 100, 255, 255 }, { 10, 100, 255, 0 }, { 20, 100, 0, 255 }, { 30, 101, 0, 0 } };
+	RGBA8 outPixel;
+	MipChainBuilder::downsample({ 2, 2, 1 }, pixels, { MipChainBuilder::Filter::BOX, MipChainBuilder::Content::COLOR }, &outPixel, 1);
+	WOLF_CHECK(isEqual(outPixel, { 15, 100, 128, 128 }));
+
+	// Filtering is done in linear space: black and white average to linear 0.5, sRGB 188
+	const RGBA8 srgbPixels[4] = { { 0, 0, 0, 255 }, { 255, 255, 255, 255 }, { 0, 0, 0, 255 }, { 255, 255, 255, 255 } };
+	MipChainBuilder::downsample({ 2, 2, 1 }, srgbPixels, { MipChainBuilder::Filter::BOX, MipChainBuilder::Content::SRGB_COLOR }, &outPixel, 1);
+	WOLF_CHECK(isEqual(outPixel, { 188, 188, 188, 255 }));
+}
+
+WOLF_TEST(MipChainBuilder, uniformImageStaysUniform)
+{
+	constexpr RGBA8 COLOR = { 37, 140, 222, 90 };
+	const Wolf::Extent3D extent = { 64, 16, 1 };
+	const std::vector<RGBA8> pixels(static_cast<size_t>(extent.width) * extent.height, COLOR);
+
+	for (MipChainBuilder::Filter filter : { MipChainBuilder::Filter::BOX, MipChainBuilder::Filter::KAISER })
+	{
+		for (MipChainBuilder::Content content : { MipChainBuilder::Content::COLOR, MipChainBuilder::Content::SRGB_COLOR })
+		{
+			std::vector<std::vector<RGBA8>> mipLevels;
+			MipChainBuilder::buildMipChain(extent, pixels.data(), { filter, content }, mipLevels, 0);
+
+			WOLF_CHECK(mipLevels.size() == MipChainBuilder::computeMipLevelCount(extent) - 1);
+			for (uint32_t levelIdx = 0; levelIdx < mipLevels.size(); ++levelIdx)
+			{
+				const uint32_t mipLevel = levelIdx + 1;
+				WOLF_CHECK(mipLevels[levelIdx].size() == static_cast<size_t>(std::max(extent.width >> mipLevel, 1u)) * std::max(extent.height >> mipLevel, 1u));
+
+				bool isUniform = true;
+				for (const RGBA8& pixel : mipLevels[levelIdx])
+					isUniform &= isEqual(pixel, COLOR);
+				WOLF_CHECK(isUniform);
+			}
+		}
+	}
+}
+
+WOLF_TEST(MipChainBuilder, normalsAreRenormalized)
+{
+	const RG32F pixels[4] = { RG32F(0.6f, 0.0f), RG32F(0.0f, 0.6f), RG32F(0.6f, 0.0f), RG32F(0.0f, 0.6f) };
+	RG32F outPixel;
+	MipChainBuilder::downsample({ 2, 2, 1 }, pixels, { MipChainBuilder::Filter::BOX, MipChainBuilder::Content::NORMAL }, &outPixel, 1);
+
+	// Average of (0.6, 0, 0.8) and (0, 0.6, 0.8) normalized
+	const float expected = 0.3f / std::sqrt(0.82f);
+	const float* components = reinterpret_cast<const float*>(&outPixel);
+	WOLF_CHECK(std::abs(components[0] - expected) < 1e-4f);
+	WOLF_CHECK(std::abs(components[1] - expected) < 1e-4f);
+}
+
+WOLF_TEST(MipChainBuilder, rowPairsMatchBoxDownsample)
+{
+	const Wolf::Extent3D extent = { 32, 8, 1 };
+	std::vector<RGBA8> pixels(static_cast<size_t>(extent.width) * extent.height);
+	uint32_t seed = 7;
+	for (RGBA8& pixel : pixels)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		memcpy(&pixel, &seed, sizeof(pixel));
+	}
+
+	for (MipChainBuilder::Content content : { MipChainBuilder::Content::COLOR, MipChainBuilder::Content::SRGB_COLOR, MipChainBuilder::Content::NORMAL })
+	{
+		std::vector<RGBA8> expectedPixels(static_cast<size_t>(extent.width / 2) * (extent.height / 2));
+		MipChainBuilder::downsample(extent, pixels.data(), { MipChainBuilder::Filter::BOX, content }, expectedPixels.data(), 1);
+
+		std::vector<RGBA8> rowPairPixels(expectedPixels.size());
+		MipChainBuilder::downsampleRowPairs(pixels.data(), extent.width, extent.height / 2, content, rowPairPixels.data());
+
+		WOLF_CHECK(memcmp(rowPairPixels.data(), expectedPixels.data(), expectedPixels.size() * sizeof(RGBA8)) == 0);
+	}
+}
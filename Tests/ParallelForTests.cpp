@@ -0,0 +1,76 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "ParallelFor.h"
+
+#include "TestFramework.h"
+
+WOLF_TEST(ParallelFor, everyTaskRunsOnce)
+{
+	for (uint32_t taskCount : { 0u, 1u, 7u, 1000u })
+	{
+		for (uint32_t maxThreadCount : { 0u, 1u, 2u })
+		{
+			std::vector<std::atomic<uint32_t>> runCounts(taskCount);
+			parallelFor(taskCount, [&runCounts](uint32_t taskIdx) { runCounts[taskIdx]++; }, maxThreadCount);
+
+			bool isEveryTaskRunOnce = true;
+			for (const std::atomic<uint32_t>& runCount : runCounts)
+				isEveryTaskRunOnce &= runCount == 1;
+			WOLF_CHECK(isEveryTaskRunOnce);
+		}
+	}
+}
+
+WOLF_TEST(ParallelFor, singleThreadRunsOnCallingThread)
+{
+	const std::thread::id callingThreadId = std::this_thread::get_id();
+	std::atomic<bool> hasRunElsewhere = false;
+	parallelFor(64, [&](uint32_t) { hasRunElsewhere = hasRunElsewhere || std::this_thread::get_id() != callingThreadId; }, 1);
+	WOLF_CHECK(!hasRunElsewhere);
+}
+
+WOLF_TEST(ParallelFor, nestedCallsComplete)
+{
+	constexpr uint32_t OUTER_TASK_COUNT = 8;
+	constexpr uint32_t INNER_TASK_COUNT = 100;
+
+	std::atomic<uint32_t> runCount = 0;
+	parallelFor(OUTER_TASK_COUNT, [&runCount](uint32_t)
+		{
+			parallelFor(INNER_TASK_COUNT, [&runCount](uint32_t) { runCount++; });
+		});
+	WOLF_CHECK(runCount == OUTER_TASK_COUNT * INNER_TASK_COUNT);
+
+	// A single outer task lets the inner call use the workers
+	runCount = 0;
+	parallelFor(1, [&runCount](uint32_t)
+		{
+			parallelFor(INNER_TASK_COUNT, [&runCount](uint32_t) { runCount++; });
+		});
+	WOLF_CHECK(runCount == INNER_TASK_COUNT);
+}
+
+WOLF_TEST(ParallelFor, concurrentCallers)
+{
+	constexpr uint32_t CALLER_COUNT = 4;
+	constexpr uint32_t TASK_COUNT = 500;
+
+	std::vector<uint64_t> sums(CALLER_COUNT, 0);
+	std::vector<std::thread> callers;
+	for (uint32_t callerIdx = 0; callerIdx < CALLER_COUNT; ++callerIdx)
+	{
+		callers.emplace_back([callerIdx, &sums]()
+			{
+				std::atomic<uint64_t> sum = 0;
+				parallelFor(TASK_COUNT, [&sum](uint32_t taskIdx) { sum += taskIdx; });
+				sums[callerIdx] = sum;
+			});
+	}
+	for (std::thread& caller : callers)
+		caller.join();
+
+	for (uint64_t sum : sums)
+		WOLF_CHECK(sum == static_cast<uint64_t>(TASK_COUNT) * (TASK_COUNT - 1) / 2);
+}
@@ -0,0 +1,86 @@
+#include <fstream>
+
+#include "ShaderSnippetCache.h"
+
+#include "TestFramework.h"
+
+namespace
+{
+	void writeFile(const std::filesystem::path& path, const std::string& content)
+	{
+		std::ofstream output(path, std::ios::out | std::ios::binary | std::ios::trunc);
+		output << content;
+	}
+}
+
+WOLF_TEST(ShaderSnippetCache, tokensAreReplacedAndSnippetsReused)
+{
+	const std::filesystem::path folder = TestFramework::createTemporaryFolder("ShaderSnippetCache_reuse");
+	const std::string sourceFilePath = (folder / "snippet.glsl").string();
+	writeFile(folder / "snippet.glsl", "layout(binding = @BINDING) uniform sampler2D tex@BINDING;");
+
+	ShaderSnippetCache shaderSnippetCache((folder / "cache.bin").string());
+
+	std::string code;
+	shaderSnippetCache.appendSnippet(sourceFilePath, { { "@BINDING", "3" } }, code);
+	WOLF_CHECK(code == "layout(binding = 3) uniform sampler2D tex3;\n");
+
+	shaderSnippetCache.appendSnippet(sourceFilePath, { { "@BINDING", "3" } }, code);
+	shaderSnippetCache.appendSnippet(sourceFilePath, { { "@BINDING", "4" } }, code);
+	WOLF_CHECK(code == "layout(binding = 3) uniform sampler2D tex3;\nlayout(binding = 3) uniform sampler2D tex3;\nlayout(binding = 4) uniform sampler2D tex4;\n");
+	WOLF_CHECK(shaderSnippetCache.getHitCount() == 1);
+	WOLF_CHECK(shaderSnippetCache.getMissCount() == 2);
+}
+
+WOLF_TEST(ShaderSnippetCache, snippetKeysSeparateTokens)
+{
+	WOLF_CHECK(ShaderSnippetCache::computeSnippetKey(1, { { "ab", "c" } }) != ShaderSnippetCache::computeSnippetKey(1, { { "a", "bc" } }));
+	WOLF_CHECK(ShaderSnippetCache::computeSnippetKey(1, { { "a", "b" } }) != ShaderSnippetCache::computeSnippetKey(2, { { "a", "b" } }));
+	WOLF_CHECK(ShaderSnippetCache::computeSnippetKey(1, { { "a", "b" } }) == ShaderSnippetCache::computeSnippetKey(1, { { "a", "b" } }));
+}
+
+WOLF_TEST(ShaderSnippetCache, savedSnippetsAreHitByNextRun)
+{
+	const std::filesystem::path folder = TestFramework::createTemporaryFolder("ShaderSnippetCache_save");
+	const std::string sourceFilePath = (folder / "snippet.glsl").string();
+	const std::string cacheFilePath = (folder / "cache.bin").string();
+	writeFile(folder / "snippet.glsl", "float value = @VALUE;\n");
+
+	{
+		ShaderSnippetCache shaderSnippetCache(cacheFilePath);
+		std::string code;
+		shaderSnippetCache.appendSnippet(sourceFilePath, { { "@VALUE", "1.0" } }, code);
+		shaderSnippetCache.save();
+	}
+
+	ShaderSnippetCache shaderSnippetCache(cacheFilePath);
+	std::string code;
+	shaderSnippetCache.appendSnippet(sourceFilePath, { { "@VALUE", "1.0" } }, code);
+	WOLF_CHECK(code == "float value = 1.0;\n");
+	WOLF_CHECK(shaderSnippetCache.getHitCount() == 1);
+	WOLF_CHECK(shaderSnippetCache.getMissCount() == 0);
+	WOLF_CHECK(shaderSnippetCache.getHitRate() == 1.0f);
+}
+
+WOLF_TEST(ShaderSnippetCache, modifiedSourceIsReadAgain)
+{
+	const std::filesystem::path folder = TestFramework::createTemporaryFolder("ShaderSnippetCache_modified");
+	const std::string sourceFilePath = (folder / "snippet.glsl").string();
+	writeFile(folder / "snippet.glsl", "int a = @VALUE;\n");
+
+	ShaderSnippetCache shaderSnippetCache((folder / "cache.bin").string());
+	std::string code;
+	shaderSnippetCache.appendSnippet(sourceFilePath, { { "@VALUE", "1" } }, code);
+
+	writeFile(folder / "snippet.glsl", "int abc = @VALUE;\n"); // size changes, whatever the file time resolution
+	code.clear();
+	shaderSnippetCache.appendSnippet(sourceFilePath, { { "@VALUE", "1" } }, code);
+	WOLF_CHECK(code == "int abc = 1;\n");
+	WOLF_CHECK(shaderSnippetCache.getMissCount() == 2);
+
+	shaderSnippetCache.invalidate(sourceFilePath);
+	code.clear();
+	shaderSnippetCache.appendSnippet(sourceFilePath, { { "@VALUE", "1" } }, code);
+	WOLF_CHECK(code == "int abc = 1;\n");
+	WOLF_CHECK(shaderSnippetCache.getHitCount() == 1); // same content, the snippet is still there
+}
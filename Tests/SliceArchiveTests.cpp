@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <random>
+
+#include "SliceArchive.h"
+
+#include "TestFramework.h"
+
+namespace
+{
+	struct SliceData
+	{
+		uint32_t m_mipLevel;
+		uint32_t m_sliceX;
+		uint32_t m_sliceY;
+		std::vector<uint8_t> m_data;
+	};
+
+	constexpr uint32_t BLOCK_SIZE = 8;
+	const std::vector<SliceArchive::MipInfo> MIPS = { { 4, 3 }, { 2, 2 }, { 1, 1 } };
+
+	// Odd columns are uniform and compress, even ones are noise and are stored as they are
+	std::vector<SliceData> createSlices()
+	{
+		std::mt19937 randomEngine(1);
+		std::vector<SliceData> slices;
+		for (uint32_t mipLevel = 0; mipLevel < MIPS.size(); ++mipLevel)
+		{
+			for (uint32_t sliceY = 0; sliceY < MIPS[mipLevel].m_sliceCountY; ++sliceY)
+			{
+				for (uint32_t sliceX = 0; sliceX < MIPS[mipLevel].m_sliceCountX; ++sliceX)
+				{
+					SliceData& slice = slices.emplace_back(SliceData{ mipLevel, sliceX, sliceY, std::vector<uint8_t>(64 * BLOCK_SIZE, 7) });
+					if (sliceX % 2 == 0)
+						std::generate(slice.m_data.begin(), slice.m_data.end(), [&randomEngine]() { return static_cast<uint8_t>(randomEngine()); });
+				}
+			}
+		}
+		return slices;
+	}
+
+	bool writeArchive(const std::string& filename, const std::vector<SliceData>& slices, const std::vector<uint32_t>& writeOrder)
+	{
+		SliceArchive::Writer writer(filename, 42, MIPS, BLOCK_SIZE, true);
+		for (uint32_t sliceIdx : writeOrder)
+		{
+			const SliceData& slice = slices[sliceIdx];
+			writer.writeSlice(slice.m_mipLevel, slice.m_sliceX, slice.m_sliceY, slice.m_data.data(), static_cast<uint32_t>(slice.m_data.size()));
+		}
+		return writer.finalize();
+	}
+
+	std::vector<char> readFile(const std::filesystem::path& path)
+	{
+		std::ifstream input(path, std::ios::in | std::ios::binary);
+		return { std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>() };
+	}
+}
+
+WOLF_TEST(SliceArchive, layoutDoesNotDependOnWriteOrder)
+{
+	const std::filesystem::path folder = TestFramework::createTemporaryFolder("SliceArchive_layout");
+	const std::vector<SliceData> slices = createSlices();
+
+	std::vector<uint32_t> writeOrder(slices.size());
+	for (uint32_t i = 0; i < writeOrder.size(); ++i)
+		writeOrder[i] = i;
+	WOLF_CHECK(writeArchive((folder / "inOrder.pack").string(), slices, writeOrder));
+
+	std::shuffle(writeOrder.begin(), writeOrder.end(), std::mt19937(2));
+	WOLF_CHECK(writeArchive((folder / "shuffled.pack").string(), slices, writeOrder));
+
+	WOLF_CHECK(readFile(folder / "inOrder.pack") == readFile(folder / "shuffled.pack"));
+
+	const SliceArchive::Reader reader((folder / "shuffled.pack").string());
+	WOLF_CHECK(reader.isValid());
+	WOLF_CHECK(reader.getHash() == 42);
+	WOLF_CHECK(reader.getMipCount() == MIPS.size());
+	for (const SliceData& slice : slices)
+	{
+		std::vector<uint8_t> data;
+		WOLF_CHECK(reader.readSlice(slice.m_mipLevel, slice.m_sliceX, slice.m_sliceY, data));
+		WOLF_CHECK(data == slice.m_data);
+
+		const SliceArchive::SliceEntry* entry = reader.getSliceEntry(slice.m_mipLevel, slice.m_sliceX, slice.m_sliceY);
+		WOLF_CHECK(entry && entry->m_offset % SliceArchive::ALIGNMENT == 0);
+		WOLF_CHECK(entry && (entry->m_compression == SliceArchive::SliceCompression::BLOCK_RUN_LENGTH) == (slice.m_sliceX % 2 == 1));
+	}
+	WOLF_CHECK(reader.getSliceEntry(0, 4, 0) == nullptr);
+
+	uint64_t hash = 0;
+	WOLF_CHECK(SliceArchive::readHash((folder / "inOrder.pack").string(), hash) && hash == 42);
+}
+
+WOLF_TEST(SliceArchive, incompleteArchiveIsInvalid)
+{
+	const std::filesystem::path folder = TestFramework::createTemporaryFolder("SliceArchive_incomplete");
+	const std::vector<SliceData> slices = createSlices();
+
+	std::vector<uint32_t> writeOrder(slices.size() - 1);
+	for (uint32_t i = 0; i < writeOrder.size(); ++i)
+		writeOrder[i] = i;
+	WOLF_CHECK(!writeArchive((folder / "incomplete.pack").string(), slices, writeOrder));
+
+	uint64_t hash = 0;
+	WOLF_CHECK(!SliceArchive::readHash((folder / "incomplete.pack").string(), hash));
+	WOLF_CHECK(!SliceArchive::Reader((folder / "incomplete.pack").string()).isValid());
+}
+
+WOLF_TEST(SliceArchive, blockRunLengthRoundTrip)
+{
+	std::vector<uint8_t> data(32 * BLOCK_SIZE, 3);
+	std::fill_n(data.begin() + 5 * BLOCK_SIZE, BLOCK_SIZE, 9);
+
+	std::vector<uint8_t> compressedData;
+	const uint32_t storedSize = SliceArchive::compressBlockRunLength(data.data(), static_cast<uint32_t>(data.size()), BLOCK_SIZE, compressedData);
+	WOLF_CHECK(storedSize == 3 * (sizeof(uint16_t) + BLOCK_SIZE));
+
+	std::vector<uint8_t> uncompressedData(data.size());
+	WOLF_CHECK(SliceArchive::uncompressBlockRunLength(compressedData.data(), storedSize, BLOCK_SIZE, static_cast<uint32_t>(data.size()), uncompressedData.data()));
+	WOLF_CHECK(uncompressedData == data);
+
+	// Runs longer than the expected size are rejected
+	WOLF_CHECK(!SliceArchive::uncompressBlockRunLength(compressedData.data(), storedSize, BLOCK_SIZE, static_cast<uint32_t>(data.size()) - BLOCK_SIZE, uncompressedData.data()));
+
+	// Data which doesn't get smaller is left uncompressed
+	std::vector<uint8_t> noise(4 * BLOCK_SIZE);
+	for (size_t i = 0; i < noise.size(); ++i)
+		noise[i] = static_cast<uint8_t>(i);
+	WOLF_CHECK(SliceArchive::compressBlockRunLength(noise.data(), static_cast<uint32_t>(noise.size()), BLOCK_SIZE, compressedData) == std::numeric_limits<uint32_t>::max());
+}
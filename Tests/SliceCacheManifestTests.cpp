@@ -0,0 +1,129 @@
+#include <fstream>
+
+#include "SliceCacheManifest.h"
+
+#include "TestFramework.h"
+
+namespace
+{
+	SliceCacheManifest::Parameters createParameters()
+	{
+		SliceCacheManifest::Parameters parameters;
+		parameters.m_codeHash = 0x1234;
+		parameters.m_sourceFileSize = 4096;
+		parameters.m_sourceLastWriteTime = 42;
+		parameters.m_width = 1024;
+		parameters.m_height = 512;
+		parameters.m_mipCount = 3;
+		parameters.m_pageSize = 128;
+		parameters.m_borderSize = 8;
+		parameters.m_blockSize = 16;
+		return parameters;
+	}
+}
+
+WOLF_TEST(SliceCacheManifest, saveAndLoadRoundTrip)
+{
+	const std::filesystem::path folder = TestFramework::createTemporaryFolder("SliceCacheManifest_roundTrip");
+	const std::string filename = (folder / SliceCacheManifest::FILENAME).string();
+
+	SliceCacheManifest manifest(createParameters(), 3);
+	manifest.setSliceInfo(0, { 1, 2, 100, 1 });
+	manifest.setSliceInfo(2, { 5, 6, 300, 1 });
+	manifest.setIsComplete(true);
+	WOLF_CHECK(manifest.save(filename));
+	WOLF_CHECK(!std::filesystem::exists(filename + ".tmp"));
+
+	SliceCacheManifest loadedManifest;
+	WOLF_CHECK(loadedManifest.load(filename));
+	WOLF_CHECK(loadedManifest.getParameters() == createParameters());
+	WOLF_CHECK(loadedManifest.getSliceCount() == 3);
+	WOLF_CHECK(loadedManifest.getSliceInfo(2).m_sourceHash == 5 && loadedManifest.getSliceInfo(2).m_contentHash == 6 && loadedManifest.getSliceInfo(2).m_size == 300);
+	WOLF_CHECK(!loadedManifest.isComplete()); // slice 1 isn't built
+
+	loadedManifest.setSliceInfo(1, { 3, 4, 200, 1 });
+	WOLF_CHECK(loadedManifest.isComplete());
+	loadedManifest.setIsComplete(false);
+	WOLF_CHECK(!loadedManifest.isComplete());
+}
+
+WOLF_TEST(SliceCacheManifest, otherFilesAreRejected)
+{
+	const std::filesystem::path folder = TestFramework::createTemporaryFolder("SliceCacheManifest_rejected");
+
+	SliceCacheManifest manifest;
+	WOLF_CHECK(!manifest.load((folder / "missing.bin").string()));
+
+	const std::filesystem::path oldVersionPath = folder / "oldVersion.bin";
+	{
+		std::ofstream output(oldVersionPath, std::ios::out | std::ios::binary);
+		const uint32_t header[2] = { SliceCacheManifest::MAGIC, SliceCacheManifest::VERSION - 1 };
+		output.write(reinterpret_cast<const char*>(header), sizeof(header));
+	}
+	WOLF_CHECK(!manifest.load(oldVersionPath.string()));
+
+	const std::filesystem::path truncatedPath = folder / "truncated.bin";
+	{
+		std::ofstream output(truncatedPath, std::ios::out | std::ios::binary);
+		const uint32_t header[3] = { SliceCacheManifest::MAGIC, SliceCacheManifest::VERSION, 0 };
+		output.write(reinterpret_cast<const char*>(header), sizeof(header));
+	}
+	WOLF_CHECK(!manifest.load(truncatedPath.string()));
+}
+
+WOLF_TEST(SliceCacheManifest, layoutCompatibilityIgnoresSourceFile)
+{
+	const SliceCacheManifest::Parameters parameters = createParameters();
+
+	SliceCacheManifest::Parameters touchedSource = parameters;
+	touchedSource.m_sourceFileSize = 8192;
+	touchedSource.m_sourceLastWriteTime = 43;
+	WOLF_CHECK(parameters.isLayoutCompatible(touchedSource));
+	WOLF_CHECK(!(parameters == touchedSource));
+
+	SliceCacheManifest::Parameters otherPageSize = parameters;
+	otherPageSize.m_pageSize = 256;
+	WOLF_CHECK(!parameters.isLayoutCompatible(otherPageSize));
+
+	SliceCacheManifest::Parameters packed = parameters;
+	packed.m_isPacked = 1;
+	WOLF_CHECK(!parameters.isLayoutCompatible(packed));
+}
+
+WOLF_TEST(SliceCacheManifest, hashDependsOnEveryByte)
+{
+	std::vector<uint8_t> data(37);
+	for (size_t i = 0; i < data.size(); ++i)
+		data[i] = static_cast<uint8_t>(i);
+	const uint64_t hash = SliceCacheManifest::computeHash(data.data(), data.size());
+
+	WOLF_CHECK(hash == SliceCacheManifest::computeHash(data.data(), data.size()));
+	WOLF_CHECK(hash != SliceCacheManifest::computeHash(data.data(), data.size() - 1));
+	for (size_t i = 0; i < data.size(); ++i)
+	{
+		data[i] ^= 1;
+		WOLF_CHECK(hash != SliceCacheManifest::computeHash(data.data(), data.size()));
+		data[i] ^= 1;
+	}
+
+	const std::vector<uint8_t> zeros(16, 0);
+	WOLF_CHECK(SliceCacheManifest::computeHash(zeros.data(), 8) != SliceCacheManifest::computeHash(zeros.data(), 16));
+}
+
+WOLF_TEST(SliceCacheManifest, sourceFileInfo)
+{
+	const std::filesystem::path folder = TestFramework::createTemporaryFolder("SliceCacheManifest_sourceFile");
+	{
+		std::ofstream output(folder / "source.png", std::ios::out | std::ios::binary);
+		output << "0123456789";
+	}
+
+	uint64_t size;
+	int64_t lastWriteTime;
+	SliceCacheManifest::computeSourceFileInfo((folder / "source.png").string(), size, lastWriteTime);
+	WOLF_CHECK(size == 10);
+	WOLF_CHECK(lastWriteTime != 0);
+
+	SliceCacheManifest::computeSourceFileInfo((folder / "missing.png").string(), size, lastWriteTime);
+	WOLF_CHECK(size == 0 && lastWriteTime == 0);
+}
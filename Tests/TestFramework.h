@@ -0,0 +1,37 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Minimal test registry for the CPU-only parts of the editor (no window, no GPU).
+// Tests register themselves at static initialization and are run by TestMain.cpp, optionally filtered by suite name.
+// A failed check is reported and the test goes on, so a single run lists every failure
+namespace TestFramework
+{
+	struct TestCase
+	{
+		const char* m_suiteName;
+		const char* m_testName;
+		void (*m_function)();
+	};
+
+	std::vector<TestCase>& getTestCases();
+	void reportFailure(const char* expression, const char* file, int line);
+
+	// Empty folder, created again for each call, for tests writing files
+	std::filesystem::path createTemporaryFolder(const std::string& name);
+
+	struct Registration
+	{
+		Registration(const char* suiteName, const char* testName, void (*function)()) { getTestCases().push_back({ suiteName, testName, function }); }
+	};
+}
+
+#define WOLF_TEST(suiteName, testName) \
+	static void suiteName##_##testName(); \
+	static TestFramework::Registration suiteName##_##testName##_registration(#suiteName, #testName, &suiteName##_##testName); \
+	static void suiteName##_##testName()
+
+#define WOLF_CHECK(expression) \
+	do { if (!(expression)) TestFramework::reportFailure(#expression, __FILE__, __LINE__); } while (false)
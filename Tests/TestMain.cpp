@@ -0,0 +1,62 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "TestFramework.h"
+
+namespace
+{
+	uint32_t g_failureCount = 0;
+}
+
+std::vector<TestFramework::TestCase>& TestFramework::getTestCases()
+{
+	static std::vector<TestCase> testCases;
+	return testCases;
+}
+
+void TestFramework::reportFailure(const char* expression, const char* file, int line)
+{
+	printf("    %s(%d): check failed: %s\n", file, line, expression);
+	g_failureCount++;
+}
+
+std::filesystem::path TestFramework::createTemporaryFolder(const std::string& name)
+{
+	const std::filesystem::path folder = std::filesystem::temp_directory_path() / "WolfEditorTests" / name;
+	std::filesystem::remove_all(folder);
+	std::filesystem::create_directories(folder);
+	return folder;
+}
+
+// Usage: WolfEngine_3DEditor_Tests [suite name], all suites are run when no name is given
+int main(int argc, char** argv)
+{
+	const char* suiteFilter = argc > 1 ? argv[1] : nullptr;
+
+	uint32_t runCount = 0;
+	uint32_t failedTestCount = 0;
+	for (const TestFramework::TestCase& testCase : TestFramework::getTestCases())
+	{
+		if (suiteFilter && strcmp(suiteFilter, testCase.m_suiteName) != 0)
+			continue;
+
+		const uint32_t previousFailureCount = g_failureCount;
+		testCase.m_function();
+		runCount++;
+
+		const bool hasFailed = g_failureCount != previousFailureCount;
+		if (hasFailed)
+			failedTestCount++;
+		printf("[%s] %s.%s\n", hasFailed ? "FAILED" : "passed", testCase.m_suiteName, testCase.m_testName);
+	}
+
+	if (runCount == 0)
+	{
+		printf("No test found for suite %s\n", suiteFilter ? suiteFilter : "(all)");
+		return 1;
+	}
+
+	printf("%u/%u tests passed\n", runCount - failedTestCount, runCount);
+	return failedTestCount == 0 ? 0 : 1;
+}
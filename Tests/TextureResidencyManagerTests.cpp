@@ -0,0 +1,129 @@
+#include "TextureResidencyManager.h"
+
+#include "TestFramework.h"
+
+namespace
+{
+	// 2048x2048, 1 byte per texel: tail starts at mip 4 (128x128)
+	std::vector<uint64_t> createLevelSizes()
+	{
+		std::vector<uint64_t> levelSizes;
+		for (uint32_t mipLevel = 0; mipLevel < 12; ++mipLevel)
+			levelSizes.push_back((2048ull >> mipLevel) * (2048ull >> mipLevel));
+		return levelSizes;
+	}
+
+	uint64_t computeTailSize(const std::vector<uint64_t>& levelSizes)
+	{
+		uint64_t tailSize = 0;
+		for (uint32_t mipLevel = 4; mipLevel < levelSizes.size(); ++mipLevel)
+			tailSize += levelSizes[mipLevel];
+		return tailSize;
+	}
+}
+
+WOLF_TEST(TextureResidencyManager, tailIsResidentAtRegistration)
+{
+	const std::vector<uint64_t> levelSizes = createLevelSizes();
+	WOLF_CHECK(TextureResidencyManager::computeTailFirstMip(2048, 2048, 12) == 4);
+
+	TextureResidencyManager textureResidencyManager(1ull << 40, 1ull << 40, 1ull << 40);
+	WOLF_CHECK(textureResidencyManager.registerImage({ 1, 0 }, 2048, 2048, levelSizes) == 0);
+	WOLF_CHECK(textureResidencyManager.getFirstResidentMip({ 1, 0 }) == 4);
+	WOLF_CHECK(textureResidencyManager.getResidentMemory() == computeTailSize(levelSizes));
+	WOLF_CHECK(textureResidencyManager.getPendingLevelCount() == 4);
+
+	textureResidencyManager.unregisterImage({ 1, 0 });
+	WOLF_CHECK(!textureResidencyManager.contains({ 1, 0 }));
+	WOLF_CHECK(textureResidencyManager.getResidentMemory() == 0 && textureResidencyManager.getAllocatedMemory() == 0);
+}
+
+WOLF_TEST(TextureResidencyManager, smallestLevelsStreamFirstWithinFrameLimit)
+{
+	const std::vector<uint64_t> levelSizes = createLevelSizes();
+	TextureResidencyManager textureResidencyManager(1ull << 40, 1ull << 40, levelSizes[3] + levelSizes[2]);
+	textureResidencyManager.registerImage({ 1, 0 }, 2048, 2048, levelSizes);
+
+	std::vector<TextureResidencyManager::StreamRequest> streamRequests;
+	textureResidencyManager.popLevelsToStream(streamRequests);
+	WOLF_CHECK(streamRequests.size() == 2);
+	WOLF_CHECK(streamRequests[0].m_mipLevel == 3 && streamRequests[1].m_mipLevel == 2);
+
+	// A level bigger than the frame limit still streams alone
+	streamRequests.clear();
+	textureResidencyManager.popLevelsToStream(streamRequests);
+	WOLF_CHECK(streamRequests.size() == 1 && streamRequests[0].m_mipLevel == 1);
+}
+
+WOLF_TEST(TextureResidencyManager, allocationIsCappedPerImage)
+{
+	const std::vector<uint64_t> levelSizes = createLevelSizes();
+	const uint64_t tailSize = computeTailSize(levelSizes);
+
+	// Each image allocates its tail and mips 3 and 2, the budget holds both tails, both mips 3 and a single mip 2
+	TextureResidencyManager textureResidencyManager(tailSize * 2 + levelSizes[3] * 2 + levelSizes[2], tailSize + levelSizes[3] + levelSizes[2], 1ull << 40);
+	WOLF_CHECK(textureResidencyManager.registerImage({ 1, 0 }, 2048, 2048, levelSizes) == 2);
+	WOLF_CHECK(textureResidencyManager.registerImage({ 2, 0 }, 2048, 2048, levelSizes) == 2);
+	WOLF_CHECK(textureResidencyManager.getAllocatedMemory() == 2 * (tailSize + levelSizes[3] + levelSizes[2]));
+
+	std::vector<TextureResidencyManager::StreamRequest> streamRequests;
+	textureResidencyManager.popLevelsToStream(streamRequests);
+	WOLF_CHECK(streamRequests.size() == 3);
+	WOLF_CHECK(textureResidencyManager.getResidentMemory() == textureResidencyManager.getMemoryBudget());
+
+	streamRequests.clear();
+	textureResidencyManager.popLevelsToStream(streamRequests);
+	WOLF_CHECK(streamRequests.empty());
+	WOLF_CHECK(textureResidencyManager.getPendingLevelCount() == 1);
+}
+
+WOLF_TEST(TextureResidencyManager, lowerResolutionEvictsLevels)
+{
+	const std::vector<uint64_t> levelSizes = createLevelSizes();
+	const uint64_t tailSize = computeTailSize(levelSizes);
+
+	TextureResidencyManager textureResidencyManager(tailSize * 2 + levelSizes[3] * 2 + levelSizes[2], tailSize + levelSizes[3] + levelSizes[2], 1ull << 40);
+	textureResidencyManager.registerImage({ 1, 0 }, 2048, 2048, levelSizes);
+	textureResidencyManager.registerImage({ 2, 0 }, 2048, 2048, levelSizes);
+
+	std::vector<TextureResidencyManager::StreamRequest> streamRequests;
+	textureResidencyManager.popLevelsToStream(streamRequests);
+	const uint32_t fullAssetId = textureResidencyManager.getFirstResidentMip({ 1, 0 }) == 2 ? 1 : 2;
+	const uint32_t otherAssetId = 3 - fullAssetId;
+
+	// Resolution of the image holding mip 2 falls, its mip 2 goes back to the budget and the other image streams its own
+	textureResidencyManager.requestResolution({ fullAssetId, 0 }, 256, 10);
+	textureResidencyManager.evictUnwantedLevels();
+	WOLF_CHECK(textureResidencyManager.getFirstResidentMip({ fullAssetId, 0 }) == 3);
+
+	streamRequests.clear();
+	textureResidencyManager.popLevelsToStream(streamRequests);
+	WOLF_CHECK(streamRequests.size() == 1);
+	WOLF_CHECK(!streamRequests.empty() && streamRequests[0].m_key.m_assetId == otherAssetId && streamRequests[0].m_mipLevel == 2);
+
+	// Tail is never evicted
+	textureResidencyManager.requestResolution({ fullAssetId, 0 }, 1, 20);
+	textureResidencyManager.evictUnwantedLevels();
+	WOLF_CHECK(textureResidencyManager.getFirstResidentMip({ fullAssetId, 0 }) == 4);
+
+	textureResidencyManager.clear();
+	WOLF_CHECK(textureResidencyManager.getResidentMemory() == 0);
+}
+
+WOLF_TEST(TextureResidencyManager, largestRequestOfAFrameWins)
+{
+	const std::vector<uint64_t> levelSizes = createLevelSizes();
+	TextureResidencyManager textureResidencyManager(1ull << 40, 1ull << 40, 1ull << 40);
+	textureResidencyManager.registerImage({ 1, 0 }, 2048, 2048, levelSizes);
+
+	textureResidencyManager.requestResolution({ 1, 0 }, 256, 1);
+	textureResidencyManager.requestResolution({ 1, 0 }, 1024, 1);
+	std::vector<TextureResidencyManager::StreamRequest> streamRequests;
+	textureResidencyManager.popLevelsToStream(streamRequests);
+	WOLF_CHECK(textureResidencyManager.getFirstResidentMip({ 1, 0 }) == 1);
+
+	// Next frame only asks for 256
+	textureResidencyManager.requestResolution({ 1, 0 }, 256, 2);
+	textureResidencyManager.evictUnwantedLevels();
+	WOLF_CHECK(textureResidencyManager.getFirstResidentMip({ 1, 0 }) == 3);
+}
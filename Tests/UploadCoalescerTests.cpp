@@ -0,0 +1,105 @@
+#include <algorithm>
+
+#include "UploadCoalescer.h"
+
+#include "TestFramework.h"
+
+WOLF_TEST(UploadCoalescer, contiguousWritesAreMerged)
+{
+	UploadCoalescer uploadCoalescer;
+	uploadCoalescer.addWrite({ 1, 0, 16, 7, 0, 0 });
+	uploadCoalescer.addWrite({ 1, 16, 16, 7, 16, 1 });
+	uploadCoalescer.addWrite({ 1, 32, 16, 7, 64, 2 }); // contiguous in destination only
+
+	std::vector<UploadCoalescer::Write> copies;
+	uploadCoalescer.computeCopies(copies);
+
+	WOLF_CHECK(copies.size() == 2);
+	WOLF_CHECK(copies[0].m_dstOffset == 0 && copies[0].m_size == 32 && copies[0].m_srcOffset == 0 && copies[0].m_requestIdx == 0);
+	WOLF_CHECK(copies[1].m_dstOffset == 32 && copies[1].m_size == 16 && copies[1].m_srcOffset == 64);
+	WOLF_CHECK(uploadCoalescer.getDroppedByteCount() == 0);
+}
+
+WOLF_TEST(UploadCoalescer, overwrittenBytesAreDropped)
+{
+	UploadCoalescer uploadCoalescer;
+	uploadCoalescer.addWrite({ 1, 0, 64, 7, 0, 0 });
+	uploadCoalescer.addWrite({ 1, 16, 16, 8, 0, 1 }); // later write wins over [16, 32)
+	uploadCoalescer.addWrite({ 1, 0, 0, 7, 0, 2 }); // empty writes are ignored
+
+	std::vector<UploadCoalescer::Write> copies;
+	uploadCoalescer.computeCopies(copies);
+
+	WOLF_CHECK(uploadCoalescer.getInputWriteCount() == 2);
+	WOLF_CHECK(copies.size() == 3);
+	WOLF_CHECK(copies[0].m_dstOffset == 0 && copies[0].m_size == 16 && copies[0].m_srcKey == 7 && copies[0].m_srcOffset == 0);
+	WOLF_CHECK(copies[1].m_dstOffset == 16 && copies[1].m_size == 16 && copies[1].m_srcKey == 8 && copies[1].m_srcOffset == 0);
+	WOLF_CHECK(copies[2].m_dstOffset == 32 && copies[2].m_size == 32 && copies[2].m_srcKey == 7 && copies[2].m_srcOffset == 32);
+	WOLF_CHECK(uploadCoalescer.getDroppedByteCount() == 16);
+}
+
+WOLF_TEST(UploadCoalescer, destinationsAreKeptApart)
+{
+	UploadCoalescer uploadCoalescer;
+	uploadCoalescer.addWrite({ 2, 0, 32, 7, 0, 0 });
+	uploadCoalescer.addWrite({ 1, 0, 32, 7, 0, 1 });
+	uploadCoalescer.addWrite({ 2, 0, 32, 7, 32, 2 }); // replaces the first write entirely
+
+	std::vector<UploadCoalescer::Write> copies;
+	uploadCoalescer.computeCopies(copies);
+
+	WOLF_CHECK(copies.size() == 2);
+	for (const UploadCoalescer::Write& copy : copies)
+	{
+		WOLF_CHECK(copy.m_size == 32);
+		WOLF_CHECK(copy.m_dstKey == 1 ? copy.m_srcOffset == 0 : copy.m_srcOffset == 32);
+	}
+	WOLF_CHECK(uploadCoalescer.getDroppedByteCount() == 32);
+
+	uploadCoalescer.clear();
+	copies.clear();
+	uploadCoalescer.computeCopies(copies);
+	WOLF_CHECK(copies.empty());
+	WOLF_CHECK(uploadCoalescer.getInputWriteCount() == 0);
+}
+
+// Applying the copies must give the same buffer as applying every write in order
+WOLF_TEST(UploadCoalescer, copiesMatchSequentialWrites)
+{
+	constexpr uint64_t BUFFER_SIZE = 256;
+	std::vector<uint8_t> source(1024);
+	for (size_t i = 0; i < source.size(); ++i)
+		source[i] = static_cast<uint8_t>(i * 31 + 7);
+
+	UploadCoalescer uploadCoalescer;
+	std::vector<uint8_t> expected(BUFFER_SIZE, 0);
+	uint32_t seed = 12345;
+	auto random = [&seed]() { seed = seed * 1664525u + 1013904223u; return seed >> 8; };
+	for (uint32_t requestIdx = 0; requestIdx < 64; ++requestIdx)
+	{
+		const uint64_t dstOffset = random() % BUFFER_SIZE;
+		const uint64_t size = 1 + random() % (BUFFER_SIZE - dstOffset);
+		const uint64_t srcOffset = random() % (source.size() - size);
+		uploadCoalescer.addWrite({ 1, dstOffset, size, 7, srcOffset, requestIdx });
+		std::copy_n(source.begin() + static_cast<std::ptrdiff_t>(srcOffset), size, expected.begin() + static_cast<std::ptrdiff_t>(dstOffset));
+	}
+
+	std::vector<UploadCoalescer::Write> copies;
+	uploadCoalescer.computeCopies(copies);
+
+	std::vector<uint8_t> written(BUFFER_SIZE, 0);
+	std::vector<bool> isWritten(BUFFER_SIZE, false);
+	bool hasOverlap = false;
+	for (const UploadCoalescer::Write& copy : copies)
+	{
+		for (uint64_t i = 0; i < copy.m_size; ++i)
+		{
+			hasOverlap |= isWritten[copy.m_dstOffset + i];
+			isWritten[copy.m_dstOffset + i] = true;
+			written[copy.m_dstOffset + i] = source[copy.m_srcOffset + i];
+		}
+	}
+
+	WOLF_CHECK(!hasOverlap);
+	WOLF_CHECK(written == expected);
+}
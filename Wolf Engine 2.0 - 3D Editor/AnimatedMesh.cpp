@@ -1,6 +1,7 @@
 #include "AnimatedMesh.h"
 
 #include <ProfilerCommon.h>
+#include <RuntimeContext.h>
 #include <glm/gtx/matrix_decompose.hpp>
 
 #include "CommonLayouts.h"
@@ -8,10 +9,9 @@
 #include "EditorParamsHelper.h"
 #include "Entity.h"
 #include "MaterialEditor.h"
-#include "UpdateGPUBuffersPass.h"
 
-AnimatedMesh::AnimatedMesh(const Wolf::ResourceNonOwner<AssetManager>& resourceManager,	const Wolf::ResourceNonOwner<RenderingPipelineInterface>& renderingPipeline)
-: m_assetManager(resourceManager), m_updateGPUBuffersPass(renderingPipeline->getUpdateGPUBuffersPass())
+AnimatedMesh::AnimatedMesh(const Wolf::ResourceNonOwner<AssetManager>& resourceManager, const Wolf::ResourceNonOwner<AnimationSystem>& animationSystem)
+: m_assetManager(resourceManager), m_animationSystem(animationSystem), m_sharedPoseCache(animationSystem->getSharedPoseCache()), m_animationLODScheduler(animationSystem->getLODScheduler())
 {
 	m_defaultPipelineSet.reset(new Wolf::LazyInitSharedResource<Wolf::PipelineSet, AnimatedMesh>([](Wolf::ResourceUniqueOwner<Wolf::PipelineSet>& pipelineSet)
 		{
@@ -75,7 +75,13 @@ AnimatedMesh::AnimatedMesh(const Wolf::ResourceNonOwner<AssetManager>& resourceM
 			descriptorSetLayout.reset(Wolf::DescriptorSetLayout::createDescriptorSetLayout(m_descriptorSetLayoutGenerator.getDescriptorLayouts()));
 		}));
 
-	m_descriptorSet.reset(Wolf::DescriptorSet::createDescriptorSet(*m_descriptorSetLayout->getResource()));
+	m_animationSystem->registerAnimatedMesh(this);
+}
+
+AnimatedMesh::~AnimatedMesh()
+{
+	m_animationSystem->unregisterAnimatedMesh(this);
+	releaseSharedPose();
 }
 
 void AnimatedMesh::loadParams(Wolf::JSONReader& jsonReader)
@@ -98,19 +104,11 @@ void AnimatedMesh::updateBeforeFrame(const Wolf::Timer& globalTimer, const Wolf:
 		{
 			Wolf::ResourceNonOwner<AnimationData> animationData = m_assetManager->getAnimationData(m_meshAssetId);
 
+			// Skeleton may have changed, the shared pose will be acquired again at next update
+			releaseSharedPose();
 			m_boneCount = animationData->m_boneCount;
-			m_bonesBuffer.reset(Wolf::Buffer::createBuffer(m_boneCount * sizeof(glm::mat4), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
-			m_bonesBuffer->setName("Animation bones (AnimatedModel::m_bonesBuffer)");
-
-			m_bonesInfoGPU.resize(m_boneCount);
-			m_bonesInfoCPU.resize(m_boneCount);
 			m_updateMaxTimerRequested = true;
 
-			Wolf::DescriptorSetGenerator descriptorSetGenerator(m_descriptorSetLayoutGenerator.getDescriptorLayouts());
-			descriptorSetGenerator.setBuffer(0, *m_bonesBuffer);
-
-			m_descriptorSet->update(descriptorSetGenerator.getDescriptorSetCreateInfo());
-
 			// Bone names
 			m_boneNamesAndIndices.clear();
 			addBoneNamesAndIndices(animationData->m_rootBones.data());
@@ -127,46 +125,13 @@ void AnimatedMesh::updateBeforeFrame(const Wolf::Timer& globalTimer, const Wolf:
 			m_waitingForMeshLoadingFrameCount = 1;
 		}
 	}
-	else
-	{
-		// Animation update
-		if (m_assetManager->isMeshLoaded(m_meshAssetId))
-		{
-			bool unused;
-			Wolf::ResourceNonOwner<AnimationData> animationData = findAnimationData(unused);
-
-			if (!m_forceTPoseParam)
-			{
-				float timer = static_cast<float>(globalTimer.getCurrentCachedMillisecondsDuration()) / 1000.0f;
-				timer = fmod(timer, m_maxTimer);
-				if (m_forceTimer.isEnabled())
-				{
-					timer = m_forceTimer;
-				}
-				computeBonesInfo(animationData->m_rootBones.data(), glm::mat4(1.0f), timer, m_transform, m_bonesInfoGPU, m_bonesInfoCPU);
-			}
-			else
-			{
-				for (BoneInfoGPU& boneInfo : m_bonesInfoGPU)
-				{
-					boneInfo.transform = glm::mat4(1.0f);
-				}
-			}
-			m_updateGPUBuffersPass->addRequestBeforeFrame({ m_bonesInfoGPU.data(), static_cast<uint32_t>(m_bonesInfoGPU.size() * sizeof(BoneInfoGPU)), m_bonesBuffer.createNonOwnerResource(), 0 });
-		}
-
-		if (m_updateMaxTimerRequested)
-		{
-			updateMaxTimer();
-		}
-	}
 }
 
 bool AnimatedMesh::getMeshesToRender(std::vector<DrawManager::DrawMeshInfo>& outList)
 {
 	PROFILE_FUNCTION
 
-	if (m_waitingForMeshLoadingFrameCount > 0 || !m_assetManager->isMeshLoaded(m_meshAssetId))
+	if (m_waitingForMeshLoadingFrameCount > 0 || !m_assetManager->isMeshLoaded(m_meshAssetId) || !m_sharedPose)
 		return false;
 
 	if (m_hideModel == true)
@@ -175,7 +140,7 @@ bool AnimatedMesh::getMeshesToRender(std::vector<DrawManager::DrawMeshInfo>& out
 	Wolf::InstanceMeshRenderer::MeshToRender meshToRenderInfo = { m_defaultPipelineSet->getResource().createConstNonOwnerResource() };
 	meshToRenderInfo.m_lods.emplace_back(m_assetManager->getMesh(m_meshAssetId).duplicateAs<Wolf::MeshInterface>(), 10'000.0f);
 
-	Wolf::DescriptorSetBindInfo descriptorSetBindInfo(m_descriptorSet.createConstNonOwnerResource(), m_descriptorSetLayout->getResource().createConstNonOwnerResource(), 1);
+	Wolf::DescriptorSetBindInfo descriptorSetBindInfo(m_sharedPose->m_descriptorSet.createConstNonOwnerResource(), m_descriptorSetLayout->getResource().createConstNonOwnerResource(), 1);
 	meshToRenderInfo.m_perPipelineDescriptorSets[CommonPipelineIndices::PIPELINE_IDX_PRE_DEPTH].emplace_back(descriptorSetBindInfo);
 	meshToRenderInfo.m_perPipelineDescriptorSets[CommonPipelineIndices::PIPELINE_IDX_SHADOW_MAP].emplace_back(descriptorSetBindInfo);
 
@@ -265,7 +230,11 @@ void AnimatedMesh::getAnimationOptions(std::vector<std::string>& out)
 
 glm::vec3 AnimatedMesh::getBonePosition(uint32_t boneIdx) const
 {
-	return m_bonesInfoCPU[boneIdx].position;
+	// Shared pose can be evaluated by a job at the same time, the copy is only written by the main thread
+	if (boneIdx >= m_bonePositions.size())
+		return glm::vec3(m_transform[3]);
+
+	return m_transform * glm::vec4(m_bonePositions[boneIdx], 1.0f);
 }
 
 void AnimatedMesh::setAnimation(uint32_t animationIdx)
@@ -275,16 +244,13 @@ void AnimatedMesh::setAnimation(uint32_t animationIdx)
 
 void AnimatedMesh::addBonesToDebug(const AnimationData::Bone* bone, DebugRenderingManager& debugRenderingManager)
 {
-	if (m_bonesInfoGPU.empty())
+	if (!m_sharedPose)
 		return;
 
 	static constexpr float DEBUG_SPHERE_RADIUS = 0.05f;
 
-	glm::vec3 offset = glm::inverse(bone->m_offsetMatrix) * glm::vec4(1.0f);
-	glm::vec4 translation = m_transform * (m_bonesInfoGPU[bone->m_idx].transform * glm::vec4(offset, 1.0f));
-
 	bool isHighlighted = m_boneNamesAndIndices[m_highlightBone].second == bone->m_idx;
-	debugRenderingManager.addSphere(m_bonesInfoCPU[bone->m_idx].position, isHighlighted ? DEBUG_SPHERE_RADIUS * 1.5f : DEBUG_SPHERE_RADIUS, isHighlighted ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(1.0f));
+	debugRenderingManager.addSphere(getBonePosition(bone->m_idx), isHighlighted ? DEBUG_SPHERE_RADIUS * 1.5f : DEBUG_SPHERE_RADIUS, isHighlighted ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(1.0f));
 
 	for (const AnimationData::Bone& childBone : bone->m_children)
 	{
@@ -302,33 +268,164 @@ void AnimatedMesh::addBoneNamesAndIndices(const AnimationData::Bone* bone)
 	}
 }
 
-Wolf::NullableResourceNonOwner<AnimationData> AnimatedMesh::findAnimationData(bool& success)
+AssetId AnimatedMesh::findAnimationAssetId(bool& success)
 {
 	if (!m_assetManager->isMeshLoaded(m_meshAssetId))
 	{
 		success = false;
-		return Wolf::NullableResourceNonOwner<AnimationData>();
+		return NO_ASSET;
 	}
 
 	success = true; // will be set to false if we encounter an error
 
 	uint32_t animationIdx = m_animationSelectParam;
-
-	Wolf::ResourceNonOwner<AnimationData> animationData = m_assetManager->getAnimationData(m_meshAssetId);
 	if (animationIdx > 0)
 	{
 		uint32_t animationResourceId = m_animationsParam[animationIdx - 1 /* first one is default */].getAssetId();
 		if (m_assetManager->isMeshLoaded(animationResourceId))
 		{
-			animationData = m_assetManager->getAnimationData(animationResourceId);
+			return animationResourceId;
+		}
+
+		success = false;
+	}
+
+	return m_meshAssetId;
+}
+
+Wolf::NullableResourceNonOwner<AnimationData> AnimatedMesh::findAnimationData(bool& success)
+{
+	const AssetId animationAssetId = findAnimationAssetId(success);
+	if (animationAssetId == NO_ASSET)
+		return Wolf::NullableResourceNonOwner<AnimationData>();
+
+	return m_assetManager->getAnimationData(animationAssetId);
+}
+
+void AnimatedMesh::updateSharedPose()
+{
+	if (m_waitingForMeshLoadingFrameCount > 0 || !m_assetManager->isMeshLoaded(m_meshAssetId))
+		return;
+
+	if (m_updateMaxTimerRequested)
+	{
+		updateMaxTimer();
+	}
+
+	bool unused;
+	const AssetId animationAssetId = findAnimationAssetId(unused);
+
+	const std::shared_ptr<const FlattenedSkeleton> skeleton = m_assetManager->getFlattenedSkeleton(m_forceTPoseParam ? m_meshAssetId : animationAssetId);
+	if (!skeleton)
+		return;
+
+	SharedPoseCache::Key key;
+	if (m_forceTPoseParam)
+	{
+		key = SharedPoseCache::computeKey(skeleton, m_boneCount, NO_ASSET, 0.0f, true);
+	}
+	else
+	{
+		if (m_forceTimer.isEnabled())
+		{
+			key = SharedPoseCache::computeKey(skeleton, m_boneCount, animationAssetId, m_forceTimer, true);
 		}
 		else
 		{
-			success = false;
+			key = SharedPoseCache::computeKey(skeleton, m_boneCount, animationAssetId, m_timeOffsetParam, false);
 		}
+		key.m_useBakedAnimation = m_useBakedAnimationParam;
+	}
+
+	if (!m_sharedPose || !(m_sharedPose->m_key == key))
+	{
+		releaseSharedPose();
+		m_sharedPose = m_sharedPoseCache->acquire(key, [this](SharedPoseCache::SharedPose& sharedPose) { initializeSharedPose(sharedPose); });
+
+		// Descriptor set to bind has changed
+		notifySubscribers();
+	}
+
+	// Jobs of the previous frame are done, none has started for this one
+	if (m_sharedPose->m_lastEvaluationFrameNumber != SharedPoseCache::NEVER_EVALUATED)
+	{
+		m_bonePositions.resize(m_sharedPose->m_boneCount);
+		for (uint32_t boneIdx = 0; boneIdx < m_sharedPose->m_boneCount; ++boneIdx)
+		{
+			m_bonePositions[boneIdx] = SharedPoseCache::computeUploadedBonePosition(*m_sharedPose, boneIdx);
+		}
+	}
+	else if (m_bonePositions.size() != m_sharedPose->m_boneCount)
+	{
+		m_bonePositions.clear(); // previous skeleton
+	}
+
+	// Bounding sphere includes the transform, all instances sharing the pose request their own rate
+	const Wolf::BoundingSphere boundingSphere = getBoundingSphere();
+	SharedPoseCache::requestUpdatePeriod(m_sharedPose, m_animationLODScheduler->computeUpdatePeriod(boundingSphere.getCenter(), boundingSphere.getRadius()));
+}
+
+bool AnimatedMesh::prepareAnimationJob(const Wolf::Timer& globalTimer, AnimationSystem::Job& outJob)
+{
+	if (!m_sharedPose || m_waitingForMeshLoadingFrameCount > 0)
+		return false;
+
+	const uint32_t currentFrameNumber = Wolf::g_runtimeContext->getCurrentCPUFrameNumber();
+	if (!m_sharedPoseCache->tryBeginUpdate(m_sharedPose, currentFrameNumber))
+		return false; // already updated by another instance
+
+	outJob.m_sharedPose = m_sharedPose;
+	outJob.m_evaluate = m_sharedPoseCache->beginEvaluation(m_sharedPose, currentFrameNumber);
+	// Pose updated every frame has nothing to interpolate, bones are evaluated directly in staging memory
+	const uint32_t updatePeriod = m_sharedPose->m_updatePeriod;
+	outJob.m_interpolate = m_animationLODScheduler->getInterpolateBetweenUpdates() && updatePeriod > 1 && updatePeriod != AnimationLODScheduler::NEVER_UPDATE;
+	if (outJob.m_evaluate)
+	{
+		m_sharedPose->m_isLastEvaluationKept = outJob.m_interpolate;
+	}
+	m_sharedPose->m_uploadedInterpolationFactor = 1.0f;
+	if (outJob.m_interpolate)
+	{
+		if (!SharedPoseCache::computeInterpolationFactor(*m_sharedPose, currentFrameNumber, outJob.m_interpolationFactor))
+			return false; // nothing new to upload
+		m_sharedPose->m_uploadedInterpolationFactor = outJob.m_interpolationFactor;
+	}
+	else if (!outJob.m_evaluate)
+	{
+		return false; // bones buffer keeps the last evaluation
+	}
+
+	const SharedPoseCache::Key& key = m_sharedPose->m_key;
+	outJob.m_time = key.getTime();
+	if (!key.m_isFrozen)
+	{
+		outJob.m_time = fmod(static_cast<float>(globalTimer.getCurrentCachedMillisecondsDuration()) / 1000.0f + outJob.m_time, m_maxTimer);
 	}
+	outJob.m_bakedAnimation = key.m_useBakedAnimation && key.m_clipAssetId != NO_ASSET ? m_assetManager->getBakedAnimation(key.m_clipAssetId) : nullptr;
 
-	return animationData;
+	return true;
+}
+
+void AnimatedMesh::initializeSharedPose(SharedPoseCache::SharedPose& sharedPose)
+{
+	sharedPose.m_staggerId = m_animationLODScheduler->allocateStaggerId();
+
+	sharedPose.m_bonesBuffer.reset(Wolf::Buffer::createBuffer(sharedPose.m_boneCount * sizeof(glm::mat4), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+	sharedPose.m_bonesBuffer->setName("Animation bones (SharedPoseCache::SharedPose::m_bonesBuffer)");
+
+	sharedPose.m_descriptorSet.reset(Wolf::DescriptorSet::createDescriptorSet(*m_descriptorSetLayout->getResource()));
+	Wolf::DescriptorSetGenerator descriptorSetGenerator(m_descriptorSetLayoutGenerator.getDescriptorLayouts());
+	descriptorSetGenerator.setBuffer(0, *sharedPose.m_bonesBuffer);
+	sharedPose.m_descriptorSet->update(descriptorSetGenerator.getDescriptorSetCreateInfo());
+}
+
+void AnimatedMesh::releaseSharedPose()
+{
+	if (m_sharedPose)
+	{
+		m_sharedPoseCache->release(m_sharedPose, Wolf::g_runtimeContext->getCurrentCPUFrameNumber());
+		m_sharedPose = nullptr;
+	}
 }
 
 void AnimatedMesh::updateMaxTimer()
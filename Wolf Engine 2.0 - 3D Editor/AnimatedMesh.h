@@ -5,6 +5,8 @@
 #include "EditorTypesTemplated.h"
 #include "ParameterGroupInterface.h"
 #include "AssetManager.h"
+#include "AnimationSystem.h"
+#include "SharedPoseCache.h"
 
 class AnimatedMesh : public EditorModelInterface
 {
@@ -12,7 +14,8 @@ public:
 	static inline std::string ID = "animatedMesh";
 	std::string getId() const override { return ID; }
 
-	AnimatedMesh(const Wolf::ResourceNonOwner<AssetManager>& resourceManager, const Wolf::ResourceNonOwner<RenderingPipelineInterface>& renderingPipeline);
+	AnimatedMesh(const Wolf::ResourceNonOwner<AssetManager>& resourceManager, const Wolf::ResourceNonOwner<AnimationSystem>& animationSystem);
+	~AnimatedMesh() override;
 
 	void loadParams(Wolf::JSONReader& jsonReader) override;
 
@@ -27,6 +30,7 @@ public:
 
 	Wolf::AABB getAABB() const override;
 	Wolf::BoundingSphere getBoundingSphere() const override;
+	uint32_t getFirstMaterialGPUIdx() const override { return m_materialGPUIdx; }
 
 	void saveCustom() const override {}
 
@@ -34,18 +38,23 @@ public:
 
 	void getAnimationOptions(std::vector<std::string>& out);
 	const std::vector<std::pair<std::string, uint32_t>>& getBoneNamesAndIndices() const { return m_boneNamesAndIndices; }
+	// From the last evaluation completed before this frame's animation jobs, can be called while they run
 	glm::vec3 getBonePosition(uint32_t boneIdx) const;
 	void setAnimation(uint32_t animationIdx);
 
+	// Called by the animation system on main thread: updateSharedPose() for all meshes first, then prepareAnimationJob()
+	void updateSharedPose();
+	bool prepareAnimationJob(const Wolf::Timer& globalTimer, AnimationSystem::Job& outJob);
+
 private:
 	void addBonesToDebug(const AnimationData::Bone* bone, DebugRenderingManager& debugRenderingManager);
 	void addBoneNamesAndIndices(const AnimationData::Bone* bone);
 
 	inline static const std::string TAB = "Mesh";
 	Wolf::ResourceNonOwner<AssetManager> m_assetManager;
-	Wolf::ResourceNonOwner<UpdateGPUBuffersPass> m_updateGPUBuffersPass;
 	AssetId m_meshAssetId = NO_ASSET;
 
+	AssetId findAnimationAssetId(bool& success);
 	Wolf::NullableResourceNonOwner<AnimationData> findAnimationData(bool& success);
 
 	void updateMaxTimer();
@@ -93,6 +102,8 @@ private:
 	void onAnimationAdded();
 	static constexpr uint32_t MAX_ANIMATION = 8;
 	EditorParamArray<Animation> m_animationsParam = EditorParamArray<Animation>("Animations", TAB, "Animation", MAX_ANIMATION, [this] { onAnimationAdded(); });
+	EditorParamBool m_useBakedAnimationParam = EditorParamBool("Baked sampling", TAB, "Animation");
+	EditorParamFloat m_timeOffsetParam = EditorParamFloat("Time offset", TAB, "Animation", 0.0f, 10.0f);
 
 	void updateAnimationsOptions();
 	EditorParamEnum m_animationSelectParam = EditorParamEnum({ "Default" }, "Animation", TAB, "Debug", [this]() { m_updateMaxTimerRequested = true; });
@@ -104,11 +115,13 @@ private:
 
 	std::vector<std::pair<std::string, uint32_t>> m_boneNamesAndIndices;
 
-	std::array<EditorParamInterface*, 9> m_editorParams =
+	std::array<EditorParamInterface*, 11> m_editorParams =
 	{
 		&m_meshAssetParam,
 		&m_materialAsset,
 		&m_animationsParam,
+		&m_useBakedAnimationParam,
+		&m_timeOffsetParam,
 		&m_animationSelectParam,
 		&m_showBonesParam,
 		&m_highlightBone,
@@ -121,12 +134,17 @@ private:
 	std::unique_ptr<Wolf::LazyInitSharedResource<Wolf::PipelineSet, AnimatedMesh>> m_defaultPipelineSet;
 
 	uint32_t m_boneCount = 0;
-	Wolf::ResourceUniqueOwner<Wolf::Buffer> m_bonesBuffer;
-	std::vector<BoneInfoGPU> m_bonesInfoGPU;
-	std::vector<BoneInfoCPU> m_bonesInfoCPU;
+
+	// Bones buffer and descriptor set are owned by the shared pose, bones are evaluated by the animation system
+	void initializeSharedPose(SharedPoseCache::SharedPose& sharedPose);
+	void releaseSharedPose();
+	Wolf::ResourceNonOwner<AnimationSystem> m_animationSystem;
+	Wolf::ResourceNonOwner<SharedPoseCache> m_sharedPoseCache;
+	Wolf::ResourceNonOwner<AnimationLODScheduler> m_animationLODScheduler;
+	SharedPoseCache::SharedPose* m_sharedPose = nullptr;
+	std::vector<glm::vec3> m_bonePositions; // model space, copied from the shared pose before the jobs are queued
 	
 	Wolf::DescriptorSetLayoutGenerator m_descriptorSetLayoutGenerator;
 	std::unique_ptr<Wolf::LazyInitSharedResource<Wolf::DescriptorSetLayout, AnimatedMesh>> m_descriptorSetLayout;
-	Wolf::ResourceUniqueOwner<Wolf::DescriptorSet> m_descriptorSet;
 };
 
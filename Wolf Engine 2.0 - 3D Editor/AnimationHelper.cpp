@@ -1,64 +1,247 @@
 #include "AnimationHelper.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/quaternion.hpp>
 
 #include "Debug.h"
 
-void findMaxTimer(const AnimationData::Bone* bone, float& maxTimer)
+BakedAnimation::BakedAnimation(const AnimationData& animationData, float sampleRate) : m_sampleRate(sampleRate)
 {
-	if (!bone->m_poses.empty() && bone->m_poses.back().m_time > maxTimer)
+	for (const AnimationData::Bone& rootBone : animationData.m_rootBones)
 	{
-		maxTimer = bone->m_poses.back().m_time;
+		findMaxTimer(&rootBone, m_duration);
 	}
 
-	for (const AnimationData::Bone& childBone : bone->m_children)
+	// Last sample is at or after the duration, and at least 2 samples are needed to interpolate
+	m_sampleCount = std::max(static_cast<uint32_t>(std::ceil(m_duration * m_sampleRate)) + 1, 2u);
+
+	m_isBoneAnimated.resize(animationData.m_boneCount, 0);
+	m_translations.resize(static_cast<size_t>(animationData.m_boneCount) * m_sampleCount);
+	m_orientations.resize(static_cast<size_t>(animationData.m_boneCount) * m_sampleCount);
+	m_scales.resize(static_cast<size_t>(animationData.m_boneCount) * m_sampleCount);
+
+	for (const AnimationData::Bone& rootBone : animationData.m_rootBones)
 	{
-		findMaxTimer(&childBone, maxTimer);
+		bakeBone(&rootBone);
 	}
 }
 
-void computeBonesInfo(const AnimationData::Bone* bone, glm::mat4 currentTransform, float time, const glm::mat4& modelTransform, std::vector<BoneInfoGPU>& outBonesInfoGPU, std::vector<BoneInfoCPU>& outBoneInfoCPU)
+bool BakedAnimation::samplePose(uint32_t boneIdx, float time, glm::vec3& outTranslation, glm::quat& outOrientation, glm::vec3& outScale) const
+{
+	if (!m_isBoneAnimated[boneIdx])
+		return false;
+
+	const float samplePosition = std::clamp(time * m_sampleRate, 0.0f, static_cast<float>(m_sampleCount - 1));
+	const uint32_t sampleIdx = std::min(static_cast<uint32_t>(samplePosition), m_sampleCount - 2);
+	const float lerpValue = samplePosition - static_cast<float>(sampleIdx);
+
+	const size_t firstSampleIdx = static_cast<size_t>(boneIdx) * m_sampleCount + sampleIdx;
+	outTranslation = glm::mix(m_translations[firstSampleIdx], m_translations[firstSampleIdx + 1], lerpValue);
+	outOrientation = glm::slerp(m_orientations[firstSampleIdx], m_orientations[firstSampleIdx + 1], lerpValue);
+	outScale = glm::mix(m_scales[firstSampleIdx], m_scales[firstSampleIdx + 1], lerpValue);
+
+	return true;
+}
+
+void BakedAnimation::bakeBone(const AnimationData::Bone* bone)
 {
-	glm::mat4 poseTransform(1.0f);
 	if (!bone->m_poses.empty())
 	{
-		int32_t poseIdx;
-		float lerpValue = 0.0f;
-		for (poseIdx = 1; poseIdx < static_cast<int32_t>(bone->m_poses.size()); ++poseIdx)
+		m_isBoneAnimated[bone->m_idx] = 1;
+
+		const AnimationData::Bone::Pose& firstPose = bone->m_poses.front();
+		const AnimationData::Bone::Pose& lastPose = bone->m_poses.back();
+		const size_t boneFirstSampleIdx = static_cast<size_t>(bone->m_idx) * m_sampleCount;
+
+		uint32_t poseIdx = 1;
+		for (uint32_t sampleIdx = 0; sampleIdx < m_sampleCount; ++sampleIdx)
 		{
-			if (time < bone->m_poses[poseIdx].m_time)
+			// Don't extrapolate before the first keyframe
+			const float sampleTime = std::max(static_cast<float>(sampleIdx) / m_sampleRate, firstPose.m_time);
+			const size_t outIdx = boneFirstSampleIdx + sampleIdx;
+
+			// Time is wrapped before reaching the clip end, holding the last pose keeps the last interval close to the source
+			if (sampleTime >= lastPose.m_time && lastPose.m_time >= m_duration)
 			{
-				lerpValue = (time - bone->m_poses[poseIdx - 1].m_time) / (bone->m_poses[poseIdx].m_time - bone->m_poses[poseIdx - 1].m_time);
-				break;
+				m_translations[outIdx] = lastPose.m_translation;
+				m_orientations[outIdx] = lastPose.m_orientation;
+				m_scales[outIdx] = lastPose.m_scale;
+			}
+			else
+			{
+				::samplePose(bone->m_poses, sampleTime, poseIdx, m_translations[outIdx], m_orientations[outIdx], m_scales[outIdx]);
 			}
 		}
-		if (poseIdx >= static_cast<int32_t>(bone->m_poses.size()))
-		{
-			poseIdx = 1;
-			lerpValue = 0.0f;
-		}
-		if (lerpValue < 0.0f || lerpValue > 1.0f)
-		{
-			Wolf::Debug::sendError("Wrong lerp value");
-		}
+	}
+
+	for (const AnimationData::Bone& childBone : bone->m_children)
+	{
+		bakeBone(&childBone);
+	}
+}
+
+void findMaxTimer(const AnimationData::Bone* bone, float& maxTimer)
+{
+	if (!bone->m_poses.empty() && bone->m_poses.back().m_time > maxTimer)
+	{
+		maxTimer = bone->m_poses.back().m_time;
+	}
+
+	for (const AnimationData::Bone& childBone : bone->m_children)
+	{
+		findMaxTimer(&childBone, maxTimer);
+	}
+}
+
+// Finds the 2 poses to interpolate, 'getPoseTime' returns the time of a pose from its index in the bone poses
+template <typename GetPoseTimeFunction>
+void findPoseInterval(uint32_t poseCount, float time, uint32_t& inOutPoseIdx, const GetPoseTimeFunction& getPoseTime, uint32_t& outPoseIdx, float& outLerpValue)
+{
+	// Start from the first keyframe when time went back (loop, seek) or when the index comes from another clip
+	uint32_t poseIdx = inOutPoseIdx;
+	if (poseIdx == 0 || poseIdx >= poseCount || time < getPoseTime(poseIdx - 1))
+	{
+		poseIdx = 1;
+	}
+	while (poseIdx < poseCount && time >= getPoseTime(poseIdx))
+	{
+		poseIdx++;
+	}
 
+	outLerpValue = 0.0f;
+	if (poseIdx < poseCount)
+	{
+		inOutPoseIdx = poseIdx;
+		outLerpValue = (time - getPoseTime(poseIdx - 1)) / (getPoseTime(poseIdx) - getPoseTime(poseIdx - 1));
+	}
+	else
+	{
+		// After the last keyframe, the first pose is used
+		inOutPoseIdx = poseIdx - 1;
+		poseIdx = 1;
+	}
+	if (outLerpValue < 0.0f || outLerpValue > 1.0f)
+	{
+		Wolf::Debug::sendError("Wrong lerp value");
+	}
+	outPoseIdx = poseIdx;
+}
 
-		glm::vec3 translation = glm::mix(bone->m_poses[poseIdx - 1].m_translation, bone->m_poses[poseIdx].m_translation, lerpValue);
-		glm::quat orientation = glm::slerp(bone->m_poses[poseIdx - 1].m_orientation, bone->m_poses[poseIdx].m_orientation, lerpValue);
-		glm::vec3 scale = glm::mix(bone->m_poses[poseIdx - 1].m_scale, bone->m_poses[poseIdx].m_scale, lerpValue);
+void samplePose(const std::vector<AnimationData::Bone::Pose>& poses, float time, uint32_t& inOutPoseIdx, glm::vec3& outTranslation, glm::quat& outOrientation, glm::vec3& outScale)
+{
+	if (poses.size() == 1)
+	{
+		outTranslation = poses[0].m_translation;
+		outOrientation = poses[0].m_orientation;
+		outScale = poses[0].m_scale;
+		return;
+	}
+
+	uint32_t poseIdx;
+	float lerpValue;
+	findPoseInterval(static_cast<uint32_t>(poses.size()), time, inOutPoseIdx, [&poses](uint32_t idx) { return poses[idx].m_time; }, poseIdx, lerpValue);
+
+	outTranslation = glm::mix(poses[poseIdx - 1].m_translation, poses[poseIdx].m_translation, lerpValue);
+	outOrientation = glm::slerp(poses[poseIdx - 1].m_orientation, poses[poseIdx].m_orientation, lerpValue);
+	outScale = glm::mix(poses[poseIdx - 1].m_scale, poses[poseIdx].m_scale, lerpValue);
+}
+
+void samplePose(const FlattenedSkeleton& skeleton, uint32_t flattenedBoneIdx, float time, uint32_t& inOutPoseIdx, glm::vec3& outTranslation, glm::quat& outOrientation, glm::vec3& outScale)
+{
+	const uint32_t firstPoseIdx = skeleton.m_firstPoseIndices[flattenedBoneIdx];
+	const uint32_t poseCount = skeleton.m_poseCounts[flattenedBoneIdx];
+	if (poseCount == 1)
+	{
+		outTranslation = skeleton.m_poseTranslations[firstPoseIdx];
+		outOrientation = skeleton.m_poseOrientations[firstPoseIdx];
+		outScale = skeleton.m_poseScales[firstPoseIdx];
+		return;
+	}
+
+	uint32_t poseIdx;
+	float lerpValue;
+	findPoseInterval(poseCount, time, inOutPoseIdx, [&skeleton, firstPoseIdx](uint32_t idx) { return skeleton.m_poseTimes[firstPoseIdx + idx]; }, poseIdx, lerpValue);
+
+	const uint32_t previousPoseIdx = firstPoseIdx + poseIdx - 1;
+	const uint32_t nextPoseIdx = firstPoseIdx + poseIdx;
+	outTranslation = glm::mix(skeleton.m_poseTranslations[previousPoseIdx], skeleton.m_poseTranslations[nextPoseIdx], lerpValue);
+	outOrientation = glm::slerp(skeleton.m_poseOrientations[previousPoseIdx], skeleton.m_poseOrientations[nextPoseIdx], lerpValue);
+	outScale = glm::mix(skeleton.m_poseScales[previousPoseIdx], skeleton.m_poseScales[nextPoseIdx], lerpValue);
+}
+
+void computeBonesInfo(const AnimationData::Bone* bone, glm::mat4 currentTransform, float time, const glm::mat4& modelTransform, BoneInfoGPU* outBonesInfoGPU, std::vector<BoneInfoCPU>& outBoneInfoCPU,
+	AnimationCursor* cursor)
+{
+	glm::mat4 poseTransform(1.0f);
+	if (!bone->m_poses.empty())
+	{
+		glm::vec3 translation;
+		glm::quat orientation;
+		glm::vec3 scale;
+		uint32_t poseIdx = 1;
+		uint32_t& cursorPoseIdx = cursor && bone->m_idx < cursor->m_poseIndices.size() ? cursor->m_poseIndices[bone->m_idx] : poseIdx;
+		samplePose(bone->m_poses, time, cursorPoseIdx, translation, orientation, scale);
 
 		poseTransform = glm::translate(glm::mat4(1.0f), translation) * glm::toMat4(orientation) * glm::scale(glm::mat4(1.0f), scale);
 	}
 	currentTransform = currentTransform * poseTransform;
-	outBonesInfoGPU[bone->m_idx].transform = currentTransform * bone->m_offsetMatrix;
+
+	// Output can be upload memory, don't read it back
+	const glm::mat4 boneTransform = currentTransform * bone->m_offsetMatrix;
+	outBonesInfoGPU[bone->m_idx].transform = boneTransform;
 
 	glm::vec3 offset = glm::inverse(bone->m_offsetMatrix) * glm::vec4(1.0f);
-	outBoneInfoCPU[bone->m_idx].position = modelTransform * (outBonesInfoGPU[bone->m_idx].transform * glm::vec4(offset, 1.0f));
+	outBoneInfoCPU[bone->m_idx].position = modelTransform * (boneTransform * glm::vec4(offset, 1.0f));
 
 	for (const AnimationData::Bone& childBone : bone->m_children)
 	{
-		computeBonesInfo(&childBone, currentTransform, time, modelTransform, outBonesInfoGPU, outBoneInfoCPU);
+		computeBonesInfo(&childBone, currentTransform, time, modelTransform, outBonesInfoGPU, outBoneInfoCPU, cursor);
+	}
+}
+
+void computeBonesInfo(const FlattenedSkeleton& skeleton, float time, const glm::mat4& modelTransform, BoneInfoGPU* outBonesInfoGPU, std::vector<BoneInfoCPU>& outBoneInfoCPU, AnimationCursor* cursor,
+	const BakedAnimation* bakedAnimation)
+{
+	// Animated meshes can be evaluated by several jobs at the same time
+	thread_local std::vector<glm::mat4> globalTransforms;
+	globalTransforms.resize(skeleton.getBoneCount());
+
+	for (uint32_t flattenedBoneIdx = 0; flattenedBoneIdx < skeleton.getBoneCount(); ++flattenedBoneIdx)
+	{
+		const uint32_t boneIdx = skeleton.m_boneIndices[flattenedBoneIdx];
+
+		glm::mat4 poseTransform(1.0f);
+		glm::vec3 translation;
+		glm::quat orientation;
+		glm::vec3 scale;
+		bool hasPose = false;
+		if (bakedAnimation)
+		{
+			hasPose = bakedAnimation->samplePose(boneIdx, time, translation, orientation, scale);
+		}
+		else if (skeleton.m_poseCounts[flattenedBoneIdx] > 0)
+		{
+			uint32_t poseIdx = 1;
+			uint32_t& cursorPoseIdx = cursor && boneIdx < cursor->m_poseIndices.size() ? cursor->m_poseIndices[boneIdx] : poseIdx;
+			samplePose(skeleton, flattenedBoneIdx, time, cursorPoseIdx, translation, orientation, scale);
+			hasPose = true;
+		}
+		if (hasPose)
+		{
+			poseTransform = glm::translate(glm::mat4(1.0f), translation) * glm::toMat4(orientation) * glm::scale(glm::mat4(1.0f), scale);
+		}
+
+		// Parents are always evaluated before their children
+		const uint32_t parentIdx = skeleton.m_parentIndices[flattenedBoneIdx];
+		globalTransforms[flattenedBoneIdx] = parentIdx == FlattenedSkeleton::NO_PARENT ? poseTransform : globalTransforms[parentIdx] * poseTransform;
+
+		// Output can be upload memory, don't read it back
+		const glm::mat4 boneTransform = globalTransforms[flattenedBoneIdx] * skeleton.m_offsetMatrices[flattenedBoneIdx];
+		outBonesInfoGPU[boneIdx].transform = boneTransform;
+		outBoneInfoCPU[boneIdx].position = modelTransform * (boneTransform * glm::vec4(skeleton.m_bindPositions[flattenedBoneIdx], 1.0f));
 	}
 }
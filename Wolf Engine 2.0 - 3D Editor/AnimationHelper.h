@@ -1,6 +1,9 @@
 #pragma once
 
+#include <vector>
+
 #include "DAEImporter.h"
+#include "FlattenedSkeleton.h"
 
 struct BoneInfoGPU
 {
@@ -12,5 +15,49 @@ struct BoneInfoCPU
 	glm::vec3 position;
 };
 
+// Keyframe reached by each bone at the last evaluation, one cursor per animated instance.
+// Time mostly moves forward so the next search starts from there instead of the first keyframe
+struct AnimationCursor
+{
+	void reset(uint32_t boneCount) { m_poseIndices.assign(boneCount, 1); }
+
+	std::vector<uint32_t> m_poseIndices; // indexed by bone idx, first pose after the evaluated time
+};
+
+// Clip resampled at a fixed rate. Samples of a bone are contiguous so any time is read from 2 consecutive samples
+class BakedAnimation
+{
+public:
+	static constexpr float DEFAULT_SAMPLE_RATE = 60.0f;
+
+	BakedAnimation(const AnimationData& animationData, float sampleRate = DEFAULT_SAMPLE_RATE);
+
+	// Returns false if the bone isn't animated
+	bool samplePose(uint32_t boneIdx, float time, glm::vec3& outTranslation, glm::quat& outOrientation, glm::vec3& outScale) const;
+
+	float getDuration() const { return m_duration; }
+	float getSampleRate() const { return m_sampleRate; }
+	uint32_t getSampleCount() const { return m_sampleCount; }
+
+private:
+	void bakeBone(const AnimationData::Bone* bone);
+
+	float m_sampleRate;
+	float m_duration = 0.0f;
+	uint32_t m_sampleCount = 0;
+
+	std::vector<uint8_t> m_isBoneAnimated;
+	std::vector<glm::vec3> m_translations; // [boneIdx * m_sampleCount + sampleIdx]
+	std::vector<glm::quat> m_orientations;
+	std::vector<glm::vec3> m_scales;
+};
+
 void findMaxTimer(const AnimationData::Bone* bone, float& maxTimer);
-void computeBonesInfo(const AnimationData::Bone* bone, glm::mat4 currentTransform, float time, const glm::mat4& modelTransform, std::vector<BoneInfoGPU>& outBonesInfoGPU, std::vector<BoneInfoCPU>& outBoneInfoCPU);
\ No newline at end of file
+// 'inOutPoseIdx' is the search start, any value is valid but the search is the shortest when it's the result of the previous call for an earlier time
+void samplePose(const std::vector<AnimationData::Bone::Pose>& poses, float time, uint32_t& inOutPoseIdx, glm::vec3& outTranslation, glm::quat& outOrientation, glm::vec3& outScale);
+void samplePose(const FlattenedSkeleton& skeleton, uint32_t flattenedBoneIdx, float time, uint32_t& inOutPoseIdx, glm::vec3& outTranslation, glm::quat& outOrientation, glm::vec3& outScale);
+void computeBonesInfo(const AnimationData::Bone* bone, glm::mat4 currentTransform, float time, const glm::mat4& modelTransform, BoneInfoGPU* outBonesInfoGPU, std::vector<BoneInfoCPU>& outBoneInfoCPU,
+	AnimationCursor* cursor = nullptr);
+// Single pass over the flattened bones, baked animation is used instead of keyframes when given
+void computeBonesInfo(const FlattenedSkeleton& skeleton, float time, const glm::mat4& modelTransform, BoneInfoGPU* outBonesInfoGPU, std::vector<BoneInfoCPU>& outBoneInfoCPU, AnimationCursor* cursor = nullptr,
+	const BakedAnimation* bakedAnimation = nullptr);
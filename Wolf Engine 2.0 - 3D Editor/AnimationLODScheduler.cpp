@@ -0,0 +1,128 @@
+#include "AnimationLODScheduler.h"
+
+#include <cmath>
+#include <stdexcept>
+
+AnimationLODScheduler::AnimationLODScheduler()
+{
+	m_tiers = { { 0.25f, 1 }, { 0.1f, 2 }, { 0.03f, 4 }, { 0.0f, 8 } };
+	m_frustumPlanes.fill(glm::vec4(0.0f));
+}
+
+bool AnimationLODScheduler::parseTiers(const std::string& tiersDescription, std::vector<Tier>& outTiers)
+{
+	outTiers.clear();
+
+	size_t tierStart = 0;
+	while (tierStart < tiersDescription.size())
+	{
+		size_t tierEnd = tiersDescription.find(',', tierStart);
+		if (tierEnd == std::string::npos)
+			tierEnd = tiersDescription.size();
+
+		const std::string tierDescription = tiersDescription.substr(tierStart, tierEnd - tierStart);
+		const size_t separatorPos = tierDescription.find(':');
+		if (separatorPos == std::string::npos)
+		{
+			outTiers.clear();
+			return false;
+		}
+
+		Tier tier;
+		try
+		{
+			tier.m_minScreenSize = std::stof(tierDescription.substr(0, separatorPos));
+			tier.m_updatePeriod = static_cast<uint32_t>(std::stoul(tierDescription.substr(separatorPos + 1)));
+		}
+		catch (const std::logic_error&)
+		{
+			outTiers.clear();
+			return false;
+		}
+
+		if (tier.m_updatePeriod == 0 || (!outTiers.empty() && tier.m_minScreenSize > outTiers.back().m_minScreenSize))
+		{
+			outTiers.clear();
+			return false;
+		}
+		outTiers.push_back(tier);
+
+		tierStart = tierEnd + 1;
+	}
+
+	return !outTiers.empty();
+}
+
+void AnimationLODScheduler::setTiers(const std::vector<Tier>& tiers)
+{
+	m_tiers = tiers;
+}
+
+void AnimationLODScheduler::beginFrame(uint32_t frameNumber, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix)
+{
+	m_frameNumber = frameNumber;
+	m_viewMatrix = viewMatrix;
+	m_projectionScale = std::abs(projectionMatrix[1][1]); // Y can be flipped
+
+	// Planes from the view projection matrix rows (Gribb-Hartmann), near plane uses the [-1, 1] depth range which is more conservative than [0, 1]
+	const glm::mat4 viewProjectionMatrix = projectionMatrix * viewMatrix;
+	const glm::vec4 row0(viewProjectionMatrix[0][0], viewProjectionMatrix[1][0], viewProjectionMatrix[2][0], viewProjectionMatrix[3][0]);
+	const glm::vec4 row1(viewProjectionMatrix[0][1], viewProjectionMatrix[1][1], viewProjectionMatrix[2][1], viewProjectionMatrix[3][1]);
+	const glm::vec4 row2(viewProjectionMatrix[0][2], viewProjectionMatrix[1][2], viewProjectionMatrix[2][2], viewProjectionMatrix[3][2]);
+	const glm::vec4 row3(viewProjectionMatrix[0][3], viewProjectionMatrix[1][3], viewProjectionMatrix[2][3], viewProjectionMatrix[3][3]);
+
+	m_frustumPlanes = { row3 + row0, row3 - row0, row3 + row1, row3 - row1, row3 + row2, row3 - row2 };
+	for (glm::vec4& plane : m_frustumPlanes)
+	{
+		plane /= glm::length(glm::vec3(plane));
+	}
+}
+
+uint32_t AnimationLODScheduler::computeUpdatePeriod(const glm::vec3& boundingSphereCenter, float boundingSphereRadius) const
+{
+	if (!m_updateOffScreen && !isVisible(boundingSphereCenter, boundingSphereRadius))
+		return NEVER_UPDATE;
+
+	if (m_tiers.empty())
+		return 1;
+
+	return m_tiers[selectTier(computeScreenSize(boundingSphereCenter, boundingSphereRadius))].m_updatePeriod;
+}
+
+bool AnimationLODScheduler::isVisible(const glm::vec3& boundingSphereCenter, float boundingSphereRadius) const
+{
+	for (const glm::vec4& plane : m_frustumPlanes)
+	{
+		if (glm::dot(glm::vec3(plane), boundingSphereCenter) + plane.w < -boundingSphereRadius)
+			return false;
+	}
+	return true;
+}
+
+float AnimationLODScheduler::computeScreenSize(const glm::vec3& boundingSphereCenter, float boundingSphereRadius) const
+{
+	const float distance = glm::length(glm::vec3(m_viewMatrix * glm::vec4(boundingSphereCenter, 1.0f)));
+	if (distance <= boundingSphereRadius)
+		return 1.0f; // camera is inside
+
+	// Projected radius is radius * projectionScale / distance in NDC. Screen height is 2 in NDC so it's also the diameter over the screen height
+	return boundingSphereRadius * m_projectionScale / distance;
+}
+
+uint32_t AnimationLODScheduler::selectTier(float screenSize) const
+{
+	for (uint32_t tierIdx = 0; tierIdx < m_tiers.size(); ++tierIdx)
+	{
+		if (screenSize >= m_tiers[tierIdx].m_minScreenSize)
+			return tierIdx;
+	}
+	return static_cast<uint32_t>(m_tiers.size()) - 1;
+}
+
+bool AnimationLODScheduler::shouldUpdate(uint32_t frameNumber, uint32_t staggerId, uint32_t updatePeriod)
+{
+	if (updatePeriod == NEVER_UPDATE || updatePeriod == 0)
+		return false;
+
+	return (frameNumber + staggerId) % updatePeriod == 0;
+}
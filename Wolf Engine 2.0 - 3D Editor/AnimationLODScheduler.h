@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Decides how often animated meshes are evaluated.
+// The update period comes from the screen size of the bounding sphere, off-screen meshes are not updated.
+// Instances with the same period are updated on different frames: a stagger id is added to the frame number so updates spread evenly.
+class AnimationLODScheduler
+{
+public:
+	static constexpr uint32_t NEVER_UPDATE = -1;
+
+	struct Tier
+	{
+		float m_minScreenSize; // fraction of the screen height covered by the bounding sphere diameter, see computeScreenSize()
+		uint32_t m_updatePeriod; // in frames
+	};
+
+	AnimationLODScheduler();
+
+	// Format is "minScreenSize:updatePeriod" separated by commas, for example "0.2:1,0.05:2,0:4". Returns false and leaves 'outTiers' empty if the string is invalid
+	static bool parseTiers(const std::string& tiersDescription, std::vector<Tier>& outTiers);
+	void setTiers(const std::vector<Tier>& tiers); // sorted by decreasing screen size, smaller meshes use the last tier
+	void setUpdateOffScreen(bool updateOffScreen) { m_updateOffScreen = updateOffScreen; }
+	// Bones of meshes not updated every frame are interpolated between their 2 last evaluations, with one update period of delay
+	void setInterpolateBetweenUpdates(bool interpolateBetweenUpdates) { m_interpolateBetweenUpdates = interpolateBetweenUpdates; }
+	[[nodiscard]] bool getInterpolateBetweenUpdates() const { return m_interpolateBetweenUpdates; }
+
+	void beginFrame(uint32_t frameNumber, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix);
+	uint32_t allocateStaggerId() { return m_nextStaggerId++; }
+
+	// Can be called from any thread between two beginFrame() calls
+	[[nodiscard]] uint32_t computeUpdatePeriod(const glm::vec3& boundingSphereCenter, float boundingSphereRadius) const;
+	[[nodiscard]] bool isVisible(const glm::vec3& boundingSphereCenter, float boundingSphereRadius) const;
+	// Fraction of the screen height covered by the sphere diameter, 1 when it fills the screen vertically
+	[[nodiscard]] float computeScreenSize(const glm::vec3& boundingSphereCenter, float boundingSphereRadius) const;
+	[[nodiscard]] uint32_t selectTier(float screenSize) const;
+	[[nodiscard]] const std::vector<Tier>& getTiers() const { return m_tiers; }
+	[[nodiscard]] uint32_t getFrameNumber() const { return m_frameNumber; }
+
+	static bool shouldUpdate(uint32_t frameNumber, uint32_t staggerId, uint32_t updatePeriod);
+
+private:
+	std::vector<Tier> m_tiers;
+	bool m_updateOffScreen = false;
+	bool m_interpolateBetweenUpdates = true;
+
+	uint32_t m_frameNumber = 0;
+	glm::mat4 m_viewMatrix = glm::mat4(1.0f);
+	float m_projectionScale = 1.0f; // 1 / tan(fovY / 2)
+	std::array<glm::vec4, 6> m_frustumPlanes; // normalized, inside is positive
+
+	std::atomic<uint32_t> m_nextStaggerId = 0;
+};
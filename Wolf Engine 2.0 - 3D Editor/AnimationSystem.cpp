@@ -0,0 +1,106 @@
+#include "AnimationSystem.h"
+
+#include <Configuration.h>
+#include <ProfilerCommon.h>
+
+#include "AnimatedMesh.h"
+
+AnimationSystem::AnimationSystem(const Wolf::ResourceNonOwner<UpdateGPUBuffersPass>& updateGPUBuffersPass) : m_updateGPUBuffersPass(updateGPUBuffersPass)
+{
+	m_sharedPoseCache.reset(new SharedPoseCache);
+	m_animationLODScheduler.reset(new AnimationLODScheduler);
+}
+
+void AnimationSystem::registerAnimatedMesh(AnimatedMesh* animatedMesh)
+{
+	std::lock_guard lock(m_animatedMeshesMutex);
+	m_animatedMeshes.push_back(animatedMesh);
+}
+
+void AnimationSystem::unregisterAnimatedMesh(AnimatedMesh* animatedMesh)
+{
+	std::lock_guard lock(m_animatedMeshesMutex);
+	std::erase(m_animatedMeshes, animatedMesh);
+}
+
+void AnimationSystem::beginFrame(uint32_t frameNumber, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix)
+{
+	m_sharedPoseCache->releaseUnusedPoses(frameNumber, Wolf::g_configuration->getMaxCachedFrames());
+	m_animationLODScheduler->beginFrame(frameNumber, viewMatrix, projectionMatrix);
+}
+
+void AnimationSystem::collectJobs(const Wolf::Timer& globalTimer)
+{
+	PROFILE_FUNCTION
+
+	m_jobs.clear();
+	m_nextJobIdx = 0;
+
+	std::lock_guard lock(m_animatedMeshesMutex);
+
+	// All instances request their update period before the shared poses decide whether they are evaluated this frame
+	for (AnimatedMesh* animatedMesh : m_animatedMeshes)
+	{
+		animatedMesh->updateSharedPose();
+	}
+
+	Job job;
+	for (AnimatedMesh* animatedMesh : m_animatedMeshes)
+	{
+		if (!animatedMesh->prepareAnimationJob(globalTimer, job))
+			continue;
+
+		job.m_reservation = m_updateGPUBuffersPass->reserveBufferUploadBeforeFrame(job.m_sharedPose->m_boneCount * sizeof(BoneInfoGPU), job.m_sharedPose->m_bonesBuffer.createNonOwnerResource(), 0);
+		m_jobs.push_back(job);
+	}
+}
+
+void AnimationSystem::runJobs()
+{
+	PROFILE_FUNCTION
+
+	const uint32_t jobCount = static_cast<uint32_t>(m_jobs.size());
+	for (uint32_t jobIdx = m_nextJobIdx++; jobIdx < jobCount; jobIdx = m_nextJobIdx++)
+	{
+		Job& job = m_jobs[jobIdx];
+		executeJob(job, job.m_reservation.getDataAs<BoneInfoGPU>());
+		m_updateGPUBuffersPass->commitReservation(job.m_reservation);
+	}
+}
+
+void AnimationSystem::executeJob(const Job& job, BoneInfoGPU* outBonesInfoGPU)
+{
+	SharedPoseCache::SharedPose& sharedPose = *job.m_sharedPose;
+
+	if (job.m_evaluate)
+	{
+		BoneInfoGPU* bonesInfoGPU = job.m_interpolate ? sharedPose.m_lastBonesInfoGPU.data() : outBonesInfoGPU;
+
+		const SharedPoseCache::Key& key = sharedPose.m_key;
+		if (key.m_clipAssetId == NO_ASSET)
+		{
+			for (uint32_t boneIdx = 0; boneIdx < sharedPose.m_boneCount; ++boneIdx)
+			{
+				bonesInfoGPU[boneIdx].transform = glm::mat4(1.0f);
+			}
+			for (uint32_t flattenedBoneIdx = 0; flattenedBoneIdx < key.m_skeleton->getBoneCount(); ++flattenedBoneIdx)
+			{
+				sharedPose.m_bonesInfoCPU[key.m_skeleton->m_boneIndices[flattenedBoneIdx]].position = key.m_skeleton->m_bindPositions[flattenedBoneIdx];
+			}
+		}
+		else
+		{
+			computeBonesInfo(*key.m_skeleton, job.m_time, glm::mat4(1.0f), bonesInfoGPU, sharedPose.m_bonesInfoCPU, &sharedPose.m_cursor, job.m_bakedAnimation.get());
+		}
+
+		if (job.m_interpolate)
+		{
+			SharedPoseCache::decomposeLastEvaluation(sharedPose);
+		}
+	}
+
+	if (job.m_interpolate)
+	{
+		SharedPoseCache::interpolateBones(sharedPose, job.m_interpolationFactor, outBonesInfoGPU);
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <ResourceUniqueOwner.h>
+#include <Timer.h>
+
+#include "AnimationLODScheduler.h"
+#include "SharedPoseCache.h"
+#include "UpdateGPUBuffersPass.h"
+
+class AnimatedMesh;
+
+// Evaluates the bones of all animated meshes each frame.
+// Jobs are collected on the main thread, then any number of threads take them one by one so a single heavy range of entities doesn't decide the frame time.
+// Bones are written directly to staging memory, reservations are committed by the thread which evaluated them.
+// Entity updates run at the same time as the jobs: they read bone positions from the copy each AnimatedMesh makes in updateSharedPose(), never from the shared pose.
+class AnimationSystem
+{
+public:
+	struct Job
+	{
+		SharedPoseCache::SharedPose* m_sharedPose = nullptr;
+		float m_time = 0.0f; // clip time, unused for bind pose
+		std::shared_ptr<const BakedAnimation> m_bakedAnimation; // kept alive if the clip is reloaded while the job runs
+		bool m_evaluate = false; // false when only interpolating between the 2 last evaluations
+		bool m_interpolate = false; // bones are stored in the shared pose and interpolated, otherwise evaluated directly in staging memory
+		float m_interpolationFactor = 1.0f;
+		UpdateGPUBuffersPass::Reservation m_reservation;
+	};
+
+	AnimationSystem(const Wolf::ResourceNonOwner<UpdateGPUBuffersPass>& updateGPUBuffersPass);
+
+	void registerAnimatedMesh(AnimatedMesh* animatedMesh);
+	void unregisterAnimatedMesh(AnimatedMesh* animatedMesh);
+
+	void beginFrame(uint32_t frameNumber, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix);
+	// Main thread, before the jobs run
+	void collectJobs(const Wolf::Timer& globalTimer);
+	// Can be called from several threads at once, returns when all jobs have been taken
+	void runJobs();
+	// CPU part of a job, doesn't touch GPU resources
+	static void executeJob(const Job& job, BoneInfoGPU* outBonesInfoGPU);
+
+	[[nodiscard]] uint32_t getJobCount() const { return static_cast<uint32_t>(m_jobs.size()); }
+	[[nodiscard]] Wolf::ResourceNonOwner<SharedPoseCache> getSharedPoseCache() { return m_sharedPoseCache.createNonOwnerResource(); }
+	[[nodiscard]] Wolf::ResourceNonOwner<AnimationLODScheduler> getLODScheduler() { return m_animationLODScheduler.createNonOwnerResource(); }
+
+private:
+	Wolf::ResourceNonOwner<UpdateGPUBuffersPass> m_updateGPUBuffersPass;
+	Wolf::ResourceUniqueOwner<SharedPoseCache> m_sharedPoseCache;
+	Wolf::ResourceUniqueOwner<AnimationLODScheduler> m_animationLODScheduler;
+
+	std::mutex m_animatedMeshesMutex;
+	std::vector<AnimatedMesh*> m_animatedMeshes;
+
+	std::vector<Job> m_jobs;
+	std::atomic<uint32_t> m_nextJobIdx = 0;
+};
@@ -72,19 +72,14 @@ void AssetCombinedImage::loadImage(const LoadingRequest& loadingRequest)
 		if (channelAssetId == NO_ASSET)
 			continue;
 
-		AssetImageInterface::LoadingRequest imageLoadingRequest{};
-		imageLoadingRequest.m_format = Wolf::Format::R8G8B8A8_UNORM;
-		imageLoadingRequest.m_loadMips = true;
-		imageLoadingRequest.m_canBeVirtualized = false;
-		imageLoadingRequest.m_keepDataOnCPU = true;
-		m_assetManager->requestImageLoading(channelAssetId, imageLoadingRequest, true);
-		Wolf::ResourceNonOwner<Wolf::Image> image = m_assetManager->getImage(channelAssetId, Wolf::Format::R8G8B8A8_UNORM);
-
-		const uint8_t* pixels = m_assetManager->getImageData(channelAssetId, 0, Wolf::Format::R8G8B8A8_UNORM);
+		m_assetManager->requestImageLoading(channelAssetId, CHANNEL_LOADING_REQUEST, true);
+		Wolf::ResourceNonOwner<Wolf::Image> image = m_assetManager->getImage(channelAssetId, CHANNEL_LOADING_REQUEST.m_format);
+
+		const uint8_t* pixels = m_assetManager->getImageData(channelAssetId, 0, CHANNEL_LOADING_REQUEST.m_format);
 		std::vector<const uint8_t*> mipLevels(image->getMipLevelCount() - 1);
 		for (uint32_t mipIdx = 0; mipIdx < mipLevels.size(); mipIdx++)
 		{
-			mipLevels[mipIdx] = m_assetManager->getImageData(channelAssetId, mipIdx + 1, Wolf::Format::R8G8B8A8_UNORM);
+			mipLevels[mipIdx] = m_assetManager->getImageData(channelAssetId, mipIdx + 1, CHANNEL_LOADING_REQUEST.m_format);
 		}
 		Wolf::Extent3D extent = image->getExtent();
 		uint32_t pixelCount = extent.width * extent.height * extent.depth;
@@ -9,6 +9,9 @@ class AssetManager;
 class AssetCombinedImage : public AssetInterface, public AssetImageInterface
 {
 public:
+    // Channel images are loaded this way to be combined, when the combined image isn't cached
+    static constexpr LoadingRequest CHANNEL_LOADING_REQUEST = { Wolf::Format::R8G8B8A8_UNORM, true, false, true };
+
     AssetCombinedImage(const Wolf::ResourceNonOwner<EditorGPUDataTransfersManager>& editorPushDataToGPU, const std::string& loadingPath, bool needThumbnailsGeneration,
         AssetId assetId, const std::function<void(const std::string&, const std::string&, AssetId)>& updateAssetInUICallback, AssetManager* assetManager, AssetId parentAssetId);
 
@@ -1,12 +1,14 @@
 #include "AssetImage.h"
 
+#include <Configuration.h>
+
 #include "AssetManager.h"
 #include "EditorConfiguration.h"
 #include "ImageFormatter.h"
 
-AssetImage::AssetImage(const Wolf::ResourceNonOwner<EditorGPUDataTransfersManager>& editorPushDataToGPU, const std::string& loadingPath, bool needThumbnailsGeneration, AssetId assetId,
-	const std::function<void(const std::string&, const std::string&, AssetId)>& updateResourceInUICallback, AssetId parentAssetId)
-	: AssetInterface(loadingPath, assetId, updateResourceInUICallback, parentAssetId), AssetImageInterface(editorPushDataToGPU, needThumbnailsGeneration)
+AssetImage::AssetImage(AssetManager* assetManager, const Wolf::ResourceNonOwner<EditorGPUDataTransfersManager>& editorPushDataToGPU, const std::string& loadingPath, bool needThumbnailsGeneration,
+	AssetId assetId, const std::function<void(const std::string&, const std::string&, AssetId)>& updateResourceInUICallback, AssetId parentAssetId)
+	: AssetInterface(loadingPath, assetId, updateResourceInUICallback, parentAssetId), AssetImageInterface(editorPushDataToGPU, needThumbnailsGeneration), m_assetManager(assetManager)
 {
 	m_editor.reset(new ImageEditor());
 	m_editor->subscribe(this, [this](Flags)
@@ -56,6 +58,18 @@ const uint8_t* AssetImage::getMipData(uint32_t mipLevel, Wolf::Format format) co
 	return m_mipData[mipLevel].data();
 }
 
+void AssetImage::uploadStreamedMipLevel(Wolf::Format format, uint32_t mipLevel, const std::vector<uint8_t>& pixels)
+{
+	// Image may have been released or reloaded with fewer levels while the level was read
+	if (!m_images.contains(format) || !m_images[format] || !m_firstAllocatedMips.contains(format) || mipLevel < m_firstAllocatedMips[format])
+		return;
+
+	const uint32_t imageMipLevel = mipLevel - m_firstAllocatedMips[format];
+	Wolf::GPUDataTransfersManagerInterface::PushDataToGPUImageInfo pushDataToGpuImageInfo(pixels.data(), m_images[format].createNonOwnerResource(), Wolf::Image::SampledInFragmentShader(imageMipLevel),
+		imageMipLevel);
+	m_editorPushDataToGPU->pushDataToGPUImage(pushDataToGpuImageInfo);
+}
+
 void AssetImage::loadImage(const LoadingRequest& loadingRequest)
 {
 	if (m_editor->getLoadingPath().empty())
@@ -74,6 +88,11 @@ void AssetImage::loadImage(const LoadingRequest& loadingRequest)
 	std::string fullFilePath = g_editorConfiguration->computeFullPathFromLocalPath(m_editor->getLoadingPath());
 
 	bool keepDataOnCPU = m_thumbnailGenerationRequested || loadingRequest.m_keepDataOnCPU;
+	const bool isVirtualized = loadingRequest.m_canBeVirtualized && Wolf::g_configuration->getUseVirtualTexture();
+	if (loadingRequest.m_streamMips && loadingRequest.m_loadMips && !keepDataOnCPU && !isVirtualized && loadStreamedImage(loadingRequest.m_format, fullFilePath))
+		return;
+	m_firstAllocatedMips.erase(loadingRequest.m_format);
+
 	ImageFormatter imageFormatter(m_editorPushDataToGPU, fullFilePath, loadingRequest.m_format, loadingRequest.m_canBeVirtualized,
 		keepDataOnCPU ? ImageFormatter::KeepDataMode::CPU_AND_GPU : ImageFormatter::KeepDataMode::ONLY_GPU, loadingRequest.m_loadMips);
 	imageFormatter.transferImageTo(image);
@@ -115,6 +134,32 @@ void AssetImage::loadImage(const LoadingRequest& loadingRequest)
 	}
 }
 
+bool AssetImage::loadStreamedImage(Wolf::Format format, const std::string& fullFilePath)
+{
+	// Caches are written by the first import, which needs all levels anyway
+	Wolf::Extent3D extent;
+	std::vector<uint64_t> levelSizes;
+	if (!ImageFormatter::readCacheLayout(fullFilePath, format, extent, levelSizes))
+		return false;
+
+	TextureResidencyManager& textureResidencyManager = m_assetManager->m_textureResidencyManager;
+	const TextureResidencyManager::Key key = { m_assetId, static_cast<uint32_t>(format) };
+	const uint32_t firstAllocatedMip = textureResidencyManager.registerImage(key, extent.width, extent.height, levelSizes);
+
+	ImageFormatter imageFormatter(m_editorPushDataToGPU, fullFilePath, format, firstAllocatedMip, textureResidencyManager.getFirstResidentMip(key));
+	imageFormatter.transferImageTo(m_images[format]);
+	if (!m_images[format])
+	{
+		textureResidencyManager.unregisterImage(key);
+		return false;
+	}
+
+	m_slicesFolder = imageFormatter.getSlicesFolder();
+	m_firstAllocatedMips[format] = firstAllocatedMip;
+
+	return true;
+}
+
 void AssetImage::recomputeThumbnail()
 {
 	if (m_preventThumbnailsGeneration)
@@ -4,10 +4,12 @@
 #include "AssetInterface.h"
 #include "ImageEditor.h"
 
+class AssetManager;
+
 class AssetImage : public AssetInterface, public AssetImageInterface
 {
 public:
-    AssetImage(const Wolf::ResourceNonOwner<EditorGPUDataTransfersManager>& editorPushDataToGPU, const std::string& loadingPath, bool needThumbnailsGeneration, AssetId assetId,
+    AssetImage(AssetManager* assetManager, const Wolf::ResourceNonOwner<EditorGPUDataTransfersManager>& editorPushDataToGPU, const std::string& loadingPath, bool needThumbnailsGeneration, AssetId assetId,
         const std::function<void(const std::string&, const std::string&, AssetId)>& updateResourceInUICallback, AssetId parentAssetId);
     AssetImage(const AssetImage&) = delete;
 
@@ -19,8 +21,14 @@ public:
     Wolf::ResourceNonOwner<ImageEditor> getEditor() const { return m_editor.createNonOwnerResource(); }
     const uint8_t* getMipData(uint32_t mipLevel, Wolf::Format format) const;
 
+    // 'mipLevel' is a level of the full resolution chain, as TextureResidencyManager returns them. 'pixels' are read from the cache beforehand (see AsyncMipReader)
+    void uploadStreamedMipLevel(Wolf::Format format, uint32_t mipLevel, const std::vector<uint8_t>& pixels);
+
 private:
     void loadImage(const LoadingRequest& loadingRequest);
+    [[nodiscard]] bool loadStreamedImage(Wolf::Format format, const std::string& fullFilePath);
+    AssetManager* m_assetManager;
+    std::map<Wolf::Format, uint32_t> m_firstAllocatedMips; // streamed images only, level of the full resolution chain the image starts at
     bool m_preventThumbnailsGeneration = true;
     void recomputeThumbnail();
 
@@ -5,6 +5,7 @@
 
 #include <ImageCompression.h>
 
+#include "BlockEncoder.h"
 #include "EditorConfiguration.h"
 #include "ImageFormatter.h"
 #include "ThumbnailsGenerationPass.h"
@@ -67,6 +68,14 @@ bool AssetImageInterface::generateThumbnail(const std::string& fullFilePath, con
 		{
 			Wolf::ImageCompression::uncompressImage(Wolf::ImageCompression::Compression::BC5, m_mipData[0].data(), { imageExtent.width, imageExtent.height }, RG8Pixels);
 		}
+		else if (imageFormat == Wolf::Format::BC4_UNORM_BLOCK)
+		{
+			BlockEncoder::uncompress(imageExtent, reinterpret_cast<const BlockEncoder::BC4*>(m_mipData[0].data()), RGBA8Pixels);
+		}
+		else if (imageFormat == Wolf::Format::BC7_SRGB_BLOCK || imageFormat == Wolf::Format::BC7_UNORM_BLOCK)
+		{
+			BlockEncoder::uncompress(imageExtent, reinterpret_cast<const BlockEncoder::BC7*>(m_mipData[0].data()), RGBA8Pixels);
+		}
 
 		bool hadAnErrorDuringGeneration = false;
 		for (uint32_t x = 0; x < ThumbnailsGenerationPass::OUTPUT_SIZE; ++x)
@@ -104,7 +113,8 @@ bool AssetImageInterface::generateThumbnail(const std::string& fullFilePath, con
 					pixel.b = pixels[4 * samplingIndex + 2];
 					pixel.a = pixels[4 * samplingIndex + 3];
 				}
-				else if (imageFormat == Wolf::Format::BC1_RGB_SRGB_BLOCK || imageFormat == Wolf::Format::BC3_UNORM_BLOCK)
+				else if (imageFormat == Wolf::Format::BC1_RGB_SRGB_BLOCK || imageFormat == Wolf::Format::BC3_UNORM_BLOCK || imageFormat == Wolf::Format::BC4_UNORM_BLOCK ||
+					imageFormat == Wolf::Format::BC7_SRGB_BLOCK || imageFormat == Wolf::Format::BC7_UNORM_BLOCK)
 				{
 					pixel = RGBA8Pixels[samplingIndex];
 					pixel.a = 255;
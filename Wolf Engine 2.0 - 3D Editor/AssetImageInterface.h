@@ -19,6 +19,7 @@ public:
         bool m_loadMips;
         bool m_canBeVirtualized;
         bool m_keepDataOnCPU;
+        bool m_streamMips = false; // only the smallest levels are loaded at first, see TextureResidencyManager. Ignored when data is kept on CPU or the image is virtualized
     };
     void requestImageLoading(const LoadingRequest& loadingRequest);
 
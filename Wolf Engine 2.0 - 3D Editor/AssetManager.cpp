@@ -1,12 +1,15 @@
 #include "AssetManager.h"
 
 #include <glm/gtc/packing.hpp>
+#include <chrono>
 #include <fstream>
 
+#include <Configuration.h>
 #include <ImageFileLoader.h>
 #include <MipMapGenerator.h>
 
 #include <ProfilerCommon.h>
+#include <RuntimeContext.h>
 #include <Timer.h>
 
 #include "EditorConfiguration.h"
@@ -25,7 +28,9 @@ AssetManager::AssetManager(const std::function<void(const std::string&, const st
                          const Wolf::ResourceNonOwner<Wolf::BufferPoolInterface>& bufferPoolInterface)
 	: m_addAssetToUICallback(addAssetToUICallback), m_updateResourceInUICallback(updateResourceInUICallback), m_editorConfiguration(editorConfiguration),
       m_materialsGPUManager(materialsGPUManager), m_thumbnailsGenerationPass(renderingPipeline->getThumbnailsGenerationPass()), m_isolateMeshCallback(isolateMeshCallback), m_removeIsolationAndGetViewMatrixCallback(removeIsolationAndGetViewMatrixCallback),
-	  m_renderingPipeline(renderingPipeline), m_editorPushDataToGPU(editorPushDataToGPU), m_bufferPoolInterface(bufferPoolInterface)
+	  m_renderingPipeline(renderingPipeline), m_editorPushDataToGPU(editorPushDataToGPU), m_bufferPoolInterface(bufferPoolInterface),
+	  m_blasResidencyCache(editorConfiguration->getBLASMemoryBudget()), m_blasBuildScheduler(MAX_BLAS_BUILD_TRIANGLES_PER_FRAME, editorConfiguration->getBLASBuildTimeBudgetMs()),
+	  m_textureResidencyManager(editorConfiguration->getTextureMemoryBudget(), editorConfiguration->getTextureMaxImageMemory(), editorConfiguration->getTextureStreamingBytesPerFrame())
 {
 	ms_assetManager = this;
 }
@@ -45,12 +50,16 @@ void AssetManager::updateBeforeFrame()
 		Wolf::ResourceUniqueOwner<AssetMesh>& mesh = m_meshes[i];
 		mesh->updateBeforeFrame(m_materialsGPUManager, m_thumbnailsGenerationPass);
 	}
+	buildScheduledBLASes();
+	evictBLASesOverBudget();
 
 	for (uint32_t i = 0; i < m_images.size(); ++i)
 	{
 		Wolf::ResourceUniqueOwner<AssetImage>& image = m_images[i];
 		image->updateBeforeFrame(m_materialsGPUManager, m_thumbnailsGenerationPass);
 	}
+	applyMaterialTextureResolutionRequests();
+	streamImageMips();
 
 	for (uint32_t i = 0; i < m_textureSets.size(); ++i)
 	{
@@ -158,6 +167,126 @@ void AssetManager::clear()
 	m_meshes.clear();
 	m_images.clear();
 	m_combinedImages.clear();
+	m_textureResidencyManager.clear();
+	m_asyncMipReader.cancel();
+	m_streamedImageMips.clear();
+	m_materialTextureResolutionRequests.clear();
+}
+
+void AssetManager::buildScheduledBLASes()
+{
+	if (m_blasBuildScheduler.getPendingBuildCount() == 0)
+		return;
+
+	PROFILE_SCOPED("Build scheduled BLASes")
+
+	const auto startTime = std::chrono::steady_clock::now();
+	float elapsedMilliseconds = 0.0f;
+
+	m_blasBuildScheduler.beginFrame();
+	BLASBuildScheduler::Request request{};
+	while (m_blasBuildScheduler.popNextBuild(elapsedMilliseconds, request))
+	{
+		m_meshes[request.m_assetId - MESH_ASSET_IDX_OFFSET]->ensureBLASIsLoaded(request.m_lod, request.m_lodType);
+		if (m_blasBuiltCallback)
+			m_blasBuiltCallback(request.m_assetId);
+		elapsedMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	}
+}
+
+void AssetManager::evictBLASesOverBudget()
+{
+	if (m_blasResidencyCache.getResidentMemory() <= m_blasResidencyCache.getMemoryBudget())
+		return;
+
+	PROFILE_SCOPED("Evict BLASes")
+
+	m_blasesToEvict.clear();
+	m_blasResidencyCache.collectEvictions(Wolf::g_runtimeContext->getCurrentCPUFrameNumber(), Wolf::g_configuration->getMaxCachedFrames(), [this](const BLASResidencyCache::Key& key)
+	{
+		return isBLASInUse(m_meshes[key.m_assetId - MESH_ASSET_IDX_OFFSET]->getBuiltBLAS(key.m_lod, key.m_lodType));
+	}, m_blasesToEvict);
+
+	for (const BLASResidencyCache::Key& key : m_blasesToEvict)
+	{
+		m_meshes[key.m_assetId - MESH_ASSET_IDX_OFFSET]->releaseBLAS(key.m_lod, key.m_lodType);
+	}
+}
+
+bool AssetManager::isBLASInUse(const Wolf::BottomLevelAccelerationStructure* bottomLevelAccelerationStructure) const
+{
+	if (!bottomLevelAccelerationStructure)
+		return false;
+
+	// Without a way to know if the BLAS is referenced, it's never released
+	return !m_isBLASInUseCallback || m_isBLASInUseCallback(bottomLevelAccelerationStructure);
+}
+
+void AssetManager::streamImageMips()
+{
+	PROFILE_SCOPED("Stream image mips")
+
+	m_textureResidencyManager.evictUnwantedLevels();
+
+	// Levels which didn't fit in the staging budget on previous frames are uploaded first
+	m_asyncMipReader.popResults(m_streamedImageMips);
+	uint32_t processedMipCount = 0;
+	for (; processedMipCount < m_streamedImageMips.size(); ++processedMipCount)
+	{
+		const AsyncMipReader::Result& streamedMip = m_streamedImageMips[processedMipCount];
+		const TextureResidencyManager::StreamRequest& streamRequest = streamedMip.m_streamRequest;
+		if (!m_textureResidencyManager.contains(streamRequest.m_key))
+			continue;
+
+		if (!streamedMip.m_isRead)
+		{
+			// Cache has been rebuilt since the image was created, the level keeps its placeholder until the image is loaded again
+			Wolf::Debug::sendWarning("Can't stream level " + std::to_string(streamRequest.m_mipLevel) + " of " + streamedMip.m_fullFilePath);
+			continue;
+		}
+
+		// Levels stay in their placeholder state a bit longer, staging memory is kept for uploads which can't wait
+		if (!m_editorPushDataToGPU->canStageWithinBudget(static_cast<uint32_t>(streamedMip.m_pixels.size())))
+			break;
+
+		m_images[streamRequest.m_key.m_assetId - IMAGE_ASSET_IDX_OFFSET]->uploadStreamedMipLevel(static_cast<Wolf::Format>(streamRequest.m_key.m_format), streamRequest.m_mipLevel,
+			streamedMip.m_pixels);
+	}
+
+	m_streamedImageMips.erase(m_streamedImageMips.begin(), m_streamedImageMips.begin() + processedMipCount);
+
+	// Next levels are only read once the previous ones are uploaded, the frame budget of TextureResidencyManager then also bounds reads
+	if (!m_streamedImageMips.empty() || m_textureResidencyManager.getPendingLevelCount() == 0 || !m_asyncMipReader.isIdle())
+		return;
+
+	m_imageMipsToStream.clear();
+	m_textureResidencyManager.popLevelsToStream(m_imageMipsToStream);
+	for (const TextureResidencyManager::StreamRequest& streamRequest : m_imageMipsToStream)
+	{
+		const std::string fullFilePath = g_editorConfiguration->computeFullPathFromLocalPath(m_images[streamRequest.m_key.m_assetId - IMAGE_ASSET_IDX_OFFSET]->getLoadingPath());
+		m_asyncMipReader.pushRequest({ streamRequest, fullFilePath });
+	}
+}
+
+void AssetManager::applyMaterialTextureResolutionRequests()
+{
+	if (m_materialTextureResolutionRequests.empty())
+		return;
+
+	for (uint32_t i = 0; i < m_materials.size(); ++i)
+	{
+		Wolf::ResourceUniqueOwner<AssetMaterial>& assetMaterial = m_materials[i];
+		if (!assetMaterial->isLoaded())
+			continue;
+
+		Wolf::ResourceNonOwner<MaterialEditor> materialEditor = assetMaterial->getEditor();
+		auto it = m_materialTextureResolutionRequests.find(materialEditor->getMaterialGPUIdx());
+		if (it != m_materialTextureResolutionRequests.end())
+		{
+			materialEditor->requestTextureResolution(it->second);
+		}
+	}
+	m_materialTextureResolutionRequests.clear();
 }
 
 void AssetManager::releaseRenderingPipeline()
@@ -398,14 +527,34 @@ Wolf::ResourceNonOwner<AnimationData> AssetManager::getAnimationData(AssetId ass
 	return m_meshes[assetId - MESH_ASSET_IDX_OFFSET]->getAnimationData();
 }
 
-Wolf::NullableResourceNonOwner<Wolf::BottomLevelAccelerationStructure> AssetManager::getBLAS(AssetId assetId, uint32_t lod, uint32_t lodType)
+std::shared_ptr<const FlattenedSkeleton> AssetManager::getFlattenedSkeleton(AssetId assetId)
+{
+	if (!isMesh(assetId))
+	{
+		Wolf::Debug::sendError("AssetId is not a mesh");
+	}
+
+	return m_meshes[assetId - MESH_ASSET_IDX_OFFSET]->getFlattenedSkeleton();
+}
+
+std::shared_ptr<const BakedAnimation> AssetManager::getBakedAnimation(AssetId assetId)
+{
+	if (!isMesh(assetId))
+	{
+		Wolf::Debug::sendError("AssetId is not a mesh");
+	}
+
+	return m_meshes[assetId - MESH_ASSET_IDX_OFFSET]->getBakedAnimation();
+}
+
+Wolf::NullableResourceNonOwner<Wolf::BottomLevelAccelerationStructure> AssetManager::getBLAS(AssetId assetId, uint32_t lod, uint32_t lodType, float buildPriority)
 {
 	if (!isMesh(assetId))
 	{
 		Wolf::Debug::sendError("AssetId is not a mesh");
 	}
 
-	return m_meshes[assetId - MESH_ASSET_IDX_OFFSET]->getBLAS(lod, lodType);
+	return m_meshes[assetId - MESH_ASSET_IDX_OFFSET]->getBLAS(lod, lodType, buildPriority);
 }
 
 std::vector<Wolf::ResourceUniqueOwner<Wolf::Physics::Shape>>& AssetManager::getPhysicsShapes(AssetId modelAssetId) const
@@ -474,7 +623,7 @@ AssetId AssetManager::addImage(const std::string& loadingPath, AssetId parentAss
 		std::string iconFullPath = computeIconPath(loadingPath, 0);
 		bool iconFileExists = formatIconPath(loadingPath, iconFullPath);
 
-		m_images.emplace_back(new AssetImage(m_editorPushDataToGPU, loadingPath, !iconFileExists, assetId, m_updateResourceInUICallback, parentAssetId));
+		m_images.emplace_back(new AssetImage(this, m_editorPushDataToGPU, loadingPath, !iconFileExists, assetId, m_updateResourceInUICallback, parentAssetId));
 		m_addAssetToUICallback(m_images.back()->computeName(), loadingPath, iconFullPath, assetId, "image");
 	}
 
@@ -505,6 +654,22 @@ void AssetManager::requestImageLoading(AssetId assetId, const AssetImageInterfac
 	}
 }
 
+void AssetManager::requestImageResolution(AssetId imageAssetId, Wolf::Format format, uint32_t resolution)
+{
+	if (!isImage(imageAssetId))
+	{
+		Wolf::Debug::sendError("AssetId is not an image");
+	}
+
+	m_textureResidencyManager.requestResolution({ imageAssetId, static_cast<uint32_t>(format) }, resolution, Wolf::g_runtimeContext->getCurrentCPUFrameNumber());
+}
+
+void AssetManager::requestMaterialTextureResolution(uint32_t materialGPUIdx, uint32_t resolution)
+{
+	uint32_t& requestedResolution = m_materialTextureResolutionRequests[materialGPUIdx];
+	requestedResolution = std::max(requestedResolution, resolution);
+}
+
 Wolf::ResourceNonOwner<Wolf::Image> AssetManager::getImage(AssetId imageAssetId, Wolf::Format format) const
 {
 	if (!isImage(imageAssetId))
@@ -535,13 +700,14 @@ void AssetManager::deleteImageData(AssetId imageAssetId) const
 	m_images[imageAssetId - IMAGE_ASSET_IDX_OFFSET]->deleteImageData();
 }
 
-void AssetManager::releaseImage(AssetId imageAssetId) const
+void AssetManager::releaseImage(AssetId imageAssetId)
 {
 	if (!isImage(imageAssetId))
 	{
 		Wolf::Debug::sendError("AssetId is not an image");
 	}
 	m_images[imageAssetId - IMAGE_ASSET_IDX_OFFSET]->releaseImages();
+	m_textureResidencyManager.removeAsset(imageAssetId);
 }
 
 std::string AssetManager::getImageSlicesFolder(AssetId imageAssetId) const
@@ -621,6 +787,50 @@ void AssetManager::requestCombinedImageLoading(AssetId assetId, const AssetImage
 	}
 }
 
+void AssetManager::createMissingImageCaches(const std::vector<std::pair<AssetId, AssetImageInterface::LoadingRequest>>& loadingRequests) const
+{
+	std::vector<ImageFormatter::CacheRequest> cacheRequests;
+	auto addImageCacheRequest = [&](AssetId imageAssetId, const AssetImageInterface::LoadingRequest& loadingRequest)
+		{
+			// Caches are written with mips
+			if (!loadingRequest.m_loadMips)
+				return;
+
+			const std::string fullFilePath = g_editorConfiguration->computeFullPathFromLocalPath(m_images[imageAssetId - IMAGE_ASSET_IDX_OFFSET]->getLoadingPath());
+			cacheRequests.push_back({ fullFilePath, loadingRequest.m_format, loadingRequest.m_canBeVirtualized });
+		};
+
+	for (const auto& [assetId, loadingRequest] : loadingRequests)
+	{
+		if (isImage(assetId))
+		{
+			addImageCacheRequest(assetId, loadingRequest);
+		}
+		else if (isCombinedImage(assetId))
+		{
+			const Wolf::ResourceUniqueOwner<AssetCombinedImage>& combinedImage = m_combinedImages[assetId - COMBINED_IMAGE_ASSET_IDX_OFFSET];
+			if (ImageFormatter::isCacheAvailable(g_editorConfiguration->computeFullPathFromLocalPath(combinedImage->getLoadingPath()), loadingRequest.m_format, loadingRequest.m_canBeVirtualized))
+				continue;
+
+			// Combining and compressing need all channels, only decoding them runs concurrently
+			for (uint32_t channelIdx = 0; channelIdx < 4; ++channelIdx)
+			{
+				AssetId channelAssetId = combinedImage->getEditor()->getAssetId(channelIdx);
+				if (channelAssetId != NO_ASSET)
+				{
+					addImageCacheRequest(channelAssetId, AssetCombinedImage::CHANNEL_LOADING_REQUEST);
+				}
+			}
+		}
+		else
+		{
+			Wolf::Debug::sendError("AssetId is not an image");
+		}
+	}
+
+	ImageFormatter::createMissingCaches(m_editorPushDataToGPU, cacheRequests);
+}
+
 Wolf::ResourceNonOwner<Wolf::Image> AssetManager::getCombinedImage(AssetId combinedImageAssetId, Wolf::Format format) const
 {
 	if (!isCombinedImage(combinedImageAssetId))
@@ -10,11 +10,15 @@
 #include "AssetMesh.h"
 #include "AssetParticle.h"
 #include "AssetTextureSet.h"
+#include "AsyncMipReader.h"
+#include "BLASBuildScheduler.h"
+#include "BLASResidencyCache.h"
 #include "ComponentInterface.h"
 #include "EditorConfiguration.h"
 #include "ExternalSceneLoader.h"
 #include "MeshAssetEditor.h"
 #include "RenderingPipelineInterface.h"
+#include "TextureResidencyManager.h"
 #include "ThumbnailsGenerationPass.h"
 
 class TextureSetEditor;
@@ -56,7 +60,17 @@ public:
 	std::vector<Wolf::ResourceNonOwner<Wolf::Mesh>> getMeshDefaultSimplifiedMeshes(AssetId assetId) const;
 	std::vector<Wolf::ResourceNonOwner<Wolf::Mesh>> getMeshSloppySimplifiedMeshes(AssetId assetId) const;
 	Wolf::ResourceNonOwner<AnimationData> getAnimationData(AssetId assetId) const;
-	Wolf::NullableResourceNonOwner<Wolf::BottomLevelAccelerationStructure> getBLAS(AssetId assetId, uint32_t lod, uint32_t lodType);
+	std::shared_ptr<const FlattenedSkeleton> getFlattenedSkeleton(AssetId assetId);
+	std::shared_ptr<const BakedAnimation> getBakedAnimation(AssetId assetId);
+	// BLAS build is scheduled when not available yet, highest priorities are built first
+	Wolf::NullableResourceNonOwner<Wolf::BottomLevelAccelerationStructure> getBLAS(AssetId assetId, uint32_t lod, uint32_t lodType, float buildPriority);
+	uint32_t getPendingBLASBuildCount() const { return m_blasBuildScheduler.getPendingBuildCount(); }
+	float getBLASBuildProgress() const { return m_blasBuildScheduler.getProgress(); }
+	// Called on the main thread each time a scheduled BLAS has been built
+	void setBLASBuiltCallback(const std::function<void(AssetId)>& callback) { m_blasBuiltCallback = callback; }
+	// BLASes are only released while the callback reports them as not in use
+	void setIsBLASInUseCallback(const std::function<bool(const Wolf::BottomLevelAccelerationStructure*)>& callback) { m_isBLASInUseCallback = callback; }
+	const BLASResidencyCache& getBLASResidencyCache() const { return m_blasResidencyCache; }
 	std::vector<Wolf::ResourceUniqueOwner<Wolf::Physics::Shape>>& getPhysicsShapes(AssetId modelAssetId) const;
 	uint32_t getMaterialIdx(AssetId meshAssetId) const;
 	std::string computeModelName(AssetId modelAssetId) const;
@@ -65,10 +79,15 @@ public:
 	AssetId addImage(const std::string& loadingPath, AssetId parentAssetId = NO_ASSET);
 	bool isImageLoaded(AssetId assetId) const;
 	void requestImageLoading(AssetId assetId, const AssetImageInterface::LoadingRequest& loadingRequest, bool requestImmediateLoading = false);
+	// Levels of streamed images bigger than 'resolution' (largest size in texels, as displayed on screen) aren't streamed. Images are streamed up to full resolution until requested
+	void requestImageResolution(AssetId imageAssetId, Wolf::Format format, uint32_t resolution);
+	// Same for the streamed images of the material texture sets, 'resolution' is the on screen size of a surface using the material. Largest request of the frame is applied on next update
+	void requestMaterialTextureResolution(uint32_t materialGPUIdx, uint32_t resolution);
+	const TextureResidencyManager& getTextureResidencyManager() const { return m_textureResidencyManager; }
 	Wolf::ResourceNonOwner<Wolf::Image> getImage(AssetId imageAssetId, Wolf::Format format) const;
 	const uint8_t* getImageData(AssetId imageAssetId, uint32_t mipLevel, Wolf::Format format) const;
 	void deleteImageData(AssetId imageAssetId) const;
-	void releaseImage(AssetId imageAssetId) const;
+	void releaseImage(AssetId imageAssetId);
 	std::string getImageSlicesFolder(AssetId imageAssetId) const;
 	std::string getImageLoadingPath(AssetId assetId) const;
 	Wolf::ResourceNonOwner<ImageEditor> getImageEditor(AssetId assetId) const;
@@ -79,6 +98,10 @@ public:
 	std::string getCombinedImageSlicesFolder(AssetId combinedImageAssetId) const;
 	Wolf::ResourceNonOwner<CombinedImageEditor> getCombinedImageEditor(AssetId assetId) const;
 
+	// Images and combined images about to be loaded together: missing caches, including channels of uncached combined images, are built concurrently (see ImageFormatter::createMissingCaches)
+	// so loading them one by one afterwards only reads caches. Loadings still have to be requested
+	void createMissingImageCaches(const std::vector<std::pair<AssetId, AssetImageInterface::LoadingRequest>>& loadingRequests) const;
+
 	AssetId addExternalScene(const std::string& loadingPath);
 	bool isSceneLoaded(AssetId sceneAssetId) const;
 	Wolf::AABB getSceneAABB(AssetId sceneAssetId) const;
@@ -109,6 +132,11 @@ private:
 	static std::string computeIconPath(const std::string& loadingPath, uint32_t thumbnailsLockedCount);
 	static bool formatIconPath(const std::string& inLoadingPath, std::string& outIconPath);
 	void releaseAllEditorsFromTransientEntity();
+	void evictBLASesOverBudget();
+	void buildScheduledBLASes();
+	bool isBLASInUse(const Wolf::BottomLevelAccelerationStructure* bottomLevelAccelerationStructure) const;
+	void streamImageMips();
+	void applyMaterialTextureResolutionRequests();
 	void onAssetEditionChanged(Notifier::Flags flags);
 	static bool saveAsset(std::stringstream& outStringStream, Wolf::ResourceNonOwner<AssetInterface> assetInterface);
 
@@ -121,6 +149,20 @@ private:
 	Wolf::ResourceNonOwner<EditorGPUDataTransfersManager> m_editorPushDataToGPU;
 	Wolf::ResourceNonOwner<Wolf::BufferPoolInterface> m_bufferPoolInterface;
 
+	// Declared before assets so it outlives the meshes registered in it
+	BLASResidencyCache m_blasResidencyCache;
+	std::function<bool(const Wolf::BottomLevelAccelerationStructure*)> m_isBLASInUseCallback;
+	std::function<void(AssetId)> m_blasBuiltCallback;
+	std::vector<BLASResidencyCache::Key> m_blasesToEvict;
+	static constexpr uint64_t MAX_BLAS_BUILD_TRIANGLES_PER_FRAME = 4'000'000;
+	BLASBuildScheduler m_blasBuildScheduler;
+
+	TextureResidencyManager m_textureResidencyManager;
+	std::vector<TextureResidencyManager::StreamRequest> m_imageMipsToStream;
+	AsyncMipReader m_asyncMipReader;
+	std::vector<AsyncMipReader::Result> m_streamedImageMips;
+	std::unordered_map<uint32_t /* material GPU idx */, uint32_t> m_materialTextureResolutionRequests;
+
 	static constexpr uint32_t MESH_ASSET_IDX_OFFSET = 0;
 	static constexpr uint32_t MAX_ASSET_RESOURCE_COUNT = 1000;
 	Wolf::DynamicResourceUniqueOwnerArray<AssetMesh, 16> m_meshes;
@@ -52,6 +52,8 @@ AssetMesh::AssetMesh(AssetManager* assetManager, const std::string& loadingPath,
 
 AssetMesh::~AssetMesh()
 {
+	m_assetManager->m_blasResidencyCache.removeAsset(m_assetId);
+	m_assetManager->m_blasBuildScheduler.cancelAsset(m_assetId);
 	m_meshAssetEditor.reset(nullptr);
 }
 
@@ -76,9 +78,8 @@ void AssetMesh::updateBeforeFrame(const Wolf::ResourceNonOwner<Wolf::MaterialsGP
 	uint32_t currentFrameIdx = Wolf::g_runtimeContext->getCurrentCPUFrameNumber();
 	for (int32_t blasToDestroyIdx = static_cast<int32_t>(m_BLASesToDestroy.size()) - 1; blasToDestroyIdx >= 0; blasToDestroyIdx--)
 	{
-		if (m_BLASesToDestroy[blasToDestroyIdx].second <= currentFrameIdx)
+		if (m_BLASesToDestroy[blasToDestroyIdx].second <= currentFrameIdx && !m_assetManager->isBLASInUse(&*m_BLASesToDestroy[blasToDestroyIdx].first))
 		{
-			m_bottomLevelAccelerationStructures[m_BLASesToDestroy[blasToDestroyIdx].first.m_lodType][m_BLASesToDestroy[blasToDestroyIdx].first.m_lod].reset(nullptr);
 			m_BLASesToDestroy.erase(m_BLASesToDestroy.begin() + blasToDestroyIdx);
 		}
 	}
@@ -135,7 +136,28 @@ std::vector<Wolf::ResourceNonOwner<Wolf::Mesh>> AssetMesh::getSloppySimplifiedMe
 	return r;
 }
 
-Wolf::NullableResourceNonOwner<Wolf::BottomLevelAccelerationStructure> AssetMesh::getBLAS(uint32_t lod, uint32_t lodType)
+std::shared_ptr<const FlattenedSkeleton> AssetMesh::getFlattenedSkeleton()
+{
+	std::lock_guard lock(m_sharedAnimationDataMutex);
+	if (!m_flattenedSkeleton)
+	{
+		Wolf::Debug::sendError("Mesh has no skeleton");
+	}
+	return m_flattenedSkeleton;
+}
+
+std::shared_ptr<const BakedAnimation> AssetMesh::getBakedAnimation()
+{
+	// Animated meshes are updated from several jobs
+	std::lock_guard lock(m_sharedAnimationDataMutex);
+	if (!m_bakedAnimation)
+	{
+		m_bakedAnimation.reset(new BakedAnimation(*m_animationData));
+	}
+	return m_bakedAnimation;
+}
+
+Wolf::NullableResourceNonOwner<Wolf::BottomLevelAccelerationStructure> AssetMesh::getBLAS(uint32_t lod, uint32_t lodType, float buildPriority)
 {
 	if (lod == 0)
 	{
@@ -147,11 +169,40 @@ Wolf::NullableResourceNonOwner<Wolf::BottomLevelAccelerationStructure> AssetMesh
 		return Wolf::NullableResourceNonOwner<Wolf::BottomLevelAccelerationStructure>();
 	}
 
-	ensureBLASIsLoaded(lod, lodType);
+	if (!m_bottomLevelAccelerationStructures[lodType][lod])
+	{
+		if (!g_editorConfiguration->getEnableRayTracing())
+		{
+			Wolf::Debug::sendCriticalError("Can't build BLAS if ray tracing isn't enabled");
+		}
+
+		const uint64_t triangleCount = getMeshForLOD(lod, lodType)->getIndexCount() / 3;
+		m_assetManager->m_blasBuildScheduler.request({ m_assetId, lodType, lod, triangleCount, buildPriority });
+		return Wolf::NullableResourceNonOwner<Wolf::BottomLevelAccelerationStructure>();
+	}
+
+	m_assetManager->m_blasResidencyCache.markUsed({ m_assetId, lodType, lod }, Wolf::g_runtimeContext->getCurrentCPUFrameNumber());
 
 	return m_bottomLevelAccelerationStructures[lodType][lod].createNonOwnerResource();
 }
 
+const Wolf::BottomLevelAccelerationStructure* AssetMesh::getBuiltBLAS(uint32_t lod, uint32_t lodType) const
+{
+	if (lodType >= m_bottomLevelAccelerationStructures.size() || lod >= m_bottomLevelAccelerationStructures[lodType].size() || !m_bottomLevelAccelerationStructures[lodType][lod])
+		return nullptr;
+
+	return &*m_bottomLevelAccelerationStructures[lodType][lod];
+}
+
+void AssetMesh::releaseBLAS(uint32_t lod, uint32_t lodType)
+{
+	if (lodType >= m_bottomLevelAccelerationStructures.size() || lod >= m_bottomLevelAccelerationStructures[lodType].size())
+		return;
+
+	m_bottomLevelAccelerationStructures[lodType][lod].reset(nullptr);
+	m_assetManager->m_blasResidencyCache.remove({ m_assetId, lodType, lod });
+}
+
 void AssetMesh::loadMeshFormatter(Wolf::ResourceUniqueOwner<MeshFormatter>& meshFormatter)
 {
 	meshFormatter.reset(new MeshFormatter(m_loadingPath, m_assetManager));
@@ -240,6 +291,7 @@ void AssetMesh::loadModel()
 
 	if (g_editorConfiguration->getEnableRayTracing())
 	{
+		releaseAllBLASes(); // built from previous meshes
 		m_bottomLevelAccelerationStructures.resize(2);
 		for (uint32_t lodType = 0; lodType < 2; lodType++)
 		{
@@ -259,12 +311,16 @@ void AssetMesh::loadModel()
 		lod.m_indices.clear();
 	}
 
-	m_loadedBLAS = { static_cast<uint32_t>(-1), static_cast<uint32_t>(-1) };
 
 	if (meshFormatter->getAnimationData())
 	{
 		m_animationData.reset(new AnimationData());
 		*m_animationData = *meshFormatter->getAnimationData();
+
+		// Shared poses and animation jobs still running hold their own reference to the previous skeleton and bake
+		std::lock_guard lock(m_sharedAnimationDataMutex);
+		m_flattenedSkeleton.reset(new FlattenedSkeleton(*m_animationData));
+		m_bakedAnimation.reset();
 	}
 
 	m_isCentered = meshFormatter->isMeshCentered();
@@ -303,39 +359,36 @@ void AssetMesh::requestThumbnailReload(const glm::mat4& viewMatrix)
 
 void AssetMesh::ensureBLASIsLoaded(uint32_t lod, uint32_t lodType)
 {
-	if (m_bottomLevelAccelerationStructures[lodType][lod])
+	// Model may have been reloaded with fewer LODs since the build was requested
+	if (lodType >= m_bottomLevelAccelerationStructures.size() || lod >= m_bottomLevelAccelerationStructures[lodType].size())
 		return;
 
-	if (m_loadedBLAS.m_lodType != -1)
-	{
-		m_BLASesToDestroy.emplace_back(m_loadedBLAS, Wolf::g_runtimeContext->getCurrentCPUFrameNumber() + Wolf::g_configuration->getMaxCachedFrames());
-	}
+	if (m_bottomLevelAccelerationStructures[lodType][lod])
+		return;
 
 	if (g_editorConfiguration->getEnableRayTracing())
 	{
 		buildBLAS(lod, lodType, m_loadingPath);
-		m_loadedBLAS = { lodType, lod };
 	}
 	else
 	{
-		Wolf::Debug::sendCriticalError("Can't build BLAS is ray tracing isn't enabled");
+		Wolf::Debug::sendCriticalError("Can't build BLAS if ray tracing isn't enabled");
 	}
 }
 
+const Wolf::ResourceUniqueOwner<Wolf::Mesh>& AssetMesh::getMeshForLOD(uint32_t lod, uint32_t lodType) const
+{
+	if (lod == 0)
+		return m_mesh;
+
+	if (lodType == 0)
+		return m_defaultSimplifiedMeshes[lod - 1];
+	return m_sloppySimplifiedMeshes[lod - 1];
+}
+
 void AssetMesh::buildBLAS(uint32_t lod, uint32_t lodType, const std::string& filename)
 {
-	const Wolf::ResourceUniqueOwner<Wolf::Mesh>* mesh = &m_mesh;
-	if (lod > 0)
-	{
-		if (lodType == 0)
-		{
-			mesh = &m_defaultSimplifiedMeshes[lod - 1];
-		}
-		else
-		{
-			mesh = &m_sloppySimplifiedMeshes[lod - 1];
-		}
-	}
+	const Wolf::ResourceUniqueOwner<Wolf::Mesh>* mesh = &getMeshForLOD(lod, lodType);
 
 	Wolf::GeometryInfo geometryInfo;
 	geometryInfo.mesh.vertexBuffer = &*(*mesh)->getVertexBuffer();
@@ -353,4 +406,28 @@ void AssetMesh::buildBLAS(uint32_t lod, uint32_t lodType, const std::string& fil
 	createInfo.name = "filename " + filename + ", lod type " + std::to_string(lodType) + ", lod " + std::to_string(lod);
 
 	m_bottomLevelAccelerationStructures[lodType][lod].reset(Wolf::BottomLevelAccelerationStructure::createBottomLevelAccelerationStructure(createInfo));
+
+	const uint64_t triangleCount = (*mesh)->getIndexCount() / 3;
+	m_assetManager->m_blasResidencyCache.onBuilt({ m_assetId, lodType, lod }, triangleCount * ESTIMATED_BLAS_BYTES_PER_TRIANGLE, Wolf::g_runtimeContext->getCurrentCPUFrameNumber());
+}
+
+void AssetMesh::releaseAllBLASes()
+{
+	// Instances may still reference them, wait for the GPU to be done
+	const uint32_t destroyFrameIdx = Wolf::g_runtimeContext->getCurrentCPUFrameNumber() + Wolf::g_configuration->getMaxCachedFrames();
+	for (std::vector<Wolf::ResourceUniqueOwner<Wolf::BottomLevelAccelerationStructure>>& bottomLevelAccelerationStructures : m_bottomLevelAccelerationStructures)
+	{
+		for (Wolf::ResourceUniqueOwner<Wolf::BottomLevelAccelerationStructure>& bottomLevelAccelerationStructure : bottomLevelAccelerationStructures)
+		{
+			if (bottomLevelAccelerationStructure)
+			{
+				std::pair<Wolf::ResourceUniqueOwner<Wolf::BottomLevelAccelerationStructure>, uint32_t>& blasToDestroy = m_BLASesToDestroy.emplace_back();
+				blasToDestroy.first.reset(bottomLevelAccelerationStructure.release());
+				blasToDestroy.second = destroyFrameIdx;
+			}
+		}
+	}
+	m_bottomLevelAccelerationStructures.clear();
+	m_assetManager->m_blasResidencyCache.removeAsset(m_assetId);
+	m_assetManager->m_blasBuildScheduler.cancelAsset(m_assetId);
 }
\ No newline at end of file
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <memory>
+#include <mutex>
+
+#include "AnimationHelper.h"
 #include "AssetInterface.h"
 #include "BottomLevelAccelerationStructure.h"
 #include "MeshAssetEditor.h"
@@ -30,8 +34,16 @@ public:
 	std::vector<Wolf::ResourceNonOwner<Wolf::Mesh>> getSloppySimplifiedMeshes() const;
 	bool isAnimated() const { return static_cast<bool>(m_animationData);}
 	Wolf::ResourceNonOwner<AnimationData> getAnimationData() const { return m_animationData.createNonOwnerResource(); }
+	// Null if the mesh isn't animated. Shared poses keep their skeleton alive while the model is reloaded
+	std::shared_ptr<const FlattenedSkeleton> getFlattenedSkeleton();
+	// Baked on first call, shared by all instances playing this clip. Jobs keep their copy alive while the model is reloaded
+	std::shared_ptr<const BakedAnimation> getBakedAnimation();
 	std::vector<Wolf::ResourceUniqueOwner<Wolf::Physics::Shape>>& getPhysicsShapes() { return m_physicsShapes; }
-	Wolf::NullableResourceNonOwner<Wolf::BottomLevelAccelerationStructure> getBLAS(uint32_t lod, uint32_t lodType);
+	// Returns an empty resource while the BLAS is waiting to be built by the asset manager scheduler
+	Wolf::NullableResourceNonOwner<Wolf::BottomLevelAccelerationStructure> getBLAS(uint32_t lod, uint32_t lodType, float buildPriority);
+	void ensureBLASIsLoaded(uint32_t lod, uint32_t lodType);
+	const Wolf::BottomLevelAccelerationStructure* getBuiltBLAS(uint32_t lod, uint32_t lodType) const; // doesn't build the BLAS, nullptr if not resident
+	void releaseBLAS(uint32_t lod, uint32_t lodType); // caller must ensure GPU doesn't use it anymore
 	uint32_t getMaterialIdx() const { return m_materialIdx; }
 
 private:
@@ -57,8 +69,9 @@ private:
 	void computeThumbnailGenerationViewMatrix(const Wolf::AABB& aabb);
 	void generateThumbnail(const Wolf::ResourceNonOwner<ThumbnailsGenerationPass>& thumbnailsGenerationPass);
 	void requestThumbnailReload(const glm::mat4& viewMatrix);
-	void ensureBLASIsLoaded(uint32_t lod, uint32_t lodType);
+	const Wolf::ResourceUniqueOwner<Wolf::Mesh>& getMeshForLOD(uint32_t lod, uint32_t lodType) const;
 	void buildBLAS(uint32_t lod, uint32_t lodType, const std::string& filename);
+	void releaseAllBLASes();
 
 	Wolf::ResourceUniqueOwner<MeshAssetEditor> m_meshAssetEditor;
 
@@ -74,17 +87,16 @@ private:
 	Wolf::DynamicResourceUniqueOwnerArray<Wolf::Mesh, 16> m_sloppySimplifiedMeshes;
 
 	Wolf::ResourceUniqueOwner<AnimationData> m_animationData;
+	std::mutex m_sharedAnimationDataMutex; // skeleton and bake are read by animation jobs, the model can be reloaded meanwhile
+	std::shared_ptr<const FlattenedSkeleton> m_flattenedSkeleton;
+	std::shared_ptr<const BakedAnimation> m_bakedAnimation;
 
 	std::vector<Wolf::ResourceUniqueOwner<Wolf::Physics::Shape>> m_physicsShapes;
 
+	// All LODs can be resident at the same time, residency is managed by the asset manager BLAS cache
 	std::vector<std::vector<Wolf::ResourceUniqueOwner<Wolf::BottomLevelAccelerationStructure>>> m_bottomLevelAccelerationStructures;
-	struct BlasId
-	{
-		uint32_t m_lodType;
-		uint32_t m_lod;
-	};
-	BlasId m_loadedBLAS;
-	std::vector<std::pair<BlasId, uint32_t /* frame index */>> m_BLASesToDestroy;
+	static constexpr uint64_t ESTIMATED_BLAS_BYTES_PER_TRIANGLE = 64;
+	std::vector<std::pair<Wolf::ResourceUniqueOwner<Wolf::BottomLevelAccelerationStructure>, uint32_t /* frame index */>> m_BLASesToDestroy; // BLASes from a previous model load
 
 	Wolf::ResourceUniqueOwner<Wolf::Mesh> m_meshToKeepInMemory;
 
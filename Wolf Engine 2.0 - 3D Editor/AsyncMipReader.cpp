@@ -0,0 +1,78 @@
+#include "AsyncMipReader.h"
+
+#include <iterator>
+
+#include "ImageFormatter.h"
+
+AsyncMipReader::AsyncMipReader() : m_thread([this]() { readLoop(); })
+{
+}
+
+AsyncMipReader::~AsyncMipReader()
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_stopRequested = true;
+	}
+	m_requestsAvailableCondition.notify_all();
+
+	m_thread.join();
+}
+
+void AsyncMipReader::pushRequest(Request&& request)
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_requests.push_back(std::move(request));
+	}
+	m_requestsAvailableCondition.notify_all();
+}
+
+void AsyncMipReader::popResults(std::vector<Result>& outResults)
+{
+	std::lock_guard lock(m_mutex);
+	outResults.insert(outResults.end(), std::make_move_iterator(m_results.begin()), std::make_move_iterator(m_results.end()));
+	m_results.clear();
+}
+
+void AsyncMipReader::cancel()
+{
+	std::lock_guard lock(m_mutex);
+	m_requests.clear();
+	m_results.clear();
+	m_cancelCount++;
+}
+
+bool AsyncMipReader::isIdle() const
+{
+	std::lock_guard lock(m_mutex);
+	return m_requests.empty() && !m_isReading && m_results.empty();
+}
+
+void AsyncMipReader::readLoop()
+{
+	std::unique_lock lock(m_mutex);
+	while (true)
+	{
+		m_requestsAvailableCondition.wait(lock, [this]() { return m_stopRequested || !m_requests.empty(); });
+		if (m_stopRequested)
+			return;
+
+		Request request = std::move(m_requests.front());
+		m_requests.pop_front();
+		const uint64_t cancelCount = m_cancelCount;
+		m_isReading = true;
+
+		lock.unlock();
+		Result result{ request.m_streamRequest, std::move(request.m_fullFilePath), false, {} };
+		result.m_isRead = ImageFormatter::readCachedMipLevel(result.m_fullFilePath, static_cast<Wolf::Format>(result.m_streamRequest.m_key.m_format), result.m_streamRequest.m_mipLevel,
+			result.m_pixels);
+		lock.lock();
+
+		m_isReading = false;
+		if (cancelCount == m_cancelCount)
+		{
+			m_results.push_back(std::move(result));
+		}
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TextureResidencyManager.h"
+
+// Reads levels of image caches on a dedicated thread so streaming doesn't stall the main thread on disk accesses.
+// Requests are pushed and results popped by the main thread, which uploads the levels itself
+class AsyncMipReader
+{
+public:
+	struct Request
+	{
+		TextureResidencyManager::StreamRequest m_streamRequest;
+		std::string m_fullFilePath;
+	};
+
+	struct Result
+	{
+		TextureResidencyManager::StreamRequest m_streamRequest;
+		std::string m_fullFilePath;
+		bool m_isRead;
+		std::vector<uint8_t> m_pixels;
+	};
+
+	AsyncMipReader();
+	AsyncMipReader(const AsyncMipReader&) = delete;
+	~AsyncMipReader();
+
+	void pushRequest(Request&& request);
+	void popResults(std::vector<Result>& outResults);
+	// Pending requests are dropped and the level being read, if any, is discarded
+	void cancel();
+
+	// No request pending, being read or waiting to be popped
+	[[nodiscard]] bool isIdle() const;
+
+private:
+	void readLoop();
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_requestsAvailableCondition;
+	std::deque<Request> m_requests;
+	std::vector<Result> m_results;
+	bool m_isReading = false;
+	uint64_t m_cancelCount = 0; // reads started before a cancel don't produce results
+	bool m_stopRequested = false;
+
+	// Last so the thread starts once everything it uses is initialized
+	std::thread m_thread;
+};
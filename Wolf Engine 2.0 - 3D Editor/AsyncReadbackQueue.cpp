@@ -0,0 +1,67 @@
+#include "AsyncReadbackQueue.h"
+
+#include <algorithm>
+
+#include <Debug.h>
+
+AsyncReadbackQueue::AsyncReadbackQueue(uint32_t slotCount, uint32_t framesBeforeCompletion) : m_framesBeforeCompletion(framesBeforeCompletion)
+{
+	if (slotCount == 0)
+	{
+		Wolf::Debug::sendError("Async readback queue must have at least one slot");
+		slotCount = 1;
+	}
+	m_slotsInUse.resize(slotCount, false);
+}
+
+uint32_t AsyncReadbackQueue::reserveSlot(uint32_t frameNumber, const CompletionCallback& callback)
+{
+	if (!isSlotAvailable())
+		return NO_SLOT_AVAILABLE;
+
+	if (!m_pendingReadbacks.empty() && frameNumber < m_pendingReadbacks.back().m_frameNumber)
+	{
+		Wolf::Debug::sendError("Readbacks must be reserved in frame order");
+	}
+
+	const uint32_t slotIdx = m_nextSlotIdx;
+	m_slotsInUse[slotIdx] = true;
+	m_nextSlotIdx = (m_nextSlotIdx + 1) % getSlotCount();
+
+	m_pendingReadbacks.push_back({ slotIdx, frameNumber, callback });
+
+	return slotIdx;
+}
+
+void AsyncReadbackQueue::processCompletedReadbacks(uint32_t currentFrameNumber)
+{
+	while (!m_pendingReadbacks.empty() && currentFrameNumber >= m_pendingReadbacks.front().m_frameNumber + m_framesBeforeCompletion)
+	{
+		completeFrontReadback();
+	}
+}
+
+void AsyncReadbackQueue::processAllReadbacks()
+{
+	while (!m_pendingReadbacks.empty())
+	{
+		completeFrontReadback();
+	}
+}
+
+void AsyncReadbackQueue::clear()
+{
+	m_pendingReadbacks.clear();
+	std::fill(m_slotsInUse.begin(), m_slotsInUse.end(), false);
+	m_nextSlotIdx = 0;
+}
+
+void AsyncReadbackQueue::completeFrontReadback()
+{
+	// Pop before calling so the callback can reserve a new readback
+	const PendingReadback readback = std::move(m_pendingReadbacks.front());
+	m_pendingReadbacks.pop_front();
+
+	readback.m_callback(readback.m_slotIdx);
+	m_slotsInUse[readback.m_slotIdx] = false;
+}
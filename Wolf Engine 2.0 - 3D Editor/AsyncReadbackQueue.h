@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+// Tracks GPU -> CPU readbacks recorded into a ring of host-visible destinations ("slots").
+// A readback recorded during frame N is complete once frame N + framesBeforeCompletion starts, as the frame fence of frame N has then been waited.
+// Completion callbacks are called from processCompletedReadbacks(), on the thread recording the frame, in the order readbacks have been reserved.
+class AsyncReadbackQueue
+{
+public:
+	using CompletionCallback = std::function<void(uint32_t slotIdx)>;
+	static constexpr uint32_t NO_SLOT_AVAILABLE = static_cast<uint32_t>(-1);
+
+	AsyncReadbackQueue(uint32_t slotCount, uint32_t framesBeforeCompletion);
+
+	// Returns the slot to record the copy into, or NO_SLOT_AVAILABLE if all destinations are still used by the GPU (caller should retry next frame)
+	[[nodiscard]] uint32_t reserveSlot(uint32_t frameNumber, const CompletionCallback& callback);
+	void processCompletedReadbacks(uint32_t currentFrameNumber);
+	// Only valid when the GPU is known to be idle
+	void processAllReadbacks();
+	void clear();
+
+	[[nodiscard]] bool isSlotAvailable() const { return !m_slotsInUse[m_nextSlotIdx]; }
+	[[nodiscard]] bool hasPendingReadbacks() const { return !m_pendingReadbacks.empty(); }
+	[[nodiscard]] uint32_t getSlotCount() const { return static_cast<uint32_t>(m_slotsInUse.size()); }
+
+private:
+	void completeFrontReadback();
+
+	struct PendingReadback
+	{
+		uint32_t m_slotIdx;
+		uint32_t m_frameNumber;
+		CompletionCallback m_callback;
+	};
+	std::deque<PendingReadback> m_pendingReadbacks;
+	std::vector<bool> m_slotsInUse;
+	uint32_t m_nextSlotIdx = 0;
+	uint32_t m_framesBeforeCompletion;
+};
@@ -0,0 +1,117 @@
+#include "BLASBuildScheduler.h"
+
+#include <algorithm>
+
+BLASBuildScheduler::BLASBuildScheduler(uint64_t maxTrianglesPerFrame, float maxMillisecondsPerFrame) : m_maxTrianglesPerFrame(maxTrianglesPerFrame), m_maxMillisecondsPerFrame(maxMillisecondsPerFrame)
+{
+}
+
+void BLASBuildScheduler::request(const Request& request)
+{
+	const uint64_t key = computeHash(request.m_assetId, request.m_lodType, request.m_lod);
+	auto it = m_requestIdxByKey.find(key);
+	if (it != m_requestIdxByKey.end())
+	{
+		Request& queuedRequest = m_requests[it->second].m_request;
+		queuedRequest.m_priority = std::max(queuedRequest.m_priority, request.m_priority);
+		return;
+	}
+
+	if (m_requests.empty())
+	{
+		m_builtCountSinceIdle = 0;
+	}
+
+	m_requestIdxByKey[key] = static_cast<uint32_t>(m_requests.size());
+	m_requests.push_back({ request, m_nextSequenceIdx++ });
+}
+
+void BLASBuildScheduler::cancelAsset(uint32_t assetId)
+{
+	for (int32_t requestIdx = static_cast<int32_t>(m_requests.size()) - 1; requestIdx >= 0; requestIdx--)
+	{
+		if (m_requests[requestIdx].m_request.m_assetId == assetId)
+		{
+			removeRequest(requestIdx);
+		}
+	}
+}
+
+void BLASBuildScheduler::clear()
+{
+	m_requests.clear();
+	m_requestIdxByKey.clear();
+	m_builtCountSinceIdle = 0;
+}
+
+void BLASBuildScheduler::beginFrame()
+{
+	m_trianglesBuiltThisFrame = 0;
+	m_buildCountThisFrame = 0;
+}
+
+bool BLASBuildScheduler::popNextBuild(float elapsedMilliseconds, Request& outRequest)
+{
+	if (m_requests.empty())
+		return false;
+
+	if (m_buildCountThisFrame > 0 && elapsedMilliseconds >= m_maxMillisecondsPerFrame)
+		return false;
+
+	uint32_t bestRequestIdx = 0;
+	for (uint32_t requestIdx = 1; requestIdx < m_requests.size(); ++requestIdx)
+	{
+		const QueuedRequest& candidate = m_requests[requestIdx];
+		const QueuedRequest& best = m_requests[bestRequestIdx];
+		if (candidate.m_request.m_priority > best.m_request.m_priority ||
+			(candidate.m_request.m_priority == best.m_request.m_priority && candidate.m_sequenceIdx < best.m_sequenceIdx))
+		{
+			bestRequestIdx = requestIdx;
+		}
+	}
+
+	const Request& bestRequest = m_requests[bestRequestIdx].m_request;
+	if (m_buildCountThisFrame > 0 && m_trianglesBuiltThisFrame + bestRequest.m_triangleCount > m_maxTrianglesPerFrame)
+		return false;
+
+	outRequest = bestRequest;
+	m_trianglesBuiltThisFrame += bestRequest.m_triangleCount;
+	m_buildCountThisFrame++;
+	m_builtCountSinceIdle++;
+	removeRequest(bestRequestIdx);
+
+	return true;
+}
+
+float BLASBuildScheduler::getProgress() const
+{
+	if (m_requests.empty())
+		return 1.0f;
+
+	return static_cast<float>(m_builtCountSinceIdle) / static_cast<float>(m_builtCountSinceIdle + m_requests.size());
+}
+
+float BLASBuildScheduler::computeVisibilityPriority(const glm::mat4& viewMatrix, const glm::vec3& boundingSphereCenter, float boundingSphereRadius)
+{
+	const glm::vec3 viewSpaceCenter(viewMatrix * glm::vec4(boundingSphereCenter, 1.0f));
+	const float distance = std::max(glm::length(viewSpaceCenter) - boundingSphereRadius, 0.0f);
+	const float distancePriority = 1.0f / (1.0f + distance);
+
+	// View space looks towards -Z
+	const bool isInFront = viewSpaceCenter.z - boundingSphereRadius < 0.0f;
+	return isInFront ? 1.0f + distancePriority : distancePriority;
+}
+
+void BLASBuildScheduler::removeRequest(uint32_t requestIdx)
+{
+	const Request& request = m_requests[requestIdx].m_request;
+	m_requestIdxByKey.erase(computeHash(request.m_assetId, request.m_lodType, request.m_lod));
+
+	if (requestIdx != m_requests.size() - 1)
+	{
+		m_requests[requestIdx] = m_requests.back();
+		const Request& movedRequest = m_requests[requestIdx].m_request;
+		m_requestIdxByKey[computeHash(movedRequest.m_assetId, movedRequest.m_lodType, movedRequest.m_lod)] = requestIdx;
+	}
+	m_requests.pop_back();
+}
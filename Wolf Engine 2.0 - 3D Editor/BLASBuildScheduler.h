@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Queues BLAS build requests and decides which ones are built each frame.
+// Highest priority requests are built first until the frame triangle budget or time budget is reached, at least one build is done per frame so the queue always progresses.
+class BLASBuildScheduler
+{
+public:
+	struct Request
+	{
+		uint32_t m_assetId;
+		uint32_t m_lodType;
+		uint32_t m_lod;
+		uint64_t m_triangleCount;
+		float m_priority;
+	};
+
+	BLASBuildScheduler(uint64_t maxTrianglesPerFrame, float maxMillisecondsPerFrame);
+
+	// Requesting an already queued BLAS only raises its priority
+	void request(const Request& request);
+	void cancelAsset(uint32_t assetId);
+	void clear();
+
+	void beginFrame();
+	// Returns false when the queue is empty or the frame budget is exhausted. 'elapsedMilliseconds' is the time spent building since beginFrame()
+	bool popNextBuild(float elapsedMilliseconds, Request& outRequest);
+
+	void setBudget(uint64_t maxTrianglesPerFrame, float maxMillisecondsPerFrame) { m_maxTrianglesPerFrame = maxTrianglesPerFrame; m_maxMillisecondsPerFrame = maxMillisecondsPerFrame; }
+	[[nodiscard]] uint32_t getPendingBuildCount() const { return static_cast<uint32_t>(m_requests.size()); }
+	[[nodiscard]] uint32_t getBuiltCount() const { return m_builtCountSinceIdle; } // since queue was last empty
+	[[nodiscard]] float getProgress() const; // 1.0 when nothing is pending
+
+	// Priority helper: objects in front of the camera come first, then closest ones
+	static float computeVisibilityPriority(const glm::mat4& viewMatrix, const glm::vec3& boundingSphereCenter, float boundingSphereRadius);
+
+private:
+	static uint64_t computeHash(uint32_t assetId, uint32_t lodType, uint32_t lod) { return (static_cast<uint64_t>(assetId) << 32) | (static_cast<uint64_t>(lodType) << 16) | lod; }
+	void removeRequest(uint32_t requestIdx);
+
+	struct QueuedRequest
+	{
+		Request m_request;
+		uint64_t m_sequenceIdx; // older requests first when priorities are equal
+	};
+	std::vector<QueuedRequest> m_requests;
+	std::unordered_map<uint64_t, uint32_t> m_requestIdxByKey;
+	uint64_t m_nextSequenceIdx = 0;
+
+	uint64_t m_maxTrianglesPerFrame;
+	float m_maxMillisecondsPerFrame;
+	uint64_t m_trianglesBuiltThisFrame = 0;
+	uint32_t m_buildCountThisFrame = 0;
+
+	uint32_t m_builtCountSinceIdle = 0;
+};
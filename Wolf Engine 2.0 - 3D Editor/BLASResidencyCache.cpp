@@ -0,0 +1,93 @@
+#include "BLASResidencyCache.h"
+
+#include <iterator>
+
+BLASResidencyCache::BLASResidencyCache(uint64_t memoryBudget) : m_memoryBudget(memoryBudget)
+{
+}
+
+void BLASResidencyCache::onBuilt(const Key& key, uint64_t sizeInBytes, uint32_t frameNumber)
+{
+	remove(key);
+
+	m_entries.push_front({ key, sizeInBytes, frameNumber });
+	m_entriesByKey[computeHash(key)] = m_entries.begin();
+	m_residentMemory += sizeInBytes;
+}
+
+void BLASResidencyCache::markUsed(const Key& key, uint32_t frameNumber)
+{
+	auto it = m_entriesByKey.find(computeHash(key));
+	if (it == m_entriesByKey.end())
+		return;
+
+	it->second->m_lastUsedFrameNumber = frameNumber;
+	m_entries.splice(m_entries.begin(), m_entries, it->second);
+}
+
+void BLASResidencyCache::remove(const Key& key)
+{
+	auto it = m_entriesByKey.find(computeHash(key));
+	if (it == m_entriesByKey.end())
+		return;
+
+	m_residentMemory -= it->second->m_sizeInBytes;
+	m_entries.erase(it->second);
+	m_entriesByKey.erase(it);
+}
+
+void BLASResidencyCache::removeAsset(uint32_t assetId)
+{
+	for (auto it = m_entries.begin(); it != m_entries.end();)
+	{
+		if (it->m_key.m_assetId == assetId)
+		{
+			m_residentMemory -= it->m_sizeInBytes;
+			m_entriesByKey.erase(computeHash(it->m_key));
+			it = m_entries.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+void BLASResidencyCache::clear()
+{
+	m_entries.clear();
+	m_entriesByKey.clear();
+	m_residentMemory = 0;
+}
+
+void BLASResidencyCache::collectEvictions(uint32_t currentFrameNumber, uint32_t framesBeforeRelease, const std::function<bool(const Key&)>& isInUse, std::vector<Key>& outKeysToEvict)
+{
+	if (m_residentMemory <= m_memoryBudget)
+		return;
+
+	// Walk from least to most recently used, entries found in use are moved to the front and not visited again
+	auto it = std::prev(m_entries.end());
+	const uint32_t entryCount = static_cast<uint32_t>(m_entries.size());
+	for (uint32_t i = 0; i < entryCount && m_residentMemory > m_memoryBudget; ++i)
+	{
+		const bool isFirst = it == m_entries.begin();
+		auto previousIt = isFirst ? m_entries.end() : std::prev(it);
+
+		if (isInUse(it->m_key))
+		{
+			it->m_lastUsedFrameNumber = currentFrameNumber;
+			m_entries.splice(m_entries.begin(), m_entries, it);
+		}
+		else if (it->m_lastUsedFrameNumber + framesBeforeRelease <= currentFrameNumber)
+		{
+			outKeysToEvict.push_back(it->m_key);
+			m_residentMemory -= it->m_sizeInBytes;
+			m_entriesByKey.erase(computeHash(it->m_key));
+			m_entries.erase(it);
+		}
+
+		if (isFirst)
+			break;
+		it = previousIt;
+	}
+}
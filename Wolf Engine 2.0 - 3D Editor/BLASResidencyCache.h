@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+// Keeps track of resident bottom level acceleration structures in least recently used order and picks the ones to release when the memory budget is exceeded.
+// Only bookkeeping is done here, owners build and destroy the acceleration structures themselves.
+class BLASResidencyCache
+{
+public:
+	struct Key
+	{
+		uint32_t m_assetId;
+		uint32_t m_lodType;
+		uint32_t m_lod;
+	};
+
+	explicit BLASResidencyCache(uint64_t memoryBudget);
+
+	void onBuilt(const Key& key, uint64_t sizeInBytes, uint32_t frameNumber);
+	void markUsed(const Key& key, uint32_t frameNumber);
+	void remove(const Key& key);
+	void removeAsset(uint32_t assetId);
+	void clear();
+
+	// Least recently used entries are selected until resident memory fits the budget. Entries are removed from the cache, caller must destroy the matching acceleration structures.
+	// An entry is only selected when it's not in use and hasn't been used during the last 'framesBeforeRelease' frames (GPU may still read it)
+	void collectEvictions(uint32_t currentFrameNumber, uint32_t framesBeforeRelease, const std::function<bool(const Key&)>& isInUse, std::vector<Key>& outKeysToEvict);
+
+	void setMemoryBudget(uint64_t memoryBudget) { m_memoryBudget = memoryBudget; }
+	[[nodiscard]] uint64_t getMemoryBudget() const { return m_memoryBudget; }
+	[[nodiscard]] uint64_t getResidentMemory() const { return m_residentMemory; }
+	[[nodiscard]] uint32_t getEntryCount() const { return static_cast<uint32_t>(m_entries.size()); }
+	[[nodiscard]] bool contains(const Key& key) const { return m_entriesByKey.contains(computeHash(key)); }
+
+private:
+	static uint64_t computeHash(const Key& key) { return (static_cast<uint64_t>(key.m_assetId) << 32) | (static_cast<uint64_t>(key.m_lodType) << 16) | key.m_lod; }
+
+	struct Entry
+	{
+		Key m_key;
+		uint64_t m_sizeInBytes;
+		uint32_t m_lastUsedFrameNumber;
+	};
+	std::list<Entry> m_entries; // most recently used first
+	std::unordered_map<uint64_t, std::list<Entry>::iterator> m_entriesByKey;
+
+	uint64_t m_memoryBudget;
+	uint64_t m_residentMemory = 0;
+};
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+#include <Extents.h>
+#include <ImageCompression.h>
+
+#include "BlockEncoder.h"
+#include "MipChainBuilder.h"
+#include "ParallelFor.h"
+
+// Converts, mips and compresses an image band by band, memory used by uncompressed pixels depends on the image width and the budget, not on its height.
+// Each level holds a single band of rows. Once a band is filled, its rows are compressed and downsampled into the next level band, then the band is reused.
+// Downsampling uses the box filter of MipChainBuilder, the only one which doesn't need rows of the neighbour bands.
+// Only compressed blocks are kept for the whole image. Blocks are encoded independently, so the output is identical to compressing each full level at once
+template <typename PixelType, typename CompressionType>
+class BandedImageCompressor
+{
+public:
+	static_assert(std::is_same_v<PixelType, Wolf::ImageCompression::RGBA8> || std::is_same_v<PixelType, Wolf::ImageCompression::RG32F>, "Unhandled pixel type");
+
+	// A band is split in groups of rows, each group is filled, compressed and downsampled by a single task
+	static constexpr uint32_t GROUP_ROW_COUNT = 32;
+
+	// Fills 'rowCount' rows of the full resolution image, starting at 'firstRow'. Called from worker threads with different rows
+	using RowProvider = std::function<void(uint32_t firstRow, uint32_t rowCount, PixelType* outPixels)>;
+
+	// 'mipCount' includes the full resolution, each level must have a width and a height multiple of 4 (see computeMipCount)
+	BandedImageCompressor(const Wolf::Extent3D& extent, uint32_t mipCount, MipChainBuilder::Content content, uint64_t memoryBudget);
+
+	void compress(const RowProvider& rowProvider, uint32_t maxThreadCount);
+
+	// Level 0 is the full resolution, blocks are stored row after row as BlockEncoder::compress does
+	[[nodiscard]] const std::vector<std::vector<CompressionType>>& getLevelBlocks() const { return m_levelBlocks; }
+	[[nodiscard]] uint32_t getBandRowCount() const { return m_bandRowCount; }
+	[[nodiscard]] uint64_t getPeakWorkingMemory() const { return m_peakWorkingMemory; } // bytes of uncompressed pixels held at once, all levels
+
+	// Levels are added while their width and height stay multiples of 4
+	static uint32_t computeMipCount(const Wolf::Extent3D& extent, uint32_t maxMipCount);
+	// All level bands together (at most twice the level 0 band) fit in 'memoryBudget', a band is never smaller than 2 groups
+	static uint32_t computeBandRowCount(uint32_t width, uint64_t memoryBudget);
+
+private:
+	struct Level
+	{
+		Wolf::Extent3D m_extent;
+		uint32_t m_firstBandRow = 0;
+		uint32_t m_filledRowCount = 0;
+		std::vector<std::vector<PixelType>> m_groups;
+	};
+
+	void beginBand(uint32_t levelIdx);
+	void processBand(uint32_t levelIdx, const RowProvider* rowProvider, uint32_t maxThreadCount);
+
+	MipChainBuilder::Content m_content;
+	uint32_t m_bandRowCount;
+	std::vector<Level> m_levels;
+	std::vector<std::vector<CompressionType>> m_levelBlocks;
+	uint64_t m_peakWorkingMemory = 0;
+};
+
+template <typename PixelType, typename CompressionType>
+BandedImageCompressor<PixelType, CompressionType>::BandedImageCompressor(const Wolf::Extent3D& extent, uint32_t mipCount, MipChainBuilder::Content content, uint64_t memoryBudget)
+	: m_content(content)
+{
+	if (extent.depth != 1 || computeMipCount(extent, mipCount) != mipCount)
+	{
+		Wolf::Debug::sendError("Image can't be compressed in bands, width and height of each level must be multiples of 4");
+		mipCount = 0;
+	}
+
+	m_bandRowCount = computeBandRowCount(extent.width, memoryBudget);
+
+	m_levels.resize(mipCount);
+	m_levelBlocks.resize(mipCount);
+	for (uint32_t levelIdx = 0; levelIdx < mipCount; ++levelIdx)
+	{
+		m_levels[levelIdx].m_extent = { extent.width >> levelIdx, extent.height >> levelIdx, 1 };
+		m_levelBlocks[levelIdx].resize(static_cast<size_t>(m_levels[levelIdx].m_extent.width / 4) * (m_levels[levelIdx].m_extent.height / 4));
+	}
+}
+
+template <typename PixelType, typename CompressionType>
+void BandedImageCompressor<PixelType, CompressionType>::compress(const RowProvider& rowProvider, uint32_t maxThreadCount)
+{
+	if (m_levels.empty())
+		return;
+
+	Level& fullResolution = m_levels[0];
+	for (uint32_t firstRow = 0; firstRow < fullResolution.m_extent.height; firstRow += m_bandRowCount)
+	{
+		fullResolution.m_firstBandRow = firstRow;
+		beginBand(0);
+		fullResolution.m_filledRowCount = std::min(m_bandRowCount, fullResolution.m_extent.height - firstRow);
+
+		processBand(0, &rowProvider, maxThreadCount);
+	}
+
+	for (Level& level : m_levels)
+	{
+		level.m_groups.clear();
+		level.m_groups.shrink_to_fit();
+	}
+}
+
+template <typename PixelType, typename CompressionType>
+uint32_t BandedImageCompressor<PixelType, CompressionType>::computeMipCount(const Wolf::Extent3D& extent, uint32_t maxMipCount)
+{
+	uint32_t mipCount = 0;
+	while (mipCount < maxMipCount && (extent.width >> mipCount) != 0 && (extent.height >> mipCount) != 0 &&
+		(extent.width >> mipCount) % 4 == 0 && (extent.height >> mipCount) % 4 == 0)
+	{
+		mipCount++;
+	}
+	return mipCount;
+}
+
+template <typename PixelType, typename CompressionType>
+uint32_t BandedImageCompressor<PixelType, CompressionType>::computeBandRowCount(uint32_t width, uint64_t memoryBudget)
+{
+	// Band starts of a level must fall on group starts of the next level
+	constexpr uint32_t ROW_COUNT_ALIGNMENT = 2 * GROUP_ROW_COUNT;
+
+	const uint64_t bandRowBytes = 2ull * std::max(width, 1u) * sizeof(PixelType);
+	const uint64_t rowCount = (memoryBudget / bandRowBytes) / ROW_COUNT_ALIGNMENT * ROW_COUNT_ALIGNMENT;
+	return static_cast<uint32_t>(std::clamp<uint64_t>(rowCount, ROW_COUNT_ALIGNMENT, 1u << 30));
+}
+
+template <typename PixelType, typename CompressionType>
+void BandedImageCompressor<PixelType, CompressionType>::beginBand(uint32_t levelIdx)
+{
+	Level& level = m_levels[levelIdx];
+	const uint32_t bandRowCount = std::min(m_bandRowCount, level.m_extent.height - level.m_firstBandRow);
+
+	level.m_filledRowCount = 0;
+	level.m_groups.resize((bandRowCount + GROUP_ROW_COUNT - 1) / GROUP_ROW_COUNT);
+	for (uint32_t groupIdx = 0; groupIdx < level.m_groups.size(); ++groupIdx)
+	{
+		const uint32_t groupRowCount = std::min(GROUP_ROW_COUNT, bandRowCount - groupIdx * GROUP_ROW_COUNT);
+		level.m_groups[groupIdx].resize(static_cast<size_t>(groupRowCount) * level.m_extent.width);
+	}
+
+	uint64_t workingMemory = 0;
+	for (const Level& otherLevel : m_levels)
+	{
+		for (const std::vector<PixelType>& group : otherLevel.m_groups)
+			workingMemory += group.capacity() * sizeof(PixelType);
+	}
+	m_peakWorkingMemory = std::max(m_peakWorkingMemory, workingMemory);
+}
+
+template <typename PixelType, typename CompressionType>
+void BandedImageCompressor<PixelType, CompressionType>::processBand(uint32_t levelIdx, const RowProvider* rowProvider, uint32_t maxThreadCount)
+{
+	Level& level = m_levels[levelIdx];
+	Level* nextLevel = levelIdx + 1 < m_levels.size() ? &m_levels[levelIdx + 1] : nullptr;
+
+	// Level band covers half a band of the next level, aligned on its groups
+	uint32_t nextLevelFirstGroupIdx = 0;
+	if (nextLevel)
+	{
+		if (nextLevel->m_filledRowCount == 0)
+			beginBand(levelIdx + 1);
+		nextLevelFirstGroupIdx = (level.m_firstBandRow / 2 - nextLevel->m_firstBandRow) / GROUP_ROW_COUNT;
+	}
+
+	const uint32_t width = level.m_extent.width;
+	parallelFor(static_cast<uint32_t>(level.m_groups.size()), [&](uint32_t groupIdx)
+		{
+			std::vector<PixelType>& groupPixels = level.m_groups[groupIdx];
+			const uint32_t groupRowCount = static_cast<uint32_t>(groupPixels.size() / width);
+			const uint32_t firstRow = level.m_firstBandRow + groupIdx * GROUP_ROW_COUNT;
+
+			if (rowProvider)
+				(*rowProvider)(firstRow, groupRowCount, groupPixels.data());
+
+			std::vector<CompressionType> groupBlocks;
+			BlockEncoder::compress({ width, groupRowCount, 1 }, groupPixels, groupBlocks);
+			std::copy(groupBlocks.begin(), groupBlocks.end(), m_levelBlocks[levelIdx].begin() + static_cast<size_t>(firstRow / 4) * (width / 4));
+
+			if (nextLevel)
+			{
+				std::vector<PixelType>& nextLevelGroupPixels = nextLevel->m_groups[nextLevelFirstGroupIdx + groupIdx / 2];
+				MipChainBuilder::downsampleRowPairs(groupPixels.data(), width, groupRowCount / 2, m_content,
+					nextLevelGroupPixels.data() + static_cast<size_t>(groupIdx % 2) * (GROUP_ROW_COUNT / 2) * (width / 2));
+			}
+		}, maxThreadCount);
+
+	if (!nextLevel)
+		return;
+
+	nextLevel->m_filledRowCount += level.m_filledRowCount / 2;
+	if (nextLevel->m_filledRowCount == std::min(m_bandRowCount, nextLevel->m_extent.height - nextLevel->m_firstBandRow))
+	{
+		processBand(levelIdx + 1, nullptr, maxThreadCount);
+		nextLevel->m_firstBandRow += m_bandRowCount;
+		nextLevel->m_filledRowCount = 0;
+	}
+}
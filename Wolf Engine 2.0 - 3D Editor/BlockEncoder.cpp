@@ -0,0 +1,1288 @@
+#include "BlockEncoder.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define BLOCK_ENCODER_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TARGET_SSE41
+#define TARGET_AVX2
+#else
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+static_assert(sizeof(Wolf::ImageCompression::RGBA8) == 4);
+static_assert(sizeof(Wolf::ImageCompression::RG32F) == 2 * sizeof(float));
+static_assert(sizeof(Wolf::ImageCompression::BC1) == 8);
+static_assert(sizeof(Wolf::ImageCompression::BC3) == 16);
+static_assert(sizeof(Wolf::ImageCompression::BC5) == 16);
+static_assert(sizeof(BlockEncoder::BC4) == 8);
+static_assert(sizeof(BlockEncoder::BC7) == 16);
+
+namespace
+{
+	struct PlanarBlock
+	{
+		alignas(32) int32_t r[BlockEncoder::BLOCK_PIXEL_COUNT];
+		alignas(32) int32_t g[BlockEncoder::BLOCK_PIXEL_COUNT];
+		alignas(32) int32_t b[BlockEncoder::BLOCK_PIXEL_COUNT];
+	};
+
+	// Steps which run on every pixel, one implementation per instruction set
+	struct Kernels
+	{
+		// Colours are centered and scaled by 16 (16 * x - sum) to stay in integers. Output is [rr, rg, rb, gg, gb, bb]
+		void (*computeCovariance)(const PlanarBlock& block, const int32_t sums[3], int32_t outCovariance[6]);
+		void (*projectOnAxis)(const PlanarBlock& block, const int32_t axis[3], int32_t outProjections[BlockEncoder::BLOCK_PIXEL_COUNT]);
+		// Palette is in BC1 index order, returns 2 bits per pixel
+		uint32_t (*assignColorIndices)(const PlanarBlock& block, const int32_t palette[4][3]);
+		void (*findMinMax)(const uint8_t* values, uint8_t& outMin, uint8_t& outMax);
+		// 'value0' > 'value1' (8 values mode), returns 3 bits per pixel
+		uint64_t (*assignBC4Indices)(const uint8_t* values, int32_t value0, int32_t value1);
+	};
+
+	/* Scalar, reference */
+	void computeCovarianceScalar(const PlanarBlock& block, const int32_t sums[3], int32_t outCovariance[6])
+	{
+		std::memset(outCovariance, 0, 6 * sizeof(int32_t));
+		for (uint32_t i = 0; i < BlockEncoder::BLOCK_PIXEL_COUNT; ++i)
+		{
+			const int32_t r = 16 * block.r[i] - sums[0];
+			const int32_t g = 16 * block.g[i] - sums[1];
+			const int32_t b = 16 * block.b[i] - sums[2];
+
+			outCovariance[0] += r * r;
+			outCovariance[1] += r * g;
+			outCovariance[2] += r * b;
+			outCovariance[3] += g * g;
+			outCovariance[4] += g * b;
+			outCovariance[5] += b * b;
+		}
+	}
+
+	void projectOnAxisScalar(const PlanarBlock& block, const int32_t axis[3], int32_t outProjections[BlockEncoder::BLOCK_PIXEL_COUNT])
+	{
+		for (uint32_t i = 0; i < BlockEncoder::BLOCK_PIXEL_COUNT; ++i)
+		{
+			outProjections[i] = block.r[i] * axis[0] + block.g[i] * axis[1] + block.b[i] * axis[2];
+		}
+	}
+
+	uint32_t assignColorIndicesScalar(const PlanarBlock& block, const int32_t palette[4][3])
+	{
+		uint32_t indices = 0;
+		for (uint32_t i = 0; i < BlockEncoder::BLOCK_PIXEL_COUNT; ++i)
+		{
+			int32_t bestDistance = INT32_MAX;
+			uint32_t bestIdx = 0;
+			for (uint32_t paletteIdx = 0; paletteIdx < 4; ++paletteIdx)
+			{
+				const int32_t dr = block.r[i] - palette[paletteIdx][0];
+				const int32_t dg = block.g[i] - palette[paletteIdx][1];
+				const int32_t db = block.b[i] - palette[paletteIdx][2];
+				const int32_t distance = dr * dr + dg * dg + db * db;
+				if (distance < bestDistance)
+				{
+					bestDistance = distance;
+					bestIdx = paletteIdx;
+				}
+			}
+			indices |= bestIdx << (2 * i);
+		}
+		return indices;
+	}
+
+	void findMinMaxScalar(const uint8_t* values, uint8_t& outMin, uint8_t& outMax)
+	{
+		outMin = 255;
+		outMax = 0;
+		for (uint32_t i = 0; i < BlockEncoder::BLOCK_PIXEL_COUNT; ++i)
+		{
+			outMin = std::min(outMin, values[i]);
+			outMax = std::max(outMax, values[i]);
+		}
+	}
+
+	// Position between value0 (0) and value1 (7) is computed with a fixed point reciprocal instead of searching the 8 palette values
+	constexpr int32_t BC4_RECIPROCAL_SHIFT = 16;
+	int32_t computeBC4Reciprocal(int32_t value0, int32_t value1)
+	{
+		const int32_t doubleRange = 2 * (value0 - value1);
+		return ((1 << BC4_RECIPROCAL_SHIFT) + doubleRange - 1) / doubleRange;
+	}
+
+	uint64_t assignBC4IndicesScalar(const uint8_t* values, int32_t value0, int32_t value1)
+	{
+		const int32_t range = value0 - value1;
+		const int32_t reciprocal = computeBC4Reciprocal(value0, value1);
+
+		uint64_t indices = 0;
+		for (uint32_t i = 0; i < BlockEncoder::BLOCK_PIXEL_COUNT; ++i)
+		{
+			const int32_t position = std::clamp((((value0 - values[i]) * 14 + range) * reciprocal) >> BC4_RECIPROCAL_SHIFT, 0, 7);
+			const uint64_t idx = position == 0 ? 0 : (position == 7 ? 1 : position + 1);
+			indices |= idx << (3 * i);
+		}
+		return indices;
+	}
+
+	constexpr Kernels SCALAR_KERNELS = { computeCovarianceScalar, projectOnAxisScalar, assignColorIndicesScalar, findMinMaxScalar, assignBC4IndicesScalar };
+
+#ifdef BLOCK_ENCODER_X86
+	/* SSE4.1, 4 pixels per instruction */
+	TARGET_SSE41 int32_t horizontalSumSSE41(__m128i values)
+	{
+		values = _mm_add_epi32(values, _mm_shuffle_epi32(values, _MM_SHUFFLE(1, 0, 3, 2)));
+		values = _mm_add_epi32(values, _mm_shuffle_epi32(values, _MM_SHUFFLE(2, 3, 0, 1)));
+		return _mm_cvtsi128_si32(values);
+	}
+
+	TARGET_SSE41 void computeCovarianceSSE41(const PlanarBlock& block, const int32_t sums[3], int32_t outCovariance[6])
+	{
+		const __m128i sumR = _mm_set1_epi32(sums[0]);
+		const __m128i sumG = _mm_set1_epi32(sums[1]);
+		const __m128i sumB = _mm_set1_epi32(sums[2]);
+
+		__m128i rr = _mm_setzero_si128(), rg = _mm_setzero_si128(), rb = _mm_setzero_si128(), gg = _mm_setzero_si128(), gb = _mm_setzero_si128(), bb = _mm_setzero_si128();
+		for (uint32_t i = 0; i < BlockEncoder::BLOCK_PIXEL_COUNT; i += 4)
+		{
+			const __m128i r = _mm_sub_epi32(_mm_slli_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(&block.r[i])), 4), sumR);
+			const __m128i g = _mm_sub_epi32(_mm_slli_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(&block.g[i])), 4), sumG);
+			const __m128i b = _mm_sub_epi32(_mm_slli_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(&block.b[i])), 4), sumB);
+
+			rr = _mm_add_epi32(rr, _mm_mullo_epi32(r, r));
+			rg = _mm_add_epi32(rg, _mm_mullo_epi32(r, g));
+			rb = _mm_add_epi32(rb, _mm_mullo_epi32(r, b));
+			gg = _mm_add_epi32(gg, _mm_mullo_epi32(g, g));
+			gb = _mm_add_epi32(gb, _mm_mullo_epi32(g, b));
+			bb = _mm_add_epi32(bb, _mm_mullo_epi32(b, b));
+		}
+
+		outCovariance[0] = horizontalSumSSE41(rr);
+		outCovariance[1] = horizontalSumSSE41(rg);
+		outCovariance[2] = horizontalSumSSE41(rb);
+		outCovariance[3] = horizontalSumSSE41(gg);
+		outCovariance[4] = horizontalSumSSE41(gb);
+		outCovariance[5] = horizontalSumSSE41(bb);
+	}
+
+	TARGET_SSE41 void projectOnAxisSSE41(const PlanarBlock& block, const int32_t axis[3], int32_t outProjections[BlockEncoder::BLOCK_PIXEL_COUNT])
+	{
+		const __m128i axisR = _mm_set1_epi32(axis[0]);
+		const __m128i axisG = _mm_set1_epi32(axis[1]);
+		const __m128i axisB = _mm_set1_epi32(axis[2]);
+		for (uint32_t i = 0; i < BlockEncoder::BLOCK_PIXEL_COUNT; i += 4)
+		{
+			const __m128i r = _mm_mullo_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(&block.r[i])), axisR);
+			const __m128i g = _mm_mullo_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(&block.g[i])), axisG);
+			const __m128i b = _mm_mullo_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(&block.b[i])), axisB);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&outProjections[i]), _mm_add_epi32(_mm_add_epi32(r, g), b));
+		}
+	}
+
+	TARGET_SSE41 uint32_t assignColorIndicesSSE41(const PlanarBlock& block, const int32_t palette[4][3])
+	{
+		uint32_t indices = 0;
+		for (uint32_t i = 0; i < BlockEncoder::BLOCK_PIXEL_COUNT; i += 4)
+		{
+			const __m128i r = _mm_load_si128(reinterpret_cast<const __m128i*>(&block.r[i]));
+			const __m128i g = _mm_load_si128(reinterpret_cast<const __m128i*>(&block.g[i]));
+			const __m128i b = _mm_load_si128(reinterpret_cast<const __m128i*>(&block.b[i]));
+
+			__m128i bestDistance = _mm_set1_epi32(INT32_MAX);
+			__m128i bestIdx = _mm_setzero_si128();
+			for (int32_t paletteIdx = 0; paletteIdx < 4; ++paletteIdx)
+			{
+				const __m128i dr = _mm_sub_epi32(r, _mm_set1_epi32(palette[paletteIdx][0]));
+				const __m128i dg = _mm_sub_epi32(g, _mm_set1_epi32(palette[paletteIdx][1]));
+				const __m128i db = _mm_sub_epi32(b, _mm_set1_epi32(palette[paletteIdx][2]));
+				const __m128i distance = _mm_add_epi32(_mm_add_epi32(_mm_mullo_epi32(dr, dr), _mm_mullo_epi32(dg, dg)), _mm_mullo_epi32(db, db));
+
+				// Strictly closer only, first palette entry wins on equality as in the scalar path
+				const __m128i isCloser = _mm_cmpgt_epi32(bestDistance, distance);
+				bestDistance = _mm_min_epi32(bestDistance, distance);
+				bestIdx = _mm_blendv_epi8(bestIdx, _mm_set1_epi32(paletteIdx), isCloser);
+			}
+
+			// 2 bits per pixel, lane j is shifted by 2 * j (no variable shift before AVX2), bits don't overlap so the sum is an or
+			const __m128i shiftedIdx = _mm_mullo_epi32(bestIdx, _mm_setr_epi32(1, 1 << 2, 1 << 4, 1 << 6));
+			indices |= static_cast<uint32_t>(horizontalSumSSE41(shiftedIdx)) << (2 * i);
+		}
+		return indices;
+	}
+
+	TARGET_SSE41 void findMinMaxSSE41(const uint8_t* values, uint8_t& outMin, uint8_t& outMax)
+	{
+		const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values));
+
+		// _mm_minpos_epu16 works on 8 x 16 bits: min of the bytes, then min of the inverted bytes for the max
+		const __m128i minBytes = _mm_min_epu8(bytes, _mm_srli_si128(bytes, 8));
+		const __m128i maxBytes = _mm_max_epu8(bytes, _mm_srli_si128(bytes, 8));
+		const __m128i minWords = _mm_cvtepu8_epi16(minBytes);
+		const __m128i invertedMaxWords = _mm_sub_epi16(_mm_set1_epi16(255), _mm_cvtepu8_epi16(maxBytes));
+
+		outMin = static_cast<uint8_t>(_mm_cvtsi128_si32(_mm_minpos_epu16(minWords)) & 0xff);
+		outMax = static_cast<uint8_t>(255 - (_mm_cvtsi128_si32(_mm_minpos_epu16(invertedMaxWords)) & 0xff));
+	}
+
+	TARGET_SSE41 uint64_t assignBC4IndicesSSE41(const uint8_t* values, int32_t value0, int32_t value1)
+	{
+		const int32_t range = value0 - value1;
+		const __m128i reciprocal = _mm_set1_epi32(computeBC4Reciprocal(value0, value1));
+		const __m128i value0x14PlusRange = _mm_set1_epi32(value0 * 14 + range);
+		const __m128i fourteen = _mm_set1_epi32(14);
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i seven = _mm_set1_epi32(7);
+		const __m128i one = _mm_set1_epi32(1);
+
+		uint64_t indices = 0;
+		for (uint32_t i = 0; i < BlockEncoder::BLOCK_PIXEL_COUNT; i += 4)
+		{
+			int32_t packedValues;
+			std::memcpy(&packedValues, &values[i], sizeof(packedValues));
+			const __m128i v = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(packedValues));
+
+			__m128i position = _mm_sub_epi32(value0x14PlusRange, _mm_mullo_epi32(v, fourteen));
+			position = _mm_srai_epi32(_mm_mullo_epi32(position, reciprocal), BC4_RECIPROCAL_SHIFT);
+			position = _mm_min_epi32(_mm_max_epi32(position, zero), seven);
+
+			// Positions 1 to 6 are indices 2 to 7, position 7 is index 1
+			__m128i idx = _mm_add_epi32(position, _mm_andnot_si128(_mm_cmpeq_epi32(position, zero), one));
+			idx = _mm_blendv_epi8(idx, one, _mm_cmpeq_epi32(position, seven));
+
+			const __m128i shiftedIdx = _mm_mullo_epi32(idx, _mm_setr_epi32(1, 1 << 3, 1 << 6, 1 << 9));
+			indices |= static_cast<uint64_t>(horizontalSumSSE41(shiftedIdx)) << (3 * i);
+		}
+		return indices;
+	}
+
+	constexpr Kernels SSE41_KERNELS = { computeCovarianceSSE41, projectOnAxisSSE41, assignColorIndicesSSE41, findMinMaxSSE41, assignBC4IndicesSSE41 };
+
+	/* AVX2, 8 pixels per instruction */
+	TARGET_AVX2 int32_t horizontalSumAVX2(__m256i values)
+	{
+		__m128i halfSum = _mm_add_epi32(_mm256_castsi256_si128(values), _mm256_extracti128_si256(values, 1));
+		halfSum = _mm_add_epi32(halfSum, _mm_shuffle_epi32(halfSum, _MM_SHUFFLE(1, 0, 3, 2)));
+		halfSum = _mm_add_epi32(halfSum, _mm_shuffle_epi32(halfSum, _MM_SHUFFLE(2, 3, 0, 1)));
+		return _mm_cvtsi128_si32(halfSum);
+	}
+
+	TARGET_AVX2 void computeCovarianceAVX2(const PlanarBlock& block, const int32_t sums[3], int32_t outCovariance[6])
+	{
+		const __m256i sumR = _mm256_set1_epi32(sums[0]);
+		const __m256i sumG = _mm256_set1_epi32(sums[1]);
+		const __m256i sumB = _mm256_set1_epi32(sums[2]);
+
+		__m256i rr = _mm256_setzero_si256(), rg = _mm256_setzero_si256(), rb = _mm256_setzero_si256(), gg = _mm256_setzero_si256(), gb = _mm256_setzero_si256(), bb = _mm256_setzero_si256();
+		for (uint32_t i = 0; i < BlockEncoder::BLOCK_PIXEL_COUNT; i += 8)
+		{
+			const __m256i r = _mm256_sub_epi32(_mm256_slli_epi32(_mm256_load_si256(reinterpret_cast<const __m256i*>(&block.r[i])), 4), sumR);
+			const __m256i g = _mm256_sub_epi32(_mm256_slli_epi32(_mm256_load_si256(reinterpret_cast<const __m256i*>(&block.g[i])), 4), sumG);
+			const __m256i b = _mm256_sub_epi32(_mm256_slli_epi32(_mm256_load_si256(reinterpret_cast<const __m256i*>(&block.b[i])), 4), sumB);
+
+			rr = _mm256_add_epi32(rr, _mm256_mullo_epi32(r, r));
+			rg = _mm256_add_epi32(rg, _mm256_mullo_epi32(r, g));
+			rb = _mm256_add_epi32(rb, _mm256_mullo_epi32(r, b));
+			gg = _mm256_add_epi32(gg, _mm256_mullo_epi32(g, g));
+			gb = _mm256_add_epi32(gb, _mm256_mullo_epi32(g, b));
+			bb = _mm256_add_epi32(bb, _mm256_mullo_epi32(b, b));
+		}
+
+		outCovariance[0] = horizontalSumAVX2(rr);
+		outCovariance[1] = horizontalSumAVX2(rg);
+		outCovariance[2] = horizontalSumAVX2(rb);
+		outCovariance[3] = horizontalSumAVX2(gg);
+		outCovariance[4] = horizontalSumAVX2(gb);
+		outCovariance[5] = horizontalSumAVX2(bb);
+	}
+
+	TARGET_AVX2 void projectOnAxisAVX2(const PlanarBlock& block, const int32_t axis[3], int32_t outProjections[BlockEncoder::BLOCK_PIXEL_COUNT])
+	{
+		const __m256i axisR = _mm256_set1_epi32(axis[0]);
+		const __m256i axisG = _mm256_set1_epi32(axis[1]);
+		const __m256i axisB = _mm256_set1_epi32(axis[2]);
+		for (uint32_t i = 0; i < BlockEncoder::BLOCK_PIXEL_COUNT; i += 8)
+		{
+			const __m256i r = _mm256_mullo_epi32(_mm256_load_si256(reinterpret_cast<const __m256i*>(&block.r[i])), axisR);
+			const __m256i g = _mm256_mullo_epi32(_mm256_load_si256(reinterpret_cast<const __m256i*>(&block.g[i])), axisG);
+			const __m256i b = _mm256_mullo_epi32(_mm256_load_si256(reinterpret_cast<const __m256i*>(&block.b[i])), axisB);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(&outProjections[i]), _mm256_add_epi32(_mm256_add_epi32(r, g), b));
+		}
+	}
+
+	TARGET_AVX2 uint32_t assignColorIndicesAVX2(const PlanarBlock& block, const int32_t palette[4][3])
+	{
+		const __m256i shifts = _mm256_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14);
+
+		uint32_t indices = 0;
+		for (uint32_t i = 0; i < BlockEncoder::BLOCK_PIXEL_COUNT; i += 8)
+		{
+			const __m256i r = _mm256_load_si256(reinterpret_cast<const __m256i*>(&block.r[i]));
+			const __m256i g = _mm256_load_si256(reinterpret_cast<const __m256i*>(&block.g[i]));
+			const __m256i b = _mm256_load_si256(reinterpret_cast<const __m256i*>(&block.b[i]));
+
+			__m256i bestDistance = _mm256_set1_epi32(INT32_MAX);
+			__m256i bestIdx = _mm256_setzero_si256();
+			for (int32_t paletteIdx = 0; paletteIdx < 4; ++paletteIdx)
+			{
+				const __m256i dr = _mm256_sub_epi32(r, _mm256_set1_epi32(palette[paletteIdx][0]));
+				const __m256i dg = _mm256_sub_epi32(g, _mm256_set1_epi32(palette[paletteIdx][1]));
+				const __m256i db = _mm256_sub_epi32(b, _mm256_set1_epi32(palette[paletteIdx][2]));
+				const __m256i distance = _mm256_add_epi32(_mm256_add_epi32(_mm256_mullo_epi32(dr, dr), _mm256_mullo_epi32(dg, dg)), _mm256_mullo_epi32(db, db));
+
+				const __m256i isCloser = _mm256_cmpgt_epi32(bestDistance, distance);
+				bestDistance = _mm256_min_epi32(bestDistance, distance);
+				bestIdx = _mm256_blendv_epi8(bestIdx, _mm256_set1_epi32(paletteIdx), isCloser);
+			}
+
+			indices |= static_cast<uint32_t>(horizontalSumAVX2(_mm256_sllv_epi32(bestIdx, shifts))) << (2 * i);
+		}
+		return indices;
+	}
+
+	TARGET_AVX2 uint64_t assignBC4IndicesAVX2(const uint8_t* values, int32_t value0, int32_t value1)
+	{
+		const int32_t range = value0 - value1;
+		const __m256i reciprocal = _mm256_set1_epi32(computeBC4Reciprocal(value0, value1));
+		const __m256i value0x14PlusRange = _mm256_set1_epi32(value0 * 14 + range);
+		const __m256i fourteen = _mm256_set1_epi32(14);
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i seven = _mm256_set1_epi32(7);
+		const __m256i one = _mm256_set1_epi32(1);
+		const __m256i shifts = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+
+		uint64_t indices = 0;
+		for (uint32_t i = 0; i < BlockEncoder::BLOCK_PIXEL_COUNT; i += 8)
+		{
+			const __m256i v = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&values[i])));
+
+			__m256i position = _mm256_sub_epi32(value0x14PlusRange, _mm256_mullo_epi32(v, fourteen));
+			position = _mm256_srai_epi32(_mm256_mullo_epi32(position, reciprocal), BC4_RECIPROCAL_SHIFT);
+			position = _mm256_min_epi32(_mm256_max_epi32(position, zero), seven);
+
+			__m256i idx = _mm256_add_epi32(position, _mm256_andnot_si256(_mm256_cmpeq_epi32(position, zero), one));
+			idx = _mm256_blendv_epi8(idx, one, _mm256_cmpeq_epi32(position, seven));
+
+			indices |= static_cast<uint64_t>(static_cast<uint32_t>(horizontalSumAVX2(_mm256_sllv_epi32(idx, shifts)))) << (3 * i);
+		}
+		return indices;
+	}
+
+	// Min/max of 16 bytes fits in a single SSE register, AVX2 has nothing more to offer
+	constexpr Kernels AVX2_KERNELS = { computeCovarianceAVX2, projectOnAxisAVX2, assignColorIndicesAVX2, findMinMaxSSE41, assignBC4IndicesAVX2 };
+#endif
+
+	const Kernels& getKernels(BlockEncoder::InstructionSet instructionSet)
+	{
+#ifdef BLOCK_ENCODER_X86
+		switch (instructionSet)
+		{
+			case BlockEncoder::InstructionSet::AVX2:
+				return AVX2_KERNELS;
+			case BlockEncoder::InstructionSet::SSE41:
+				return SSE41_KERNELS;
+			default:
+				break;
+		}
+#endif
+		return SCALAR_KERNELS;
+	}
+
+	// Power iteration on the covariance matrix, shared by all instruction sets. Axis is returned as integers in [-256, 256]
+	bool computePrincipalAxis(const int32_t covariance[6], int32_t outAxis[3])
+	{
+		const float matrix[3][3] =
+		{
+			{ static_cast<float>(covariance[0]), static_cast<float>(covariance[1]), static_cast<float>(covariance[2]) },
+			{ static_cast<float>(covariance[1]), static_cast<float>(covariance[3]), static_cast<float>(covariance[4]) },
+			{ static_cast<float>(covariance[2]), static_cast<float>(covariance[4]), static_cast<float>(covariance[5]) }
+		};
+
+		// Start from the column of the largest variance, it can't be orthogonal to the principal axis
+		uint32_t startColumn = 0;
+		for (uint32_t i = 1; i < 3; ++i)
+		{
+			if (matrix[i][i] > matrix[startColumn][startColumn])
+				startColumn = i;
+		}
+		if (matrix[startColumn][startColumn] <= 0.0f)
+			return false; // all pixels have the same colour
+
+		float axis[3] = { matrix[0][startColumn], matrix[1][startColumn], matrix[2][startColumn] };
+		constexpr uint32_t POWER_ITERATION_COUNT = 8;
+		for (uint32_t iteration = 0; iteration < POWER_ITERATION_COUNT; ++iteration)
+		{
+			float newAxis[3];
+			for (uint32_t i = 0; i < 3; ++i)
+			{
+				newAxis[i] = matrix[i][0] * axis[0] + matrix[i][1] * axis[1] + matrix[i][2] * axis[2];
+			}
+
+			const float maxComponent = std::max({ std::abs(newAxis[0]), std::abs(newAxis[1]), std::abs(newAxis[2]) });
+			if (maxComponent == 0.0f)
+				break;
+			for (uint32_t i = 0; i < 3; ++i)
+			{
+				axis[i] = newAxis[i] / maxComponent;
+			}
+		}
+
+		const float maxComponent = std::max({ std::abs(axis[0]), std::abs(axis[1]), std::abs(axis[2]) });
+		for (uint32_t i = 0; i < 3; ++i)
+		{
+			outAxis[i] = static_cast<int32_t>(std::lround(axis[i] / maxComponent * 256.0f));
+		}
+		return true;
+	}
+
+	uint16_t packRGB565(const int32_t color[3])
+	{
+		const uint32_t r = (color[0] * 31 + 127) / 255;
+		const uint32_t g = (color[1] * 63 + 127) / 255;
+		const uint32_t b = (color[2] * 31 + 127) / 255;
+		return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+	}
+
+	void unpackRGB565(uint16_t packedColor, int32_t outColor[3])
+	{
+		const int32_t r = packedColor >> 11;
+		const int32_t g = (packedColor >> 5) & 63;
+		const int32_t b = packedColor & 31;
+		outColor[0] = (r << 3) | (r >> 2);
+		outColor[1] = (g << 2) | (g >> 4);
+		outColor[2] = (b << 3) | (b >> 2);
+	}
+
+	void encodeColorBlock(const Wolf::ImageCompression::RGBA8* pixels, uint8_t* outBlock, const Kernels& kernels)
+	{
+		PlanarBlock block;
+		int32_t sums[3] = { 0, 0, 0 };
+		for (uint32_t i = 0; i < BlockEncoder::BLOCK_PIXEL_COUNT; ++i)
+		{
+			block.r[i] = pixels[i].r;
+			block.g[i] = pixels[i].g;
+			block.b[i] = pixels[i].b;
+			sums[0] += block.r[i];
+			sums[1] += block.g[i];
+			sums[2] += block.b[i];
+		}
+
+		int32_t covariance[6];
+		kernels.computeCovariance(block, sums, covariance);
+
+		int32_t axis[3] = { 1, 1, 1 }; // any axis works for a single colour
+		computePrincipalAxis(covariance, axis);
+
+		int32_t projections[BlockEncoder::BLOCK_PIXEL_COUNT];
+		kernels.projectOnAxis(block, axis, projections);
+
+		uint32_t minIdx = 0, maxIdx = 0;
+		for (uint32_t i = 1; i < BlockEncoder::BLOCK_PIXEL_COUNT; ++i)
+		{
+			if (projections[i] < projections[minIdx])
+				minIdx = i;
+			if (projections[i] > projections[maxIdx])
+				maxIdx = i;
+		}
+
+		// Extremes are moved slightly inward: the interpolated colours then cover the block better
+		int32_t high[3] = { block.r[maxIdx], block.g[maxIdx], block.b[maxIdx] };
+		int32_t low[3] = { block.r[minIdx], block.g[minIdx], block.b[minIdx] };
+		for (uint32_t i = 0; i < 3; ++i)
+		{
+			const int32_t inset = (high[i] - low[i]) / 16;
+			high[i] -= inset;
+			low[i] += inset;
+		}
+
+		uint16_t color0 = packRGB565(high);
+		uint16_t color1 = packRGB565(low);
+		if (color0 < color1)
+			std::swap(color0, color1); // color0 > color1 selects the 4 colours mode
+
+		uint32_t indices = 0;
+		if (color0 != color1)
+		{
+			int32_t palette[4][3];
+			unpackRGB565(color0, palette[0]);
+			unpackRGB565(color1, palette[1]);
+			for (uint32_t i = 0; i < 3; ++i)
+			{
+				palette[2][i] = (2 * palette[0][i] + palette[1][i]) / 3;
+				palette[3][i] = (palette[0][i] + 2 * palette[1][i]) / 3;
+			}
+			indices = kernels.assignColorIndices(block, palette);
+		}
+
+		outBlock[0] = static_cast<uint8_t>(color0 & 0xff);
+		outBlock[1] = static_cast<uint8_t>(color0 >> 8);
+		outBlock[2] = static_cast<uint8_t>(color1 & 0xff);
+		outBlock[3] = static_cast<uint8_t>(color1 >> 8);
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			outBlock[4 + i] = static_cast<uint8_t>((indices >> (8 * i)) & 0xff);
+		}
+	}
+
+	void encodeSingleChannelBlock(const uint8_t* values, uint8_t* outBlock, const Kernels& kernels)
+	{
+		uint8_t minValue, maxValue;
+		kernels.findMinMax(values, minValue, maxValue);
+
+		// value0 > value1 selects the 8 values mode, when equal every index points to value0
+		outBlock[0] = maxValue;
+		outBlock[1] = minValue;
+
+		uint64_t indices = 0;
+		if (maxValue != minValue)
+			indices = kernels.assignBC4Indices(values, maxValue, minValue);
+
+		for (uint32_t i = 0; i < 6; ++i)
+		{
+			outBlock[2 + i] = static_cast<uint8_t>((indices >> (8 * i)) & 0xff);
+		}
+	}
+
+	uint8_t signedNormalToUNorm8(float value)
+	{
+		return static_cast<uint8_t>(std::clamp(value * 0.5f + 0.5f, 0.0f, 1.0f) * 255.0f + 0.5f);
+	}
+
+	void decodeSingleChannelBlock(const uint8_t* block, uint8_t* outValues)
+	{
+		const int32_t value0 = block[0];
+		const int32_t value1 = block[1];
+
+		int32_t palette[8] = { value0, value1 };
+		if (value0 > value1)
+		{
+			for (int32_t i = 1; i < 7; ++i)
+				palette[i + 1] = ((7 - i) * value0 + i * value1) / 7;
+		}
+		else
+		{
+			for (int32_t i = 1; i < 5; ++i)
+				palette[i + 1] = ((5 - i) * value0 + i * value1) / 5;
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+
+		uint64_t indices = 0;
+		for (uint32_t i = 0; i < 6; ++i)
+		{
+			indices |= static_cast<uint64_t>(block[2 + i]) << (8 * i);
+		}
+		for (uint32_t i = 0; i < BlockEncoder::BLOCK_PIXEL_COUNT; ++i)
+		{
+			outValues[i] = static_cast<uint8_t>(palette[(indices >> (3 * i)) & 7]);
+		}
+	}
+
+	/* BC7, modes 5 and 6 (single subset). Pixels are encoded along lines: mode 6 uses one RGBA line, mode 5 one RGB line and one alpha line */
+	constexpr uint32_t BC7_CHANNEL_COUNT = 4;
+	constexpr uint32_t BC7_REFINEMENT_COUNT = 2;
+	constexpr int32_t BC7_WEIGHTS_2_BITS[4] = { 0, 21, 43, 64 };
+	constexpr int32_t BC7_WEIGHTS_4_BITS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	class BC7BitWriter
+	{
+	public:
+		explicit BC7BitWriter(uint8_t* outBlock) : m_block(outBlock) { std::memset(m_block, 0, sizeof(BlockEncoder::BC7)); }
+
+		void write(uint32_t value, uint32_t bitCount)
+		{
+			for (uint32_t i = 0; i < bitCount; ++i, ++m_bitOffset)
+			{
+				m_block[m_bitOffset / 8] |= static_cast<uint8_t>(((value >> i) & 1) << (m_bitOffset % 8));
+			}
+		}
+
+	private:
+		uint8_t* m_block;
+		uint32_t m_bitOffset = 0;
+	};
+
+	class BC7BitReader
+	{
+	public:
+		explicit BC7BitReader(const uint8_t* block) : m_block(block) {}
+
+		uint32_t read(uint32_t bitCount)
+		{
+			uint32_t value = 0;
+			for (uint32_t i = 0; i < bitCount; ++i, ++m_bitOffset)
+			{
+				value |= static_cast<uint32_t>((m_block[m_bitOffset / 8] >> (m_bitOffset % 8)) & 1) << i;
+			}
+			return value;
+		}
+
+	private:
+		const uint8_t* m_block;
+		uint32_t m_bitOffset = 0;
+	};
+
+	// Endpoints stored on 7 bits plus a lowest bit shared by the channels (p-bit, mode 6), on 7 bits (mode 5 colour) or on 8 bits (mode 5 alpha)
+	enum class BC7Quantization { SEVEN_BITS_AND_P_BIT, SEVEN_BITS, EIGHT_BITS };
+
+	struct BC7Line
+	{
+		uint32_t m_firstChannel;
+		uint32_t m_channelCount;
+		BC7Quantization m_quantization;
+		const int32_t* m_weights;
+		uint32_t m_indexBitCount;
+
+		uint32_t m_quantized[2][BC7_CHANNEL_COUNT] = {};
+		uint32_t m_pBits[2] = {};
+		uint32_t m_indices[BlockEncoder::BLOCK_PIXEL_COUNT] = {};
+		int32_t m_error = INT32_MAX;
+
+		BC7Line(uint32_t firstChannel, uint32_t channelCount, BC7Quantization quantization, const int32_t* weights, uint32_t indexBitCount)
+			: m_firstChannel(firstChannel), m_channelCount(channelCount), m_quantization(quantization), m_weights(weights), m_indexBitCount(indexBitCount) {}
+
+		[[nodiscard]] uint32_t getWeightCount() const { return 1u << m_indexBitCount; }
+		[[nodiscard]] int32_t getEndpointValue(uint32_t endpointIdx, uint32_t channelIdx) const
+		{
+			const uint32_t quantized = m_quantized[endpointIdx][channelIdx];
+			switch (m_quantization)
+			{
+				case BC7Quantization::SEVEN_BITS_AND_P_BIT: return static_cast<int32_t>((quantized << 1) | m_pBits[endpointIdx]);
+				case BC7Quantization::SEVEN_BITS: return static_cast<int32_t>((quantized << 1) | (quantized >> 6));
+				default: return static_cast<int32_t>(quantized);
+			}
+		}
+		[[nodiscard]] int32_t interpolate(uint32_t index, uint32_t channelIdx) const
+		{
+			return ((64 - m_weights[index]) * getEndpointValue(0, channelIdx) + m_weights[index] * getEndpointValue(1, channelIdx) + 32) >> 6;
+		}
+	};
+
+	using BC7Pixels = int32_t[BlockEncoder::BLOCK_PIXEL_COUNT][BC7_CHANNEL_COUNT];
+
+	void quantizeBC7Endpoint(const float endpoint[BC7_CHANNEL_COUNT], uint32_t endpointIdx, BC7Line& line)
+	{
+		if (line.m_quantization == BC7Quantization::SEVEN_BITS_AND_P_BIT)
+		{
+			// Both p-bits are tried, the one giving the closest 8 bits values is kept
+			float bestError = std::numeric_limits<float>::max();
+			for (uint32_t pBit = 0; pBit < 2; ++pBit)
+			{
+				uint32_t quantized[BC7_CHANNEL_COUNT];
+				float error = 0.0f;
+				for (uint32_t channelIdx = line.m_firstChannel; channelIdx < line.m_firstChannel + line.m_channelCount; ++channelIdx)
+				{
+					quantized[channelIdx] = static_cast<uint32_t>(std::clamp(std::lround((endpoint[channelIdx] - static_cast<float>(pBit)) * 0.5f), 0l, 127l));
+					const float difference = static_cast<float>((quantized[channelIdx] << 1) | pBit) - endpoint[channelIdx];
+					error += difference * difference;
+				}
+
+				if (error < bestError)
+				{
+					bestError = error;
+					for (uint32_t channelIdx = line.m_firstChannel; channelIdx < line.m_firstChannel + line.m_channelCount; ++channelIdx)
+						line.m_quantized[endpointIdx][channelIdx] = quantized[channelIdx];
+					line.m_pBits[endpointIdx] = pBit;
+				}
+			}
+			return;
+		}
+
+		const float maxQuantized = line.m_quantization == BC7Quantization::SEVEN_BITS ? 127.0f : 255.0f;
+		for (uint32_t channelIdx = line.m_firstChannel; channelIdx < line.m_firstChannel + line.m_channelCount; ++channelIdx)
+		{
+			line.m_quantized[endpointIdx][channelIdx] = static_cast<uint32_t>(std::lround(endpoint[channelIdx] / 255.0f * maxQuantized));
+		}
+	}
+
+	void evaluateBC7Line(const BC7Pixels& pixels, const float endpoint0[BC7_CHANNEL_COUNT], const float endpoint1[BC7_CHANNEL_COUNT], BC7Line& line)
+	{
+		quantizeBC7Endpoint(endpoint0, 0, line);
+		quantizeBC7Endpoint(endpoint1, 1, line);
+
+		int32_t palette[16][BC7_CHANNEL_COUNT];
+		for (uint32_t index = 0; index < line.getWeightCount(); ++index)
+		{
+			for (uint32_t channelIdx = line.m_firstChannel; channelIdx < line.m_firstChannel + line.m_channelCount; ++channelIdx)
+				palette[index][channelIdx] = line.interpolate(index, channelIdx);
+		}
+
+		line.m_error = 0;
+		for (uint32_t i = 0; i < BlockEncoder::BLOCK_PIXEL_COUNT; ++i)
+		{
+			int32_t bestDistance = INT32_MAX;
+			for (uint32_t index = 0; index < line.getWeightCount(); ++index)
+			{
+				int32_t distance = 0;
+				for (uint32_t channelIdx = line.m_firstChannel; channelIdx < line.m_firstChannel + line.m_channelCount; ++channelIdx)
+				{
+					const int32_t difference = pixels[i][channelIdx] - palette[index][channelIdx];
+					distance += difference * difference;
+				}
+				if (distance < bestDistance)
+				{
+					bestDistance = distance;
+					line.m_indices[i] = index;
+				}
+			}
+			line.m_error += bestDistance;
+		}
+	}
+
+	// Extremes of the pixels along the principal axis of the line channels
+	void fitBC7Endpoints(const BC7Pixels& pixels, const BC7Line& line, float outEndpoint0[BC7_CHANNEL_COUNT], float outEndpoint1[BC7_CHANNEL_COUNT])
+	{
+		const uint32_t firstChannel = line.m_firstChannel;
+		const uint32_t lastChannel = line.m_firstChannel + line.m_channelCount;
+
+		float mean[BC7_CHANNEL_COUNT] = {};
+		for (uint32_t i = 0; i < BlockEncoder::BLOCK_PIXEL_COUNT; ++i)
+		{
+			for (uint32_t channelIdx = firstChannel; channelIdx < lastChannel; ++channelIdx)
+				mean[channelIdx] += static_cast<float>(pixels[i][channelIdx]) / static_cast<float>(BlockEncoder::BLOCK_PIXEL_COUNT);
+		}
+
+		float covariance[BC7_CHANNEL_COUNT][BC7_CHANNEL_COUNT] = {};
+		for (uint32_t i = 0; i < BlockEncoder::BLOCK_PIXEL_COUNT; ++i)
+		{
+			for (uint32_t row = firstChannel; row < lastChannel; ++row)
+			{
+				for (uint32_t column = firstChannel; column < lastChannel; ++column)
+					covariance[row][column] += (static_cast<float>(pixels[i][row]) - mean[row]) * (static_cast<float>(pixels[i][column]) - mean[column]);
+			}
+		}
+
+		uint32_t startColumn = firstChannel;
+		for (uint32_t i = firstChannel + 1; i < lastChannel; ++i)
+		{
+			if (covariance[i][i] > covariance[startColumn][startColumn])
+				startColumn = i;
+		}
+
+		float axis[BC7_CHANNEL_COUNT] = {};
+		if (covariance[startColumn][startColumn] > 0.0f)
+		{
+			for (uint32_t i = firstChannel; i < lastChannel; ++i)
+				axis[i] = covariance[i][startColumn];
+
+			constexpr uint32_t POWER_ITERATION_COUNT = 8;
+			for (uint32_t iteration = 0; iteration < POWER_ITERATION_COUNT; ++iteration)
+			{
+				float newAxis[BC7_CHANNEL_COUNT] = {};
+				float maxComponent = 0.0f;
+				for (uint32_t row = firstChannel; row < lastChannel; ++row)
+				{
+					for (uint32_t column = firstChannel; column < lastChannel; ++column)
+						newAxis[row] += covariance[row][column] * axis[column];
+					maxComponent = std::max(maxComponent, std::abs(newAxis[row]));
+				}
+				if (maxComponent == 0.0f)
+					break;
+				for (uint32_t i = firstChannel; i < lastChannel; ++i)
+					axis[i] = newAxis[i] / maxComponent;
+			}
+
+			float length = 0.0f;
+			for (uint32_t i = firstChannel; i < lastChannel; ++i)
+				length += axis[i] * axis[i];
+			length = std::sqrt(length);
+			for (uint32_t i = firstChannel; i < lastChannel; ++i)
+				axis[i] /= length;
+		}
+
+		float minProjection = 0.0f, maxProjection = 0.0f;
+		for (uint32_t i = 0; i < BlockEncoder::BLOCK_PIXEL_COUNT; ++i)
+		{
+			float projection = 0.0f;
+			for (uint32_t channelIdx = firstChannel; channelIdx < lastChannel; ++channelIdx)
+				projection += (static_cast<float>(pixels[i][channelIdx]) - mean[channelIdx]) * axis[channelIdx];
+			minProjection = std::min(minProjection, projection);
+			maxProjection = std::max(maxProjection, projection);
+		}
+
+		for (uint32_t channelIdx = firstChannel; channelIdx < lastChannel; ++channelIdx)
+		{
+			outEndpoint0[channelIdx] = std::clamp(mean[channelIdx] + axis[channelIdx] * minProjection, 0.0f, 255.0f);
+			outEndpoint1[channelIdx] = std::clamp(mean[channelIdx] + axis[channelIdx] * maxProjection, 0.0f, 255.0f);
+		}
+	}
+
+	// Least squares endpoints for the weights given by the indices, returns false when all pixels use the same weight
+	bool refineBC7Endpoints(const BC7Pixels& pixels, const BC7Line& line, float outEndpoint0[BC7_CHANNEL_COUNT], float outEndpoint1[BC7_CHANNEL_COUNT])
+	{
+		float a = 0.0f, b = 0.0f, c = 0.0f;
+		float x0[BC7_CHANNEL_COUNT] = {}, x1[BC7_CHANNEL_COUNT] = {};
+		for (uint32_t i = 0; i < BlockEncoder::BLOCK_PIXEL_COUNT; ++i)
+		{
+			const float weight = static_cast<float>(line.m_weights[line.m_indices[i]]) / 64.0f;
+			a += (1.0f - weight) * (1.0f - weight);
+			b += (1.0f - weight) * weight;
+			c += weight * weight;
+			for (uint32_t channelIdx = line.m_firstChannel; channelIdx < line.m_firstChannel + line.m_channelCount; ++channelIdx)
+			{
+				x0[channelIdx] += (1.0f - weight) * static_cast<float>(pixels[i][channelIdx]);
+				x1[channelIdx] += weight * static_cast<float>(pixels[i][channelIdx]);
+			}
+		}
+
+		const float determinant = a * c - b * b;
+		if (std::abs(determinant) < 1e-6f)
+			return false;
+
+		for (uint32_t channelIdx = line.m_firstChannel; channelIdx < line.m_firstChannel + line.m_channelCount; ++channelIdx)
+		{
+			outEndpoint0[channelIdx] = std::clamp((c * x0[channelIdx] - b * x1[channelIdx]) / determinant, 0.0f, 255.0f);
+			outEndpoint1[channelIdx] = std::clamp((a * x1[channelIdx] - b * x0[channelIdx]) / determinant, 0.0f, 255.0f);
+		}
+		return true;
+	}
+
+	void encodeBC7Line(const BC7Pixels& pixels, BC7Line& line)
+	{
+		float endpoint0[BC7_CHANNEL_COUNT] = {}, endpoint1[BC7_CHANNEL_COUNT] = {};
+		fitBC7Endpoints(pixels, line, endpoint0, endpoint1);
+		evaluateBC7Line(pixels, endpoint0, endpoint1, line);
+
+		for (uint32_t refinementIdx = 0; refinementIdx < BC7_REFINEMENT_COUNT && line.m_error > 0; ++refinementIdx)
+		{
+			if (!refineBC7Endpoints(pixels, line, endpoint0, endpoint1))
+				break;
+
+			BC7Line refinedLine = line;
+			evaluateBC7Line(pixels, endpoint0, endpoint1, refinedLine);
+			if (refinedLine.m_error >= line.m_error)
+				break;
+			line = refinedLine;
+		}
+
+		// Highest bit of the first index is implicit (0): endpoints are swapped if needed
+		const uint32_t maxIndex = line.getWeightCount() - 1;
+		if (line.m_indices[0] > maxIndex / 2)
+		{
+			std::swap(line.m_quantized[0], line.m_quantized[1]);
+			std::swap(line.m_pBits[0], line.m_pBits[1]);
+			for (uint32_t& index : line.m_indices)
+				index = maxIndex - index;
+		}
+	}
+
+	void writeBC7Indices(BC7BitWriter& bitWriter, const BC7Line& line)
+	{
+		bitWriter.write(line.m_indices[0], line.m_indexBitCount - 1);
+		for (uint32_t i = 1; i < BlockEncoder::BLOCK_PIXEL_COUNT; ++i)
+		{
+			bitWriter.write(line.m_indices[i], line.m_indexBitCount);
+		}
+	}
+
+	void readBC7Indices(BC7BitReader& bitReader, BC7Line& line)
+	{
+		line.m_indices[0] = bitReader.read(line.m_indexBitCount - 1);
+		for (uint32_t i = 1; i < BlockEncoder::BLOCK_PIXEL_COUNT; ++i)
+		{
+			line.m_indices[i] = bitReader.read(line.m_indexBitCount);
+		}
+	}
+
+	BC7Line createBC7Mode6Line() { return BC7Line(0, 4, BC7Quantization::SEVEN_BITS_AND_P_BIT, BC7_WEIGHTS_4_BITS, 4); }
+	BC7Line createBC7Mode5ColorLine() { return BC7Line(0, 3, BC7Quantization::SEVEN_BITS, BC7_WEIGHTS_2_BITS, 2); }
+	BC7Line createBC7Mode5AlphaLine() { return BC7Line(3, 1, BC7Quantization::EIGHT_BITS, BC7_WEIGHTS_2_BITS, 2); }
+
+	// Rotation 1, 2 and 3 swap alpha with red, green and blue, the decoder swaps them back
+	void rotateBC7Pixels(BC7Pixels& pixels, uint32_t rotation)
+	{
+		if (rotation == 0)
+			return;
+		for (int32_t (&pixel)[BC7_CHANNEL_COUNT] : pixels)
+			std::swap(pixel[rotation - 1], pixel[3]);
+	}
+}
+
+BlockEncoder::InstructionSet BlockEncoder::getSupportedInstructionSet()
+{
+	static const InstructionSet supportedInstructionSet = []()
+	{
+#ifdef BLOCK_ENCODER_X86
+#if defined(_MSC_VER)
+		int cpuInfo[4];
+		__cpuid(cpuInfo, 0);
+		const int maxLeaf = cpuInfo[0];
+
+		__cpuid(cpuInfo, 1);
+		const bool hasSSE41 = (cpuInfo[2] & (1 << 19)) != 0;
+		const bool hasOSXSAVE = (cpuInfo[2] & (1 << 27)) != 0;
+		const bool hasAVX = (cpuInfo[2] & (1 << 28)) != 0;
+
+		bool hasAVX2 = false;
+		if (maxLeaf >= 7 && hasOSXSAVE && hasAVX && (_xgetbv(0) & 0x6) == 0x6) // OS saves YMM registers
+		{
+			__cpuidex(cpuInfo, 7, 0);
+			hasAVX2 = (cpuInfo[1] & (1 << 5)) != 0;
+		}
+#else
+		__builtin_cpu_init();
+		const bool hasSSE41 = __builtin_cpu_supports("sse4.1");
+		const bool hasAVX2 = __builtin_cpu_supports("avx2");
+#endif
+		if (hasAVX2)
+			return InstructionSet::AVX2;
+		if (hasSSE41)
+			return InstructionSet::SSE41;
+#endif
+		return InstructionSet::SCALAR;
+	}();
+
+	return supportedInstructionSet;
+}
+
+void BlockEncoder::encodeBC1(const Wolf::ImageCompression::RGBA8* pixels, uint8_t* outBlock, InstructionSet instructionSet)
+{
+	encodeColorBlock(pixels, outBlock, getKernels(instructionSet));
+}
+
+void BlockEncoder::encodeBC3(const Wolf::ImageCompression::RGBA8* pixels, uint8_t* outBlock, InstructionSet instructionSet)
+{
+	const Kernels& kernels = getKernels(instructionSet);
+
+	uint8_t alphaValues[BLOCK_PIXEL_COUNT];
+	for (uint32_t i = 0; i < BLOCK_PIXEL_COUNT; ++i)
+	{
+		alphaValues[i] = pixels[i].a;
+	}
+
+	// Alpha block then colour block
+	encodeSingleChannelBlock(alphaValues, outBlock, kernels);
+	encodeColorBlock(pixels, outBlock + 8, kernels);
+}
+
+void BlockEncoder::encodeBC4(const uint8_t* values, uint8_t* outBlock, InstructionSet instructionSet)
+{
+	encodeSingleChannelBlock(values, outBlock, getKernels(instructionSet));
+}
+
+void BlockEncoder::encodeBC5(const uint8_t* redValues, const uint8_t* greenValues, uint8_t* outBlock, InstructionSet instructionSet)
+{
+	const Kernels& kernels = getKernels(instructionSet);
+	encodeSingleChannelBlock(redValues, outBlock, kernels);
+	encodeSingleChannelBlock(greenValues, outBlock + 8, kernels);
+}
+
+void BlockEncoder::encodeBC7(const Wolf::ImageCompression::RGBA8* pixels, uint8_t* outBlock)
+{
+	BC7Pixels blockPixels;
+	for (uint32_t i = 0; i < BLOCK_PIXEL_COUNT; ++i)
+	{
+		blockPixels[i][0] = pixels[i].r;
+		blockPixels[i][1] = pixels[i].g;
+		blockPixels[i][2] = pixels[i].b;
+		blockPixels[i][3] = pixels[i].a;
+	}
+
+	// Mode 6 suits correlated channels, mode 5 encodes one channel apart (alpha, or a packed map channel after rotation)
+	BC7Line mode6Line = createBC7Mode6Line();
+	encodeBC7Line(blockPixels, mode6Line);
+
+	uint32_t bestRotation = 0;
+	BC7Line bestMode5ColorLine = createBC7Mode5ColorLine();
+	BC7Line bestMode5AlphaLine = createBC7Mode5AlphaLine();
+	int64_t bestMode5Error = INT64_MAX;
+	for (uint32_t rotation = 0; rotation < 4 && mode6Line.m_error > 0; ++rotation)
+	{
+		BC7Pixels rotatedPixels;
+		std::memcpy(rotatedPixels, blockPixels, sizeof(BC7Pixels));
+		rotateBC7Pixels(rotatedPixels, rotation);
+
+		BC7Line colorLine = createBC7Mode5ColorLine();
+		BC7Line alphaLine = createBC7Mode5AlphaLine();
+		encodeBC7Line(rotatedPixels, colorLine);
+		encodeBC7Line(rotatedPixels, alphaLine);
+
+		const int64_t error = static_cast<int64_t>(colorLine.m_error) + alphaLine.m_error;
+		if (error < bestMode5Error)
+		{
+			bestMode5Error = error;
+			bestRotation = rotation;
+			bestMode5ColorLine = colorLine;
+			bestMode5AlphaLine = alphaLine;
+		}
+	}
+
+	BC7BitWriter bitWriter(outBlock);
+	if (mode6Line.m_error <= bestMode5Error)
+	{
+		bitWriter.write(1 << 6, 7);
+		for (uint32_t channelIdx = 0; channelIdx < BC7_CHANNEL_COUNT; ++channelIdx)
+		{
+			bitWriter.write(mode6Line.m_quantized[0][channelIdx], 7);
+			bitWriter.write(mode6Line.m_quantized[1][channelIdx], 7);
+		}
+		bitWriter.write(mode6Line.m_pBits[0], 1);
+		bitWriter.write(mode6Line.m_pBits[1], 1);
+		writeBC7Indices(bitWriter, mode6Line);
+	}
+	else
+	{
+		bitWriter.write(1 << 5, 6);
+		bitWriter.write(bestRotation, 2);
+		for (uint32_t channelIdx = 0; channelIdx < 3; ++channelIdx)
+		{
+			bitWriter.write(bestMode5ColorLine.m_quantized[0][channelIdx], 7);
+			bitWriter.write(bestMode5ColorLine.m_quantized[1][channelIdx], 7);
+		}
+		bitWriter.write(bestMode5AlphaLine.m_quantized[0][3], 8);
+		bitWriter.write(bestMode5AlphaLine.m_quantized[1][3], 8);
+		writeBC7Indices(bitWriter, bestMode5ColorLine);
+		writeBC7Indices(bitWriter, bestMode5AlphaLine);
+	}
+}
+
+void BlockEncoder::decodeBC4(const uint8_t* block, uint8_t* outValues)
+{
+	decodeSingleChannelBlock(block, outValues);
+}
+
+bool BlockEncoder::decodeBC7(const uint8_t* block, Wolf::ImageCompression::RGBA8* outPixels)
+{
+	BC7BitReader bitReader(block);
+	uint32_t mode = 0;
+	while (mode < 8 && bitReader.read(1) == 0)
+		mode++;
+
+	BC7Pixels blockPixels;
+	if (mode == 6)
+	{
+		BC7Line line = createBC7Mode6Line();
+		for (uint32_t channelIdx = 0; channelIdx < BC7_CHANNEL_COUNT; ++channelIdx)
+		{
+			line.m_quantized[0][channelIdx] = bitReader.read(7);
+			line.m_quantized[1][channelIdx] = bitReader.read(7);
+		}
+		line.m_pBits[0] = bitReader.read(1);
+		line.m_pBits[1] = bitReader.read(1);
+		readBC7Indices(bitReader, line);
+
+		for (uint32_t i = 0; i < BLOCK_PIXEL_COUNT; ++i)
+		{
+			for (uint32_t channelIdx = 0; channelIdx < BC7_CHANNEL_COUNT; ++channelIdx)
+				blockPixels[i][channelIdx] = line.interpolate(line.m_indices[i], channelIdx);
+		}
+	}
+	else if (mode == 5)
+	{
+		const uint32_t rotation = bitReader.read(2);
+		BC7Line colorLine = createBC7Mode5ColorLine();
+		BC7Line alphaLine = createBC7Mode5AlphaLine();
+		for (uint32_t channelIdx = 0; channelIdx < 3; ++channelIdx)
+		{
+			colorLine.m_quantized[0][channelIdx] = bitReader.read(7);
+			colorLine.m_quantized[1][channelIdx] = bitReader.read(7);
+		}
+		alphaLine.m_quantized[0][3] = bitReader.read(8);
+		alphaLine.m_quantized[1][3] = bitReader.read(8);
+		readBC7Indices(bitReader, colorLine);
+		readBC7Indices(bitReader, alphaLine);
+
+		for (uint32_t i = 0; i < BLOCK_PIXEL_COUNT; ++i)
+		{
+			for (uint32_t channelIdx = 0; channelIdx < 3; ++channelIdx)
+				blockPixels[i][channelIdx] = colorLine.interpolate(colorLine.m_indices[i], channelIdx);
+			blockPixels[i][3] = alphaLine.interpolate(alphaLine.m_indices[i], 3);
+		}
+		rotateBC7Pixels(blockPixels, rotation);
+	}
+	else
+	{
+		return false;
+	}
+
+	for (uint32_t i = 0; i < BLOCK_PIXEL_COUNT; ++i)
+	{
+		outPixels[i] = { static_cast<uint8_t>(blockPixels[i][0]), static_cast<uint8_t>(blockPixels[i][1]), static_cast<uint8_t>(blockPixels[i][2]), static_cast<uint8_t>(blockPixels[i][3]) };
+	}
+	return true;
+}
+
+void BlockEncoder::compress(const Wolf::Extent3D& extent, const std::vector<Wolf::ImageCompression::RGBA8>& pixels, std::vector<Wolf::ImageCompression::BC1>& outBlocks)
+{
+	if (s_backend == Backend::ENGINE)
+	{
+		Wolf::ImageCompression::compress(extent, pixels, outBlocks);
+		return;
+	}
+	if (s_backend == Backend::COMPARE_WITH_ENGINE)
+		logComparisonWithEngineEncoder(extent, pixels, Wolf::ImageCompression::Compression::BC1);
+
+	const InstructionSet instructionSet = getSupportedInstructionSet();
+	compressBlocks(extent, pixels, outBlocks, [instructionSet](const Wolf::ImageCompression::RGBA8* blockPixels, uint8_t* outBlock)
+		{
+			encodeBC1(blockPixels, outBlock, instructionSet);
+		});
+}
+
+void BlockEncoder::compress(const Wolf::Extent3D& extent, const std::vector<Wolf::ImageCompression::RGBA8>& pixels, std::vector<Wolf::ImageCompression::BC3>& outBlocks)
+{
+	if (s_backend == Backend::ENGINE)
+	{
+		Wolf::ImageCompression::compress(extent, pixels, outBlocks);
+		return;
+	}
+	if (s_backend == Backend::COMPARE_WITH_ENGINE)
+		logComparisonWithEngineEncoder(extent, pixels, Wolf::ImageCompression::Compression::BC3);
+
+	const InstructionSet instructionSet = getSupportedInstructionSet();
+	compressBlocks(extent, pixels, outBlocks, [instructionSet](const Wolf::ImageCompression::RGBA8* blockPixels, uint8_t* outBlock)
+		{
+			encodeBC3(blockPixels, outBlock, instructionSet);
+		});
+}
+
+void BlockEncoder::compress(const Wolf::Extent3D& extent, const std::vector<Wolf::ImageCompression::RG32F>& pixels, std::vector<Wolf::ImageCompression::BC5>& outBlocks)
+{
+	if (s_backend == Backend::ENGINE)
+	{
+		Wolf::ImageCompression::compress(extent, pixels, outBlocks);
+		return;
+	}
+
+	const InstructionSet instructionSet = getSupportedInstructionSet();
+	compressBlocks(extent, pixels, outBlocks, [instructionSet](const Wolf::ImageCompression::RG32F* blockPixels, uint8_t* outBlock)
+		{
+			uint8_t redValues[BLOCK_PIXEL_COUNT];
+			uint8_t greenValues[BLOCK_PIXEL_COUNT];
+			for (uint32_t i = 0; i < BLOCK_PIXEL_COUNT; ++i)
+			{
+				const float* components = reinterpret_cast<const float*>(&blockPixels[i]);
+				redValues[i] = signedNormalToUNorm8(components[0]);
+				greenValues[i] = signedNormalToUNorm8(components[1]);
+			}
+			encodeBC5(redValues, greenValues, outBlock, instructionSet);
+		});
+}
+
+void BlockEncoder::compress(const Wolf::Extent3D& extent, const std::vector<Wolf::ImageCompression::RGBA8>& pixels, std::vector<BC4>& outBlocks)
+{
+	const InstructionSet instructionSet = getSupportedInstructionSet();
+	compressBlocks(extent, pixels, outBlocks, [instructionSet](const Wolf::ImageCompression::RGBA8* blockPixels, uint8_t* outBlock)
+		{
+			uint8_t redValues[BLOCK_PIXEL_COUNT];
+			for (uint32_t i = 0; i < BLOCK_PIXEL_COUNT; ++i)
+			{
+				redValues[i] = blockPixels[i].r;
+			}
+			encodeBC4(redValues, outBlock, instructionSet);
+		});
+}
+
+void BlockEncoder::compress(const Wolf::Extent3D& extent, const std::vector<Wolf::ImageCompression::RGBA8>& pixels, std::vector<BC7>& outBlocks)
+{
+	compressBlocks(extent, pixels, outBlocks, [](const Wolf::ImageCompression::RGBA8* blockPixels, uint8_t* outBlock)
+		{
+			encodeBC7(blockPixels, outBlock);
+		});
+}
+
+void BlockEncoder::uncompress(const Wolf::Extent3D& extent, const BC4* blocks, std::vector<Wolf::ImageCompression::RGBA8>& outPixels)
+{
+	uncompressBlocks(extent, blocks, outPixels, [](const uint8_t* block, Wolf::ImageCompression::RGBA8* outBlockPixels)
+		{
+			uint8_t values[BLOCK_PIXEL_COUNT];
+			decodeBC4(block, values);
+			for (uint32_t i = 0; i < BLOCK_PIXEL_COUNT; ++i)
+			{
+				outBlockPixels[i] = { values[i], values[i], values[i], 255 };
+			}
+		});
+}
+
+void BlockEncoder::uncompress(const Wolf::Extent3D& extent, const BC7* blocks, std::vector<Wolf::ImageCompression::RGBA8>& outPixels)
+{
+	uncompressBlocks(extent, blocks, outPixels, [](const uint8_t* block, Wolf::ImageCompression::RGBA8* outBlockPixels)
+		{
+			if (!decodeBC7(block, outBlockPixels))
+			{
+				std::fill(outBlockPixels, outBlockPixels + BLOCK_PIXEL_COUNT, Wolf::ImageCompression::RGBA8{ 0, 0, 0, 255 });
+			}
+		});
+}
+
+float BlockEncoder::computePSNR(const std::vector<Wolf::ImageCompression::RGBA8>& reference, const std::vector<Wolf::ImageCompression::RGBA8>& compared, uint32_t channelCount)
+{
+	if (reference.size() != compared.size() || reference.empty() || channelCount == 0 || channelCount > 4)
+	{
+		Wolf::Debug::sendError("PSNR requires two non empty images of the same size and 1 to 4 channels");
+		return 0.0f;
+	}
+
+	double squaredErrorSum = 0.0;
+	for (size_t i = 0; i < reference.size(); ++i)
+	{
+		const uint8_t referenceChannels[4] = { reference[i].r, reference[i].g, reference[i].b, reference[i].a };
+		const uint8_t comparedChannels[4] = { compared[i].r, compared[i].g, compared[i].b, compared[i].a };
+		for (uint32_t channel = 0; channel < channelCount; ++channel)
+		{
+			const double difference = static_cast<double>(referenceChannels[channel]) - static_cast<double>(comparedChannels[channel]);
+			squaredErrorSum += difference * difference;
+		}
+	}
+
+	if (squaredErrorSum == 0.0)
+		return std::numeric_limits<float>::infinity();
+
+	const double meanSquaredError = squaredErrorSum / (static_cast<double>(reference.size()) * channelCount);
+	return static_cast<float>(10.0 * std::log10(255.0 * 255.0 / meanSquaredError));
+}
+
+BlockEncoder::EncoderComparison BlockEncoder::compareWithEngineEncoder(const Wolf::Extent3D& extent, const std::vector<Wolf::ImageCompression::RGBA8>& pixels, Wolf::ImageCompression::Compression compression)
+{
+	if (compression != Wolf::ImageCompression::Compression::BC1 && compression != Wolf::ImageCompression::Compression::BC3)
+	{
+		Wolf::Debug::sendError("Only BC1 and BC3 can be compared with the engine encoder");
+		return { 0.0f, 0.0f };
+	}
+
+	std::vector<Wolf::ImageCompression::RGBA8> editorDecodedPixels;
+	std::vector<Wolf::ImageCompression::RGBA8> engineDecodedPixels;
+	const InstructionSet instructionSet = getSupportedInstructionSet();
+	auto compressAndDecode = [&]<typename CompressionType>(std::vector<CompressionType>& blocks)
+		{
+			compressBlocks(extent, pixels, blocks, [instructionSet](const Wolf::ImageCompression::RGBA8* blockPixels, uint8_t* outBlock)
+				{
+					if constexpr (std::is_same_v<CompressionType, Wolf::ImageCompression::BC1>)
+						encodeBC1(blockPixels, outBlock, instructionSet);
+					else
+						encodeBC3(blockPixels, outBlock, instructionSet);
+				});
+			Wolf::ImageCompression::uncompressImage(compression, reinterpret_cast<const uint8_t*>(blocks.data()), { extent.width, extent.height }, editorDecodedPixels);
+
+			blocks.clear();
+			Wolf::ImageCompression::compress(extent, pixels, blocks);
+			Wolf::ImageCompression::uncompressImage(compression, reinterpret_cast<const uint8_t*>(blocks.data()), { extent.width, extent.height }, engineDecodedPixels);
+		};
+	if (compression == Wolf::ImageCompression::Compression::BC1)
+	{
+		std::vector<Wolf::ImageCompression::BC1> blocks;
+		compressAndDecode(blocks);
+	}
+	else
+	{
+		std::vector<Wolf::ImageCompression::BC3> blocks;
+		compressAndDecode(blocks);
+	}
+
+	const uint32_t channelCount = compression == Wolf::ImageCompression::Compression::BC1 ? 3 : 4;
+	return { computePSNR(pixels, editorDecodedPixels, channelCount), computePSNR(pixels, engineDecodedPixels, channelCount) };
+}
+
+void BlockEncoder::logComparisonWithEngineEncoder(const Wolf::Extent3D& extent, const std::vector<Wolf::ImageCompression::RGBA8>& pixels, Wolf::ImageCompression::Compression compression)
+{
+	const EncoderComparison comparison = compareWithEngineEncoder(extent, pixels, compression);
+	Wolf::Debug::sendInfo(std::string(compression == Wolf::ImageCompression::Compression::BC1 ? "BC1" : "BC3") + " " + std::to_string(extent.width) + "x" + std::to_string(extent.height) +
+		" PSNR: editor " + std::to_string(comparison.m_editorPSNR) + " dB, engine " + std::to_string(comparison.m_enginePSNR) + " dB");
+}
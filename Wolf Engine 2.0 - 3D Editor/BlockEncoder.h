@@ -0,0 +1,147 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include <Debug.h>
+#include <Extents.h>
+#include <ImageCompression.h>
+
+// BC1, BC3, BC4, BC5 and BC7 block encoders used by the editor when importing textures.
+// The scalar path is the reference: SIMD paths run the same integer arithmetic on 4 (SSE4.1) or 8 (AVX2) pixels at once and produce identical blocks.
+// Endpoints come from the principal axis of the block colours (colour line), indices are assigned to the nearest palette entry.
+// Wolf::ImageCompression::compress stays available for BC1, BC3 and BC5 as the quality reference, see Backend.
+class BlockEncoder
+{
+public:
+	enum class InstructionSet { SCALAR, SSE41, AVX2 };
+	static InstructionSet getSupportedInstructionSet(); // detected once, at first call
+
+	// Which encoder compresses BC1, BC3 and BC5 levels, BC4 and BC7 are always encoded by the editor as the engine doesn't support them.
+	// COMPARE_WITH_ENGINE keeps the editor output and logs the PSNR of both encoders for each RGBA8 level (BC1 and BC3)
+	enum class Backend { EDITOR, ENGINE, COMPARE_WITH_ENGINE };
+	static void setBackend(Backend backend) { s_backend = backend; }
+	[[nodiscard]] static Backend getBackend() { return s_backend; }
+
+	static constexpr uint32_t BLOCK_PIXEL_COUNT = 16;
+
+	// Formats the engine doesn't compress
+	struct BC4
+	{
+		uint8_t m_data[8];
+	};
+	struct BC7
+	{
+		uint8_t m_data[16];
+	};
+
+	// 'pixels' are the 16 pixels of a 4x4 block in row order
+	static void encodeBC1(const Wolf::ImageCompression::RGBA8* pixels, uint8_t* outBlock, InstructionSet instructionSet);
+	static void encodeBC3(const Wolf::ImageCompression::RGBA8* pixels, uint8_t* outBlock, InstructionSet instructionSet);
+	static void encodeBC4(const uint8_t* values, uint8_t* outBlock, InstructionSet instructionSet);
+	static void encodeBC5(const uint8_t* redValues, const uint8_t* greenValues, uint8_t* outBlock, InstructionSet instructionSet);
+	// Modes 5 (separate alpha, or any channel through rotation) and 6 (single RGBA line), the one with the lowest error is kept. Scalar
+	static void encodeBC7(const Wolf::ImageCompression::RGBA8* pixels, uint8_t* outBlock);
+
+	static void decodeBC4(const uint8_t* block, uint8_t* outValues);
+	static bool decodeBC7(const uint8_t* block, Wolf::ImageCompression::RGBA8* outPixels); // returns false for modes other than 5 and 6
+
+	// Image level, blocks are stored row after row as Wolf::ImageCompression::compress does. Images with a size not multiple of 4 are left to the engine (not supported for BC4 and BC7)
+	static void compress(const Wolf::Extent3D& extent, const std::vector<Wolf::ImageCompression::RGBA8>& pixels, std::vector<Wolf::ImageCompression::BC1>& outBlocks);
+	static void compress(const Wolf::Extent3D& extent, const std::vector<Wolf::ImageCompression::RGBA8>& pixels, std::vector<Wolf::ImageCompression::BC3>& outBlocks);
+	static void compress(const Wolf::Extent3D& extent, const std::vector<Wolf::ImageCompression::RG32F>& pixels, std::vector<Wolf::ImageCompression::BC5>& outBlocks); // normals in [-1, 1]
+	static void compress(const Wolf::Extent3D& extent, const std::vector<Wolf::ImageCompression::RGBA8>& pixels, std::vector<BC4>& outBlocks); // red channel
+	static void compress(const Wolf::Extent3D& extent, const std::vector<Wolf::ImageCompression::RGBA8>& pixels, std::vector<BC7>& outBlocks);
+
+	// Red channel is replicated to green and blue for BC4. Blocks which can't be decoded are left black
+	static void uncompress(const Wolf::Extent3D& extent, const BC4* blocks, std::vector<Wolf::ImageCompression::RGBA8>& outPixels);
+	static void uncompress(const Wolf::Extent3D& extent, const BC7* blocks, std::vector<Wolf::ImageCompression::RGBA8>& outPixels);
+
+	// Peak signal to noise ratio in dB over the first 'channelCount' channels, infinity when both images are identical
+	[[nodiscard]] static float computePSNR(const std::vector<Wolf::ImageCompression::RGBA8>& reference, const std::vector<Wolf::ImageCompression::RGBA8>& compared, uint32_t channelCount);
+
+	// Both encoders compress 'pixels', both outputs are decoded by the engine and compared to the source. Alpha is ignored for BC1
+	struct EncoderComparison
+	{
+		float m_editorPSNR;
+		float m_enginePSNR;
+	};
+	[[nodiscard]] static EncoderComparison compareWithEngineEncoder(const Wolf::Extent3D& extent, const std::vector<Wolf::ImageCompression::RGBA8>& pixels, Wolf::ImageCompression::Compression compression);
+
+	// Other pixel/block combinations are compressed by the engine
+	template <typename PixelType, typename CompressionType>
+	static void compress(const Wolf::Extent3D& extent, const std::vector<PixelType>& pixels, std::vector<CompressionType>& outBlocks)
+	{
+		Wolf::ImageCompression::compress(extent, pixels, outBlocks);
+	}
+
+private:
+	template <typename PixelType, typename CompressionType, typename EncodeFunction>
+	static void compressBlocks(const Wolf::Extent3D& extent, const std::vector<PixelType>& pixels, std::vector<CompressionType>& outBlocks, EncodeFunction encodeFunction);
+	template <typename CompressionType, typename DecodeFunction>
+	static void uncompressBlocks(const Wolf::Extent3D& extent, const CompressionType* blocks, std::vector<Wolf::ImageCompression::RGBA8>& outPixels, DecodeFunction decodeFunction);
+
+	static void logComparisonWithEngineEncoder(const Wolf::Extent3D& extent, const std::vector<Wolf::ImageCompression::RGBA8>& pixels, Wolf::ImageCompression::Compression compression);
+
+	static inline std::atomic<Backend> s_backend = Backend::EDITOR;
+};
+
+template <typename PixelType, typename CompressionType, typename EncodeFunction>
+void BlockEncoder::compressBlocks(const Wolf::Extent3D& extent, const std::vector<PixelType>& pixels, std::vector<CompressionType>& outBlocks, EncodeFunction encodeFunction)
+{
+	if (extent.width % 4 != 0 || extent.height % 4 != 0)
+	{
+		if constexpr (std::is_same_v<CompressionType, BC4> || std::is_same_v<CompressionType, BC7>)
+		{
+			Wolf::Debug::sendError("BC4 and BC7 compression requires a size multiple of 4");
+			outBlocks.clear();
+		}
+		else
+		{
+			Wolf::ImageCompression::compress(extent, pixels, outBlocks);
+		}
+		return;
+	}
+
+	const uint32_t blockCountX = extent.width / 4;
+	const uint32_t blockCountY = extent.height / 4;
+	outBlocks.resize(static_cast<size_t>(blockCountX) * blockCountY);
+
+	PixelType blockPixels[BLOCK_PIXEL_COUNT];
+	for (uint32_t blockY = 0; blockY < blockCountY; ++blockY)
+	{
+		for (uint32_t blockX = 0; blockX < blockCountX; ++blockX)
+		{
+			for (uint32_t line = 0; line < 4; ++line)
+			{
+				const PixelType* src = &pixels[static_cast<size_t>(blockY * 4 + line) * extent.width + blockX * 4];
+				std::copy(src, src + 4, &blockPixels[line * 4]);
+			}
+			encodeFunction(blockPixels, reinterpret_cast<uint8_t*>(&outBlocks[static_cast<size_t>(blockY) * blockCountX + blockX]));
+		}
+	}
+}
+
+template <typename CompressionType, typename DecodeFunction>
+void BlockEncoder::uncompressBlocks(const Wolf::Extent3D& extent, const CompressionType* blocks, std::vector<Wolf::ImageCompression::RGBA8>& outPixels, DecodeFunction decodeFunction)
+{
+	const uint32_t blockCountX = extent.width / 4;
+	const uint32_t blockCountY = extent.height / 4;
+	outPixels.resize(static_cast<size_t>(extent.width) * extent.height);
+
+	Wolf::ImageCompression::RGBA8 blockPixels[BLOCK_PIXEL_COUNT];
+	for (uint32_t blockY = 0; blockY < blockCountY; ++blockY)
+	{
+		for (uint32_t blockX = 0; blockX < blockCountX; ++blockX)
+		{
+			decodeFunction(reinterpret_cast<const uint8_t*>(&blocks[static_cast<size_t>(blockY) * blockCountX + blockX]), blockPixels);
+			for (uint32_t line = 0; line < 4; ++line)
+			{
+				std::copy(&blockPixels[line * 4], &blockPixels[line * 4] + 4, &outPixels[static_cast<size_t>(blockY * 4 + line) * extent.width + blockX * 4]);
+			}
+		}
+	}
+}
@@ -30,6 +30,9 @@ namespace Wolf
 	constexpr uint64_t HASH_ASSET_PARTICLE_H = 18121159717986459615ULL;
 	constexpr uint64_t HASH_ASSET_TEXTURE_SET_CPP = 17506707702271188376ULL;
 	constexpr uint64_t HASH_ASSET_TEXTURE_SET_H = 9862211112703422035ULL;
+	constexpr uint64_t HASH_BANDED_IMAGE_COMPRESSOR_H = 7742183965021446519ULL;
+	constexpr uint64_t HASH_BLOCK_ENCODER_CPP = 992297421847413323ULL;
+	constexpr uint64_t HASH_BLOCK_ENCODER_H = 10456737362569585377ULL;
 	constexpr uint64_t HASH_CACHE_HELPER_H = 5961641822613078993ULL;
 	constexpr uint64_t HASH_CAMERA_SETTINGS_COMPONENT_CPP = 14621511059729788838ULL;
 	constexpr uint64_t HASH_CAMERA_SETTINGS_COMPONENT_H = 16417486768166897647ULL;
@@ -128,6 +131,8 @@ namespace Wolf
 	constexpr uint64_t HASH_MESH_ASSET_EDITOR_H = 4247861274243940335ULL;
 	constexpr uint64_t HASH_MESH_FORMATTER_CPP = 5294605690325805437ULL;
 	constexpr uint64_t HASH_MESH_FORMATTER_H = 11613825345315008158ULL;
+	constexpr uint64_t HASH_MIP_CHAIN_BUILDER_CPP = 13861734005278114629ULL;
+	constexpr uint64_t HASH_MIP_CHAIN_BUILDER_H = 4180927365521907713ULL;
 	constexpr uint64_t HASH_NOTIFIER_CPP = 9086985695491353793ULL;
 	constexpr uint64_t HASH_NOTIFIER_H = 16517838079190887428ULL;
 	constexpr uint64_t HASH_O_B_J_IMPORTER_CPP = 7635950658507977801ULL;
@@ -160,6 +165,8 @@ namespace Wolf
 	constexpr uint64_t HASH_RENDERING_PIPELINE_H = 11789567121547362172ULL;
 	constexpr uint64_t HASH_RENDERING_PIPELINE_INTERFACE_CPP = 6770691233100445386ULL;
 	constexpr uint64_t HASH_RENDERING_PIPELINE_INTERFACE_H = 11784153733938236659ULL;
+	constexpr uint64_t HASH_SHADER_SNIPPET_CACHE_CPP = 7390519146523180412ULL;
+	constexpr uint64_t HASH_SHADER_SNIPPET_CACHE_H = 12904418329671532056ULL;
 	constexpr uint64_t HASH_SHADOW_MASK_PASS_CASCADED_SHADOW_MAPPING_CPP = 3922500210060426132ULL;
 	constexpr uint64_t HASH_SHADOW_MASK_PASS_CASCADED_SHADOW_MAPPING_H = 11276107665526768672ULL;
 	constexpr uint64_t HASH_SHADOW_MASK_PASS_INTERFACE_CPP = 654134001452790395ULL;
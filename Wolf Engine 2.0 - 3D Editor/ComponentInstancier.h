@@ -31,7 +31,8 @@ public:
 	ComponentInstancier(const Wolf::ResourceNonOwner<Wolf::MaterialsGPUManager>& materialsGPUManager, const Wolf::ResourceNonOwner<RenderingPipelineInterface>& renderingPipeline,
 		const std::function<Wolf::NullableResourceNonOwner<Entity>(const std::string&)>& getEntityFromLoadingPathCallback,const Wolf::ResourceNonOwner<EditorConfiguration>& editorConfiguration,
 		const Wolf::ResourceNonOwner<AssetManager>& assetManager, const Wolf::ResourceNonOwner<Wolf::Physics::PhysicsManager>& physicsManager, const Wolf::ResourceNonOwner<EntityContainer>& entityContainer,
-		const Wolf::ResourceNonOwner<Wolf::BufferPoolInterface>& bufferPoolInterface, const std::function<Entity*(ComponentInterface*, const std::string&)>& createEntityCallback);
+		const Wolf::ResourceNonOwner<Wolf::BufferPoolInterface>& bufferPoolInterface, const std::function<Entity*(ComponentInterface*, const std::string&)>& createEntityCallback,
+		const Wolf::ResourceNonOwner<AnimationSystem>& animationSystem);
 
 	ComponentInterface* instanciateComponent(const std::string& componentId) const;
 
@@ -47,6 +48,7 @@ private:
 	Wolf::ResourceNonOwner<EntityContainer> m_entityContainer;
 	Wolf::ResourceNonOwner<Wolf::BufferPoolInterface> m_bufferPoolInterface;
 	std::function<Entity*(ComponentInterface*, const std::string&)> m_createEntityCallback;
+	Wolf::ResourceNonOwner<AnimationSystem> m_animationSystem;
 
 	struct ComponentInfo
 	{
@@ -127,7 +129,7 @@ private:
 			AnimatedMesh::ID,
 			[this]()
 			{
-				return static_cast<ComponentInterface*>(new AnimatedMesh(m_assetManager, m_renderingPipeline));
+				return static_cast<ComponentInterface*>(new AnimatedMesh(m_assetManager, m_animationSystem));
 			}
 		},
 		ComponentInfo
@@ -3,6 +3,7 @@
 #include <glm/gtc/packing.hpp>
 #include <stb_image_write.h>
 
+#include <Configuration.h>
 #include <DebugMarker.h>
 #include <DescriptorSetGenerator.h>
 #include <ProfilerCommon.h>
@@ -60,6 +61,9 @@ void CompositionPass::initializeResources(const Wolf::InitializationContext& con
     m_uiImage = context.userInterfaceImage;
     updateDescriptorSets();
 
+    m_screenshotReadbackQueue.reset(new AsyncReadbackQueue(Wolf::g_configuration->getMaxCachedFrames(), Wolf::g_configuration->getMaxCachedFrames()));
+    m_screenshotCopyImages.resize(m_screenshotReadbackQueue->getSlotCount());
+
     // Load fullscreen rect
     const std::vector<Vertex2DTextured> vertices =
     {
@@ -111,6 +115,13 @@ void CompositionPass::initializeResources(const Wolf::InitializationContext& con
 
 void CompositionPass::resize(const Wolf::InitializationContext& context)
 {
+    // Device is idle when swap chain is resized, copy images are recreated with the new extent on next screenshot
+    flushPendingScreenshots();
+    for (Wolf::ResourceUniqueOwner<Wolf::Image>& screenshotCopyImage : m_screenshotCopyImages)
+    {
+        screenshotCopyImage.reset(nullptr);
+    }
+
     m_swapChainImages = context.swapChainImages;
     m_uiImage = context.userInterfaceImage;
     updateDescriptorSets();
@@ -121,6 +132,8 @@ void CompositionPass::record(const Wolf::RecordContext& context)
 {
     PROFILE_FUNCTION
 
+    m_screenshotReadbackQueue->processCompletedReadbacks(Wolf::g_runtimeContext->getCurrentCPUFrameNumber());
+
     const GameContext* gameContext = static_cast<const GameContext*>(context.m_gameContext);
     const Wolf::Viewport renderViewport = m_editorParams->getRenderViewport();
 
@@ -155,13 +168,17 @@ void CompositionPass::record(const Wolf::RecordContext& context)
     const uint32_t groupSizeY = context.m_swapchainImage->getExtent().height % dispatchGroups.height != 0 ? context.m_swapchainImage->getExtent().height / dispatchGroups.height + 1 : context.m_swapchainImage->getExtent().height / dispatchGroups.height;
     m_commandBuffer->dispatch(groupSizeX, groupSizeY, dispatchGroups.depth);
 
+    if (m_screenshotRequested)
+    {
+        recordScreenshotCopy(context);
+        m_screenshotRequested = false;
+    }
+
     context.m_swapchainImage->transitionImageLayout(*m_commandBuffer, { Wolf::ImageLayout::PRESENT_SRC_KHR, VK_ACCESS_NONE, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT });
 
     Wolf::DebugMarker::endRegion(m_commandBuffer.get());
 
     m_commandBuffer->endCommandBuffer();
-
-    m_lastSwapChainImage = context.m_swapchainImage;
 }
 
 void CompositionPass::submit(const Wolf::SubmitContext& context)
@@ -198,14 +215,79 @@ void CompositionPass::releaseInputLUT()
     m_updateDescriptorSetRequested = true;
 }
 
-void CompositionPass::saveSwapChainToFile()
+void CompositionPass::flushPendingScreenshots()
 {
-    std::vector<uint8_t> fullImageData;
-    m_lastSwapChainImage->exportToBuffer(fullImageData);
+    if (m_screenshotReadbackQueue)
+        m_screenshotReadbackQueue->processAllReadbacks();
+}
+
+void CompositionPass::recordScreenshotCopy(const Wolf::RecordContext& context)
+{
+    if (context.m_swapchainImage->getFormat() != Wolf::Format::R8G8B8A8_UNORM)
+    {
+        Wolf::Debug::sendWarning("Screenshots are only supported for R8G8B8A8_UNORM swap chain format");
+        return;
+    }
+
+    const Wolf::Viewport renderViewport = m_editorParams->getRenderViewport();
+    const uint32_t readbackSlotIdx = m_screenshotReadbackQueue->reserveSlot(Wolf::g_runtimeContext->getCurrentCPUFrameNumber(), [this, renderViewport](uint32_t slotIdx)
+    {
+        saveScreenshotToFile(slotIdx, renderViewport);
+    });
+    if (readbackSlotIdx == AsyncReadbackQueue::NO_SLOT_AVAILABLE)
+    {
+        Wolf::Debug::sendWarning("Too many screenshots in flight, request is ignored");
+        return;
+    }
+
+    const Wolf::Extent3D swapChainExtent = context.m_swapchainImage->getExtent();
+
+    Wolf::ResourceUniqueOwner<Wolf::Image>& copyImage = m_screenshotCopyImages[readbackSlotIdx];
+    if (!copyImage)
+    {
+        Wolf::CreateImageInfo createCopyInfo;
+        createCopyInfo.extent = swapChainExtent;
+        createCopyInfo.usage = Wolf::ImageUsageFlagBits::TRANSFER_DST;
+        createCopyInfo.format = context.m_swapchainImage->getFormat();
+        createCopyInfo.mipLevelCount = 1;
+        createCopyInfo.imageTiling = VK_IMAGE_TILING_LINEAR;
+        createCopyInfo.memoryProperty = Wolf::ImageMemoryProperty::HOST;
+        copyImage.reset(Wolf::Image::createImage(createCopyInfo));
+        copyImage->setImageLayout({ Wolf::ImageLayout::TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, 0, 1,
+            Wolf::ImageLayout::UNDEFINED });
+    }
+
+    context.m_swapchainImage->transitionImageLayout(*m_commandBuffer, { Wolf::ImageLayout::TRANSFER_SRC_OPTIMAL, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT });
+
+    VkImageCopy copyRegion{};
+
+    copyRegion.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    copyRegion.srcSubresource.baseArrayLayer = 0;
+    copyRegion.srcSubresource.mipLevel = 0;
+    copyRegion.srcSubresource.layerCount = 1;
+    copyRegion.srcOffset = { 0, 0, 0 };
+
+    copyRegion.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    copyRegion.dstSubresource.baseArrayLayer = 0;
+    copyRegion.dstSubresource.mipLevel = 0;
+    copyRegion.dstSubresource.layerCount = 1;
+    copyRegion.dstOffset = { 0, 0, 0 };
+
+    copyRegion.extent = { swapChainExtent.width, swapChainExtent.height, 1 };
+
+    copyImage->recordCopyGPUImage(*context.m_swapchainImage, copyRegion, *m_commandBuffer);
+}
+
+void CompositionPass::saveScreenshotToFile(uint32_t readbackSlotIdx, Wolf::Viewport renderViewport)
+{
+    const Wolf::ResourceUniqueOwner<Wolf::Image>& copyImage = m_screenshotCopyImages[readbackSlotIdx];
+
+    const uint8_t* fullImageData = static_cast<const uint8_t*>(copyImage->map());
+    VkSubresourceLayout copyResourceLayout;
+    copyImage->getResourceLayout(copyResourceLayout);
 
     uint32_t channelCount = 4;
 
-    Wolf::Viewport renderViewport = m_editorParams->getRenderViewport();
     renderViewport.x += 3;
     renderViewport.width -= 5;
     renderViewport.height -= 5;
@@ -213,26 +295,15 @@ void CompositionPass::saveSwapChainToFile()
 
     for (uint32_t y = 0; y < static_cast<uint32_t>(renderViewport.height); y++)
     {
-        uint32_t offsetInFullImageData = ((y + static_cast<uint32_t>(renderViewport.y)) * m_lastSwapChainImage->getExtent().width * channelCount) + static_cast<uint32_t>(renderViewport.x) * channelCount;
-        uint8_t* src = &fullImageData[offsetInFullImageData];
+        uint64_t offsetInFullImageData = (y + static_cast<uint32_t>(renderViewport.y)) * copyResourceLayout.rowPitch + static_cast<uint32_t>(renderViewport.x) * channelCount;
+        const uint8_t* src = &fullImageData[offsetInFullImageData];
         uint8_t* dst = &renderImageData[y * renderViewport.width * channelCount];
         uint32_t lineCopySize = renderViewport.width * channelCount;
 
         memcpy(dst, src, lineCopySize);
     }
 
-    for (uint32_t pixelIdx = 0; pixelIdx < renderViewport.width * renderViewport.height; pixelIdx++)
-    {
-        uint8_t r = renderImageData[4 * pixelIdx + 0];
-        uint8_t g = renderImageData[4 * pixelIdx + 1];
-        uint8_t b = renderImageData[4 * pixelIdx + 2];
-        uint8_t a = renderImageData[4 * pixelIdx + 3];
-
-        renderImageData[4 * pixelIdx + 0] = r;
-        renderImageData[4 * pixelIdx + 1] = g;
-        renderImageData[4 * pixelIdx + 2] = b;
-        renderImageData[4 * pixelIdx + 3] = a;
-    }
+    copyImage->unmap();
 
     stbi_write_png("screenshot.png", renderViewport.width, renderViewport.height, channelCount, renderImageData.data(), renderViewport.width * channelCount);
 }
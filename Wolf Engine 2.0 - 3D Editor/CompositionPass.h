@@ -12,6 +12,7 @@
 #include <Sampler.h>
 #include <ShaderParser.h>
 
+#include "AsyncReadbackQueue.h"
 #include "ForwardPass.h"
 
 class CompositionPass : public Wolf::CommandRecordBase
@@ -31,11 +32,14 @@ public:
 
     void setIsFinalPassThisFrame() { m_finalPassFrameIdx = Wolf::g_runtimeContext->getCurrentCPUFrameNumber(); }
 
-    void saveSwapChainToFile();
+    void requestScreenshotBeforeFrame() { m_screenshotRequested = true; }
+    void flushPendingScreenshots(); // device must be idle
 
 private:
     void updateDescriptorSets();
     void createPipeline();
+    void recordScreenshotCopy(const Wolf::RecordContext& context);
+    void saveScreenshotToFile(uint32_t readbackSlotIdx, Wolf::Viewport renderViewport);
 
     EditorParams* m_editorParams;
     Wolf::ResourceNonOwner<ForwardPass> m_forwardPass;
@@ -66,8 +70,12 @@ private:
     };
     std::unique_ptr<Wolf::UniformBuffer> m_uniformBuffer;
 
+    /* Screenshots, swap chain is copied to a host visible image and saved when the frame is done on GPU */
+    bool m_screenshotRequested = false;
+    std::unique_ptr<AsyncReadbackQueue> m_screenshotReadbackQueue;
+    std::vector<Wolf::ResourceUniqueOwner<Wolf::Image>> m_screenshotCopyImages; // created on first screenshot
+
     /* Cached resources */
-    Wolf::Image* m_lastSwapChainImage = nullptr;
     std::vector<Wolf::Image*> m_swapChainImages;
     Wolf::Image* m_uiImage;
 
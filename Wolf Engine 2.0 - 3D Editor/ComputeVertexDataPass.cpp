@@ -282,9 +282,8 @@ void ComputeVertexDataPass::Request::initResources()
     m_rayTracedWorldManager.reset(new RayTracedWorldManager(m_editorPushDataToGPU));
 
     RayTracedWorldManager::RayTracedWorldInfo::InstanceInfo instanceInfo = { m_bottomLevelAccelerationStructure, glm::mat4(1.0f), m_firstMaterialIdx, m_mesh };
-    RayTracedWorldManager::RayTracedWorldInfo rayTracedWorldInfo{};
-    rayTracedWorldInfo.m_instances.emplace_back(instanceInfo);
-    m_rayTracedWorldManager->requestBuild(rayTracedWorldInfo);
+    m_rayTracedWorldManager->setInstances(0, { instanceInfo });
+    m_rayTracedWorldManager->requestBuild();
 
     createAccumulateColorsDescriptorSet();
 
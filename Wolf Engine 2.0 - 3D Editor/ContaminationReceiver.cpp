@@ -1,6 +1,5 @@
 #include "ContaminationReceiver.h"
 
-#include <fstream>
 #include <utility>
 
 #include "CommonLayouts.h"
@@ -8,6 +7,7 @@
 #include "EditorParamsHelper.h"
 #include "Entity.h"
 #include "PipelineSet.h"
+#include "ShaderSnippetCache.h"
 
 ContaminationReceiver::ContaminationReceiver(std::function<Wolf::NullableResourceNonOwner<Entity>(const std::string&)> getEntityFromLoadingPathCallback) : m_getEntityFromLoadingPathCallback(std::move(getEntityFromLoadingPathCallback))
 {
@@ -60,19 +60,8 @@ void ContaminationReceiver::alterMeshesToRender(std::vector<DrawManager::DrawMes
 								{
 									shaderInfo.materialFetchProcedure.codeString = "";
 
-									std::ifstream inFile("Shaders/materialFetchProcedures/contaminationReceiver.glsl");
-									std::string line;
-									while (std::getline(inFile, line))
-									{
-										const std::string& descriptorSlotToken = "@CONTAMINATION_DESCRIPTOR_SLOT";
-										size_t descriptorSlotTokenPos = line.find(descriptorSlotToken);
-										while (descriptorSlotTokenPos != std::string::npos)
-										{
-											line.replace(descriptorSlotTokenPos, descriptorSlotToken.length(), std::to_string(DescriptorSetSlots::DESCRIPTOR_SET_SLOT_COUNT));
-											descriptorSlotTokenPos = line.find(descriptorSlotToken);
-										}
-										shaderInfo.materialFetchProcedure.codeString += line + '\n';
-									}
+									g_shaderSnippetCache->appendSnippet("Shaders/materialFetchProcedures/contaminationReceiver.glsl",
+										{ { "@CONTAMINATION_DESCRIPTOR_SLOT", std::to_string(DescriptorSetSlots::DESCRIPTOR_SET_SLOT_COUNT) } }, shaderInfo.materialFetchProcedure.codeString);
 								}
 							}
 						}
@@ -1,9 +1,9 @@
 #include "DefaultGlobalIrradiance.h"
 
-#include <fstream>
-
 #include <DescriptorSetGenerator.h>
 
+#include "ShaderSnippetCache.h"
+
 DefaultGlobalIrradiance::DefaultGlobalIrradiance()
 {
     m_uniformBuffer.reset(new Wolf::UniformBuffer(sizeof(UniformBufferData)));
@@ -27,17 +27,5 @@ void DefaultGlobalIrradiance::update()
 
 void DefaultGlobalIrradiance::addShaderCode(Wolf::ShaderParser::ShaderCodeToAdd& inOutShaderCodeToAdd, uint32_t bindingSlot) const
 {
-    std::ifstream inFile("Shaders/defaultGlobalIrradiance/readGlobalIrradiance.glsl");
-    std::string line;
-    while (std::getline(inFile, line))
-    {
-        const std::string& descriptorSlotToken = "@VOXEL_GI_DESCRIPTOR_SLOT";
-        size_t descriptorSlotTokenPos = line.find(descriptorSlotToken);
-        while (descriptorSlotTokenPos != std::string::npos)
-        {
-            line.replace(descriptorSlotTokenPos, descriptorSlotToken.length(), std::to_string(bindingSlot));
-            descriptorSlotTokenPos = line.find(descriptorSlotToken);
-        }
-        inOutShaderCodeToAdd.codeString += line + '\n';
-    }
+    g_shaderSnippetCache->appendSnippet("Shaders/defaultGlobalIrradiance/readGlobalIrradiance.glsl", { { "@VOXEL_GI_DESCRIPTOR_SLOT", std::to_string(bindingSlot) } }, inOutShaderCodeToAdd.codeString);
 }
@@ -38,6 +38,38 @@ EditorConfiguration::EditorConfiguration(const std::string& filePath)
 				m_displayLogsToUI = std::stoi(line);
 			else if (token == "disableThumbnailGeneration")
 				m_disableThumbnailGeneration = std::stoi(line);
+			else if (token == "stagingMemoryBudgetMB")
+				m_stagingMemoryBudgetMB = std::stoull(line);
+			else if (token == "blasMemoryBudgetMB")
+				m_blasMemoryBudgetMB = std::stoull(line);
+			else if (token == "blasBuildTimeBudgetMs")
+				m_blasBuildTimeBudgetMs = std::stof(line);
+			else if (token == "animationLODTiers")
+				m_animationLODTiers = line;
+			else if (token == "updateOffScreenAnimations")
+				m_updateOffScreenAnimations = std::stoi(line);
+			else if (token == "interpolateAnimationUpdates")
+				m_interpolateAnimationUpdates = std::stoi(line);
+			else if (token == "compressionThreadCount")
+				m_compressionThreadCount = std::stoi(line);
+			else if (token == "packVirtualTextureSlices")
+				m_packVirtualTextureSlices = std::stoi(line);
+			else if (token == "imageImportMemoryBudgetMB")
+				m_imageImportMemoryBudgetMB = std::stoull(line);
+			else if (token == "useKaiserMipFilter")
+				m_useKaiserMipFilter = std::stoi(line);
+			else if (token == "useEngineBlockEncoder")
+				m_useEngineBlockEncoder = std::stoi(line);
+			else if (token == "compareBlockEncoderWithEngine")
+				m_compareBlockEncoderWithEngine = std::stoi(line);
+			else if (token == "disableTextureStreaming")
+				m_disableTextureStreaming = std::stoi(line);
+			else if (token == "textureMemoryBudgetMB")
+				m_textureMemoryBudgetMB = std::stoull(line);
+			else if (token == "textureMaxImageMemoryMB")
+				m_textureMaxImageMemoryMB = std::stoull(line);
+			else if (token == "textureStreamingMBPerFrame")
+				m_textureStreamingMBPerFrame = std::stoull(line);
 		}
 	}
 
@@ -16,6 +16,22 @@ public:
 	[[nodiscard]] uint32_t getTakeScreenshotAfterFrameCount() const { return m_takeScreenshotAfterFrameCount; }
 	[[nodiscard]] bool getDisplayLogsToUI() const { return m_displayLogsToUI; }
 	[[nodiscard]] bool getDisableThumbnailGeneration() const { return m_disableThumbnailGeneration; }
+	[[nodiscard]] uint64_t getStagingMemoryBudget() const { return m_stagingMemoryBudgetMB * 1024ull * 1024ull; }
+	[[nodiscard]] uint64_t getBLASMemoryBudget() const { return m_blasMemoryBudgetMB * 1024ull * 1024ull; }
+	[[nodiscard]] float getBLASBuildTimeBudgetMs() const { return m_blasBuildTimeBudgetMs; }
+	[[nodiscard]] const std::string& getAnimationLODTiers() const { return m_animationLODTiers; }
+	[[nodiscard]] bool getUpdateOffScreenAnimations() const { return m_updateOffScreenAnimations; }
+	[[nodiscard]] bool getInterpolateAnimationUpdates() const { return m_interpolateAnimationUpdates; }
+	[[nodiscard]] uint32_t getCompressionThreadCount() const { return m_compressionThreadCount; }
+	[[nodiscard]] bool getPackVirtualTextureSlices() const { return m_packVirtualTextureSlices; }
+	[[nodiscard]] uint64_t getImageImportMemoryBudget() const { return m_imageImportMemoryBudgetMB * 1024ull * 1024ull; }
+	[[nodiscard]] bool getUseKaiserMipFilter() const { return m_useKaiserMipFilter; }
+	[[nodiscard]] bool getUseEngineBlockEncoder() const { return m_useEngineBlockEncoder; }
+	[[nodiscard]] bool getCompareBlockEncoderWithEngine() const { return m_compareBlockEncoderWithEngine; }
+	[[nodiscard]] bool getDisableTextureStreaming() const { return m_disableTextureStreaming; }
+	[[nodiscard]] uint64_t getTextureMemoryBudget() const { return m_textureMemoryBudgetMB * 1024ull * 1024ull; }
+	[[nodiscard]] uint64_t getTextureMaxImageMemory() const { return m_textureMaxImageMemoryMB * 1024ull * 1024ull; }
+	[[nodiscard]] uint64_t getTextureStreamingBytesPerFrame() const { return m_textureStreamingMBPerFrame * 1024ull * 1024ull; }
 
 	void disableRayTracing() { m_enableRayTracing = false;}
 
@@ -36,6 +52,22 @@ private:
 	uint32_t m_takeScreenshotAfterFrameCount = 0;
 	bool m_displayLogsToUI = true;
 	bool m_disableThumbnailGeneration = false;
+	uint64_t m_stagingMemoryBudgetMB = 512;
+	uint64_t m_blasMemoryBudgetMB = 1024;
+	float m_blasBuildTimeBudgetMs = 4.0f;
+	std::string m_animationLODTiers; // see AnimationLODScheduler::parseTiers, scheduler defaults are used when empty
+	bool m_updateOffScreenAnimations = false;
+	bool m_interpolateAnimationUpdates = true;
+	uint32_t m_compressionThreadCount = 0; // 0 uses all hardware threads
+	bool m_packVirtualTextureSlices = false; // see SliceArchive, the engine virtual texture loader still reads one file per slice so it only reads unpacked caches
+	uint64_t m_imageImportMemoryBudgetMB = 256; // uncompressed pixels held by BandedImageCompressor, compressed output and the decoded source are not included
+	bool m_useKaiserMipFilter = false; // see MipChainBuilder, sharper mips but imports no longer go through BandedImageCompressor
+	bool m_useEngineBlockEncoder = false; // BC1, BC3 and BC5 are compressed by Wolf::ImageCompression instead of BlockEncoder
+	bool m_compareBlockEncoderWithEngine = false; // logs the PSNR of both encoders for each BC1 and BC3 level, slows imports down
+	bool m_disableTextureStreaming = false; // texture set images are loaded with all their levels at once when disabled
+	uint64_t m_textureMemoryBudgetMB = 2048; // resident levels of streamed images (see TextureResidencyManager), levels over budget keep their placeholder
+	uint64_t m_textureMaxImageMemoryMB = 128; // allocation of each streamed image, top levels over it are left out
+	uint64_t m_textureStreamingMBPerFrame = 32;
 };
 
 extern const EditorConfiguration* g_editorConfiguration;
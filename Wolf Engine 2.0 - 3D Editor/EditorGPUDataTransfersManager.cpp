@@ -69,6 +69,33 @@ void EditorGPUDataTransfersManager::pushDataToGPUImage(const PushDataToGPUImageI
         realCopySize, pushDataToGPUImageInfo.m_imageOffset });
 }
 
+UpdateGPUBuffersPass::Reservation EditorGPUDataTransfersManager::reserveGPUBufferUpload(uint32_t size, const Wolf::ResourceNonOwner<Wolf::Buffer>& outputBuffer, uint32_t outputOffset)
+{
+    if (!m_updateGPUBufferPass)
+    {
+        Wolf::Debug::sendCriticalError("Rendering pipeline hasn't been set");
+        return {};
+    }
+
+    return m_updateGPUBufferPass->reserveBufferUploadBeforeFrame(size, outputBuffer, outputOffset);
+}
+
+void EditorGPUDataTransfersManager::commitGPUBufferUpload(UpdateGPUBuffersPass::Reservation& reservation)
+{
+    if (!m_updateGPUBufferPass)
+    {
+        Wolf::Debug::sendCriticalError("Rendering pipeline hasn't been set");
+        return;
+    }
+
+    m_updateGPUBufferPass->commitReservation(reservation);
+}
+
+bool EditorGPUDataTransfersManager::canStageWithinBudget(uint32_t size) const
+{
+    return m_updateGPUBufferPass && m_updateGPUBufferPass->canStageWithinBudget(size);
+}
+
 void EditorGPUDataTransfersManager::requestGPUBufferReadbackRecord(const Wolf::ResourceNonOwner<Wolf::Buffer>& srcBuffer, uint32_t srcOffset, const Wolf::ResourceNonOwner<Wolf::ReadableBuffer>& readableBuffer, uint32_t size)
 {
     if (!m_gpuBufferToGPUBufferCopyPass)
@@ -2,8 +2,9 @@
 
 #include <GPUDataTransfersManager.h>
 
+#include "UpdateGPUBuffersPass.h"
+
 class GPUBufferToGPUBufferCopyPass;
-class UpdateGPUBuffersPass;
 
 class EditorGPUDataTransfersManager : public Wolf::GPUDataTransfersManagerInterface
 {
@@ -20,6 +21,13 @@ public:
     void fillGPUBuffer(uint32_t fillValue, uint32_t size, const Wolf::ResourceNonOwner<Wolf::Buffer>& outputBuffer, uint32_t outputOffset) override;
     void pushDataToGPUImage(const PushDataToGPUImageInfo& pushDataToGPUImageInfo) override;
 
+    // Avoids a copy when the data can be generated directly in staging memory
+    [[nodiscard]] UpdateGPUBuffersPass::Reservation reserveGPUBufferUpload(uint32_t size, const Wolf::ResourceNonOwner<Wolf::Buffer>& outputBuffer, uint32_t outputOffset);
+    void commitGPUBufferUpload(UpdateGPUBuffersPass::Reservation& reservation);
+
+    // Uploads which can be delayed (streaming) should wait for next frames while this is false
+    [[nodiscard]] bool canStageWithinBudget(uint32_t size) const;
+
     void requestGPUBufferReadbackRecord(const Wolf::ResourceNonOwner<Wolf::Buffer>& srcBuffer, uint32_t srcOffset, const Wolf::ResourceNonOwner<Wolf::ReadableBuffer>& readableBuffer, uint32_t size) override;
 
 private:
@@ -7,6 +7,7 @@
 #include <LazyInitSharedResource.h>
 #include <WolfEngine.h>
 
+#include "AssetId.h"
 #include "ComponentInterface.h"
 #include "DrawManager.h"
 #include "EditorPhysicsManager.h"
@@ -27,11 +28,16 @@ public:
 
 	void updateBeforeFrame(const Wolf::Timer& globalTimer, const Wolf::ResourceNonOwner<Wolf::InputHandler>& inputHandler) override;
 	virtual bool getMeshesToRender(std::vector<DrawManager::DrawMeshInfo>& outList) = 0;
-	virtual bool getInstancesForRayTracedWorld(std::vector<RayTracedWorldManager::RayTracedWorldInfo::InstanceInfo>& instanceInfos) { return true; }
+	// Returns false when instances aren't ready yet, 'outPendingBLASAssetId' is then set if they wait for the BLAS of this asset to be built
+	virtual bool getInstancesForRayTracedWorld(std::vector<RayTracedWorldManager::RayTracedWorldInfo::InstanceInfo>& instanceInfos, float blasBuildPriority, AssetId& outPendingBLASAssetId) { return true; }
 	virtual bool getMeshesForPhysics(std::vector<EditorPhysicsManager::PhysicsMeshInfo>& outList) = 0;
 
 	virtual Wolf::AABB getAABB() const = 0;
 	virtual Wolf::BoundingSphere getBoundingSphere() const = 0;
+	// Models without a single material return the default one (MaterialEditor::DEFAULT_MATERIAL_IDX)
+	virtual uint32_t getFirstMaterialGPUIdx() const { return 0; }
+	// Every material the model is drawn with, used to request the resolution of streamed textures
+	virtual void getMaterialGPUIndices(std::vector<uint32_t>& outMaterialGPUIndices) const { outMaterialGPUIndices.push_back(getFirstMaterialGPUIdx()); }
 	virtual const glm::mat4& getTransform() const { return m_transform; }
 	glm::vec3 getPosition() const { return m_translationParam; }
 	glm::mat3 computeRotationMatrix() const;
@@ -157,11 +157,11 @@ void Entity::addDebugInfo(DebugRenderingManager& debugRenderingManager) const
 	DYNAMIC_RESOURCE_UNIQUE_OWNER_ARRAY_RANGE_LOOP(m_components, component, component->addDebugInfo(debugRenderingManager);)
 }
 
-bool Entity::getInstancesForRayTracedWorld(std::vector<RayTracedWorldManager::RayTracedWorldInfo::InstanceInfo>& instanceInfos)
+bool Entity::getInstancesForRayTracedWorld(std::vector<RayTracedWorldManager::RayTracedWorldInfo::InstanceInfo>& instanceInfos, float blasBuildPriority, AssetId& outPendingBLASAssetId)
 {
 	if (m_modelComponent)
 	{
-		return (*m_modelComponent)->getInstancesForRayTracedWorld(instanceInfos);
+		return (*m_modelComponent)->getInstancesForRayTracedWorld(instanceInfos, blasBuildPriority, outPendingBLASAssetId);
 	}
 	return true;
 }
@@ -264,6 +264,14 @@ Wolf::BoundingSphere Entity::getBoundingSphere() const
 	return {};
 }
 
+void Entity::getMaterialGPUIndices(std::vector<uint32_t>& outMaterialGPUIndices) const
+{
+	if (m_modelComponent)
+	{
+		(*m_modelComponent)->getMaterialGPUIndices(outMaterialGPUIndices);
+	}
+}
+
 bool Entity::hasComponent(const std::string& componentId) const
 {
 	DYNAMIC_RESOURCE_UNIQUE_OWNER_ARRAY_RANGE_LOOP(m_components, component,
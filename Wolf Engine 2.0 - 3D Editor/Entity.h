@@ -36,7 +36,7 @@ public:
 	virtual void updateBeforeFrame(const Wolf::ResourceNonOwner<Wolf::InputHandler>& inputHandler, const Wolf::Timer& globalTimer, const Wolf::ResourceNonOwner<DrawManager>& drawManager, const Wolf::ResourceNonOwner<EditorPhysicsManager>& editorPhysicsManager);
 	void addLightToLightManager(const Wolf::ResourceNonOwner<Wolf::LightManager>& lightManager) const;
 	void addDebugInfo(DebugRenderingManager& debugRenderingManager) const;
-	bool getInstancesForRayTracedWorld(std::vector<RayTracedWorldManager::RayTracedWorldInfo::InstanceInfo>& instanceInfos);
+	bool getInstancesForRayTracedWorld(std::vector<RayTracedWorldManager::RayTracedWorldInfo::InstanceInfo>& instanceInfos, float blasBuildPriority, AssetId& outPendingBLASAssetId);
 	virtual void activateParams();
 	virtual void fillJSONForParams(std::string& outJSON);
 
@@ -57,6 +57,7 @@ public:
 
 	Wolf::AABB getAABB() const;
 	Wolf::BoundingSphere getBoundingSphere() const;
+	void getMaterialGPUIndices(std::vector<uint32_t>& outMaterialGPUIndices) const;
 	bool hasModelComponent() const { return m_modelComponent.get(); }
 	bool hasComponent(const std::string& componentId) const;
 	glm::vec3 getPosition() const;
@@ -26,7 +26,7 @@ public:
 
     bool getMeshesToRender(std::vector<DrawManager::DrawMeshInfo>& outList) override { return true; }
     bool getMeshesForPhysics(std::vector<EditorPhysicsManager::PhysicsMeshInfo>& outList) override { return true; }
-    bool getInstancesForRayTracedWorld(std::vector<RayTracedWorldManager::RayTracedWorldInfo::InstanceInfo>& instanceInfos) override { return true; }
+    bool getInstancesForRayTracedWorld(std::vector<RayTracedWorldManager::RayTracedWorldInfo::InstanceInfo>& instanceInfos, float blasBuildPriority, AssetId& outPendingBLASAssetId) override { return true; }
 
     Wolf::AABB getAABB() const override;
     Wolf::BoundingSphere getBoundingSphere() const override;
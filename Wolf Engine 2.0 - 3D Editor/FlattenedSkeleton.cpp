@@ -0,0 +1,41 @@
+#include "FlattenedSkeleton.h"
+
+FlattenedSkeleton::FlattenedSkeleton(const AnimationData& animationData)
+{
+	m_parentIndices.reserve(animationData.m_boneCount);
+	m_boneIndices.reserve(animationData.m_boneCount);
+	m_offsetMatrices.reserve(animationData.m_boneCount);
+	m_bindPositions.reserve(animationData.m_boneCount);
+	m_firstPoseIndices.reserve(animationData.m_boneCount);
+	m_poseCounts.reserve(animationData.m_boneCount);
+
+	for (const AnimationData::Bone& rootBone : animationData.m_rootBones)
+	{
+		addBone(rootBone, NO_PARENT);
+	}
+}
+
+void FlattenedSkeleton::addBone(const AnimationData::Bone& bone, uint32_t parentIdx)
+{
+	const uint32_t flattenedIdx = getBoneCount();
+
+	m_parentIndices.push_back(parentIdx);
+	m_boneIndices.push_back(bone.m_idx);
+	m_offsetMatrices.push_back(bone.m_offsetMatrix);
+	m_bindPositions.emplace_back(glm::inverse(bone.m_offsetMatrix) * glm::vec4(1.0f));
+
+	m_firstPoseIndices.push_back(static_cast<uint32_t>(m_poseTimes.size()));
+	m_poseCounts.push_back(static_cast<uint32_t>(bone.m_poses.size()));
+	for (const AnimationData::Bone::Pose& pose : bone.m_poses)
+	{
+		m_poseTimes.push_back(pose.m_time);
+		m_poseTranslations.push_back(pose.m_translation);
+		m_poseOrientations.push_back(pose.m_orientation);
+		m_poseScales.push_back(pose.m_scale);
+	}
+
+	for (const AnimationData::Bone& childBone : bone.m_children)
+	{
+		addBone(childBone, flattenedIdx);
+	}
+}
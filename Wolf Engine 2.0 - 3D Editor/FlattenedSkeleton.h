@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "DAEImporter.h"
+
+// Linear copy of an AnimationData tree built when the mesh is loaded.
+// Bones are stored in depth-first order so a parent always precedes its children, pose channels of all bones are stored in shared arrays.
+struct FlattenedSkeleton
+{
+	static constexpr uint32_t NO_PARENT = -1;
+
+	explicit FlattenedSkeleton(const AnimationData& animationData);
+
+	uint32_t getBoneCount() const { return static_cast<uint32_t>(m_parentIndices.size()); }
+
+	// Per bone, in flattened order
+	std::vector<uint32_t> m_parentIndices; // flattened index of the parent
+	std::vector<uint32_t> m_boneIndices; // AnimationData::Bone::m_idx, index in the GPU bone buffer
+	std::vector<glm::mat4> m_offsetMatrices;
+	std::vector<glm::vec3> m_bindPositions; // inverse offset matrix applied to the bone origin
+	std::vector<uint32_t> m_firstPoseIndices;
+	std::vector<uint32_t> m_poseCounts;
+
+	// Pose channels, poses of a bone are contiguous
+	std::vector<float> m_poseTimes;
+	std::vector<glm::vec3> m_poseTranslations;
+	std::vector<glm::quat> m_poseOrientations;
+	std::vector<glm::vec3> m_poseScales;
+
+private:
+	void addBone(const AnimationData::Bone& bone, uint32_t parentIdx);
+};
@@ -1,5 +1,6 @@
 #include "ImageFormatter.h"
 
+#include <algorithm>
 #include <cstring>
 
 #include <Configuration.h>
@@ -7,7 +8,7 @@
 #include <GPUDataTransfersManager.h>
 
 #include "EditorConfiguration.h"
-#include "MipMapGenerator.h"
+#include "MipChainBuilder.h"
 
 ImageFormatter::ImageFormatter(const Wolf::ResourceNonOwner<EditorGPUDataTransfersManager>& editorPushDataToGPU, const std::string& fullFilePath, Wolf::Format finalFormat, bool canBeVirtualized,
 	KeepDataMode keepDataMode, bool loadMips) : m_keepDataMode(keepDataMode), m_loadMips(loadMips), m_editorPushDataToGPU(editorPushDataToGPU), m_originFilename(EditorConfiguration::sanitizeFilePath(fullFilePath))
@@ -33,6 +34,14 @@ ImageFormatter::ImageFormatter(const Wolf::ResourceNonOwner<EditorGPUDataTransfe
     	{
     		createSlicedCacheFromFile<Wolf::ImageCompression::RGBA8, Wolf::ImageCompression::BC3>(fullFilePath, Wolf::isSRGBFormat(finalFormat), finalFormat);
     	}
+    	else if (finalFormat == Wolf::Format::BC4_UNORM_BLOCK)
+    	{
+    		createSlicedCacheFromFile<Wolf::ImageCompression::RGBA8, BlockEncoder::BC4>(fullFilePath, Wolf::isSRGBFormat(finalFormat), finalFormat);
+    	}
+    	else if (finalFormat == Wolf::Format::BC7_SRGB_BLOCK || finalFormat == Wolf::Format::BC7_UNORM_BLOCK)
+    	{
+    		createSlicedCacheFromFile<Wolf::ImageCompression::RGBA8, BlockEncoder::BC7>(fullFilePath, Wolf::isSRGBFormat(finalFormat), finalFormat);
+    	}
     	else if (finalFormat == Wolf::Format::R8G8B8A8_UNORM)
     	{
     		createSlicedCacheFromFile<Wolf::ImageCompression::RGBA8, Wolf::ImageCompression::RGBA8>(fullFilePath, Wolf::isSRGBFormat(finalFormat), finalFormat);
@@ -44,7 +53,8 @@ ImageFormatter::ImageFormatter(const Wolf::ResourceNonOwner<EditorGPUDataTransfe
     }
     else
     {
-        if (finalFormat == Wolf::Format::BC1_RGB_SRGB_BLOCK || finalFormat == Wolf::Format::BC3_UNORM_BLOCK || finalFormat == Wolf::Format::R8G8B8A8_UNORM || finalFormat == Wolf::Format::R8G8B8A8_SRGB)
+        if (finalFormat == Wolf::Format::BC1_RGB_SRGB_BLOCK || finalFormat == Wolf::Format::BC3_UNORM_BLOCK || finalFormat == Wolf::Format::R8G8B8A8_UNORM || finalFormat == Wolf::Format::R8G8B8A8_SRGB ||
+        	finalFormat == Wolf::Format::BC4_UNORM_BLOCK || finalFormat == Wolf::Format::BC7_SRGB_BLOCK || finalFormat == Wolf::Format::BC7_UNORM_BLOCK)
         {
             if (!createImageFileFromCache(fullFilePath, finalFormat))
             {
@@ -81,9 +91,9 @@ ImageFormatter::ImageFormatter(const Wolf::ResourceNonOwner<EditorGPUDataTransfe
 
 ImageFormatter::ImageFormatter(const Wolf::ResourceNonOwner<EditorGPUDataTransfersManager>& editorPushDataToGPU, const std::vector<Wolf::ImageCompression::RGBA8>& data, std::vector<std::vector<Wolf::ImageCompression::RGBA8>>& mipLevels,
 	Wolf::Extent3D extent, const std::string& fullFilePath, Wolf::Format finalFormat, bool canBeVirtualized, KeepDataMode keepDataMode)
-: m_keepDataMode(keepDataMode), m_editorPushDataToGPU(editorPushDataToGPU)
+: m_keepDataMode(keepDataMode), m_editorPushDataToGPU(editorPushDataToGPU), m_originFilename(EditorConfiguration::sanitizeFilePath(fullFilePath))
 {
-	if (finalFormat != Wolf::Format::BC3_UNORM_BLOCK)
+	if (finalFormat != Wolf::Format::BC3_UNORM_BLOCK && finalFormat != Wolf::Format::BC4_UNORM_BLOCK && finalFormat != Wolf::Format::BC7_UNORM_BLOCK)
 	{
 		Wolf::Debug::sendCriticalError("Unsupported format");
 	}
@@ -97,7 +107,12 @@ ImageFormatter::ImageFormatter(const Wolf::ResourceNonOwner<EditorGPUDataTransfe
 			std::filesystem::create_directory(m_slicesFolder);
 		}
 
-		createSlicedCacheFromData<Wolf::ImageCompression::RGBA8, Wolf::ImageCompression::BC3>(extent, data, mipLevels);
+		if (finalFormat == Wolf::Format::BC4_UNORM_BLOCK)
+			createSlicedCacheFromData<Wolf::ImageCompression::RGBA8, BlockEncoder::BC4>(extent, data, mipLevels);
+		else if (finalFormat == Wolf::Format::BC7_UNORM_BLOCK)
+			createSlicedCacheFromData<Wolf::ImageCompression::RGBA8, BlockEncoder::BC7>(extent, data, mipLevels);
+		else
+			createSlicedCacheFromData<Wolf::ImageCompression::RGBA8, Wolf::ImageCompression::BC3>(extent, data, mipLevels);
 	}
 	else
 	{
@@ -106,10 +121,49 @@ ImageFormatter::ImageFormatter(const Wolf::ResourceNonOwner<EditorGPUDataTransfe
 		/* Hash */
 		uint64_t hash = HASH;
 		outCacheFile.write(reinterpret_cast<char*>(&hash), sizeof(hash));
+		outCacheFile.write(reinterpret_cast<char*>(&finalFormat), sizeof(finalFormat));
 		outCacheFile.write(reinterpret_cast<char*>(&extent), sizeof(Wolf::Extent3D));
 
-		compressAndCreateImage<Wolf::ImageCompression::BC3>(mipLevels, data, extent, Wolf::Format::BC3_UNORM_BLOCK, fullFilePath, outCacheFile);
+		if (finalFormat == Wolf::Format::BC4_UNORM_BLOCK)
+			compressAndCreateImage<BlockEncoder::BC4>(mipLevels, data, extent, finalFormat, fullFilePath, outCacheFile);
+		else if (finalFormat == Wolf::Format::BC7_UNORM_BLOCK)
+			compressAndCreateImage<BlockEncoder::BC7>(mipLevels, data, extent, finalFormat, fullFilePath, outCacheFile);
+		else
+			compressAndCreateImage<Wolf::ImageCompression::BC3>(mipLevels, data, extent, finalFormat, fullFilePath, outCacheFile);
+	}
+}
+
+ImageFormatter::ImageFormatter(const Wolf::ResourceNonOwner<EditorGPUDataTransfersManager>& editorPushDataToGPU, const std::string& fullFilePath, Wolf::Format finalFormat, uint32_t firstAllocatedMip,
+	uint32_t firstResidentMip)
+: m_keepDataMode(KeepDataMode::ONLY_GPU), m_loadMips(true), m_editorPushDataToGPU(editorPushDataToGPU), m_originFilename(EditorConfiguration::sanitizeFilePath(fullFilePath))
+{
+	computeCachePaths(fullFilePath, finalFormat, m_cacheFilename, m_slicesFolder);
+
+	Wolf::Extent3D extent;
+	std::vector<std::vector<uint8_t>> levels;
+	std::vector<uint64_t> levelSizes;
+	if (!readCacheFile(m_cacheFilename, finalFormat, firstResidentMip, std::numeric_limits<uint32_t>::max(), extent, levels, &levelSizes))
+		return;
+
+	if (firstAllocatedMip > firstResidentMip || firstResidentMip >= levels.size())
+	{
+		Wolf::Debug::sendError("Resident levels are not in the cache: " + m_cacheFilename);
+		return;
+	}
+
+	// Placeholders are built from the smallest level down, each one from the level below
+	for (uint32_t mipLevel = firstResidentMip; mipLevel-- > firstAllocatedMip;)
+	{
+		const Wolf::Extent3D levelExtent = { std::max(extent.width >> mipLevel, 1u), std::max(extent.height >> mipLevel, 1u), 1 };
+		createPlaceholderLevel(finalFormat, levelExtent, levelSizes[mipLevel], levels[mipLevel + 1], levels[mipLevel]);
+	}
+
+	std::vector<const uint8_t*> mipsDataPtr;
+	for (uint32_t mipLevel = firstAllocatedMip + 1; mipLevel < levels.size(); ++mipLevel)
+	{
+		mipsDataPtr.push_back(levels[mipLevel].data());
 	}
+	createImageFromData({ std::max(extent.width >> firstAllocatedMip, 1u), std::max(extent.height >> firstAllocatedMip, 1u), 1 }, finalFormat, levels[firstAllocatedMip].data(), mipsDataPtr);
 }
 
 void ImageFormatter::transferImageTo(Wolf::ResourceUniqueOwner<Wolf::Image>& output)
@@ -132,19 +186,7 @@ bool ImageFormatter::isCacheAvailable(const std::string& fullFilePath, Wolf::For
 
 	if (canBeVirtualized && Wolf::g_configuration->getUseVirtualTexture())
 	{
-		// Check 1st file to avoid loading pixels if we don't need
-		std::string binFilename = slicesFolder + "mip0_sliceX0_sliceY0.bin";
-		if (std::filesystem::exists(binFilename))
-		{
-			std::ifstream input(binFilename, std::ios::in | std::ios::binary);
-
-			uint64_t hash;
-			input.read(reinterpret_cast<char*>(&hash), sizeof(hash));
-			if (hash == HASH)
-			{
-				return true; // we assume cache is ready
-			}
-		}
+		return isSlicedCacheUpToDate(slicesFolder, fullFilePath);
 	}
 	else
 	{
@@ -169,6 +211,34 @@ bool ImageFormatter::isCacheAvailable(const std::string& fullFilePath, Wolf::For
 	return false;
 }
 
+void ImageFormatter::createMissingCaches(const Wolf::ResourceNonOwner<EditorGPUDataTransfersManager>& editorPushDataToGPU, const std::vector<CacheRequest>& requests)
+{
+	std::vector<const CacheRequest*> missingCacheRequests;
+	std::vector<std::string> missingCachePaths;
+	for (const CacheRequest& request : requests)
+	{
+		if (isCacheAvailable(request.m_fullFilePath, request.m_format, request.m_canBeVirtualized))
+			continue;
+
+		std::string cacheFilename, slicesFolder;
+		computeCachePaths(request.m_fullFilePath, request.m_format, cacheFilename, slicesFolder);
+		const std::string& cachePath = request.m_canBeVirtualized && Wolf::g_configuration->getUseVirtualTexture() ? slicesFolder : cacheFilename;
+
+		// Same source used twice (ex: one file for several channels), the cache must be written once
+		if (std::find(missingCachePaths.begin(), missingCachePaths.end(), cachePath) != missingCachePaths.end())
+			continue;
+
+		missingCacheRequests.push_back(&request);
+		missingCachePaths.push_back(cachePath);
+	}
+
+	parallelFor(static_cast<uint32_t>(missingCacheRequests.size()), [&](uint32_t requestIdx)
+		{
+			const CacheRequest& request = *missingCacheRequests[requestIdx];
+			ImageFormatter imageFormatter(editorPushDataToGPU, request.m_fullFilePath, request.m_format, request.m_canBeVirtualized, KeepDataMode::ONLY_CACHE, true);
+		});
+}
+
 Wolf::ImageCompression::Compression ImageFormatter::findCompressionFromFormat(Wolf::Format format)
 {
 	if (format == Wolf::Format::BC1_RGB_SRGB_BLOCK)
@@ -181,6 +251,28 @@ Wolf::ImageCompression::Compression ImageFormatter::findCompressionFromFormat(Wo
 		return Wolf::ImageCompression::Compression::NO_COMPRESSION;
 }
 
+Wolf::ImageCompression::RG32F ImageFormatter::computeNormalFromColor(const Wolf::ImageCompression::RGBA8& color)
+{
+	glm::vec3 colorAsVec = 2.0f * glm::vec3(static_cast<float>(color.r) / 255.0f, static_cast<float>(color.g) / 255.0f, static_cast<float>(color.b) / 255.0f) - glm::vec3(1.0f);
+	colorAsVec = glm::normalize(colorAsVec);
+
+	return Wolf::ImageCompression::RG32F(colorAsVec.x, colorAsVec.y);
+}
+
+MipChainBuilder::Settings ImageFormatter::computeMipChainSettings(Wolf::Format uncompressedFormat)
+{
+	MipChainBuilder::Settings settings;
+	settings.m_filter = g_editorConfiguration->getUseKaiserMipFilter() ? MipChainBuilder::Filter::KAISER : MipChainBuilder::Filter::BOX;
+	if (uncompressedFormat == Wolf::Format::R32G32_SFLOAT) // normals, see computeNormalFromColor
+		settings.m_content = MipChainBuilder::Content::NORMAL;
+	else if (Wolf::isSRGBFormat(uncompressedFormat))
+		settings.m_content = MipChainBuilder::Content::SRGB_COLOR;
+	else
+		settings.m_content = MipChainBuilder::Content::COLOR;
+
+	return settings;
+}
+
 Wolf::Format ImageFormatter::findUncompressedFormat(Wolf::Format format)
 {
 	if (format == Wolf::Format::BC1_RGB_SRGB_BLOCK)
@@ -189,6 +281,10 @@ Wolf::Format ImageFormatter::findUncompressedFormat(Wolf::Format format)
 		return Wolf::Format::R8G8B8A8_UNORM;
 	else if (format == Wolf::Format::BC5_UNORM_BLOCK)
 		return Wolf::Format::R32G32_SFLOAT;
+	else if (format == Wolf::Format::BC4_UNORM_BLOCK || format == Wolf::Format::BC7_UNORM_BLOCK)
+		return Wolf::Format::R8G8B8A8_UNORM;
+	else if (format == Wolf::Format::BC7_SRGB_BLOCK)
+		return Wolf::Format::R8G8B8A8_SRGB;
 	else
 		return format;
 }
@@ -197,40 +293,18 @@ bool ImageFormatter::createImageFileFromCache(const std::string& filename, Wolf:
 {
 	if (std::filesystem::exists(m_cacheFilename))
 	{
-		std::ifstream input(m_cacheFilename, std::ios::in | std::ios::binary);
-
-		uint64_t hash;
-		input.read(reinterpret_cast<char*>(&hash), sizeof(hash));
-		if (hash != HASH)
-		{
-			Wolf::Debug::sendInfo("Cache found but hash is incorrect: " + m_cacheFilename);
-			return false;
-		}
-
 		Wolf::Extent3D extent;
-		input.read(reinterpret_cast<char*>(&extent), sizeof(extent));
-
-		uint32_t dataBytesCount;
-		input.read(reinterpret_cast<char*>(&dataBytesCount), sizeof(dataBytesCount));
-
-		std::vector<uint8_t> data(dataBytesCount);
-		input.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
-
-		uint32_t mipsCount;
-		input.read(reinterpret_cast<char*>(&mipsCount), sizeof(mipsCount));
+		std::vector<std::vector<uint8_t>> levels;
+		if (!readCacheFile(m_cacheFilename, format, 0, std::numeric_limits<uint32_t>::max(), extent, levels))
+			return false;
 
-		std::vector<std::vector<uint8_t>> mipsData(mipsCount);
-		std::vector<const uint8_t*> mipsDataPtr(mipsData.size());
-		for (uint32_t i = 0; i < mipsData.size(); ++i)
+		std::vector<const uint8_t*> mipsDataPtr(levels.size() - 1);
+		for (uint32_t i = 0; i < mipsDataPtr.size(); ++i)
 		{
-			input.read(reinterpret_cast<char*>(&dataBytesCount), sizeof(dataBytesCount));
-			mipsData[i].resize(dataBytesCount);
-			input.read(reinterpret_cast<char*>(mipsData[i].data()), static_cast<std::streamsize>(mipsData[i].size()));
-
-			mipsDataPtr[i] = mipsData[i].data();
+			mipsDataPtr[i] = levels[i + 1].data();
 		}
 
-		createImageFromData(extent, format, data.data(), mipsDataPtr);
+		createImageFromData(extent, format, levels[0].data(), mipsDataPtr);
 
 		return true;
 	}
@@ -256,6 +330,126 @@ bool ImageFormatter::createImageFileFromCache(const std::string& filename, Wolf:
 	return false;
 }
 
+bool ImageFormatter::readCacheLayout(const std::string& fullFilePath, Wolf::Format format, Wolf::Extent3D& outExtent, std::vector<uint64_t>& outLevelSizes)
+{
+	std::string cacheFilename, slicesFolder;
+	computeCachePaths(fullFilePath, format, cacheFilename, slicesFolder);
+
+	std::vector<std::vector<uint8_t>> levels;
+	return readCacheFile(cacheFilename, format, 0, 0, outExtent, levels, &outLevelSizes);
+}
+
+bool ImageFormatter::readCachedMipLevel(const std::string& fullFilePath, Wolf::Format format, uint32_t mipLevel, std::vector<uint8_t>& outData)
+{
+	std::string cacheFilename, slicesFolder;
+	computeCachePaths(fullFilePath, format, cacheFilename, slicesFolder);
+
+	Wolf::Extent3D extent;
+	std::vector<std::vector<uint8_t>> levels;
+	if (!readCacheFile(cacheFilename, format, mipLevel, mipLevel + 1, extent, levels) || mipLevel >= levels.size())
+		return false;
+
+	outData.swap(levels[mipLevel]);
+	return true;
+}
+
+bool ImageFormatter::readCacheFile(const std::string& cacheFilename, Wolf::Format format, uint32_t firstReadMip, uint32_t endReadMip, Wolf::Extent3D& outExtent,
+	std::vector<std::vector<uint8_t>>& outLevels, std::vector<uint64_t>* outLevelSizes)
+{
+	std::ifstream input(cacheFilename, std::ios::in | std::ios::binary);
+	if (!input.good())
+	{
+		Wolf::Debug::sendInfo("Cache not found: " + cacheFilename);
+		return false;
+	}
+
+	uint64_t hash;
+	input.read(reinterpret_cast<char*>(&hash), sizeof(hash));
+	if (hash != HASH)
+	{
+		Wolf::Debug::sendInfo("Cache found but hash is incorrect: " + cacheFilename);
+		return false;
+	}
+
+	Wolf::Format cacheFormat;
+	input.read(reinterpret_cast<char*>(&cacheFormat), sizeof(cacheFormat));
+	if (cacheFormat != format)
+	{
+		Wolf::Debug::sendInfo("Cache found but format is incorrect: " + cacheFilename);
+		return false;
+	}
+
+	input.read(reinterpret_cast<char*>(&outExtent), sizeof(outExtent));
+
+	// Level 0 is stored before the mip count, each level is preceded by its size so skipped levels are never read
+	uint32_t levelCount = 1;
+	outLevels.clear();
+	for (uint32_t mipLevel = 0; mipLevel < levelCount; ++mipLevel)
+	{
+		uint32_t dataBytesCount;
+		input.read(reinterpret_cast<char*>(&dataBytesCount), sizeof(dataBytesCount));
+
+		std::vector<uint8_t>& level = outLevels.emplace_back();
+		if (mipLevel >= firstReadMip && mipLevel < endReadMip)
+		{
+			level.resize(dataBytesCount);
+			input.read(reinterpret_cast<char*>(level.data()), static_cast<std::streamsize>(level.size()));
+		}
+		else
+		{
+			input.seekg(dataBytesCount, std::ios::cur);
+		}
+		if (outLevelSizes)
+			outLevelSizes->push_back(dataBytesCount);
+
+		if (mipLevel == 0)
+		{
+			uint32_t mipsCount;
+			input.read(reinterpret_cast<char*>(&mipsCount), sizeof(mipsCount));
+			levelCount += mipsCount;
+		}
+	}
+
+	if (!input.good())
+	{
+		Wolf::Debug::sendInfo("Cache found but is truncated: " + cacheFilename);
+		return false;
+	}
+
+	return true;
+}
+
+void ImageFormatter::createPlaceholderLevel(Wolf::Format format, const Wolf::Extent3D& levelExtent, uint64_t levelSize, const std::vector<uint8_t>& nextLevelPixels, std::vector<uint8_t>& outPixels)
+{
+	const bool isBlockCompressed = findCompressionFromFormat(format) != Wolf::ImageCompression::Compression::NO_COMPRESSION || format == Wolf::Format::BC4_UNORM_BLOCK ||
+		format == Wolf::Format::BC7_SRGB_BLOCK || format == Wolf::Format::BC7_UNORM_BLOCK;
+	const uint32_t unitExtent = isBlockCompressed ? 4 : 1;
+
+	const uint32_t unitCountX = std::max((levelExtent.width + unitExtent - 1) / unitExtent, 1u);
+	const uint32_t unitCountY = std::max((levelExtent.height + unitExtent - 1) / unitExtent, 1u);
+	const uint32_t nextUnitCountX = std::max((std::max(levelExtent.width / 2, 1u) + unitExtent - 1) / unitExtent, 1u);
+	const uint32_t nextUnitCountY = std::max((std::max(levelExtent.height / 2, 1u) + unitExtent - 1) / unitExtent, 1u);
+	const size_t unitSize = levelSize / (static_cast<size_t>(unitCountX) * unitCountY);
+
+	outPixels.resize(levelSize);
+	if (unitSize == 0 || nextLevelPixels.size() != unitSize * nextUnitCountX * nextUnitCountY)
+	{
+		Wolf::Debug::sendWarning("Level sizes don't match the format, placeholder is left black");
+		std::fill(outPixels.begin(), outPixels.end(), 0);
+		return;
+	}
+
+	for (uint32_t unitY = 0; unitY < unitCountY; ++unitY)
+	{
+		const uint8_t* nextLevelRow = nextLevelPixels.data() + std::min(unitY / 2, nextUnitCountY - 1) * nextUnitCountX * unitSize;
+		uint8_t* row = outPixels.data() + static_cast<size_t>(unitY) * unitCountX * unitSize;
+		for (uint32_t unitX = 0; unitX < unitCountX; ++unitX)
+		{
+			memcpy(row + unitX * unitSize, nextLevelRow + std::min(unitX / 2, nextUnitCountX - 1) * unitSize, unitSize);
+		}
+	}
+}
+
 void ImageFormatter::loadImageFile(const std::string& filename, Wolf::Format format, bool loadMips, std::vector<Wolf::ImageCompression::RGBA8>& pixels, std::vector<std::vector<Wolf::ImageCompression::RGBA8>>& mipLevels, Wolf::Extent3D& outExtent)
 {
 	const Wolf::ImageFileLoader imageFileLoader(filename);
@@ -272,15 +466,8 @@ void ImageFormatter::loadImageFile(const std::string& filename, Wolf::Format for
 
 	if (loadMips)
 	{
-		const Wolf::MipMapGenerator mipmapGenerator(reinterpret_cast<const unsigned char*>(pixels.data()), { (imageFileLoader.getWidth()), (imageFileLoader.getHeight()) }, format);
-
-		mipLevels.resize(mipmapGenerator.getMipLevelCount() - 1);
-		for (uint32_t mipLevel = 1; mipLevel < mipmapGenerator.getMipLevelCount(); ++mipLevel)
-		{
-			const std::vector<unsigned char>& mipPixels = mipmapGenerator.getMipLevel(mipLevel);
-			const Wolf::ImageCompression::RGBA8* mipPixelsAsColor = reinterpret_cast<const Wolf::ImageCompression::RGBA8*>(mipPixels.data());
-			mipLevels[mipLevel - 1] = std::vector<Wolf::ImageCompression::RGBA8>(mipPixelsAsColor, mipPixelsAsColor + mipPixels.size() / sizeof(Wolf::ImageCompression::RGBA8));
-		}
+		MipChainBuilder::buildMipChain({ imageFileLoader.getWidth(), imageFileLoader.getHeight(), 1 }, pixels.data(), computeMipChainSettings(format), mipLevels,
+			g_editorConfiguration->getCompressionThreadCount());
 	}
 
 	outExtent = { (imageFileLoader.getWidth()), (imageFileLoader.getHeight()), 1 };
@@ -305,25 +492,14 @@ void ImageFormatter::loadImageFile(const std::string& filename, Wolf::Format for
 		for (uint32_t i = 0; i < pixels.size(); ++i)
 		{
 			//ImageCompression::RGBA32F fullPixel = fullPixels[i];
-			Wolf::ImageCompression::RGBA8 fullPixel = fullPixels[i];
-			glm::vec3 fullPixelAsVec = 2.0f * glm::vec3(static_cast<float>(fullPixel.r) / 255.0f, static_cast<float>(fullPixel.g) / 255.0f, static_cast<float>(fullPixel.b) / 255.0f) - glm::vec3(1.0f);
-			fullPixelAsVec = glm::normalize(fullPixelAsVec);
-
-			pixels[i] = Wolf::ImageCompression::RG32F(fullPixelAsVec.x, fullPixelAsVec.y);
+			pixels[i] = computeNormalFromColor(fullPixels[i]);
 		}
 	}
 
 	if (loadMips)
 	{
-		const Wolf::MipMapGenerator mipmapGenerator(reinterpret_cast<const unsigned char*>(pixels.data()), { (imageFileLoader.getWidth()), (imageFileLoader.getHeight()) }, format);
-
-		mipLevels.resize(mipmapGenerator.getMipLevelCount() - 1);
-		for (uint32_t mipLevel = 1; mipLevel < mipmapGenerator.getMipLevelCount(); ++mipLevel)
-		{
-			const std::vector<unsigned char>& mipPixels = mipmapGenerator.getMipLevel(mipLevel);
-			const Wolf::ImageCompression::RG32F* mipPixelsAsColor = reinterpret_cast<const Wolf::ImageCompression::RG32F*>(mipPixels.data());
-			mipLevels[mipLevel - 1] = std::vector<Wolf::ImageCompression::RG32F>(mipPixelsAsColor, mipPixelsAsColor + mipPixels.size() / sizeof(Wolf::ImageCompression::RG32F));
-		}
+		MipChainBuilder::buildMipChain({ imageFileLoader.getWidth(), imageFileLoader.getHeight(), 1 }, pixels.data(), computeMipChainSettings(format), mipLevels,
+			g_editorConfiguration->getCompressionThreadCount());
 	}
 
 	outExtent = { (imageFileLoader.getWidth()), (imageFileLoader.getHeight()), 1 };
@@ -354,15 +530,8 @@ void ImageFormatter::loadImageFile(const std::string& filename, Wolf::Format for
 
 	if (loadMips)
 	{
-		const Wolf::MipMapGenerator mipmapGenerator(reinterpret_cast<const unsigned char*>(pixels.data()), { (imageFileLoader.getWidth()), (imageFileLoader.getHeight()) }, format);
-
-		mipLevels.resize(mipmapGenerator.getMipLevelCount() - 1);
-		for (uint32_t mipLevel = 1; mipLevel < mipmapGenerator.getMipLevelCount(); ++mipLevel)
-		{
-			const std::vector<unsigned char>& mipPixels = mipmapGenerator.getMipLevel(mipLevel);
-			const Wolf::ImageCompression::RGBA32F* mipPixelsAsColor = reinterpret_cast<const Wolf::ImageCompression::RGBA32F*>(mipPixels.data());
-			mipLevels[mipLevel - 1] = std::vector<Wolf::ImageCompression::RGBA32F>(mipPixelsAsColor, mipPixelsAsColor + mipPixels.size() / sizeof(Wolf::ImageCompression::RGBA8));
-		}
+		MipChainBuilder::buildMipChain({ imageFileLoader.getWidth(), imageFileLoader.getHeight(), 1 }, pixels.data(), computeMipChainSettings(format), mipLevels,
+			g_editorConfiguration->getCompressionThreadCount());
 	}
 
 	outExtent = { (imageFileLoader.getWidth()), (imageFileLoader.getHeight()), 1 };
@@ -396,6 +565,56 @@ void ImageFormatter::loadImageFile(const std::string& filename, Wolf::Format for
 	outExtent = { (imageFileLoader.getWidth()), (imageFileLoader.getHeight()), (imageFileLoader.getDepth()) };
 }
 
+bool ImageFormatter::isSlicedCacheUpToDate(const std::string& slicesFolder, const std::string& sourceFilePath)
+{
+	SliceCacheManifest manifest;
+	if (!manifest.load(slicesFolder + SliceCacheManifest::FILENAME) || !manifest.isComplete())
+		return false;
+
+	uint64_t sourceFileSize;
+	int64_t sourceLastWriteTime;
+	SliceCacheManifest::computeSourceFileInfo(sourceFilePath, sourceFileSize, sourceLastWriteTime);
+
+	const SliceCacheManifest::Parameters& parameters = manifest.getParameters();
+	return parameters.m_codeHash == HASH && parameters.m_isPacked == (g_editorConfiguration->getPackVirtualTextureSlices() ? 1 : 0) &&
+		parameters.m_sourceFileSize == sourceFileSize && parameters.m_sourceLastWriteTime == sourceLastWriteTime;
+}
+
+bool ImageFormatter::readSliceFile(const std::string& binFilename, std::vector<uint8_t>& outData)
+{
+	std::ifstream input(binFilename, std::ios::in | std::ios::binary);
+	if (!input.is_open())
+		return false;
+
+	uint64_t hash = 0;
+	uint32_t dataBytesCount = 0;
+	input.read(reinterpret_cast<char*>(&hash), sizeof(hash));
+	input.read(reinterpret_cast<char*>(&dataBytesCount), sizeof(dataBytesCount));
+	if (!input || hash != HASH)
+		return false;
+
+	outData.resize(dataBytesCount);
+	input.read(reinterpret_cast<char*>(outData.data()), dataBytesCount);
+	return static_cast<bool>(input);
+}
+
+void ImageFormatter::removeUnusedSliceFiles(bool packSlices) const
+{
+	std::error_code errorCode;
+	if (!packSlices)
+	{
+		std::filesystem::remove(m_slicesFolder + SliceArchive::FILENAME, errorCode);
+		return;
+	}
+
+	for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(m_slicesFolder, errorCode))
+	{
+		const std::string filename = entry.path().filename().string();
+		if (filename.starts_with("mip") && filename.find("_sliceX") != std::string::npos && filename.ends_with(".bin"))
+			std::filesystem::remove(entry.path(), errorCode);
+	}
+}
+
 void ImageFormatter::computeCachePaths(const std::string& inFullPath, Wolf::Format format, std::string& outCache, std::string& outSlicesFolder)
 {
 	std::string escapedFilename = g_editorConfiguration->computeLocalPathFromFullPath(inFullPath);
@@ -412,7 +631,7 @@ void ImageFormatter::computeCachePaths(const std::string& inFullPath, Wolf::Form
 
 void ImageFormatter::createImageFromData(Wolf::Extent3D extent, Wolf::Format format, const uint8_t* pixels, const std::vector<const unsigned char*>& mipLevels)
 {
-	if (m_keepDataMode != KeepDataMode::ONLY_CPU)
+	if (m_keepDataMode == KeepDataMode::ONLY_GPU || m_keepDataMode == KeepDataMode::CPU_AND_GPU)
 	{
 		Wolf::CreateImageInfo createImageInfo;
 		createImageInfo.extent = extent;
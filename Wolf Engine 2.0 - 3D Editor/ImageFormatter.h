@@ -1,28 +1,44 @@
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <limits>
+#include <memory>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include <ConfigurationHelper.h>
 #include <Extents.h>
 #include <ImageCompression.h>
+#include <ImageFileLoader.h>
 #include <VirtualTextureManager.h>
 
+#include "BandedImageCompressor.h"
+#include "BlockEncoder.h"
 #include "CodeFileHashes.h"
+#include "EditorConfiguration.h"
 #include "EditorGPUDataTransfersManager.h"
+#include "MipChainBuilder.h"
+#include "ParallelFor.h"
+#include "SliceArchive.h"
+#include "SliceCacheManifest.h"
 
 class ImageFormatter
 {
 public:
-	enum class KeepDataMode { ONLY_GPU, CPU_AND_GPU, ONLY_CPU};
+	enum class KeepDataMode { ONLY_GPU, CPU_AND_GPU, ONLY_CPU, ONLY_CACHE /* cache is written, no image is created and no pixel is kept */ };
 
 	ImageFormatter(const Wolf::ResourceNonOwner<EditorGPUDataTransfersManager>& editorPushDataToGPU, const std::string& fullFilePath, Wolf::Format finalFormat, bool canBeVirtualized, KeepDataMode keepDataMode,
 		bool loadMips);
 	ImageFormatter(const Wolf::ResourceNonOwner<EditorGPUDataTransfersManager>& editorPushDataToGPU, const std::vector<Wolf::ImageCompression::RGBA8>& data, std::vector<std::vector<Wolf::ImageCompression::RGBA8>>& mipLevels,
 		Wolf::Extent3D extent, const std::string& fullFilePath, Wolf::Format finalFormat, bool canBeVirtualized, KeepDataMode keepDataMode);
+	// Streamed image, from an up to date cache only: levels before 'firstAllocatedMip' are left out and levels before 'firstResidentMip' hold placeholders until they are
+	// streamed (see TextureResidencyManager and readCachedMipLevel). Level 0 of the image is 'firstAllocatedMip'. No image is created when the cache can't be read
+	ImageFormatter(const Wolf::ResourceNonOwner<EditorGPUDataTransfersManager>& editorPushDataToGPU, const std::string& fullFilePath, Wolf::Format finalFormat, uint32_t firstAllocatedMip,
+		uint32_t firstResidentMip);
 
 	void transferImageTo(Wolf::ResourceUniqueOwner<Wolf::Image>& output);
 	std::string getSlicesFolder() const { return m_slicesFolder; }
@@ -30,6 +46,18 @@ public:
 	const uint8_t* getPixels(uint32_t mipLevel = 0) const;
 
 	static bool isCacheAvailable(const std::string& filename, Wolf::Format format, bool canBeVirtualized);
+	struct CacheRequest
+	{
+		std::string m_fullFilePath;
+		Wolf::Format m_format;
+		bool m_canBeVirtualized;
+	};
+	// Builds the missing caches, with mips, one task per image so decoding an image overlaps with compressing the others. Each cache only depends on its source,
+	// the output is the same whatever order tasks finish in. No image is created, loading them afterwards reads the caches
+	static void createMissingCaches(const Wolf::ResourceNonOwner<EditorGPUDataTransfersManager>& editorPushDataToGPU, const std::vector<CacheRequest>& requests);
+	// Full resolution extent and byte size of each level stored in the cache, level 0 first. Pixels are not read
+	static bool readCacheLayout(const std::string& fullFilePath, Wolf::Format format, Wolf::Extent3D& outExtent, std::vector<uint64_t>& outLevelSizes);
+	static bool readCachedMipLevel(const std::string& fullFilePath, Wolf::Format format, uint32_t mipLevel, std::vector<uint8_t>& outData);
 	static void loadImageFile(const std::string& filename, Wolf::Format format, bool loadMips, std::vector<Wolf::ImageCompression::RGBA8>& pixels, std::vector<std::vector<Wolf::ImageCompression::RGBA8>>& mipLevels, Wolf::Extent3D& outExtent);
 	static void loadImageFile(const std::string& filename, Wolf::Format format, bool loadMips, std::vector<Wolf::ImageCompression::RG32F>& pixels, std::vector<std::vector<Wolf::ImageCompression::RG32F>>& mipLevels, Wolf::Extent3D& outExtent);
 	static void loadImageFile(const std::string& filename, Wolf::Format format, bool loadMips, std::vector<Wolf::ImageCompression::RGBA32F>& pixels, std::vector<std::vector<Wolf::ImageCompression::RGBA32F>>& mipLevels, Wolf::Extent3D& outExtent);
@@ -37,7 +65,8 @@ public:
 
 private:
 	static void computeCachePaths(const std::string& inFullPath, Wolf::Format format, std::string& outCache, std::string& outSlicesFolder);
-	static constexpr uint64_t HASH = Wolf::HASH_IMAGE_FORMATTER_H ^ Wolf::HASH_IMAGE_FORMATTER_CPP;
+	static constexpr uint64_t HASH = Wolf::HASH_IMAGE_FORMATTER_H ^ Wolf::HASH_IMAGE_FORMATTER_CPP ^ Wolf::HASH_BLOCK_ENCODER_H ^ Wolf::HASH_BLOCK_ENCODER_CPP ^ Wolf::HASH_BANDED_IMAGE_COMPRESSOR_H ^
+		Wolf::HASH_MIP_CHAIN_BUILDER_H ^ Wolf::HASH_MIP_CHAIN_BUILDER_CPP;
 
 	KeepDataMode m_keepDataMode;
 	std::vector<uint8_t> m_pixels;
@@ -50,21 +79,49 @@ private:
 
 	static Wolf::ImageCompression::Compression findCompressionFromFormat(Wolf::Format format);
 	static Wolf::Format findUncompressedFormat(Wolf::Format format);
+	static MipChainBuilder::Settings computeMipChainSettings(Wolf::Format uncompressedFormat);
+	static Wolf::ImageCompression::RG32F computeNormalFromColor(const Wolf::ImageCompression::RGBA8& color); // RGBA8 normal map texel to normalized XY, as stored in BC5
 
 	// No virtual texture
 	Wolf::ResourceUniqueOwner<Wolf::Image> m_outputImage;
 
 	[[nodiscard]] bool createImageFileFromCache(const std::string& filename, Wolf::Format format);
+	// Levels in [firstReadMip, endReadMip) are read, others are skipped and left empty. Returns false when the cache is missing, outdated or stores another format
+	static bool readCacheFile(const std::string& cacheFilename, Wolf::Format format, uint32_t firstReadMip, uint32_t endReadMip, Wolf::Extent3D& outExtent, std::vector<std::vector<uint8_t>>& outLevels,
+		std::vector<uint64_t>* outLevelSizes = nullptr);
+	// Stand-in for a level which isn't streamed yet: each block (texel for uncompressed formats) of the next level is repeated 2x2
+	static void createPlaceholderLevel(Wolf::Format format, const Wolf::Extent3D& levelExtent, uint64_t levelSize, const std::vector<uint8_t>& nextLevelPixels, std::vector<uint8_t>& outPixels);
 	template <typename PixelType>
 	void createImageFileFromSource(const std::string& filename, Wolf::Format format);
 
 	void createImageFromData(Wolf::Extent3D extent, Wolf::Format format, const uint8_t* pixels, const std::vector<const unsigned char*>& mipLevels);
+	// Images are split in bands of block rows compressed on worker threads.
+	// Blocks are encoded independently and stored row after row, so the output is identical to a compress() call per image
+	static constexpr uint32_t COMPRESSION_BAND_BLOCK_ROW_COUNT = 8;
+	template <typename CompressionType, typename PixelType>
+	static void compressInParallel(const std::vector<Wolf::Extent3D>& extents, const std::vector<const std::vector<PixelType>*>& images, std::vector<std::vector<CompressionType>>& outBlocks);
 	template <typename CompressionType, typename PixelType>
 	void compressAndCreateImage(std::vector<std::vector<PixelType>>& mipLevels, const std::vector<PixelType>& pixels, Wolf::Extent3D& extent, Wolf::Format format, const std::string& filename, std::fstream& outCacheFile);
+	template <typename CompressionType>
+	void createImageAndWriteCache(const Wolf::Extent3D& extent, Wolf::Format format, const std::vector<std::vector<CompressionType>>& imagesBlocks, std::fstream& outCacheFile);
+
+	// Compressed formats are converted, mipped and compressed in bands so memory doesn't grow with the image height, see BandedImageCompressor.
+	// Returns false, before writing anything, for sources this can't handle (already compressed, size not multiple of 4) and when the Kaiser mip filter is selected,
+	// as it needs rows of the neighbour bands
+	template <typename PixelType>
+	[[nodiscard]] bool createImageFileFromSourceInBands(const std::string& filename, Wolf::Format format);
+	template <typename CompressionType, typename PixelType>
+	void compressInBandsAndCreateImage(const Wolf::ImageFileLoader& imageFileLoader, const Wolf::Extent3D& extent, Wolf::Format format, const std::string& filename, std::fstream& outCacheFile);
 
     // Virtual texture
 	std::string m_slicesFolder;
 
+	// Reads the cache manifest only, to avoid loading pixels if we don't need
+	static bool isSlicedCacheUpToDate(const std::string& slicesFolder, const std::string& sourceFilePath);
+	static bool readSliceFile(const std::string& binFilename, std::vector<uint8_t>& outData);
+	// Slices of the other layout (loose files when packed, archive otherwise) are left by previous builds and would be read instead of the current ones
+	void removeUnusedSliceFiles(bool packSlices) const;
+
     template <typename PixelType, typename CompressionType>
     void createSlicedCacheFromData(Wolf::Extent3D extent, const std::vector<PixelType>& pixels, const std::vector<std::vector<PixelType>>& mipLevels);
     template <typename PixelType, typename CompressionType>
@@ -74,6 +131,12 @@ private:
 template <typename PixelType>
 void ImageFormatter::createImageFileFromSource(const std::string& filename, Wolf::Format format)
 {
+	if constexpr (std::is_same_v<PixelType, Wolf::ImageCompression::RGBA8> || std::is_same_v<PixelType, Wolf::ImageCompression::RG32F>)
+	{
+		if (createImageFileFromSourceInBands<PixelType>(filename, format))
+			return;
+	}
+
 	std::vector<PixelType> pixels;
 	std::vector<std::vector<PixelType>> mipLevels;
 	Wolf::Extent3D extent;
@@ -98,8 +161,24 @@ void ImageFormatter::createImageFileFromSource(const std::string& filename, Wolf
 	/* Hash */
 	uint64_t hash = HASH;
 	outCacheFile.write(reinterpret_cast<char*>(&hash), sizeof(hash));
+	outCacheFile.write(reinterpret_cast<char*>(&format), sizeof(format));
 	outCacheFile.write(reinterpret_cast<char*>(&extent), sizeof(extent));
 
+	// Formats compressed by the editor only
+	if constexpr (std::is_same_v<PixelType, Wolf::ImageCompression::RGBA8>)
+	{
+		if (format == Wolf::Format::BC4_UNORM_BLOCK)
+		{
+			compressAndCreateImage<BlockEncoder::BC4>(mipLevels, pixels, extent, format, filename, outCacheFile);
+			return;
+		}
+		if (format == Wolf::Format::BC7_SRGB_BLOCK || format == Wolf::Format::BC7_UNORM_BLOCK)
+		{
+			compressAndCreateImage<BlockEncoder::BC7>(mipLevels, pixels, extent, format, filename, outCacheFile);
+			return;
+		}
+	}
+
 	Wolf::ImageCompression::Compression compression = findCompressionFromFormat(format);
 	if (compression == Wolf::ImageCompression::Compression::BC1)
 		compressAndCreateImage<Wolf::ImageCompression::BC1>(mipLevels, pixels, extent, Wolf::Format::BC1_RGB_SRGB_BLOCK, filename, outCacheFile);
@@ -137,12 +216,63 @@ void ImageFormatter::createImageFileFromSource(const std::string& filename, Wolf
 	outCacheFile.close();
 }
 
+template <typename CompressionType, typename PixelType>
+void ImageFormatter::compressInParallel(const std::vector<Wolf::Extent3D>& extents, const std::vector<const std::vector<PixelType>*>& images, std::vector<std::vector<CompressionType>>& outBlocks)
+{
+	struct Band
+	{
+		uint32_t imageIdx;
+		uint32_t firstBlockRow;
+		uint32_t blockRowCount; // 0 when the image can't be split
+	};
+	std::vector<Band> bands;
+
+	outBlocks.resize(images.size());
+	for (uint32_t imageIdx = 0; imageIdx < images.size(); ++imageIdx)
+	{
+		const Wolf::Extent3D& extent = extents[imageIdx];
+		if (extent.width % 4 != 0 || extent.height % 4 != 0 || extent.depth != 1)
+		{
+			bands.push_back({ imageIdx, 0, 0 });
+			continue;
+		}
+
+		const uint32_t blockRowCount = extent.height / 4;
+		outBlocks[imageIdx].resize(static_cast<size_t>(extent.width / 4) * blockRowCount);
+		for (uint32_t firstBlockRow = 0; firstBlockRow < blockRowCount; firstBlockRow += COMPRESSION_BAND_BLOCK_ROW_COUNT)
+		{
+			bands.push_back({ imageIdx, firstBlockRow, std::min(COMPRESSION_BAND_BLOCK_ROW_COUNT, blockRowCount - firstBlockRow) });
+		}
+	}
+
+	parallelFor(static_cast<uint32_t>(bands.size()), [&](uint32_t bandIdx)
+		{
+			const Band& band = bands[bandIdx];
+			const Wolf::Extent3D& extent = extents[band.imageIdx];
+			const std::vector<PixelType>& pixels = *images[band.imageIdx];
+
+			if (band.blockRowCount == 0)
+			{
+				BlockEncoder::compress(extent, pixels, outBlocks[band.imageIdx]);
+				return;
+			}
+
+			const size_t firstPixelIdx = static_cast<size_t>(band.firstBlockRow) * 4 * extent.width;
+			const size_t bandPixelCount = static_cast<size_t>(band.blockRowCount) * 4 * extent.width;
+			const std::vector<PixelType> bandPixels(pixels.begin() + firstPixelIdx, pixels.begin() + firstPixelIdx + bandPixelCount);
+
+			std::vector<CompressionType> bandBlocks;
+			BlockEncoder::compress({ extent.width, band.blockRowCount * 4, 1 }, bandPixels, bandBlocks);
+			std::copy(bandBlocks.begin(), bandBlocks.end(), outBlocks[band.imageIdx].begin() + static_cast<size_t>(band.firstBlockRow) * (extent.width / 4));
+		}, g_editorConfiguration->getCompressionThreadCount());
+}
+
 template <typename CompressionType, typename PixelType>
 void ImageFormatter::compressAndCreateImage(std::vector<std::vector<PixelType>>& mipLevels, const std::vector<PixelType>& pixels, Wolf::Extent3D& extent, Wolf::Format format, const std::string& filename, std::fstream& outCacheFile)
 {
-	std::vector<CompressionType> compressedBlocks;
-	std::vector<std::vector<CompressionType>> mipBlocks(mipLevels.size());
-	Wolf::ImageCompression::compress(extent, pixels, compressedBlocks);
+	// All mips are compressed at once, first image is the full resolution
+	std::vector<Wolf::Extent3D> imageExtents = { extent };
+	std::vector<const std::vector<PixelType>*> images = { &pixels };
 	uint32_t mipWidth = extent.width / 2;
 	uint32_t mipHeight = extent.height / 2;
 	for (uint32_t i = 0; i < mipLevels.size(); ++i)
@@ -152,37 +282,136 @@ void ImageFormatter::compressAndCreateImage(std::vector<std::vector<PixelType>>&
 		{
 			Wolf::Debug::sendWarning("Image " + filename + " resolution is not a power of 2, not all mips are generated");
 			mipLevels.resize(i);
-			mipBlocks.resize(i);
 			break;
 		}
 
-		Wolf::ImageCompression::compress({ mipWidth, mipHeight, 1 }, mipLevels[i], mipBlocks[i]);
+		imageExtents.push_back({ mipWidth, mipHeight, 1 });
+		images.push_back(&mipLevels[i]);
 
 		mipWidth /= 2;
 		mipHeight /= 2;
 	}
 
-	std::vector<const unsigned char*> mipsData(mipBlocks.size());
-	for (uint32_t i = 0; i < mipBlocks.size(); ++i)
+	std::vector<std::vector<CompressionType>> imagesBlocks;
+	compressInParallel(imageExtents, images, imagesBlocks);
+	createImageAndWriteCache(extent, format, imagesBlocks, outCacheFile);
+}
+
+template <typename CompressionType>
+void ImageFormatter::createImageAndWriteCache(const Wolf::Extent3D& extent, Wolf::Format format, const std::vector<std::vector<CompressionType>>& imagesBlocks, std::fstream& outCacheFile)
+{
+	const std::vector<CompressionType>& compressedBlocks = imagesBlocks[0];
+	const uint32_t mipsCount = static_cast<uint32_t>(imagesBlocks.size()) - 1;
+
+	std::vector<const unsigned char*> mipsData(mipsCount);
+	for (uint32_t i = 0; i < mipsCount; ++i)
 	{
-		mipsData[i] = reinterpret_cast<const unsigned char*>(mipBlocks[i].data());
+		mipsData[i] = reinterpret_cast<const unsigned char*>(imagesBlocks[i + 1].data());
 	}
 	createImageFromData(extent, format, reinterpret_cast<const unsigned char*>(compressedBlocks.data()), mipsData);
 
 	// Add to cache
 	uint32_t dataBytesCount = static_cast<uint32_t>(compressedBlocks.size() * sizeof(CompressionType));
-	outCacheFile.write(reinterpret_cast<char*>(&dataBytesCount), sizeof(dataBytesCount));
-	outCacheFile.write(reinterpret_cast<char*>(compressedBlocks.data()), dataBytesCount);
+	outCacheFile.write(reinterpret_cast<const char*>(&dataBytesCount), sizeof(dataBytesCount));
+	outCacheFile.write(reinterpret_cast<const char*>(compressedBlocks.data()), dataBytesCount);
 
-	uint32_t mipsCount = static_cast<uint32_t>(mipBlocks.size());
-	outCacheFile.write(reinterpret_cast<char*>(&mipsCount), sizeof(mipsCount));
+	outCacheFile.write(reinterpret_cast<const char*>(&mipsCount), sizeof(mipsCount));
 
 	for (uint32_t i = 0; i < mipsCount; ++i)
 	{
-		dataBytesCount = static_cast<uint32_t>(mipBlocks[i].size() * sizeof(CompressionType));
-		outCacheFile.write(reinterpret_cast<char*>(&dataBytesCount), sizeof(dataBytesCount));
-		outCacheFile.write(reinterpret_cast<char*>(mipBlocks[i].data()), dataBytesCount);
+		dataBytesCount = static_cast<uint32_t>(imagesBlocks[i + 1].size() * sizeof(CompressionType));
+		outCacheFile.write(reinterpret_cast<const char*>(&dataBytesCount), sizeof(dataBytesCount));
+		outCacheFile.write(reinterpret_cast<const char*>(imagesBlocks[i + 1].data()), dataBytesCount);
+	}
+}
+
+template <typename PixelType>
+bool ImageFormatter::createImageFileFromSourceInBands(const std::string& filename, Wolf::Format format)
+{
+	const Wolf::ImageCompression::Compression compression = findCompressionFromFormat(format);
+	const bool isCompressedByEditorOnly = format == Wolf::Format::BC4_UNORM_BLOCK || format == Wolf::Format::BC7_SRGB_BLOCK || format == Wolf::Format::BC7_UNORM_BLOCK;
+	if (m_loadMips && computeMipChainSettings(findUncompressedFormat(format)).m_filter != MipChainBuilder::Filter::BOX)
+		return false;
+
+	if constexpr (std::is_same_v<PixelType, Wolf::ImageCompression::RG32F>)
+	{
+		if (compression != Wolf::ImageCompression::Compression::BC5)
+			return false;
+	}
+	else if (compression == Wolf::ImageCompression::Compression::NO_COMPRESSION && !isCompressedByEditorOnly)
+	{
+		return false;
+	}
+
+	// Sources the bands can't handle are rare, they are loaded again by the full image path
+	const Wolf::ImageFileLoader imageFileLoader(filename, false);
+	Wolf::Extent3D extent = { imageFileLoader.getWidth(), imageFileLoader.getHeight(), 1 };
+	if (imageFileLoader.getCompression() != Wolf::ImageCompression::Compression::NO_COMPRESSION || extent.width == 0 || extent.height == 0 || extent.width % 4 != 0 || extent.height % 4 != 0)
+		return false;
+
+	Wolf::Debug::sendInfo("Creating new cache: " + m_cacheFilename);
+
+	std::fstream outCacheFile(m_cacheFilename, std::ios::out | std::ios::binary);
+
+	/* Hash */
+	uint64_t hash = HASH;
+	outCacheFile.write(reinterpret_cast<char*>(&hash), sizeof(hash));
+	outCacheFile.write(reinterpret_cast<char*>(&format), sizeof(format));
+	outCacheFile.write(reinterpret_cast<char*>(&extent), sizeof(extent));
+
+	if constexpr (std::is_same_v<PixelType, Wolf::ImageCompression::RG32F>)
+	{
+		compressInBandsAndCreateImage<Wolf::ImageCompression::BC5, PixelType>(imageFileLoader, extent, Wolf::Format::BC5_UNORM_BLOCK, filename, outCacheFile);
 	}
+	else
+	{
+		if (format == Wolf::Format::BC4_UNORM_BLOCK)
+			compressInBandsAndCreateImage<BlockEncoder::BC4, PixelType>(imageFileLoader, extent, format, filename, outCacheFile);
+		else if (format == Wolf::Format::BC7_SRGB_BLOCK || format == Wolf::Format::BC7_UNORM_BLOCK)
+			compressInBandsAndCreateImage<BlockEncoder::BC7, PixelType>(imageFileLoader, extent, format, filename, outCacheFile);
+		else if (compression == Wolf::ImageCompression::Compression::BC1)
+			compressInBandsAndCreateImage<Wolf::ImageCompression::BC1, PixelType>(imageFileLoader, extent, Wolf::Format::BC1_RGB_SRGB_BLOCK, filename, outCacheFile);
+		else
+			compressInBandsAndCreateImage<Wolf::ImageCompression::BC3, PixelType>(imageFileLoader, extent, Wolf::Format::BC3_SRGB_BLOCK, filename, outCacheFile);
+	}
+
+	outCacheFile.close();
+	return true;
+}
+
+template <typename CompressionType, typename PixelType>
+void ImageFormatter::compressInBandsAndCreateImage(const Wolf::ImageFileLoader& imageFileLoader, const Wolf::Extent3D& extent, Wolf::Format format, const std::string& filename, std::fstream& outCacheFile)
+{
+	const uint32_t mipCount = BandedImageCompressor<PixelType, CompressionType>::computeMipCount(extent, m_loadMips ? std::numeric_limits<uint32_t>::max() : 1);
+	if (m_loadMips && ((extent.width & (extent.width - 1)) != 0 || (extent.height & (extent.height - 1)) != 0))
+	{
+		Wolf::Debug::sendWarning("Image " + filename + " resolution is not a power of 2, not all mips are generated");
+	}
+
+	// Source stays in its file format (RGBA8), pixels are converted one group of rows at a time
+	const Wolf::ImageCompression::RGBA8* sourcePixels = reinterpret_cast<const Wolf::ImageCompression::RGBA8*>(imageFileLoader.getPixels());
+
+	BandedImageCompressor<PixelType, CompressionType> bandedImageCompressor(extent, mipCount, computeMipChainSettings(findUncompressedFormat(format)).m_content,
+		g_editorConfiguration->getImageImportMemoryBudget());
+	bandedImageCompressor.compress([&](uint32_t firstRow, uint32_t rowCount, PixelType* outPixels)
+		{
+			const Wolf::ImageCompression::RGBA8* rowsSourcePixels = sourcePixels + static_cast<size_t>(firstRow) * extent.width;
+			const size_t pixelCount = static_cast<size_t>(rowCount) * extent.width;
+
+			if constexpr (std::is_same_v<PixelType, Wolf::ImageCompression::RG32F>)
+			{
+				for (size_t i = 0; i < pixelCount; ++i)
+				{
+					outPixels[i] = computeNormalFromColor(rowsSourcePixels[i]);
+				}
+			}
+			else
+			{
+				memcpy(outPixels, rowsSourcePixels, pixelCount * sizeof(PixelType));
+			}
+		}, g_editorConfiguration->getCompressionThreadCount());
+
+	createImageAndWriteCache(extent, format, bandedImageCompressor.getLevelBlocks(), outCacheFile);
 }
 
 template <typename PixelType, typename CompressionType>
@@ -205,132 +434,236 @@ void ImageFormatter::createSlicedCacheFromData(Wolf::Extent3D extent, const std:
 
 	Wolf::Extent3D maxSliceExtent{ Wolf::VirtualTextureManager::VIRTUAL_PAGE_SIZE, Wolf::VirtualTextureManager::VIRTUAL_PAGE_SIZE, 1 };
 
-	for (uint32_t mipLevel = 0; mipLevel < mipLevels.size() + 1; ++mipLevel)
+	const bool packSlices = g_editorConfiguration->getPackVirtualTextureSlices();
+	const std::string manifestFilename = m_slicesFolder + SliceCacheManifest::FILENAME;
+	const std::string archiveFilename = m_slicesFolder + SliceArchive::FILENAME;
+
+	SliceCacheManifest::Parameters parameters;
+	parameters.m_codeHash = HASH;
+	SliceCacheManifest::computeSourceFileInfo(m_originFilename, parameters.m_sourceFileSize, parameters.m_sourceLastWriteTime);
+	parameters.m_width = extent.width;
+	parameters.m_height = extent.height;
+	parameters.m_mipCount = static_cast<uint32_t>(mipLevels.size()) + 1;
+	parameters.m_pageSize = Wolf::VirtualTextureManager::VIRTUAL_PAGE_SIZE;
+	parameters.m_borderSize = Wolf::VirtualTextureManager::BORDER_SIZE;
+	parameters.m_blockSize = sizeof(CompressionType);
+	parameters.m_isPacked = packSlices ? 1 : 0;
+
+	// Slices are independent: each task extracts, compresses and writes a single slice.
+	// Memory stays bounded to about one slice per thread: tasks are taken in order, slices are written as soon as they are ready, or once the previous ones are for the archive.
+	// Tasks are ordered as slices in the manifest and the archive
+	struct SliceTask
 	{
-		Wolf::Extent3D extentForMip = { extent.width >> mipLevel, extent.height >> mipLevel, 1 };
-
-		const uint32_t sliceCountX = std::max(extentForMip.width / maxSliceExtent.width, 1u);
-		const uint32_t sliceCountY = std::max(extentForMip.height / maxSliceExtent.height, 1u);
+		uint32_t mipLevel;
+		uint32_t sliceX;
+		uint32_t sliceY;
+	};
+	std::vector<SliceTask> sliceTasks;
+	std::vector<SliceArchive::MipInfo> mips(parameters.m_mipCount);
+	for (uint32_t mipLevel = 0; mipLevel < mips.size(); ++mipLevel)
+	{
+		mips[mipLevel].m_sliceCountX = std::max((extent.width >> mipLevel) / maxSliceExtent.width, 1u);
+		mips[mipLevel].m_sliceCountY = std::max((extent.height >> mipLevel) / maxSliceExtent.height, 1u);
 
-		for (uint32_t sliceX = 0; sliceX < sliceCountX; ++sliceX)
+		for (uint32_t sliceY = 0; sliceY < mips[mipLevel].m_sliceCountY; ++sliceY)
 		{
-			for (uint32_t sliceY = 0; sliceY < sliceCountY; ++sliceY)
+			for (uint32_t sliceX = 0; sliceX < mips[mipLevel].m_sliceCountX; ++sliceX)
 			{
-				std::string binFilename = m_slicesFolder + "mip" + std::to_string(mipLevel) + "_sliceX" + std::to_string(sliceX) + "_sliceY" + std::to_string(sliceY) + ".bin";
-				if (std::filesystem::exists(binFilename))
-				{
-					std::ifstream input(binFilename, std::ios::in | std::ios::binary);
+				sliceTasks.push_back({ mipLevel, sliceX, sliceY });
+			}
+		}
+	}
 
-					uint64_t hash;
-					input.read(reinterpret_cast<char*>(&hash), sizeof(hash));
-					if (hash == HASH)
-					{
-						continue;
-					}
+	// Slices of the previous build are reused when their source pixels didn't change.
+	// Their stored data is trusted if the previous build is complete and has the same parameters, otherwise it's checked against its hash
+	SliceCacheManifest previousManifest;
+	const bool hasPreviousManifest = previousManifest.load(manifestFilename);
+	const bool canReusePreviousSlices = hasPreviousManifest && previousManifest.getParameters().isLayoutCompatible(parameters) && previousManifest.getSliceCount() == sliceTasks.size();
+	const bool isPreviousBuildTrusted = canReusePreviousSlices && previousManifest.isComplete() && previousManifest.getParameters() == parameters;
+	if (hasPreviousManifest)
+	{
+		// Slices are about to be overwritten, an interrupted build must not be considered valid
+		previousManifest.setIsComplete(false);
+		previousManifest.save(manifestFilename);
+	}
 
-					Wolf::Debug::sendInfo(binFilename + " found but hash is incorrect");
+	SliceCacheManifest manifest(parameters, static_cast<uint32_t>(sliceTasks.size()));
+	std::atomic<uint32_t> reusedSliceCount = 0;
+
+	std::unique_ptr<SliceArchive::Reader> previousSliceArchive;
+	std::unique_ptr<SliceArchive::Writer> sliceArchive;
+	if (packSlices)
+	{
+		if (canReusePreviousSlices)
+			previousSliceArchive.reset(new SliceArchive::Reader(archiveFilename));
+		sliceArchive.reset(new SliceArchive::Writer(archiveFilename + ".tmp", HASH, mips, sizeof(CompressionType), true));
+	}
+
+	parallelFor(static_cast<uint32_t>(sliceTasks.size()), [&](uint32_t taskIdx)
+		{
+			const uint32_t mipLevel = sliceTasks[taskIdx].mipLevel;
+			const uint32_t sliceX = sliceTasks[taskIdx].sliceX;
+			const uint32_t sliceY = sliceTasks[taskIdx].sliceY;
+
+			Wolf::Extent3D extentForMip = { extent.width >> mipLevel, extent.height >> mipLevel, 1 };
+			const uint32_t sliceCountX = std::max(extentForMip.width / maxSliceExtent.width, 1u);
+			const uint32_t sliceCountY = std::max(extentForMip.height / maxSliceExtent.height, 1u);
+
+			std::string binFilename = m_slicesFolder + "mip" + std::to_string(mipLevel) + "_sliceX" + std::to_string(sliceX) + "_sliceY" + std::to_string(sliceY) + ".bin";
+
+			Wolf::Extent3D pixelsToCompressExtent{ std::min(extentForMip.width, maxSliceExtent.width), std::min(extentForMip.height, maxSliceExtent.height), 1 };
+			pixelsToCompressExtent.width += 2 * Wolf::VirtualTextureManager::BORDER_SIZE;
+			pixelsToCompressExtent.height += 2 * Wolf::VirtualTextureManager::BORDER_SIZE;
+			std::vector<PixelType> pixelsToCompress(pixelsToCompressExtent.width * pixelsToCompressExtent.height);
+
+			const std::vector<PixelType>& allPixelsSrc = mipLevel == 0 ? pixels : mipLevels[mipLevel - 1];
+			for (uint32_t line = 0; line < pixelsToCompressExtent.height; ++line)
+			{
+				uint32_t srcY = sliceY * maxSliceExtent.width + line - Wolf::VirtualTextureManager::BORDER_SIZE;
+				if (sliceY == 0 && line < Wolf::VirtualTextureManager::BORDER_SIZE)
+				{
+					srcY = extentForMip.height - Wolf::VirtualTextureManager::BORDER_SIZE + line;
 				}
-				else
+				else if (sliceY == sliceCountY - 1 && line >= pixelsToCompressExtent.height - Wolf::VirtualTextureManager::BORDER_SIZE)
 				{
-					Wolf::Debug::sendInfo(binFilename + " not found");
+					srcY = line - std::min(extentForMip.width, maxSliceExtent.width) - Wolf::VirtualTextureManager::BORDER_SIZE;
 				}
 
-				std::fstream outCacheFile(binFilename, std::ios::out | std::ios::binary);
+				uint32_t srcX = sliceX * maxSliceExtent.width;
 
-				/* Hash */
-				uint64_t hash = HASH;
-				outCacheFile.write(reinterpret_cast<char*>(&hash), sizeof(hash));
+				const PixelType* src = &allPixelsSrc[srcY * extentForMip.width + srcX];
+				PixelType* dst = &pixelsToCompress[line * pixelsToCompressExtent.width + Wolf::VirtualTextureManager::BORDER_SIZE];
 
-				Wolf::Extent3D pixelsToCompressExtent{ std::min(extentForMip.width, maxSliceExtent.width), std::min(extentForMip.height, maxSliceExtent.height), 1 };
-				pixelsToCompressExtent.width += 2 * Wolf::VirtualTextureManager::BORDER_SIZE;
-				pixelsToCompressExtent.height += 2 * Wolf::VirtualTextureManager::BORDER_SIZE;
-				std::vector<PixelType> pixelsToCompress(pixelsToCompressExtent.width * pixelsToCompressExtent.height);
+				memcpy(dst, src, std::min(extentForMip.width, maxSliceExtent.width) * sizeof(PixelType)); // copy without left and right border
 
-				const std::vector<PixelType>& allPixelsSrc = mipLevel == 0 ? pixels : mipLevels[mipLevel - 1];
-				for (uint32_t line = 0; line < pixelsToCompressExtent.height; ++line)
+				// Left border
+				for (uint32_t i = 0; i < Wolf::VirtualTextureManager::BORDER_SIZE; ++i)
 				{
-					uint32_t srcY = sliceY * maxSliceExtent.width + line - Wolf::VirtualTextureManager::BORDER_SIZE;
-					if (sliceY == 0 && line < Wolf::VirtualTextureManager::BORDER_SIZE)
+					// Left border
+					PixelType& leftBorderPixelSrc = pixelsToCompress[line * pixelsToCompressExtent.width + i];
+					if (sliceX == 0)
 					{
-						srcY = extentForMip.height - Wolf::VirtualTextureManager::BORDER_SIZE + line;
+						leftBorderPixelSrc = allPixelsSrc[srcY * extentForMip.width + extentForMip.width - Wolf::VirtualTextureManager::BORDER_SIZE + i];
 					}
-					else if (sliceY == sliceCountY - 1 && line >= pixelsToCompressExtent.height - Wolf::VirtualTextureManager::BORDER_SIZE)
+					else
 					{
-						srcY = line - std::min(extentForMip.width, maxSliceExtent.width) - Wolf::VirtualTextureManager::BORDER_SIZE;
+						leftBorderPixelSrc = allPixelsSrc[srcY * extentForMip.width + srcX - Wolf::VirtualTextureManager::BORDER_SIZE + i];
 					}
 
-					uint32_t srcX = sliceX * maxSliceExtent.width;
-
-					const PixelType* src = &allPixelsSrc[srcY * extentForMip.width + srcX];
-					PixelType* dst = &pixelsToCompress[line * pixelsToCompressExtent.width + Wolf::VirtualTextureManager::BORDER_SIZE];
-
-					memcpy(dst, src, std::min(extentForMip.width, maxSliceExtent.width) * sizeof(PixelType)); // copy without left and right border
-
-					// Left border
-					for (uint32_t i = 0; i < Wolf::VirtualTextureManager::BORDER_SIZE; ++i)
+					// Right border
+					PixelType& rightBorderPixelSrc = pixelsToCompress[line * pixelsToCompressExtent.width + pixelsToCompressExtent.width - Wolf::VirtualTextureManager::BORDER_SIZE + i];
+					if (sliceX == sliceCountX - 1)
+					{
+						rightBorderPixelSrc = allPixelsSrc[srcY * extentForMip.width + i];
+					}
+					else
 					{
-						// Left border
-						PixelType& leftBorderPixelSrc = pixelsToCompress[line * pixelsToCompressExtent.width + i];
-						if (sliceX == 0)
-						{
-							leftBorderPixelSrc = allPixelsSrc[srcY * extentForMip.width + extentForMip.width - Wolf::VirtualTextureManager::BORDER_SIZE + i];
-						}
-						else
-						{
-							leftBorderPixelSrc = allPixelsSrc[srcY * extentForMip.width + srcX - Wolf::VirtualTextureManager::BORDER_SIZE + i];
-						}
-
-						// Right border
-						PixelType& rightBorderPixelSrc = pixelsToCompress[line * pixelsToCompressExtent.width + pixelsToCompressExtent.width - Wolf::VirtualTextureManager::BORDER_SIZE + i];
-						if (sliceX == sliceCountX - 1)
-						{
-							rightBorderPixelSrc = allPixelsSrc[srcY * extentForMip.width + i];
-						}
-						else
-						{
-							rightBorderPixelSrc = allPixelsSrc[srcY * extentForMip.width + srcX + maxSliceExtent.width + i];
-						}
+						rightBorderPixelSrc = allPixelsSrc[srcY * extentForMip.width + srcX + maxSliceExtent.width + i];
 					}
 				}
+			}
 
-				if (std::is_same<CompressionType, Wolf::ImageCompression::RGBA8>::value)
-				{
-					uint32_t dataBytesCount = static_cast<uint32_t>(pixelsToCompress.size() * sizeof(CompressionType));
-					outCacheFile.write(reinterpret_cast<char*>(&dataBytesCount), sizeof(dataBytesCount));
-					outCacheFile.write(reinterpret_cast<char*>(pixelsToCompress.data()), dataBytesCount);
-				}
-				else
+			const uint64_t sourceHash = SliceCacheManifest::computeHash(pixelsToCompress.data(), pixelsToCompress.size() * sizeof(PixelType));
+			if (canReusePreviousSlices)
+			{
+				const SliceCacheManifest::SliceInfo& previousSliceInfo = previousManifest.getSliceInfo(taskIdx);
+				if (previousSliceInfo.m_isBuilt && previousSliceInfo.m_sourceHash == sourceHash)
 				{
-					std::vector<CompressionType> compressedBlocks;
-					Wolf::ImageCompression::compress(pixelsToCompressExtent, pixelsToCompress, compressedBlocks);
+					std::error_code errorCode;
+					if (!sliceArchive && isPreviousBuildTrusted && std::filesystem::file_size(binFilename, errorCode) == sizeof(HASH) + sizeof(uint32_t) + previousSliceInfo.m_size)
+					{
+						manifest.setSliceInfo(taskIdx, previousSliceInfo);
+						reusedSliceCount++;
+						return;
+					}
 
-					uint32_t dataBytesCount = static_cast<uint32_t>(compressedBlocks.size() * sizeof(CompressionType));
-					outCacheFile.write(reinterpret_cast<char*>(&dataBytesCount), sizeof(dataBytesCount));
-					outCacheFile.write(reinterpret_cast<char*>(compressedBlocks.data()), dataBytesCount);
+					std::vector<uint8_t> previousData;
+					const bool isPreviousDataRead = sliceArchive ? previousSliceArchive->readSlice(mipLevel, sliceX, sliceY, previousData) : readSliceFile(binFilename, previousData);
+					if (isPreviousDataRead && previousData.size() == previousSliceInfo.m_size &&
+						SliceCacheManifest::computeHash(previousData.data(), previousData.size()) == previousSliceInfo.m_contentHash)
+					{
+						if (sliceArchive)
+							sliceArchive->writeSlice(mipLevel, sliceX, sliceY, previousData.data(), previousSliceInfo.m_size);
+						manifest.setSliceInfo(taskIdx, previousSliceInfo);
+						reusedSliceCount++;
+						return;
+					}
 				}
+			}
+
+			const char* sliceData;
+			uint32_t dataBytesCount;
+			std::vector<CompressionType> compressedBlocks;
+			if (std::is_same<CompressionType, Wolf::ImageCompression::RGBA8>::value)
+			{
+				sliceData = reinterpret_cast<const char*>(pixelsToCompress.data());
+				dataBytesCount = static_cast<uint32_t>(pixelsToCompress.size() * sizeof(CompressionType));
+			}
+			else
+			{
+				BlockEncoder::compress(pixelsToCompressExtent, pixelsToCompress, compressedBlocks);
+
+				sliceData = reinterpret_cast<const char*>(compressedBlocks.data());
+				dataBytesCount = static_cast<uint32_t>(compressedBlocks.size() * sizeof(CompressionType));
+			}
+
+			if (sliceArchive)
+			{
+				sliceArchive->writeSlice(mipLevel, sliceX, sliceY, reinterpret_cast<const uint8_t*>(sliceData), dataBytesCount);
+			}
+			else
+			{
+				std::fstream outCacheFile(binFilename, std::ios::out | std::ios::binary);
+
+				/* Hash */
+				uint64_t hash = HASH;
+				outCacheFile.write(reinterpret_cast<char*>(&hash), sizeof(hash));
 
+				outCacheFile.write(reinterpret_cast<char*>(&dataBytesCount), sizeof(dataBytesCount));
+				outCacheFile.write(sliceData, dataBytesCount);
 
 				outCacheFile.close();
 			}
+
+			SliceCacheManifest::SliceInfo sliceInfo;
+			sliceInfo.m_sourceHash = sourceHash;
+			sliceInfo.m_contentHash = SliceCacheManifest::computeHash(sliceData, dataBytesCount);
+			sliceInfo.m_size = dataBytesCount;
+			sliceInfo.m_isBuilt = 1;
+			manifest.setSliceInfo(taskIdx, sliceInfo);
+		}, g_editorConfiguration->getCompressionThreadCount());
+
+	Wolf::Debug::sendInfo("Slices of " + m_originFilename + ": " + std::to_string(sliceTasks.size() - reusedSliceCount) + " built, " + std::to_string(reusedSliceCount) + " reused");
+
+	if (sliceArchive)
+	{
+		const bool isArchiveWritten = sliceArchive->finalize();
+
+		// Files must be closed before replacing the previous archive
+		sliceArchive.reset();
+		previousSliceArchive.reset();
+
+		std::error_code errorCode;
+		if (isArchiveWritten)
+			std::filesystem::rename(archiveFilename + ".tmp", archiveFilename, errorCode);
+		if (!isArchiveWritten || errorCode)
+		{
+			Wolf::Debug::sendError("Failed to write slice archive for " + m_originFilename);
+			return;
 		}
 	}
+	removeUnusedSliceFiles(packSlices);
+
+	manifest.setIsComplete(true);
+	manifest.save(manifestFilename);
 }
 
 template <typename PixelType, typename CompressionType>
 void ImageFormatter::createSlicedCacheFromFile(const std::string& filename, bool sRGB, Wolf::Format format)
 {
-	// Check 1st file to avoid loading pixels if we don't need
-	std::string binFilename = m_slicesFolder + "mip0_sliceX0_sliceY0.bin";
-	if (std::filesystem::exists(binFilename) && m_keepDataMode == KeepDataMode::ONLY_GPU) // need to re-read the file if we want data on CPU
+	if ((m_keepDataMode == KeepDataMode::ONLY_GPU || m_keepDataMode == KeepDataMode::ONLY_CACHE) && isSlicedCacheUpToDate(m_slicesFolder, filename)) // need to re-read the file if we want data on CPU
 	{
-		std::ifstream input(binFilename, std::ios::in | std::ios::binary);
-
-		uint64_t hash;
-		input.read(reinterpret_cast<char*>(&hash), sizeof(hash));
-		if (hash == HASH)
-		{
-			return; // we assume cache is ready
-		}
+		return;
 	}
 
 	Wolf::Format uncompressedFormat = findUncompressedFormat(format);
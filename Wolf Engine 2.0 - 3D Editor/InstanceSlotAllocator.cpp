@@ -0,0 +1,157 @@
+#include "InstanceSlotAllocator.h"
+
+#include <algorithm>
+
+InstanceSlotAllocator::InstanceSlotAllocator(uint32_t maxSlotCount) : m_maxSlotCount(maxSlotCount)
+{
+	clear();
+}
+
+uint32_t InstanceSlotAllocator::allocate(uint64_t ownerKey, uint32_t count)
+{
+	auto ownerIt = m_ownerRanges.find(ownerKey);
+	if (ownerIt != m_ownerRanges.end())
+	{
+		SlotRange& currentRange = ownerIt->second;
+		if (count <= currentRange.m_count)
+		{
+			// Shrink in place
+			if (count < currentRange.m_count)
+			{
+				addFreeRange(currentRange.m_firstSlot + count, currentRange.m_count - count);
+				m_usedSlotCount -= currentRange.m_count - count;
+				currentRange.m_count = count;
+			}
+			return currentRange.m_firstSlot;
+		}
+
+		release(ownerKey);
+	}
+
+	if (count == 0)
+	{
+		m_ownerRanges[ownerKey] = { 0, 0 };
+		return 0;
+	}
+
+	// First fit keeps used slots packed at the beginning of the array
+	for (auto freeIt = m_freeRanges.begin(); freeIt != m_freeRanges.end(); ++freeIt)
+	{
+		if (freeIt->second < count)
+			continue;
+
+		const uint32_t firstSlot = freeIt->first;
+		const uint32_t remainingCount = freeIt->second - count;
+		m_freeRanges.erase(freeIt);
+		if (remainingCount > 0)
+		{
+			m_freeRanges[firstSlot + count] = remainingCount;
+		}
+
+		m_ownerRanges[ownerKey] = { firstSlot, count };
+		m_usedSlotCount += count;
+		return firstSlot;
+	}
+
+	return INVALID_SLOT;
+}
+
+void InstanceSlotAllocator::release(uint64_t ownerKey)
+{
+	auto ownerIt = m_ownerRanges.find(ownerKey);
+	if (ownerIt == m_ownerRanges.end())
+		return;
+
+	if (ownerIt->second.m_count > 0)
+	{
+		addFreeRange(ownerIt->second.m_firstSlot, ownerIt->second.m_count);
+		m_usedSlotCount -= ownerIt->second.m_count;
+	}
+	m_ownerRanges.erase(ownerIt);
+}
+
+void InstanceSlotAllocator::clear()
+{
+	m_ownerRanges.clear();
+	m_freeRanges.clear();
+	if (m_maxSlotCount > 0)
+	{
+		m_freeRanges[0] = m_maxSlotCount;
+	}
+	m_usedSlotCount = 0;
+	m_dirtyRanges.clear();
+}
+
+bool InstanceSlotAllocator::getRange(uint64_t ownerKey, SlotRange& outRange) const
+{
+	auto ownerIt = m_ownerRanges.find(ownerKey);
+	if (ownerIt == m_ownerRanges.end())
+		return false;
+
+	outRange = ownerIt->second;
+	return true;
+}
+
+uint32_t InstanceSlotAllocator::getSlotHighWatermark() const
+{
+	if (m_freeRanges.empty())
+		return m_maxSlotCount;
+
+	// Free ranges are merged so, if the last slot is free, the last free range ends the used part of the array
+	const auto& [lastFreeFirstSlot, lastFreeCount] = *m_freeRanges.rbegin();
+	return lastFreeFirstSlot + lastFreeCount == m_maxSlotCount ? lastFreeFirstSlot : m_maxSlotCount;
+}
+
+void InstanceSlotAllocator::markDirty(uint32_t firstSlot, uint32_t count)
+{
+	if (count > 0)
+	{
+		m_dirtyRanges.push_back({ firstSlot, count });
+	}
+}
+
+void InstanceSlotAllocator::popDirtyRanges(std::vector<SlotRange>& outRanges)
+{
+	outRanges.clear();
+
+	std::sort(m_dirtyRanges.begin(), m_dirtyRanges.end(), [](const SlotRange& a, const SlotRange& b) { return a.m_firstSlot < b.m_firstSlot; });
+	for (const SlotRange& dirtyRange : m_dirtyRanges)
+	{
+		if (!outRanges.empty() && dirtyRange.m_firstSlot <= outRanges.back().m_firstSlot + outRanges.back().m_count)
+		{
+			SlotRange& lastRange = outRanges.back();
+			lastRange.m_count = std::max(lastRange.m_firstSlot + lastRange.m_count, dirtyRange.m_firstSlot + dirtyRange.m_count) - lastRange.m_firstSlot;
+		}
+		else
+		{
+			outRanges.push_back(dirtyRange);
+		}
+	}
+
+	m_dirtyRanges.clear();
+}
+
+void InstanceSlotAllocator::addFreeRange(uint32_t firstSlot, uint32_t count)
+{
+	uint32_t mergedFirstSlot = firstSlot;
+	uint32_t mergedCount = count;
+
+	auto nextIt = m_freeRanges.lower_bound(firstSlot);
+	if (nextIt != m_freeRanges.end() && nextIt->first == firstSlot + count)
+	{
+		mergedCount += nextIt->second;
+		nextIt = m_freeRanges.erase(nextIt);
+	}
+	if (nextIt != m_freeRanges.begin())
+	{
+		auto previousIt = std::prev(nextIt);
+		if (previousIt->first + previousIt->second == firstSlot)
+		{
+			mergedFirstSlot = previousIt->first;
+			mergedCount += previousIt->second;
+			m_freeRanges.erase(previousIt);
+		}
+	}
+
+	m_freeRanges[mergedFirstSlot] = mergedCount;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+// Gives each owner a persistent, contiguous range of slots in a fixed size array and tracks which slots need to be re-uploaded.
+// Ranges only move when an owner grows past its current range, so unchanged owners never need to be rewritten.
+class InstanceSlotAllocator
+{
+public:
+	static constexpr uint32_t INVALID_SLOT = static_cast<uint32_t>(-1);
+
+	struct SlotRange
+	{
+		uint32_t m_firstSlot;
+		uint32_t m_count;
+	};
+
+	explicit InstanceSlotAllocator(uint32_t maxSlotCount);
+
+	// Returns the first slot of the owner range, INVALID_SLOT if there's no space left. Owner previous range is reused when possible
+	uint32_t allocate(uint64_t ownerKey, uint32_t count);
+	void release(uint64_t ownerKey);
+	void clear();
+
+	[[nodiscard]] bool getRange(uint64_t ownerKey, SlotRange& outRange) const;
+	[[nodiscard]] uint32_t getUsedSlotCount() const { return m_usedSlotCount; }
+	[[nodiscard]] uint32_t getSlotHighWatermark() const; // all used slots are below this value
+
+	void markDirty(uint32_t firstSlot, uint32_t count);
+	// Sorted, merged dirty ranges, dirty state is reset
+	void popDirtyRanges(std::vector<SlotRange>& outRanges);
+
+private:
+	void addFreeRange(uint32_t firstSlot, uint32_t count);
+
+	uint32_t m_maxSlotCount;
+	std::unordered_map<uint64_t, SlotRange> m_ownerRanges;
+	std::map<uint32_t, uint32_t> m_freeRanges; // first slot -> count, adjacent ranges are always merged
+	uint32_t m_usedSlotCount = 0;
+
+	std::vector<SlotRange> m_dirtyRanges;
+};
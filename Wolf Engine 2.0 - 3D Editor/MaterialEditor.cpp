@@ -124,6 +124,18 @@ bool MaterialEditor::TextureSet::hasDefaultName() const
 	return std::string(m_name) == DEFAULT_NAME;
 }
 
+void MaterialEditor::requestTextureResolution(uint32_t resolution) const
+{
+	for (uint32_t i = 0; i < m_textureSets.size(); ++i)
+	{
+		const AssetId textureSetAssetId = m_textureSets[i].getTextureSetAssetId();
+		if (textureSetAssetId != NO_ASSET && AssetManager::isTextureSet(textureSetAssetId))
+		{
+			m_assetManager->getTextureSetEditor(textureSetAssetId)->requestTextureResolution(resolution);
+		}
+	}
+}
+
 void MaterialEditor::TextureSet::setTextureSetPath(const std::string& path)
 {
 	m_textureSetAssetParam = path;
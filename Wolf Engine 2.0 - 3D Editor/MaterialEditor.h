@@ -32,6 +32,8 @@ public:
 
 	void addTextureSet(const std::string& textureSetPath, float strength);
 	uint32_t getTextureSetCount() const { return m_textureSets.size(); }
+	// 'resolution' is the on screen size of a surface using the material, forwarded to each texture set
+	void requestTextureResolution(uint32_t resolution) const;
 
 private:
 	inline static const std::string TAB = "Material";
@@ -62,6 +64,7 @@ private:
 		static constexpr uint32_t NO_TEXTURE_SET_IDX = -1;
 		uint32_t getTextureSetIdx() const;
 		float getStrength() const { return m_strength; }
+		AssetId getTextureSetAssetId() const { return m_textureSetAssetId; }
 
 	private:
 		inline static const std::string DEFAULT_NAME = "New texture set";
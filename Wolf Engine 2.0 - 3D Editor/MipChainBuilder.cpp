@@ -0,0 +1,424 @@
+#include "MipChainBuilder.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#include "ParallelFor.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define MIP_CHAIN_BUILDER_SSE
+#include <immintrin.h>
+#endif
+
+static_assert(sizeof(Wolf::ImageCompression::RGBA8) == 4);
+static_assert(sizeof(Wolf::ImageCompression::RG32F) == 2 * sizeof(float));
+static_assert(sizeof(Wolf::ImageCompression::RGBA32F) == 4 * sizeof(float));
+
+namespace
+{
+	// One pixel, 4 channels. SSE2 is always available on x64, other targets use the scalar version
+#ifdef MIP_CHAIN_BUILDER_SSE
+	struct Vec4
+	{
+		__m128 m_value;
+
+		static Vec4 zero() { return { _mm_setzero_ps() }; }
+		static Vec4 load(const float* values) { return { _mm_loadu_ps(values) }; }
+		void store(float* outValues) const { _mm_storeu_ps(outValues, m_value); }
+		Vec4 multiplyAdd(const Vec4& other, float weight) const { return { _mm_add_ps(m_value, _mm_mul_ps(other.m_value, _mm_set1_ps(weight))) }; }
+	};
+#else
+	struct Vec4
+	{
+		float m_value[4];
+
+		static Vec4 zero() { return { { 0.0f, 0.0f, 0.0f, 0.0f } }; }
+		static Vec4 load(const float* values) { return { { values[0], values[1], values[2], values[3] } }; }
+		void store(float* outValues) const { std::copy(m_value, m_value + 4, outValues); }
+		Vec4 multiplyAdd(const Vec4& other, float weight) const
+		{
+			return { { m_value[0] + other.m_value[0] * weight, m_value[1] + other.m_value[1] * weight, m_value[2] + other.m_value[2] * weight, m_value[3] + other.m_value[3] * weight } };
+		}
+	};
+#endif
+
+	// Destination texel i is the weighted sum of source texels [2i + m_firstOffset, 2i + m_firstOffset + m_tapCount)
+	struct Kernel
+	{
+		int32_t m_firstOffset;
+		uint32_t m_tapCount;
+		std::array<float, 6> m_weights;
+	};
+
+	float computeBesselI0(float x)
+	{
+		// Power series, converges quickly for the small arguments of the window
+		float result = 1.0f;
+		float term = 1.0f;
+		for (uint32_t k = 1; k < 32; ++k)
+		{
+			term *= (x / (2.0f * static_cast<float>(k))) * (x / (2.0f * static_cast<float>(k)));
+			result += term;
+		}
+		return result;
+	}
+
+	Kernel computeKaiserKernel()
+	{
+		constexpr float ALPHA = 4.0f;
+		constexpr float HALF_WIDTH = 1.5f; // in destination texels
+		constexpr float PI = 3.14159265358979f;
+
+		Kernel kernel{ -2, 6, {} };
+		float weightSum = 0.0f;
+		for (uint32_t tapIdx = 0; tapIdx < kernel.m_tapCount; ++tapIdx)
+		{
+			// Distance between the source texel centre and the destination texel centre, in destination texels
+			const float distance = (static_cast<float>(kernel.m_firstOffset + static_cast<int32_t>(tapIdx)) - 0.5f) * 0.5f;
+			const float sinc = std::sin(PI * distance) / (PI * distance);
+			const float windowPosition = distance / HALF_WIDTH;
+			const float window = computeBesselI0(ALPHA * std::sqrt(std::max(1.0f - windowPosition * windowPosition, 0.0f))) / computeBesselI0(ALPHA);
+
+			kernel.m_weights[tapIdx] = sinc * window;
+			weightSum += kernel.m_weights[tapIdx];
+		}
+		for (float& weight : kernel.m_weights)
+			weight /= weightSum;
+
+		return kernel;
+	}
+
+	Kernel computeKernel(MipChainBuilder::Filter filter, uint32_t sourceSize)
+	{
+		if (sourceSize == 1)
+			return { 0, 1, { 1.0f } };
+
+		if (filter == MipChainBuilder::Filter::KAISER)
+		{
+			static const Kernel kaiserKernel = computeKaiserKernel();
+			return kaiserKernel;
+		}
+		return { 0, 2, { 0.5f, 0.5f } };
+	}
+
+	uint32_t wrapCoordinate(int32_t coordinate, uint32_t size)
+	{
+		const int32_t signedSize = static_cast<int32_t>(size);
+		return static_cast<uint32_t>(((coordinate % signedSize) + signedSize) % signedSize);
+	}
+
+	struct SRGBTables
+	{
+		static constexpr uint32_t ENCODE_TABLE_SIZE = 4096; // buckets are smaller than the gap between 2 thresholds, a single correction step is needed
+
+		std::array<float, 256> m_toLinear;
+		std::array<float, 256> m_encodeThresholds; // linear value from which a code is used instead of the previous one, rounding is done in sRGB space
+		std::array<uint8_t, ENCODE_TABLE_SIZE + 1> m_encodeTable; // code of the bucket start
+
+		SRGBTables()
+		{
+			auto decode = [](float value) { return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f); };
+			for (uint32_t code = 0; code < 256; ++code)
+				m_toLinear[code] = decode(static_cast<float>(code) / 255.0f);
+			for (uint32_t code = 1; code < 256; ++code)
+				m_encodeThresholds[code - 1] = decode((static_cast<float>(code) - 0.5f) / 255.0f);
+			m_encodeThresholds[255] = std::numeric_limits<float>::max();
+
+			uint32_t code = 0;
+			for (uint32_t bucketIdx = 0; bucketIdx <= ENCODE_TABLE_SIZE; ++bucketIdx)
+			{
+				while (static_cast<float>(bucketIdx) / ENCODE_TABLE_SIZE >= m_encodeThresholds[code])
+					code++;
+				m_encodeTable[bucketIdx] = static_cast<uint8_t>(code);
+			}
+		}
+
+		uint8_t encode(float value) const
+		{
+			const float clampedValue = std::clamp(value, 0.0f, 1.0f);
+			uint32_t code = m_encodeTable[static_cast<uint32_t>(clampedValue * ENCODE_TABLE_SIZE)];
+			if (clampedValue >= m_encodeThresholds[code])
+				code++;
+			return static_cast<uint8_t>(code);
+		}
+	};
+	const SRGBTables& getSRGBTables()
+	{
+		static const SRGBTables tables;
+		return tables;
+	}
+
+	// RGBA8 channels other than sRGB ones are affine: value = code * m_decodeScale + m_decodeOffset
+	struct UNorm8Codec
+	{
+		std::array<float, 4> m_decodeScale;
+		std::array<float, 4> m_decodeOffset;
+		std::array<float, 4> m_encodeScale;
+		std::array<float, 4> m_encodeOffset;
+
+		explicit UNorm8Codec(MipChainBuilder::Content content)
+		{
+			const bool isNormal = content == MipChainBuilder::Content::NORMAL;
+			for (uint32_t channel = 0; channel < 4; ++channel)
+			{
+				const bool isNormalComponent = isNormal && channel < 3;
+				m_decodeScale[channel] = isNormalComponent ? 2.0f / 255.0f : 1.0f / 255.0f;
+				m_decodeOffset[channel] = isNormalComponent ? -1.0f : 0.0f;
+				m_encodeScale[channel] = isNormalComponent ? 127.5f : 255.0f;
+				m_encodeOffset[channel] = isNormalComponent ? 127.5f : 0.0f;
+			}
+		}
+	};
+
+	void normalize(float* xyz)
+	{
+		const float length = std::sqrt(xyz[0] * xyz[0] + xyz[1] * xyz[1] + xyz[2] * xyz[2]);
+		if (length > 1e-8f)
+		{
+			xyz[0] /= length;
+			xyz[1] /= length;
+			xyz[2] /= length;
+		}
+		else
+		{
+			xyz[0] = xyz[1] = 0.0f;
+			xyz[2] = 1.0f;
+		}
+	}
+
+	template <typename PixelType>
+	void decodeRow(const PixelType* pixels, uint32_t count, MipChainBuilder::Content content, float* outValues)
+	{
+		if constexpr (std::is_same_v<PixelType, Wolf::ImageCompression::RGBA8>)
+		{
+			const uint8_t* components = reinterpret_cast<const uint8_t*>(pixels);
+			const UNorm8Codec codec(content);
+#ifdef MIP_CHAIN_BUILDER_SSE
+			const __m128i zero = _mm_setzero_si128();
+			const __m128 scale = _mm_loadu_ps(codec.m_decodeScale.data());
+			const __m128 offset = _mm_loadu_ps(codec.m_decodeOffset.data());
+			for (uint32_t i = 0; i < 4 * count; i += 4)
+			{
+				int32_t packedPixel;
+				memcpy(&packedPixel, &components[i], sizeof(packedPixel));
+				const __m128i pixel = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packedPixel), zero), zero);
+				_mm_storeu_ps(&outValues[i], _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(pixel), scale), offset));
+			}
+#else
+			for (uint32_t i = 0; i < 4 * count; i += 4)
+			{
+				for (uint32_t channel = 0; channel < 4; ++channel)
+					outValues[i + channel] = static_cast<float>(components[i + channel]) * codec.m_decodeScale[channel] + codec.m_decodeOffset[channel];
+			}
+#endif
+			if (content == MipChainBuilder::Content::SRGB_COLOR)
+			{
+				const std::array<float, 256>& srgbToLinear = getSRGBTables().m_toLinear;
+				for (uint32_t i = 0; i < 4 * count; i += 4)
+				{
+					outValues[i] = srgbToLinear[components[i]];
+					outValues[i + 1] = srgbToLinear[components[i + 1]];
+					outValues[i + 2] = srgbToLinear[components[i + 2]];
+				}
+			}
+		}
+		else if constexpr (std::is_same_v<PixelType, Wolf::ImageCompression::RG32F>)
+		{
+			const float* components = reinterpret_cast<const float*>(pixels);
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				const float x = components[2 * i];
+				const float y = components[2 * i + 1];
+				outValues[4 * i] = x;
+				outValues[4 * i + 1] = y;
+				outValues[4 * i + 2] = content == MipChainBuilder::Content::NORMAL ? std::sqrt(std::max(1.0f - x * x - y * y, 0.0f)) : 0.0f;
+				outValues[4 * i + 3] = 0.0f;
+			}
+		}
+		else
+		{
+			const float* components = reinterpret_cast<const float*>(pixels);
+			std::copy(components, components + 4 * static_cast<size_t>(count), outValues);
+		}
+	}
+
+	template <typename PixelType>
+	void encodeRow(float* values, uint32_t count, MipChainBuilder::Content content, PixelType* outPixels)
+	{
+		if (content == MipChainBuilder::Content::NORMAL)
+		{
+			for (uint32_t i = 0; i < count; ++i)
+				normalize(&values[4 * i]);
+		}
+
+		if constexpr (std::is_same_v<PixelType, Wolf::ImageCompression::RGBA8>)
+		{
+			uint8_t* components = reinterpret_cast<uint8_t*>(outPixels);
+			const UNorm8Codec codec(content);
+#ifdef MIP_CHAIN_BUILDER_SSE
+			const __m128 scale = _mm_loadu_ps(codec.m_encodeScale.data());
+			const __m128 offset = _mm_add_ps(_mm_loadu_ps(codec.m_encodeOffset.data()), _mm_set1_ps(0.5f));
+			const __m128 minValue = _mm_set1_ps(0.0f);
+			const __m128 maxValue = _mm_set1_ps(255.0f);
+			for (uint32_t i = 0; i < 4 * count; i += 4)
+			{
+				const __m128 value = _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&values[i]), scale), offset), minValue), maxValue);
+				const __m128i pixel = _mm_cvttps_epi32(value);
+				const int32_t packedPixel = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packs_epi32(pixel, pixel), pixel));
+				memcpy(&components[i], &packedPixel, sizeof(packedPixel));
+			}
+#else
+			for (uint32_t i = 0; i < 4 * count; i += 4)
+			{
+				for (uint32_t channel = 0; channel < 4; ++channel)
+					components[i + channel] = static_cast<uint8_t>(std::clamp(values[i + channel] * codec.m_encodeScale[channel] + codec.m_encodeOffset[channel] + 0.5f, 0.0f, 255.0f));
+			}
+#endif
+			if (content == MipChainBuilder::Content::SRGB_COLOR)
+			{
+				const SRGBTables& srgbTables = getSRGBTables();
+				for (uint32_t i = 0; i < 4 * count; i += 4)
+				{
+					components[i] = srgbTables.encode(values[i]);
+					components[i + 1] = srgbTables.encode(values[i + 1]);
+					components[i + 2] = srgbTables.encode(values[i + 2]);
+				}
+			}
+		}
+		else if constexpr (std::is_same_v<PixelType, Wolf::ImageCompression::RG32F>)
+		{
+			float* components = reinterpret_cast<float*>(outPixels);
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				components[2 * i] = values[4 * i];
+				components[2 * i + 1] = values[4 * i + 1];
+			}
+		}
+		else
+		{
+			float* components = reinterpret_cast<float*>(outPixels);
+			std::copy(values, values + 4 * static_cast<size_t>(count), components);
+		}
+	}
+
+	// Rows [firstRow, firstRow + rowCount) of the destination level, 'outPixels' points to the first of them.
+	// Source rows are decoded and filtered horizontally once, then combined vertically
+	template <typename PixelType>
+	void downsampleBand(const PixelType* pixels, uint32_t width, uint32_t height, const Kernel& kernelX, const Kernel& kernelY, MipChainBuilder::Content content,
+		uint32_t firstRow, uint32_t rowCount, PixelType* outPixels)
+	{
+		const uint32_t outWidth = std::max(width / 2, 1u);
+		const uint32_t paddedWidth = 2 * (outWidth - 1) + kernelX.m_tapCount;
+		const int32_t firstSourceRow = 2 * static_cast<int32_t>(firstRow) + kernelY.m_firstOffset;
+		const uint32_t sourceRowCount = 2 * (rowCount - 1) + kernelY.m_tapCount;
+
+		// Padded row starts at source column kernelX.m_firstOffset, columns out of the image are wrapped
+		const uint32_t firstInnerX = static_cast<uint32_t>(std::clamp(-kernelX.m_firstOffset, 0, static_cast<int32_t>(paddedWidth)));
+		const uint32_t endInnerX = static_cast<uint32_t>(std::clamp(static_cast<int32_t>(width) - kernelX.m_firstOffset, static_cast<int32_t>(firstInnerX), static_cast<int32_t>(paddedWidth)));
+
+		// Scratch buffers are kept per thread, bands are small and allocating them each time costs as much as filtering
+		thread_local std::vector<float> paddedRow;
+		thread_local std::vector<float> filteredRows;
+		thread_local std::vector<float> outRow;
+		paddedRow.resize(4 * static_cast<size_t>(paddedWidth));
+		filteredRows.resize(4 * static_cast<size_t>(sourceRowCount) * outWidth);
+		outRow.resize(4 * static_cast<size_t>(outWidth));
+		for (uint32_t sourceRowIdx = 0; sourceRowIdx < sourceRowCount; ++sourceRowIdx)
+		{
+			const uint32_t sourceY = wrapCoordinate(firstSourceRow + static_cast<int32_t>(sourceRowIdx), height);
+			const PixelType* sourceRow = pixels + static_cast<size_t>(sourceY) * width;
+
+			decodeRow(sourceRow + (static_cast<int32_t>(firstInnerX) + kernelX.m_firstOffset), endInnerX - firstInnerX, content, &paddedRow[4 * firstInnerX]);
+			auto decodeWrappedColumn = [&](uint32_t paddedX)
+				{
+					decodeRow(sourceRow + wrapCoordinate(static_cast<int32_t>(paddedX) + kernelX.m_firstOffset, width), 1, content, &paddedRow[4 * paddedX]);
+				};
+			for (uint32_t paddedX = 0; paddedX < firstInnerX; ++paddedX)
+				decodeWrappedColumn(paddedX);
+			for (uint32_t paddedX = endInnerX; paddedX < paddedWidth; ++paddedX)
+				decodeWrappedColumn(paddedX);
+
+			float* filteredRow = &filteredRows[4 * static_cast<size_t>(sourceRowIdx) * outWidth];
+			for (uint32_t outX = 0; outX < outWidth; ++outX)
+			{
+				Vec4 sum = Vec4::zero();
+				for (uint32_t tapIdx = 0; tapIdx < kernelX.m_tapCount; ++tapIdx)
+					sum = sum.multiplyAdd(Vec4::load(&paddedRow[4 * (2 * outX + tapIdx)]), kernelX.m_weights[tapIdx]);
+				sum.store(&filteredRow[4 * outX]);
+			}
+		}
+
+		for (uint32_t rowIdx = 0; rowIdx < rowCount; ++rowIdx)
+		{
+			for (uint32_t outX = 0; outX < outWidth; ++outX)
+			{
+				Vec4 sum = Vec4::zero();
+				for (uint32_t tapIdx = 0; tapIdx < kernelY.m_tapCount; ++tapIdx)
+					sum = sum.multiplyAdd(Vec4::load(&filteredRows[4 * ((2 * rowIdx + tapIdx) * static_cast<size_t>(outWidth) + outX)]), kernelY.m_weights[tapIdx]);
+				sum.store(&outRow[4 * outX]);
+			}
+
+			encodeRow(outRow.data(), outWidth, content, outPixels + static_cast<size_t>(rowIdx) * outWidth);
+		}
+	}
+}
+
+template <typename PixelType>
+void MipChainBuilder::buildMipChain(const Wolf::Extent3D& extent, const PixelType* pixels, const Settings& settings, std::vector<std::vector<PixelType>>& outMipLevels, uint32_t maxThreadCount)
+{
+	outMipLevels.resize(computeMipLevelCount(extent) - 1);
+
+	Wolf::Extent3D levelExtent = { extent.width, extent.height, 1 };
+	const PixelType* levelPixels = pixels;
+	for (std::vector<PixelType>& mipLevel : outMipLevels)
+	{
+		mipLevel.resize(static_cast<size_t>(std::max(levelExtent.width / 2, 1u)) * std::max(levelExtent.height / 2, 1u));
+		downsample(levelExtent, levelPixels, settings, mipLevel.data(), maxThreadCount);
+
+		levelExtent = { std::max(levelExtent.width / 2, 1u), std::max(levelExtent.height / 2, 1u), 1 };
+		levelPixels = mipLevel.data();
+	}
+}
+
+template <typename PixelType>
+void MipChainBuilder::downsample(const Wolf::Extent3D& extent, const PixelType* pixels, const Settings& settings, PixelType* outPixels, uint32_t maxThreadCount)
+{
+	const Kernel kernelX = computeKernel(settings.m_filter, extent.width);
+	const Kernel kernelY = computeKernel(settings.m_filter, extent.height);
+	const uint32_t outWidth = std::max(extent.width / 2, 1u);
+	const uint32_t outHeight = std::max(extent.height / 2, 1u);
+
+	parallelFor((outHeight + BAND_ROW_COUNT - 1) / BAND_ROW_COUNT, [&](uint32_t bandIdx)
+		{
+			const uint32_t firstRow = bandIdx * BAND_ROW_COUNT;
+			downsampleBand(pixels, extent.width, extent.height, kernelX, kernelY, settings.m_content, firstRow, std::min(BAND_ROW_COUNT, outHeight - firstRow),
+				outPixels + static_cast<size_t>(firstRow) * outWidth);
+		}, maxThreadCount);
+}
+
+template <typename PixelType>
+void MipChainBuilder::downsampleRowPairs(const PixelType* pixels, uint32_t width, uint32_t rowPairCount, Content content, PixelType* outPixels)
+{
+	downsampleBand(pixels, width, 2 * rowPairCount, computeKernel(Filter::BOX, width), computeKernel(Filter::BOX, 2 * rowPairCount), content, 0, rowPairCount, outPixels);
+}
+
+uint32_t MipChainBuilder::computeMipLevelCount(const Wolf::Extent3D& extent)
+{
+	uint32_t levelCount = 1;
+	for (uint32_t size = std::max(extent.width, extent.height); size > 1; size /= 2)
+		levelCount++;
+	return levelCount;
+}
+
+template void MipChainBuilder::buildMipChain(const Wolf::Extent3D&, const Wolf::ImageCompression::RGBA8*, const Settings&, std::vector<std::vector<Wolf::ImageCompression::RGBA8>>&, uint32_t);
+template void MipChainBuilder::buildMipChain(const Wolf::Extent3D&, const Wolf::ImageCompression::RG32F*, const Settings&, std::vector<std::vector<Wolf::ImageCompression::RG32F>>&, uint32_t);
+template void MipChainBuilder::buildMipChain(const Wolf::Extent3D&, const Wolf::ImageCompression::RGBA32F*, const Settings&, std::vector<std::vector<Wolf::ImageCompression::RGBA32F>>&, uint32_t);
+template void MipChainBuilder::downsample(const Wolf::Extent3D&, const Wolf::ImageCompression::RGBA8*, const Settings&, Wolf::ImageCompression::RGBA8*, uint32_t);
+template void MipChainBuilder::downsample(const Wolf::Extent3D&, const Wolf::ImageCompression::RG32F*, const Settings&, Wolf::ImageCompression::RG32F*, uint32_t);
+template void MipChainBuilder::downsample(const Wolf::Extent3D&, const Wolf::ImageCompression::RGBA32F*, const Settings&, Wolf::ImageCompression::RGBA32F*, uint32_t);
+template void MipChainBuilder::downsampleRowPairs(const Wolf::ImageCompression::RGBA8*, uint32_t, uint32_t, Content, Wolf::ImageCompression::RGBA8*);
+template void MipChainBuilder::downsampleRowPairs(const Wolf::ImageCompression::RG32F*, uint32_t, uint32_t, Content, Wolf::ImageCompression::RG32F*);
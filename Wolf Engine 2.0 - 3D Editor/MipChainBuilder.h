@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <Extents.h>
+#include <ImageCompression.h>
+
+// Builds mip chains of imported images. Each level is filtered from the previous one, in bands of rows processed on worker threads.
+// Pixels are filtered in linear space as 4 floats (one SSE register): sRGB colours are decoded before filtering and encoded after,
+// normals are filtered as XYZ vectors and renormalized. Addressing wraps, as textures tile and virtual texture borders wrap too.
+// Levels follow the layout the caches and the GPU images expect: level N is max(size >> N, 1), down to 1x1
+class MipChainBuilder
+{
+public:
+	enum class Filter
+	{
+		BOX, // 2x2 average
+		KAISER // 6x6 Kaiser windowed sinc (alpha = 4), sharper than box, needs 2 neighbour rows on each side
+	};
+	enum class Content
+	{
+		COLOR,
+		SRGB_COLOR, // RGB stored as sRGB, alpha stays linear
+		NORMAL // RGBA8 as (n + 1) / 2 with alpha kept, or RG32F as XY of a unit vector with Z >= 0
+	};
+
+	struct Settings
+	{
+		Filter m_filter = Filter::BOX;
+		Content m_content = Content::COLOR;
+	};
+
+	// Supported pixel types are RGBA8, RG32F and RGBA32F
+	template <typename PixelType>
+	static void buildMipChain(const Wolf::Extent3D& extent, const PixelType* pixels, const Settings& settings, std::vector<std::vector<PixelType>>& outMipLevels, uint32_t maxThreadCount);
+	// 'outPixels' has room for max(width / 2, 1) * max(height / 2, 1) pixels
+	template <typename PixelType>
+	static void downsample(const Wolf::Extent3D& extent, const PixelType* pixels, const Settings& settings, PixelType* outPixels, uint32_t maxThreadCount);
+	// Box filter applied to pairs of rows only, for callers which don't hold whole levels (see BandedImageCompressor).
+	// Gives the same pixels as downsample() with a box filter on an image with an even width
+	template <typename PixelType>
+	static void downsampleRowPairs(const PixelType* pixels, uint32_t width, uint32_t rowPairCount, Content content, PixelType* outPixels);
+
+	static uint32_t computeMipLevelCount(const Wolf::Extent3D& extent); // full resolution included
+
+	// Output rows filtered by a single task
+	static constexpr uint32_t BAND_ROW_COUNT = 16;
+};
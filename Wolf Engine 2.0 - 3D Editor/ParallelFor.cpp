@@ -0,0 +1,159 @@
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// Set while a task of a batch shared with other threads runs, parallelFor calls made by the task then run serially
+	thread_local bool t_isInsideParallelTask = false;
+
+	// Workers are created on first use and live until exit, a parallelFor call only wakes them up
+	class WorkerPool
+	{
+	public:
+		struct Batch
+		{
+			const std::function<void(uint32_t taskIdx)>* m_task = nullptr;
+			uint32_t m_taskCount = 0;
+			std::atomic<uint32_t> m_nextTaskIdx = 0;
+			bool m_isParallel = false;
+
+			// Protected by the pool mutex
+			uint32_t m_remainingWorkerSlots = 0;
+			uint32_t m_activeWorkerCount = 0;
+
+			void runTasks()
+			{
+				const bool wasInsideParallelTask = t_isInsideParallelTask;
+				t_isInsideParallelTask = wasInsideParallelTask || m_isParallel;
+				for (uint32_t taskIdx = m_nextTaskIdx++; taskIdx < m_taskCount; taskIdx = m_nextTaskIdx++)
+				{
+					(*m_task)(taskIdx);
+				}
+				t_isInsideParallelTask = wasInsideParallelTask;
+			}
+		};
+
+		static WorkerPool& get()
+		{
+			static WorkerPool workerPool;
+			return workerPool;
+		}
+
+		[[nodiscard]] uint32_t getThreadCount() const { return static_cast<uint32_t>(m_workers.size()) + 1; }
+
+		// Batch must stay alive until the function returns, the calling thread takes tasks too
+		void run(Batch& batch)
+		{
+			if (batch.m_remainingWorkerSlots > 0)
+			{
+				{
+					std::lock_guard lock(m_mutex);
+					m_batches.push_back(&batch);
+				}
+				m_workAvailableCondition.notify_all();
+			}
+
+			batch.runTasks();
+
+			// All tasks are taken, wait for the workers still running one
+			std::unique_lock lock(m_mutex);
+			std::erase(m_batches, &batch);
+			m_batchDoneCondition.wait(lock, [&batch]() { return batch.m_activeWorkerCount == 0; });
+		}
+
+	private:
+		WorkerPool()
+		{
+			const uint32_t workerCount = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+			m_workers.reserve(workerCount);
+			for (uint32_t i = 0; i < workerCount; ++i)
+			{
+				m_workers.emplace_back([this]() { workerLoop(); });
+			}
+		}
+
+		~WorkerPool()
+		{
+			{
+				std::lock_guard lock(m_mutex);
+				m_stopRequested = true;
+			}
+			m_workAvailableCondition.notify_all();
+
+			for (std::thread& worker : m_workers)
+			{
+				worker.join();
+			}
+		}
+
+		void workerLoop()
+		{
+			std::unique_lock lock(m_mutex);
+			while (true)
+			{
+				m_workAvailableCondition.wait(lock, [this]() { return m_stopRequested || !m_batches.empty(); });
+				if (m_stopRequested)
+					return;
+
+				Batch* batch = m_batches.front();
+				if (--batch->m_remainingWorkerSlots == 0)
+				{
+					m_batches.pop_front();
+				}
+				batch->m_activeWorkerCount++;
+
+				lock.unlock();
+				batch->runTasks();
+				lock.lock();
+
+				if (--batch->m_activeWorkerCount == 0)
+				{
+					m_batchDoneCondition.notify_all();
+				}
+			}
+		}
+
+		std::vector<std::thread> m_workers;
+
+		std::mutex m_mutex;
+		std::condition_variable m_workAvailableCondition;
+		std::condition_variable m_batchDoneCondition;
+		std::deque<Batch*> m_batches; // batches which still accept workers
+		bool m_stopRequested = false;
+	};
+}
+
+void parallelFor(uint32_t taskCount, const std::function<void(uint32_t taskIdx)>& task, uint32_t maxThreadCount)
+{
+	// Other threads are already busy with tasks of the outer call, asking them for more would only multiply the threads competing for the cores
+	if (t_isInsideParallelTask)
+	{
+		for (uint32_t taskIdx = 0; taskIdx < taskCount; ++taskIdx)
+		{
+			task(taskIdx);
+		}
+		return;
+	}
+
+	WorkerPool& workerPool = WorkerPool::get();
+
+	if (maxThreadCount == 0)
+	{
+		maxThreadCount = workerPool.getThreadCount();
+	}
+	const uint32_t threadCount = std::min({ taskCount, maxThreadCount, workerPool.getThreadCount() });
+
+	WorkerPool::Batch batch;
+	batch.m_task = &task;
+	batch.m_taskCount = taskCount;
+	batch.m_isParallel = threadCount > 1;
+	batch.m_remainingWorkerSlots = threadCount > 0 ? threadCount - 1 : 0;
+	workerPool.run(batch);
+}
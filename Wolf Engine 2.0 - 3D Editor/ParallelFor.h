@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+// Calls 'task' for each index in [0, taskCount) on worker threads, the calling thread also takes tasks and the function returns once all are done.
+// Indices are taken one by one so tasks of different costs balance well. 'maxThreadCount' = 0 uses all hardware threads.
+// Workers are persistent and shared by all calls, several threads can call parallelFor at the same time.
+// Calls made from a task run serially on the calling thread, unless the outer call only uses one thread (ex: a single task), in which case they use the workers
+void parallelFor(uint32_t taskCount, const std::function<void(uint32_t taskIdx)>& task, uint32_t maxThreadCount = 0);
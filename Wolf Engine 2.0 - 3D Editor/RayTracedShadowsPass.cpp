@@ -2,7 +2,6 @@
 
 #include <CameraList.h>
 #include <DebugMarker.h>
-#include <fstream>
 #include <GraphicCameraInterface.h>
 #include <MaterialsGPUManager.h>
 #include <Pipeline.h>
@@ -11,6 +10,7 @@
 
 #include "GameContext.h"
 #include "LightManager.h"
+#include "ShaderSnippetCache.h"
 
 struct GameContext;
 
@@ -233,12 +233,7 @@ void RayTracedShadowsPass::submit(const Wolf::SubmitContext& context)
 
 void RayTracedShadowsPass::addComputeShadowsShaderCode(Wolf::ShaderParser::ShaderCodeToAdd& inOutShaderCodeToAdd, uint32_t bindingSlot) const
 {
-    std::ifstream inFile("Shaders/rayTracedShadows/computeShadows.glsl");
-    std::string line;
-    while (std::getline(inFile, line))
-    {
-        inOutShaderCodeToAdd.codeString += line + '\n';
-    }
+    g_shaderSnippetCache->appendSnippet("Shaders/rayTracedShadows/computeShadows.glsl", {}, inOutShaderCodeToAdd.codeString);
 }
 
 void RayTracedShadowsPass::createOutputImages(const Wolf::InitializationContext& context)
@@ -1,15 +1,21 @@
 #include "RayTracedWorldManager.h"
 
-#include <fstream>
+#include <algorithm>
+#include <array>
+#include <cstring>
 
 #include <Buffer.h>
+#include <Configuration.h>
 #include <DescriptorSetGenerator.h>
 #include <DescriptorSetLayoutGenerator.h>
 #include <GPUDataTransfersManager.h>
+#include <RuntimeContext.h>
 
 #include "ProfilerCommon.h"
+#include "ShaderSnippetCache.h"
 
-RayTracedWorldManager::RayTracedWorldManager(const Wolf::ResourceNonOwner<EditorGPUDataTransfersManager>& editorPushDataToGPU) : m_editorPushDataToGPU(editorPushDataToGPU)
+RayTracedWorldManager::RayTracedWorldManager(const Wolf::ResourceNonOwner<EditorGPUDataTransfersManager>& editorPushDataToGPU) : m_editorPushDataToGPU(editorPushDataToGPU),
+    m_instanceSlotAllocator(MAX_INSTANCES)
 {
     m_instanceBuffer.reset(Wolf::Buffer::createBuffer(MAX_INSTANCES * sizeof(InstanceData), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
     m_instanceBuffer->setName("Ray tracing instances info (RayTracedWorldManager::m_instanceBuffer)");
@@ -29,24 +35,160 @@ RayTracedWorldManager::RayTracedWorldManager(const Wolf::ResourceNonOwner<Editor
     m_descriptorSet.reset(Wolf::DescriptorSet::createDescriptorSet(*m_descriptorSetLayout->getResource()));
 }
 
-void RayTracedWorldManager::requestBuild(const RayTracedWorldInfo& info)
+void RayTracedWorldManager::setInstances(uint64_t ownerKey, const std::vector<RayTracedWorldInfo::InstanceInfo>& instances)
 {
     PROFILE_FUNCTION
 
-    if (info.m_instances.size() > MAX_INSTANCES)
+    InstanceSlotAllocator::SlotRange previousRange{};
+    const bool hadInstances = m_instanceSlotAllocator.getRange(ownerKey, previousRange);
+
+    const uint32_t firstSlot = m_instanceSlotAllocator.allocate(ownerKey, static_cast<uint32_t>(instances.size()));
+    const bool keptInPlace = hadInstances && firstSlot == previousRange.m_firstSlot;
+
+    // Release slots the owner doesn't use anymore, data stays in the instance buffer but is not referenced by the TLAS
+    for (uint32_t i = 0; hadInstances && i < previousRange.m_count; ++i)
+    {
+        if (!keptInPlace || i >= instances.size())
+        {
+            releaseSlot(previousRange.m_firstSlot + i);
+        }
+    }
+
+    if (firstSlot == InstanceSlotAllocator::INVALID_SLOT)
+    {
+        Wolf::Debug::sendError("Too much BLAS instances, instance buffer is too small");
+        return;
+    }
+
+    if (m_instanceSlots.size() < firstSlot + instances.size())
+    {
+        m_instanceSlots.resize(firstSlot + instances.size());
+        m_instancesData.resize(firstSlot + instances.size());
+    }
+    for (uint32_t i = 0; i < instances.size(); ++i)
+    {
+        updateSlot(firstSlot + i, instances[i]);
+    }
+}
+
+void RayTracedWorldManager::removeInstances(uint64_t ownerKey)
+{
+    InstanceSlotAllocator::SlotRange range{};
+    if (!m_instanceSlotAllocator.getRange(ownerKey, range))
+        return;
+
+    for (uint32_t slotIdx = range.m_firstSlot; slotIdx < range.m_firstSlot + range.m_count; ++slotIdx)
+    {
+        releaseSlot(slotIdx);
+    }
+    m_instanceSlotAllocator.release(ownerKey);
+}
+
+void RayTracedWorldManager::clearInstances()
+{
+    for (uint32_t slotIdx = 0; slotIdx < m_instanceSlots.size(); ++slotIdx)
+    {
+        releaseSlot(slotIdx);
+    }
+    m_instanceSlotAllocator.clear();
+}
+
+bool RayTracedWorldManager::isBLASInUse(const Wolf::BottomLevelAccelerationStructure* bottomLevelAccelerationStructure)
+{
+    auto it = m_blasUseInfos.find(bottomLevelAccelerationStructure);
+    if (it == m_blasUseInfos.end())
+        return false;
+
+    if (it->second.m_refCount > 0)
+        return true;
+
+    if (it->second.m_lastReleaseFrameNumber + Wolf::g_configuration->getMaxCachedFrames() > Wolf::g_runtimeContext->getCurrentCPUFrameNumber())
+        return true;
+
+    m_blasUseInfos.erase(it);
+    return false;
+}
+
+void RayTracedWorldManager::requestBuild()
+{
+    PROFILE_FUNCTION
+
+    if (m_bindlessBuffersNeedCompaction)
+    {
+        compactBindlessBuffers();
+    }
+
+    if (!m_instancesChanged)
+        return;
+
+    if (m_instanceSlotAllocator.getUsedSlotCount() == 0)
+    {
+        // Nothing to build, passes stop tracing rays (see hasInstance) so removed geometry isn't hit anymore.
+        // The TLAS is kept as frames in flight may still use it, it's rebuilt when instances are added again
+        m_blasInstances.clear();
+        m_needsRebuildTLAS = false;
+        m_pendingTLASUpdateType = TLASUpdatePlanner::UpdateType::NONE;
+        m_tlasUpdatePlanner.requestRebuild();
+        m_instancesChanged = false;
+        return;
+    }
+
+    uploadDirtyInstances();
+
+    const uint32_t slotHighWatermark = m_instanceSlotAllocator.getSlotHighWatermark();
+    m_blasInstances.clear();
+    m_plannerInstances.clear();
+    for (uint32_t slotIdx = 0; slotIdx < slotHighWatermark; ++slotIdx)
+    {
+        const InstanceSlot& slot = m_instanceSlots[slotIdx];
+        if (!slot.m_used)
+            continue;
+
+        Wolf::BLASInstance& blasInstance = m_blasInstances.emplace_back();
+        blasInstance.bottomLevelAS = slot.m_bottomLevelAccelerationStructure;
+        blasInstance.transform = slot.m_transform;
+        blasInstance.instanceID = slotIdx;
+        blasInstance.hitGroupIndex = 0;
+
+        m_plannerInstances.push_back({ slot.m_geometryKey, slot.m_transform });
+    }
+
+    switch (m_tlasUpdatePlanner.computeUpdateType(m_plannerInstances))
     {
-        Wolf::Debug::sendCriticalError("Too much BLAS instances, instance buffer will be too small");
+        case TLASUpdatePlanner::UpdateType::NONE:
+            break;
+        case TLASUpdatePlanner::UpdateType::REFIT:
+            requestRefitTLAS();
+            break;
+        case TLASUpdatePlanner::UpdateType::REBUILD:
+            requestBuildTLAS();
+            break;
     }
-    m_buffers.clear();
 
-    populateInstanceBuffer(info);
-    requestBuildTLAS(info);
+    // Buffer list only changes when an instance uses a new geometry or when the last instance of a geometry is removed
+    if (m_topLevelAccelerationStructure && (m_bindlessBuffersChanged || m_descriptorSetOutdated))
+    {
+        uint64_t bufferListHash = computeBufferListHash();
+        if (bufferListHash != m_buffersListHash || m_descriptorSetOutdated)
+        {
+            // TODO: descriptor set may be in use, updating it may cause a crash
+            createDescriptorSet(); // we need to update the descriptor set because buffers may have changed
+            m_buffersListHash = bufferListHash;
+        }
+        m_bindlessBuffersChanged = false;
+        m_descriptorSetOutdated = false;
+    }
+
+    m_instancesChanged = false;
 }
 
 void RayTracedWorldManager::build(const Wolf::CommandBuffer& commandBuffer)
 {
+    // TopLevelAccelerationStructure has no update mode yet, a pending REFIT is recorded as a full build of the existing structure.
+    // It becomes an in-place update here once the engine exposes one, the planner already bounds the refit degradation
     m_topLevelAccelerationStructure->build(&commandBuffer, m_blasInstances);
     m_needsRebuildTLAS = false;
+    m_pendingTLASUpdateType = TLASUpdatePlanner::UpdateType::NONE;
 }
 
 void RayTracedWorldManager::recordTLASBuildBarriers(const Wolf::CommandBuffer& commandBuffer)
@@ -56,68 +198,166 @@ void RayTracedWorldManager::recordTLASBuildBarriers(const Wolf::CommandBuffer& c
 
 void RayTracedWorldManager::addRayGenShaderCode(Wolf::ShaderParser::ShaderCodeToAdd& inOutShaderCodeToAdd, uint32_t bindingSlot)
 {
-    std::ifstream inFile("Shaders/rayTracedWorld/rayGen.glsl");
-    std::string line;
-    while (std::getline(inFile, line))
+    g_shaderSnippetCache->appendSnippet("Shaders/rayTracedWorld/rayGen.glsl", { { "@RAY_TRACING_DESCRIPTOR_SLOT", std::to_string(bindingSlot) } }, inOutShaderCodeToAdd.codeString);
+}
+
+void RayTracedWorldManager::requestBuildTLAS()
+{
+    PROFILE_FUNCTION
+
+    if (!m_topLevelAccelerationStructure || m_topLevelAccelerationStructure->getInstanceCount() != m_blasInstances.size())
+    {
+        m_topLevelAccelerationStructure.reset(Wolf::TopLevelAccelerationStructure::createTopLevelAccelerationStructure(m_blasInstances.size()));
+        m_descriptorSetOutdated = true;
+    }
+
+    m_needsRebuildTLAS = true;
+    m_pendingTLASUpdateType = TLASUpdatePlanner::UpdateType::REBUILD;
+}
+
+void RayTracedWorldManager::requestRefitTLAS()
+{
+    // Same instances with new transforms, the structure is kept
+    m_needsRebuildTLAS = true;
+    if (m_pendingTLASUpdateType == TLASUpdatePlanner::UpdateType::NONE)
+        m_pendingTLASUpdateType = TLASUpdatePlanner::UpdateType::REFIT;
+}
+
+void RayTracedWorldManager::updateSlot(uint32_t slotIdx, const RayTracedWorldInfo::InstanceInfo& instanceInfo)
+{
+    InstanceSlot& slot = m_instanceSlots[slotIdx];
+    const uint64_t geometryKey = computeInstanceGeometryKey(instanceInfo);
+
+    if (slot.m_used && slot.m_geometryKey == geometryKey)
     {
-        const std::string& descriptorSlotToken = "@RAY_TRACING_DESCRIPTOR_SLOT";
-        size_t descriptorSlotTokenPos = line.find(descriptorSlotToken);
-        while (descriptorSlotTokenPos != std::string::npos)
+        // Transform is not part of the instance data, only the TLAS needs it
+        if (slot.m_transform != instanceInfo.m_transform)
         {
-            line.replace(descriptorSlotTokenPos, descriptorSlotToken.length(), std::to_string(bindingSlot));
-            descriptorSlotTokenPos = line.find(descriptorSlotToken);
+            slot.m_transform = instanceInfo.m_transform;
+            m_instancesChanged = true;
         }
-        inOutShaderCodeToAdd.codeString += line + '\n';
+        return;
     }
+
+    releaseSlot(slotIdx);
+
+    slot.m_used = true;
+    slot.m_geometryKey = geometryKey;
+    slot.m_bottomLevelAccelerationStructure = instanceInfo.m_bottomLevelAccelerationStructure.operator->();
+    acquireBLAS(slot.m_bottomLevelAccelerationStructure);
+    slot.m_transform = instanceInfo.m_transform;
+    slot.m_vertexBuffer = instanceInfo.m_mesh->getVertexBuffer().operator->();
+    slot.m_indexBuffer = instanceInfo.m_mesh->getIndexBuffer().operator->();
+
+    InstanceData& data = m_instancesData[slotIdx];
+    data.firstMaterialIdx = instanceInfo.m_firstMaterialIdx;
+    data.vertexBufferBindlessOffset = acquireBindlessBuffer(instanceInfo.m_mesh->getVertexBuffer());
+    data.vertexBufferOffset = instanceInfo.m_mesh->getVertexBufferOffset() / sizeof(uint32_t); // data is read as number of uint32_t in shader but offset is number of bytes
+    data.indexBufferBindlessOffset = acquireBindlessBuffer(instanceInfo.m_mesh->getIndexBuffer());
+    data.indexBufferOffset = instanceInfo.m_mesh->getIndexBufferOffset() / sizeof(uint32_t);
+
+    m_instanceSlotAllocator.markDirty(slotIdx, 1);
+    m_instancesChanged = true;
 }
 
-void RayTracedWorldManager::requestBuildTLAS(const RayTracedWorldInfo& info)
+void RayTracedWorldManager::releaseSlot(uint32_t slotIdx)
 {
-    PROFILE_FUNCTION
+    InstanceSlot& slot = m_instanceSlots[slotIdx];
+    if (!slot.m_used)
+        return;
+
+    releaseBLAS(slot.m_bottomLevelAccelerationStructure);
+    releaseBindlessBuffer(slot.m_vertexBuffer);
+    releaseBindlessBuffer(slot.m_indexBuffer);
+    slot = InstanceSlot();
 
-    m_blasInstances.resize(info.m_instances.size());
-    for (size_t i = 0; i < m_blasInstances.size(); i++)
+    m_instancesChanged = true;
+}
+
+void RayTracedWorldManager::acquireBLAS(const Wolf::BottomLevelAccelerationStructure* bottomLevelAccelerationStructure)
+{
+    auto it = m_blasUseInfos.find(bottomLevelAccelerationStructure);
+    if (it == m_blasUseInfos.end())
     {
-        m_blasInstances[i].bottomLevelAS = info.m_instances[i].m_bottomLevelAccelerationStructure.operator->();
-        m_blasInstances[i].transform = info.m_instances[i].m_transform;
-        m_blasInstances[i].instanceID = i;
-        m_blasInstances[i].hitGroupIndex = 0;
+        m_blasUseInfos[bottomLevelAccelerationStructure] = { 1, 0 };
+        return;
     }
+    it->second.m_refCount++;
+}
 
-    if (!m_topLevelAccelerationStructure || m_topLevelAccelerationStructure->getInstanceCount() != m_blasInstances.size())
+void RayTracedWorldManager::releaseBLAS(const Wolf::BottomLevelAccelerationStructure* bottomLevelAccelerationStructure)
+{
+    auto it = m_blasUseInfos.find(bottomLevelAccelerationStructure);
+    if (it == m_blasUseInfos.end() || it->second.m_refCount == 0)
     {
-        m_topLevelAccelerationStructure.reset(Wolf::TopLevelAccelerationStructure::createTopLevelAccelerationStructure(m_blasInstances.size()));
+        Wolf::Debug::sendError("Releasing a BLAS which isn't used");
+        return;
     }
 
-    uint64_t bufferListHash = computeBufferListHash();
-    if (bufferListHash != m_buffersListHash)
+    // TLAS still references it until next build and GPU may read it for a few more frames
+    if (--it->second.m_refCount == 0)
+        it->second.m_lastReleaseFrameNumber = Wolf::g_runtimeContext->getCurrentCPUFrameNumber();
+}
+
+void RayTracedWorldManager::uploadDirtyInstances()
+{
+    PROFILE_FUNCTION
+
+    m_instanceSlotAllocator.popDirtyRanges(m_dirtySlotRanges);
+    for (const InstanceSlotAllocator::SlotRange& dirtyRange : m_dirtySlotRanges)
     {
-        // TODO: descriptor set may be in use, updating it may cause a crash
-        createDescriptorSet(); // we need to update the descriptor set because buffers may have changed
-        m_buffersListHash = bufferListHash;
+        UpdateGPUBuffersPass::Reservation reservation = m_editorPushDataToGPU->reserveGPUBufferUpload(static_cast<uint32_t>(dirtyRange.m_count * sizeof(InstanceData)),
+            m_instanceBuffer.createNonOwnerResource(), static_cast<uint32_t>(dirtyRange.m_firstSlot * sizeof(InstanceData)));
+        memcpy(reservation.getData(), &m_instancesData[dirtyRange.m_firstSlot], dirtyRange.m_count * sizeof(InstanceData));
+        m_editorPushDataToGPU->commitGPUBufferUpload(reservation);
     }
-
-    m_needsRebuildTLAS = true;
 }
 
-void RayTracedWorldManager::populateInstanceBuffer(const RayTracedWorldInfo& info)
+void RayTracedWorldManager::compactBindlessBuffers()
 {
     PROFILE_FUNCTION
 
-    m_instanceData.resize(info.m_instances.size());
-    for (size_t i = 0; i < m_instanceData.size(); i++)
+    std::vector<bool> isBindlessIdxFree(m_buffers.size(), false);
+    for (const uint32_t freeBindlessIdx : m_freeBindlessIndices)
+    {
+        isBindlessIdxFree[freeBindlessIdx] = true;
+    }
+    m_freeBindlessIndices.clear();
+
+    std::vector<Wolf::ResourceNonOwner<Wolf::Buffer>> previousBuffers;
+    previousBuffers.swap(m_buffers);
+    for (uint32_t previousBindlessIdx = 0; previousBindlessIdx < previousBuffers.size(); ++previousBindlessIdx)
     {
-        InstanceData& data = m_instanceData[i];
-        const RayTracedWorldInfo::InstanceInfo& instanceInfo = info.m_instances[i];
+        if (isBindlessIdxFree[previousBindlessIdx])
+            continue;
 
-        data.firstMaterialIdx = instanceInfo.m_firstMaterialIdx;
-        data.vertexBufferBindlessOffset = addStorageBuffer(instanceInfo.m_mesh->getVertexBuffer());
-        data.vertexBufferOffset = instanceInfo.m_mesh->getVertexBufferOffset() / sizeof(uint32_t); // data is read as number of uint32_t in shader but offset is number of bytes
-        data.indexBufferBindlessOffset = addStorageBuffer(instanceInfo.m_mesh->getIndexBuffer());
-        data.indexBufferOffset = instanceInfo.m_mesh->getIndexBufferOffset() / sizeof(uint32_t);
+        const Wolf::ResourceNonOwner<Wolf::Buffer>& buffer = previousBuffers[previousBindlessIdx];
+        m_bindlessBufferInfos[buffer.operator->()].m_bindlessIdx = static_cast<uint32_t>(m_buffers.size());
+        m_buffers.push_back(buffer);
     }
 
-    m_editorPushDataToGPU->pushDataToGPUBuffer(m_instanceData.data(), m_instanceData.size() * sizeof(InstanceData), m_instanceBuffer.createNonOwnerResource(), 0);
+    // Bindless indices have moved, all used instances must be rewritten
+    for (uint32_t slotIdx = 0; slotIdx < m_instanceSlots.size(); ++slotIdx)
+    {
+        const InstanceSlot& slot = m_instanceSlots[slotIdx];
+        if (!slot.m_used)
+            continue;
+
+        m_instancesData[slotIdx].vertexBufferBindlessOffset = m_bindlessBufferInfos[slot.m_vertexBuffer].m_bindlessIdx;
+        m_instancesData[slotIdx].indexBufferBindlessOffset = m_bindlessBufferInfos[slot.m_indexBuffer].m_bindlessIdx;
+        m_instanceSlotAllocator.markDirty(slotIdx, 1);
+    }
+
+    m_bindlessBuffersNeedCompaction = false;
+    m_bindlessBuffersChanged = true;
+    m_instancesChanged = true;
+}
+
+uint64_t RayTracedWorldManager::computeInstanceGeometryKey(const RayTracedWorldInfo::InstanceInfo& instanceInfo)
+{
+    const std::array<uint64_t, 3> keyData = { reinterpret_cast<uint64_t>(instanceInfo.m_bottomLevelAccelerationStructure.operator->()),
+        reinterpret_cast<uint64_t>(instanceInfo.m_mesh.operator->()), instanceInfo.m_firstMaterialIdx };
+    return xxh64::hash(reinterpret_cast<const char*>(keyData.data()), keyData.size() * sizeof(uint64_t), 0);
 }
 
 void RayTracedWorldManager::createDescriptorSet()
@@ -134,17 +374,65 @@ void RayTracedWorldManager::createDescriptorSet()
     m_descriptorSet->update(descriptorSetGenerator.getDescriptorSetCreateInfo());
 }
 
-uint32_t RayTracedWorldManager::addStorageBuffer(const Wolf::ResourceNonOwner<Wolf::Buffer>& buffer)
+uint32_t RayTracedWorldManager::acquireBindlessBuffer(const Wolf::ResourceNonOwner<Wolf::Buffer>& buffer)
+{
+    auto it = m_bindlessBufferInfos.find(buffer.operator->());
+    if (it != m_bindlessBufferInfos.end())
+    {
+        it->second.m_refCount++;
+        return it->second.m_bindlessIdx;
+    }
+
+    uint32_t bindlessIdx;
+    if (!m_freeBindlessIndices.empty())
+    {
+        bindlessIdx = m_freeBindlessIndices.back();
+        m_freeBindlessIndices.pop_back();
+        m_buffers[bindlessIdx] = buffer;
+    }
+    else
+    {
+        bindlessIdx = static_cast<uint32_t>(m_buffers.size());
+        m_buffers.push_back(buffer);
+    }
+    m_bindlessBufferInfos[buffer.operator->()] = { bindlessIdx, 1 };
+    m_bindlessBuffersChanged = true;
+
+    return bindlessIdx;
+}
+
+void RayTracedWorldManager::releaseBindlessBuffer(const Wolf::Buffer* buffer)
 {
-    m_buffers.push_back(buffer);
+    auto it = m_bindlessBufferInfos.find(buffer);
+    if (it == m_bindlessBufferInfos.end() || it->second.m_refCount == 0)
+    {
+        Wolf::Debug::sendError("Releasing a bindless buffer which is not used");
+        return;
+    }
+
+    it->second.m_refCount--;
+    if (it->second.m_refCount != 0)
+        return;
 
-    return m_buffers.size() - 1;
+    // Other bindless indices don't move, the entry points to a buffer which is always alive until a new buffer reuses it
+    const uint32_t bindlessIdx = it->second.m_bindlessIdx;
+    m_buffers[bindlessIdx] = m_instanceBuffer.createNonOwnerResource();
+    m_freeBindlessIndices.push_back(bindlessIdx);
+    m_bindlessBufferInfos.erase(it);
+    m_bindlessBuffersChanged = true;
+
+    // Compaction rewrites all instances, it's only worth it once most of the list is unused
+    if (m_buffers.size() >= MIN_BINDLESS_BUFFER_COUNT_FOR_COMPACTION && m_freeBindlessIndices.size() * 2 > m_buffers.size())
+    {
+        m_bindlessBuffersNeedCompaction = true;
+    }
 }
 
 uint64_t RayTracedWorldManager::computeBufferListHash() const
 {
     static_assert(sizeof(Wolf::Buffer*) == sizeof(uint64_t));
-    std::vector<uint64_t> bufferPtrs(m_buffers.size());
+    std::vector<uint64_t> bufferPtrs;
+    bufferPtrs.reserve(m_buffers.size());
     for (const Wolf::ResourceNonOwner<Wolf::Buffer>& buffer : m_buffers)
     {
         bufferPtrs.push_back(reinterpret_cast<uint64_t>(buffer.operator->()));
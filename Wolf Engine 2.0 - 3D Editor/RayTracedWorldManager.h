@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <unordered_map>
 #include <xxh64.hpp>
 
 #include <ResourceUniqueOwner.h>
@@ -15,6 +16,8 @@
 #include <ShaderParser.h>
 
 #include "EditorGPUDataTransfersManager.h"
+#include "InstanceSlotAllocator.h"
+#include "TLASUpdatePlanner.h"
 
 class RayTracedWorldManager
 {
@@ -33,23 +36,39 @@ public:
         };
         std::vector<InstanceInfo> m_instances;
     };
-    void requestBuild(const RayTracedWorldInfo& info);
+    // Instances are kept per owner (usually an entity) in persistent slots, only changed slots are uploaded
+    void setInstances(uint64_t ownerKey, const std::vector<RayTracedWorldInfo::InstanceInfo>& instances);
+    void removeInstances(uint64_t ownerKey);
+    void clearInstances();
+    void requestBuild(); // uploads changes made since last call and requests the TLAS update they need
     void build(const Wolf::CommandBuffer& commandBuffer);
     void recordTLASBuildBarriers(const Wolf::CommandBuffer& commandBuffer);
 
+    // A BLAS stays in use while an instance references it and until frames built with it are done on GPU
+    bool isBLASInUse(const Wolf::BottomLevelAccelerationStructure* bottomLevelAccelerationStructure);
+
     bool needsRebuildTLAS() const { return m_needsRebuildTLAS; }
-    bool hasInstance() const { return static_cast<bool>(m_topLevelAccelerationStructure); };
+    TLASUpdatePlanner::UpdateType getPendingTLASUpdateType() const { return m_pendingTLASUpdateType; }
+    bool hasInstance() const { return static_cast<bool>(m_topLevelAccelerationStructure) && !m_blasInstances.empty(); };
     Wolf::ResourceNonOwner<const Wolf::DescriptorSet> getDescriptorSet() { return m_descriptorSet.createConstNonOwnerResource(); }
     static void addRayGenShaderCode(Wolf::ShaderParser::ShaderCodeToAdd& inOutShaderCodeToAdd, uint32_t bindingSlot);
 
     static Wolf::ResourceUniqueOwner<Wolf::DescriptorSetLayout>& getDescriptorSetLayout() { return Wolf::LazyInitSharedResource<Wolf::DescriptorSetLayout, RayTracedWorldManager>::getResource(); }
 
 private:
-    void requestBuildTLAS(const RayTracedWorldInfo& info);
-    void populateInstanceBuffer(const RayTracedWorldInfo& info);
+    void requestBuildTLAS();
+    void requestRefitTLAS();
+    void updateSlot(uint32_t slotIdx, const RayTracedWorldInfo::InstanceInfo& instanceInfo);
+    void releaseSlot(uint32_t slotIdx);
+    void acquireBLAS(const Wolf::BottomLevelAccelerationStructure* bottomLevelAccelerationStructure);
+    void releaseBLAS(const Wolf::BottomLevelAccelerationStructure* bottomLevelAccelerationStructure);
+    void uploadDirtyInstances();
+    void compactBindlessBuffers();
     void createDescriptorSet();
-    uint32_t addStorageBuffer(const Wolf::ResourceNonOwner<Wolf::Buffer>& buffer);
+    uint32_t acquireBindlessBuffer(const Wolf::ResourceNonOwner<Wolf::Buffer>& buffer);
+    void releaseBindlessBuffer(const Wolf::Buffer* buffer);
     uint64_t computeBufferListHash() const;
+    static uint64_t computeInstanceGeometryKey(const RayTracedWorldInfo::InstanceInfo& instanceInfo);
 
     Wolf::ResourceNonOwner<EditorGPUDataTransfersManager> m_editorPushDataToGPU;
     Wolf::ResourceUniqueOwner<Wolf::TopLevelAccelerationStructure> m_topLevelAccelerationStructure;
@@ -65,15 +84,51 @@ private:
     static constexpr uint32_t MAX_INSTANCES = 16384;
     Wolf::ResourceUniqueOwner<Wolf::Buffer> m_instanceBuffer;
 
-    Wolf::DescriptorSetLayoutGenerator m_descriptorSetLayoutGenerator;;
+    struct InstanceSlot
+    {
+        bool m_used = false;
+        uint64_t m_geometryKey = 0;
+        Wolf::BottomLevelAccelerationStructure* m_bottomLevelAccelerationStructure = nullptr;
+        glm::mat4 m_transform;
+        const Wolf::Buffer* m_vertexBuffer = nullptr;
+        const Wolf::Buffer* m_indexBuffer = nullptr;
+    };
+    std::vector<InstanceSlot> m_instanceSlots; // CPU state of each slot, data sent to GPU is in m_instancesData
+    std::vector<InstanceData> m_instancesData;
+    InstanceSlotAllocator m_instanceSlotAllocator;
+    std::vector<InstanceSlotAllocator::SlotRange> m_dirtySlotRanges;
+    bool m_instancesChanged = false;
+
+    Wolf::DescriptorSetLayoutGenerator m_descriptorSetLayoutGenerator;
     Wolf::ResourceUniqueOwner<Wolf::LazyInitSharedResource<Wolf::DescriptorSetLayout, RayTracedWorldManager>> m_descriptorSetLayout;
     Wolf::ResourceUniqueOwner<Wolf::DescriptorSet> m_descriptorSet;
 
+    // Bindless vertex and index buffers, shared by all instances using them
     std::vector<Wolf::ResourceNonOwner<Wolf::Buffer>> m_buffers;
-    uint32_t m_currentBindlessCount = 0;
+    struct BindlessBufferInfo
+    {
+        uint32_t m_bindlessIdx;
+        uint32_t m_refCount;
+    };
+    std::unordered_map<const Wolf::Buffer*, BindlessBufferInfo> m_bindlessBufferInfos;
+    std::vector<uint32_t> m_freeBindlessIndices; // reused by new buffers, they point to the instance buffer meanwhile
+    static constexpr uint32_t MIN_BINDLESS_BUFFER_COUNT_FOR_COMPACTION = 64;
+    bool m_bindlessBuffersChanged = false;
+    bool m_bindlessBuffersNeedCompaction = false; // set when more than half of the bindless indices are free
     uint64_t m_buffersListHash = 0;
+    bool m_descriptorSetOutdated = false; // TLAS has been recreated
+
+    struct BLASUseInfo
+    {
+        uint32_t m_refCount;
+        uint32_t m_lastReleaseFrameNumber;
+    };
+    std::unordered_map<const Wolf::BottomLevelAccelerationStructure*, BLASUseInfo> m_blasUseInfos;
 
     std::vector<Wolf::BLASInstance> m_blasInstances;
-    std::vector<InstanceData> m_instanceData;
     bool m_needsRebuildTLAS =false;
+
+    TLASUpdatePlanner m_tlasUpdatePlanner; // instances are given to the planner in slot order
+    std::vector<TLASUpdatePlanner::Instance> m_plannerInstances;
+    TLASUpdatePlanner::UpdateType m_pendingTLASUpdateType = TLASUpdatePlanner::UpdateType::NONE;
 };
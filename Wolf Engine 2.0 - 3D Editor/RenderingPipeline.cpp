@@ -203,13 +203,19 @@ void RenderingPipeline::frame(Wolf::WolfEngine* wolfInstance, bool doScreenShot,
 		finalSemaphore = m_compositionPass->getSemaphore(swapChainImageIdx);
 		m_compositionPass->setIsFinalPassThisFrame();
 	}
-	wolfInstance->frame(passes, finalSemaphore, swapChainImageIdx);
-
 	if (doScreenShot)
 	{
-		wolfInstance->waitIdle();
-		m_compositionPass->saveSwapChainToFile();
+		// Copy is recorded by the composition pass and saved once this frame is finished on GPU
+		m_compositionPass->requestScreenshotBeforeFrame();
 	}
+
+	wolfInstance->frame(passes, finalSemaphore, swapChainImageIdx);
+}
+
+void RenderingPipeline::flushPendingReadbacks()
+{
+	m_compositionPass->flushPendingScreenshots();
+	m_thumbnailsGenerationPass->flushPendingReadbacks();
 }
 
 void RenderingPipeline::clear()
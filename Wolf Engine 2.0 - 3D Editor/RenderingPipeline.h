@@ -41,6 +41,7 @@ public:
 
 	void update(Wolf::WolfEngine* wolfInstance);
 	void frame(Wolf::WolfEngine* wolfInstance, bool doScreenShot, const GameContext& gameContext);
+	void flushPendingReadbacks(); // device must be idle
 	void clear();
 
 	void setResourceManager(const Wolf::ResourceNonOwner<AssetManager>& resourceManager) const;
@@ -0,0 +1,209 @@
+#include "ShaderSnippetCache.h"
+
+#include <fstream>
+#include <sstream>
+#include <unordered_set>
+#include <xxh64.hpp>
+
+#include <Debug.h>
+
+#include "CacheHelper.h"
+#include "CodeFileHashes.h"
+
+ShaderSnippetCache* g_shaderSnippetCache = nullptr;
+
+ShaderSnippetCache::ShaderSnippetCache(const std::string& cacheFilePath) : m_cacheFilePath(cacheFilePath)
+{
+	g_shaderSnippetCache = this;
+	load();
+}
+
+void ShaderSnippetCache::appendSnippet(const std::string& sourceFilePath, const std::vector<TokenReplacement>& tokenReplacements, std::string& inOutCode)
+{
+	std::lock_guard lock(m_mutex);
+
+	const SourceEntry* source = getSource(sourceFilePath);
+	if (!source)
+		return;
+
+	const uint64_t snippetKey = computeSnippetKey(source->m_contentHash, tokenReplacements);
+	auto snippetIt = m_snippets.find(snippetKey);
+	if (snippetIt != m_snippets.end())
+	{
+		m_hitCount++;
+		inOutCode += snippetIt->second.m_code;
+		return;
+	}
+	m_missCount++;
+
+	std::string snippet = source->m_content;
+	for (const TokenReplacement& tokenReplacement : tokenReplacements)
+	{
+		size_t tokenPos = snippet.find(tokenReplacement.m_token);
+		while (tokenPos != std::string::npos)
+		{
+			snippet.replace(tokenPos, tokenReplacement.m_token.length(), tokenReplacement.m_value);
+			tokenPos = snippet.find(tokenReplacement.m_token, tokenPos + tokenReplacement.m_value.length());
+		}
+	}
+
+	inOutCode += snippet;
+	m_snippets[snippetKey] = { source->m_contentHash, std::move(snippet) };
+	m_isDirty = true;
+}
+
+void ShaderSnippetCache::invalidate(const std::string& sourceFilePath)
+{
+	std::lock_guard lock(m_mutex);
+
+	// Snippets are keyed by content hash, they will never be hit again if the content changed and are dropped on save
+	if (m_sources.erase(sourceFilePath) > 0)
+	{
+		m_isDirty = true;
+	}
+}
+
+void ShaderSnippetCache::save()
+{
+	std::lock_guard lock(m_mutex);
+
+	if (!m_isDirty)
+		return;
+
+	std::ofstream output(m_cacheFilePath, std::ios::out | std::ios::binary);
+	if (!output.good())
+	{
+		Wolf::Debug::sendWarning("Can't write shader snippet cache to " + m_cacheFilePath);
+		return;
+	}
+
+	uint64_t hash = Wolf::HASH_SHADER_SNIPPET_CACHE_CPP;
+	output.write(reinterpret_cast<const char*>(&hash), sizeof(hash));
+
+	uint32_t sourceCount = static_cast<uint32_t>(m_sources.size());
+	output.write(reinterpret_cast<const char*>(&sourceCount), sizeof(sourceCount));
+	for (const std::pair<const std::string, SourceEntry>& source : m_sources)
+	{
+		CacheHelper::writeString(output, source.first);
+		output.write(reinterpret_cast<const char*>(&source.second.m_lastWriteTime), sizeof(source.second.m_lastWriteTime));
+		output.write(reinterpret_cast<const char*>(&source.second.m_fileSize), sizeof(source.second.m_fileSize));
+		output.write(reinterpret_cast<const char*>(&source.second.m_contentHash), sizeof(source.second.m_contentHash));
+		CacheHelper::writeString(output, source.second.m_content);
+	}
+
+	// Only keep snippets generated from current sources
+	std::unordered_set<uint64_t> currentContentHashes;
+	for (const std::pair<const std::string, SourceEntry>& source : m_sources)
+	{
+		currentContentHashes.insert(source.second.m_contentHash);
+	}
+	std::erase_if(m_snippets, [&currentContentHashes](const std::pair<const uint64_t, SnippetEntry>& snippet) { return !currentContentHashes.contains(snippet.second.m_sourceContentHash); });
+
+	uint32_t snippetCount = static_cast<uint32_t>(m_snippets.size());
+	output.write(reinterpret_cast<const char*>(&snippetCount), sizeof(snippetCount));
+	for (const std::pair<const uint64_t, SnippetEntry>& snippet : m_snippets)
+	{
+		output.write(reinterpret_cast<const char*>(&snippet.first), sizeof(snippet.first));
+		output.write(reinterpret_cast<const char*>(&snippet.second.m_sourceContentHash), sizeof(snippet.second.m_sourceContentHash));
+		CacheHelper::writeString(output, snippet.second.m_code);
+	}
+
+	m_isDirty = false;
+}
+
+float ShaderSnippetCache::getHitRate() const
+{
+	const uint32_t requestCount = m_hitCount + m_missCount;
+	return requestCount == 0 ? 0.0f : static_cast<float>(m_hitCount) / static_cast<float>(requestCount);
+}
+
+uint64_t ShaderSnippetCache::computeSnippetKey(uint64_t sourceContentHash, const std::vector<TokenReplacement>& tokenReplacements)
+{
+	std::string keyData(reinterpret_cast<const char*>(&sourceContentHash), sizeof(sourceContentHash));
+	for (const TokenReplacement& tokenReplacement : tokenReplacements)
+	{
+		// Separators avoid collisions between {"ab", "c"} and {"a", "bc"}
+		keyData += tokenReplacement.m_token + '\0' + tokenReplacement.m_value + '\0';
+	}
+	return xxh64::hash(keyData.data(), keyData.size(), 0);
+}
+
+const ShaderSnippetCache::SourceEntry* ShaderSnippetCache::getSource(const std::string& sourceFilePath)
+{
+	std::error_code errorCode;
+	const uint64_t fileSize = std::filesystem::file_size(sourceFilePath, errorCode);
+	if (errorCode)
+	{
+		Wolf::Debug::sendError("Can't find shader file " + sourceFilePath);
+		return nullptr;
+	}
+	const int64_t lastWriteTime = std::filesystem::last_write_time(sourceFilePath, errorCode).time_since_epoch().count();
+
+	auto sourceIt = m_sources.find(sourceFilePath);
+	if (sourceIt != m_sources.end() && sourceIt->second.m_fileSize == fileSize && sourceIt->second.m_lastWriteTime == lastWriteTime)
+		return &sourceIt->second;
+
+	std::ifstream inFile(sourceFilePath);
+	std::stringstream content;
+	content << inFile.rdbuf();
+
+	SourceEntry& source = m_sources[sourceFilePath];
+	source.m_lastWriteTime = lastWriteTime;
+	source.m_fileSize = fileSize;
+	source.m_content = content.str();
+	if (!source.m_content.empty() && source.m_content.back() != '\n')
+	{
+		source.m_content += '\n'; // every line of a snippet ends with a line break
+	}
+	source.m_contentHash = xxh64::hash(source.m_content.data(), source.m_content.size(), 0);
+	m_isDirty = true;
+
+	return &source;
+}
+
+void ShaderSnippetCache::load()
+{
+	if (!std::filesystem::exists(m_cacheFilePath))
+		return;
+
+	std::ifstream input(m_cacheFilePath, std::ios::in | std::ios::binary);
+
+	uint64_t hash;
+	input.read(reinterpret_cast<char*>(&hash), sizeof(hash));
+	if (hash != Wolf::HASH_SHADER_SNIPPET_CACHE_CPP)
+	{
+		Wolf::Debug::sendInfo("Shader snippet cache found but hash is incorrect");
+		return;
+	}
+
+	uint32_t sourceCount = 0;
+	input.read(reinterpret_cast<char*>(&sourceCount), sizeof(sourceCount));
+	for (uint32_t i = 0; i < sourceCount && input.good(); ++i)
+	{
+		std::string sourceFilePath;
+		CacheHelper::readString(input, sourceFilePath);
+		SourceEntry& source = m_sources[sourceFilePath];
+		input.read(reinterpret_cast<char*>(&source.m_lastWriteTime), sizeof(source.m_lastWriteTime));
+		input.read(reinterpret_cast<char*>(&source.m_fileSize), sizeof(source.m_fileSize));
+		input.read(reinterpret_cast<char*>(&source.m_contentHash), sizeof(source.m_contentHash));
+		CacheHelper::readString(input, source.m_content);
+	}
+
+	uint32_t snippetCount = 0;
+	input.read(reinterpret_cast<char*>(&snippetCount), sizeof(snippetCount));
+	for (uint32_t i = 0; i < snippetCount && input.good(); ++i)
+	{
+		uint64_t snippetKey;
+		input.read(reinterpret_cast<char*>(&snippetKey), sizeof(snippetKey));
+		SnippetEntry& snippet = m_snippets[snippetKey];
+		input.read(reinterpret_cast<char*>(&snippet.m_sourceContentHash), sizeof(snippet.m_sourceContentHash));
+		CacheHelper::readString(input, snippet.m_code);
+	}
+
+	if (!input.good())
+	{
+		Wolf::Debug::sendWarning("Shader snippet cache is corrupted, it will be rebuilt");
+		m_sources.clear();
+		m_snippets.clear();
+	}
+}
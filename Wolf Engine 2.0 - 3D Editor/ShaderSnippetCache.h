@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Shader code snippets added to passes (ray gen, global irradiance, shadows...) are generated from GLSL files with tokens replaced by binding slots.
+// Sources are read once, keyed by content hash, and generated snippets are kept for each set of replacements. Both are saved to the cache folder to be reused by next runs.
+class ShaderSnippetCache
+{
+public:
+	struct TokenReplacement
+	{
+		std::string m_token;
+		std::string m_value;
+	};
+
+	explicit ShaderSnippetCache(const std::string& cacheFilePath);
+	ShaderSnippetCache(const ShaderSnippetCache&) = delete;
+
+	// Source file is read again when its size or last write time changed
+	void appendSnippet(const std::string& sourceFilePath, const std::vector<TokenReplacement>& tokenReplacements, std::string& inOutCode);
+	void invalidate(const std::string& sourceFilePath);
+	void save();
+
+	[[nodiscard]] uint32_t getHitCount() const { return m_hitCount; }
+	[[nodiscard]] uint32_t getMissCount() const { return m_missCount; }
+	[[nodiscard]] float getHitRate() const;
+
+	static uint64_t computeSnippetKey(uint64_t sourceContentHash, const std::vector<TokenReplacement>& tokenReplacements);
+
+private:
+	struct SourceEntry
+	{
+		int64_t m_lastWriteTime = 0;
+		uint64_t m_fileSize = 0;
+		uint64_t m_contentHash = 0;
+		std::string m_content;
+	};
+	const SourceEntry* getSource(const std::string& sourceFilePath);
+	void load();
+
+	std::string m_cacheFilePath;
+	std::mutex m_mutex;
+
+	std::unordered_map<std::string, SourceEntry> m_sources;
+	struct SnippetEntry
+	{
+		uint64_t m_sourceContentHash;
+		std::string m_code;
+	};
+	std::unordered_map<uint64_t, SnippetEntry> m_snippets;
+	bool m_isDirty = false;
+
+	uint32_t m_hitCount = 0;
+	uint32_t m_missCount = 0;
+};
+
+extern ShaderSnippetCache* g_shaderSnippetCache;
@@ -1,6 +1,5 @@
 #include "ShadowMaskPassCascadedShadowMapping.h"
 
-#include <fstream>
 #include <random>
 
 #include <ProfilerCommon.h>
@@ -10,6 +9,7 @@
 #include "DescriptorSetGenerator.h"
 #include "LightManager.h"
 #include "PreDepthPass.h"
+#include "ShaderSnippetCache.h"
 
 ShadowMaskPassCascadedShadowMapping::ShadowMaskPassCascadedShadowMapping(EditorParams* editorParams, const Wolf::ResourceNonOwner<PreDepthPass>& preDepthPass,
 	const Wolf::ResourceNonOwner<CascadedShadowMapsPass>& csmPass, const Wolf::ResourceNonOwner<GPUNoiseManager>& noiseManager)
@@ -147,19 +147,7 @@ void ShadowMaskPassCascadedShadowMapping::submit(const Wolf::SubmitContext& cont
 
 void ShadowMaskPassCascadedShadowMapping::addComputeShadowsShaderCode(Wolf::ShaderParser::ShaderCodeToAdd& inOutShaderCodeToAdd, uint32_t bindingSlot) const
 {
-	std::ifstream inFile("Shaders/cascadedShadowMapping/computeShadows.glsl");
-	std::string line;
-	while (std::getline(inFile, line))
-	{
-		const std::string& descriptorSlotToken = "@CSM_DESCRIPTOR_SLOT";
-		size_t descriptorSlotTokenPos = line.find(descriptorSlotToken);
-		while (descriptorSlotTokenPos != std::string::npos)
-		{
-			line.replace(descriptorSlotTokenPos, descriptorSlotToken.length(), std::to_string(bindingSlot));
-			descriptorSlotTokenPos = line.find(descriptorSlotToken);
-		}
-		inOutShaderCodeToAdd.codeString += line + '\n';
-	}
+	g_shaderSnippetCache->appendSnippet("Shaders/cascadedShadowMapping/computeShadows.glsl", { { "@CSM_DESCRIPTOR_SLOT", std::to_string(bindingSlot) } }, inOutShaderCodeToAdd.codeString);
 }
 
 void ShadowMaskPassCascadedShadowMapping::createOutputImages(uint32_t width, uint32_t height)
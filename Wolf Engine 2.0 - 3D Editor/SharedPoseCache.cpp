@@ -0,0 +1,226 @@
+#include "SharedPoseCache.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <Debug.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+SharedPoseCache::Key SharedPoseCache::computeKey(const std::shared_ptr<const FlattenedSkeleton>& skeleton, uint32_t boneCount, AssetId clipAssetId, float time, bool isFrozen)
+{
+	Key key;
+	key.m_skeleton = skeleton;
+	key.m_boneCount = boneCount;
+	key.m_clipAssetId = clipAssetId;
+	key.m_isFrozen = isFrozen;
+	key.m_quantizedTime = static_cast<int32_t>(std::round(time / TIME_QUANTIZATION_STEP));
+
+	return key;
+}
+
+SharedPoseCache::SharedPose* SharedPoseCache::acquire(const Key& key, const std::function<void(SharedPose&)>& initializeSharedPose)
+{
+	std::lock_guard lock(m_mutex);
+
+	std::unique_ptr<SharedPose>& sharedPose = m_sharedPoses[key];
+	if (!sharedPose)
+	{
+		const uint32_t boneCount = key.m_boneCount;
+		sharedPose.reset(new SharedPose);
+		sharedPose->m_key = key;
+		sharedPose->m_boneCount = boneCount;
+		sharedPose->m_cursor.reset(boneCount);
+		sharedPose->m_bonesInfoCPU.resize(boneCount);
+		sharedPose->m_previousBonesInfoCPU.resize(boneCount);
+		sharedPose->m_lastBonesInfoGPU.resize(boneCount);
+		sharedPose->m_lastBoneTransforms.resize(boneCount);
+		sharedPose->m_previousBoneTransforms.resize(boneCount);
+		initializeSharedPose(*sharedPose);
+	}
+
+	sharedPose->m_userCount++;
+	return sharedPose.get();
+}
+
+void SharedPoseCache::release(SharedPose* sharedPose, uint32_t currentFrameNumber)
+{
+	std::lock_guard lock(m_mutex);
+
+	if (sharedPose->m_userCount == 0)
+	{
+		Wolf::Debug::sendError("Shared pose released more times than acquired");
+		return;
+	}
+
+	sharedPose->m_userCount--;
+	sharedPose->m_lastReleaseFrameNumber = currentFrameNumber;
+}
+
+void SharedPoseCache::requestUpdatePeriod(SharedPose* sharedPose, uint32_t updatePeriod)
+{
+	uint32_t requestedUpdatePeriod = sharedPose->m_requestedUpdatePeriod;
+	while (updatePeriod < requestedUpdatePeriod && !sharedPose->m_requestedUpdatePeriod.compare_exchange_weak(requestedUpdatePeriod, updatePeriod)) {}
+}
+
+bool SharedPoseCache::tryBeginUpdate(SharedPose* sharedPose, uint32_t currentFrameNumber)
+{
+	uint32_t lastUpdateFrameNumber = sharedPose->m_lastUpdateFrameNumber;
+	if (lastUpdateFrameNumber == currentFrameNumber || (sharedPose->m_key.m_isFrozen && lastUpdateFrameNumber != NEVER_EVALUATED))
+		return false;
+
+	if (!sharedPose->m_lastUpdateFrameNumber.compare_exchange_strong(lastUpdateFrameNumber, currentFrameNumber))
+		return false; // another user started the update
+
+	return true;
+}
+
+bool SharedPoseCache::beginEvaluation(SharedPose* sharedPose, uint32_t currentFrameNumber)
+{
+	// Users which haven't requested yet this frame will be taken into account at next update
+	sharedPose->m_updatePeriod = sharedPose->m_requestedUpdatePeriod.exchange(AnimationLODScheduler::NEVER_UPDATE);
+
+	const bool isFirstEvaluation = sharedPose->m_lastEvaluationFrameNumber == NEVER_EVALUATED;
+	if (!isFirstEvaluation && !sharedPose->m_key.m_isFrozen && !AnimationLODScheduler::shouldUpdate(currentFrameNumber, sharedPose->m_staggerId, sharedPose->m_updatePeriod))
+	{
+		m_skippedEvaluationCount++;
+		return false;
+	}
+
+	sharedPose->m_previousEvaluationFrameNumber = sharedPose->m_lastEvaluationFrameNumber;
+	sharedPose->m_lastEvaluationFrameNumber = currentFrameNumber;
+	std::swap(sharedPose->m_previousBonesInfoCPU, sharedPose->m_bonesInfoCPU);
+	std::swap(sharedPose->m_previousBoneTransforms, sharedPose->m_lastBoneTransforms);
+	sharedPose->m_isPreviousEvaluationKept = sharedPose->m_isLastEvaluationKept;
+	sharedPose->m_isLastEvaluationKept = false;
+
+	m_evaluationCount++;
+	return true;
+}
+
+bool SharedPoseCache::computeInterpolationFactor(const SharedPose& sharedPose, uint32_t currentFrameNumber, float& outFactor)
+{
+	outFactor = 1.0f;
+
+	// Last evaluation has been uploaded directly, bones buffer already holds it
+	if (!sharedPose.m_isLastEvaluationKept)
+		return false;
+
+	const uint32_t updatePeriod = sharedPose.m_updatePeriod;
+	if (sharedPose.m_previousEvaluationFrameNumber == NEVER_EVALUATED || !sharedPose.m_isPreviousEvaluationKept || updatePeriod <= 1 || updatePeriod == AnimationLODScheduler::NEVER_UPDATE)
+		return sharedPose.m_lastEvaluationFrameNumber == currentFrameNumber;
+
+	// Previous evaluation is too old (pose was off-screen or period has decreased), interpolating would play in slow motion
+	const uint32_t evaluationInterval = sharedPose.m_lastEvaluationFrameNumber - sharedPose.m_previousEvaluationFrameNumber;
+	if (evaluationInterval > updatePeriod)
+		return sharedPose.m_lastEvaluationFrameNumber == currentFrameNumber;
+
+	const uint32_t framesSinceLastEvaluation = currentFrameNumber - sharedPose.m_lastEvaluationFrameNumber;
+	if (framesSinceLastEvaluation > evaluationInterval)
+		return false; // last evaluation has already been uploaded
+
+	outFactor = static_cast<float>(framesSinceLastEvaluation) / static_cast<float>(evaluationInterval);
+	return true;
+}
+
+void SharedPoseCache::decomposeLastEvaluation(SharedPose& sharedPose)
+{
+	for (uint32_t boneIdx = 0; boneIdx < sharedPose.m_boneCount; ++boneIdx)
+	{
+		const glm::mat4& transform = sharedPose.m_lastBonesInfoGPU[boneIdx].transform;
+		BoneTransform& boneTransform = sharedPose.m_lastBoneTransforms[boneIdx];
+
+		// Bone matrices include the offset matrix, shear from non-uniform scales is lost
+		glm::mat3 rotation(transform);
+		boneTransform.m_translation = glm::vec3(transform[3]);
+		boneTransform.m_scale = glm::vec3(glm::length(rotation[0]), glm::length(rotation[1]), glm::length(rotation[2]));
+		if (glm::determinant(rotation) < 0.0f)
+			boneTransform.m_scale.x = -boneTransform.m_scale.x; // mirrored
+
+		static constexpr float MIN_SCALE = 1e-6f;
+		if (std::abs(boneTransform.m_scale.x) < MIN_SCALE || std::abs(boneTransform.m_scale.y) < MIN_SCALE || std::abs(boneTransform.m_scale.z) < MIN_SCALE)
+		{
+			boneTransform.m_orientation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f); // collapsed bone, any orientation works
+			continue;
+		}
+
+		rotation[0] /= boneTransform.m_scale.x;
+		rotation[1] /= boneTransform.m_scale.y;
+		rotation[2] /= boneTransform.m_scale.z;
+		boneTransform.m_orientation = glm::normalize(glm::quat_cast(rotation));
+	}
+}
+
+void SharedPoseCache::interpolateBones(const SharedPose& sharedPose, float factor, BoneInfoGPU* outBonesInfoGPU)
+{
+	if (factor >= 1.0f)
+	{
+		std::copy(sharedPose.m_lastBonesInfoGPU.begin(), sharedPose.m_lastBonesInfoGPU.end(), outBonesInfoGPU);
+		return;
+	}
+
+	for (uint32_t boneIdx = 0; boneIdx < sharedPose.m_boneCount; ++boneIdx)
+	{
+		const BoneTransform& previousTransform = sharedPose.m_previousBoneTransforms[boneIdx];
+		const BoneTransform& lastTransform = sharedPose.m_lastBoneTransforms[boneIdx];
+
+		const glm::vec3 translation = glm::mix(previousTransform.m_translation, lastTransform.m_translation, factor);
+		const glm::quat orientation = glm::slerp(previousTransform.m_orientation, lastTransform.m_orientation, factor);
+		const glm::vec3 scale = glm::mix(previousTransform.m_scale, lastTransform.m_scale, factor);
+		outBonesInfoGPU[boneIdx].transform = glm::translate(glm::mat4(1.0f), translation) * glm::toMat4(orientation) * glm::scale(glm::mat4(1.0f), scale);
+	}
+}
+
+glm::vec3 SharedPoseCache::computeUploadedBonePosition(const SharedPose& sharedPose, uint32_t boneIdx)
+{
+	const float factor = sharedPose.m_uploadedInterpolationFactor;
+	if (factor >= 1.0f)
+		return sharedPose.m_bonesInfoCPU[boneIdx].position;
+
+	return glm::mix(sharedPose.m_previousBonesInfoCPU[boneIdx].position, sharedPose.m_bonesInfoCPU[boneIdx].position, factor);
+}
+
+void SharedPoseCache::releaseUnusedPoses(uint32_t currentFrameNumber, uint32_t framesBeforeRelease)
+{
+	std::lock_guard lock(m_mutex);
+
+	std::erase_if(m_sharedPoses, [currentFrameNumber, framesBeforeRelease](const std::pair<const Key, std::unique_ptr<SharedPose>>& sharedPose)
+		{
+			return sharedPose.second->m_userCount == 0 && sharedPose.second->m_lastReleaseFrameNumber + framesBeforeRelease <= currentFrameNumber;
+		});
+}
+
+void SharedPoseCache::clear()
+{
+	std::lock_guard lock(m_mutex);
+	m_sharedPoses.clear();
+}
+
+uint32_t SharedPoseCache::getSharedPoseCount() const
+{
+	std::lock_guard lock(m_mutex);
+	return static_cast<uint32_t>(m_sharedPoses.size());
+}
+
+uint32_t SharedPoseCache::getUserCount() const
+{
+	std::lock_guard lock(m_mutex);
+
+	uint32_t userCount = 0;
+	for (const std::pair<const Key, std::unique_ptr<SharedPose>>& sharedPose : m_sharedPoses)
+	{
+		userCount += sharedPose.second->m_userCount;
+	}
+	return userCount;
+}
+
+size_t SharedPoseCache::KeyHash::operator()(const Key& key) const
+{
+	size_t hash = std::hash<const FlattenedSkeleton*>()(key.m_skeleton.get());
+	hash ^= std::hash<uint32_t>()(key.m_boneCount) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	hash ^= std::hash<uint32_t>()(key.m_clipAssetId) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	hash ^= std::hash<int32_t>()(key.m_quantizedTime) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	hash ^= std::hash<bool>()(key.m_isFrozen) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	hash ^= std::hash<bool>()(key.m_useBakedAnimation) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	return hash;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <Buffer.h>
+#include <DescriptorSet.h>
+#include <ResourceUniqueOwner.h>
+
+#include "AnimationHelper.h"
+#include "AnimationLODScheduler.h"
+#include "AssetId.h"
+
+// Animated meshes playing the same clip on the same skeleton at the same time have identical bones, crowds and repeated props are common cases.
+// They share a pose: bones are evaluated once per frame, by the first instance updating it, and uploaded to a single GPU buffer.
+// Poses are owned by the cache, users keep a pointer from acquire() to release(). A pose is destroyed a few frames after its last user left.
+class SharedPoseCache
+{
+public:
+	static constexpr float TIME_QUANTIZATION_STEP = 1.0f / 60.0f; // in seconds, instances closer than this in time share their pose
+
+	struct Key
+	{
+		std::shared_ptr<const FlattenedSkeleton> m_skeleton; // owned so a reloaded skeleton never gets the address of one still used by a pose
+		uint32_t m_boneCount = 0; // of the mesh, clips can come from a skeleton with a different bone count
+		AssetId m_clipAssetId = NO_ASSET; // NO_ASSET for bind pose
+		bool m_isFrozen = false; // time doesn't move (forced timer, bind pose), pose is evaluated once
+		int32_t m_quantizedTime = 0; // playback offset to the global timer, forced time when frozen
+		bool m_useBakedAnimation = false;
+
+		bool operator==(const Key& other) const = default;
+
+		float getTime() const { return static_cast<float>(m_quantizedTime) * TIME_QUANTIZATION_STEP; }
+	};
+	static Key computeKey(const std::shared_ptr<const FlattenedSkeleton>& skeleton, uint32_t boneCount, AssetId clipAssetId, float time, bool isFrozen);
+
+	// Interpolating matrices componentwise shrinks rotating bones, the 2 last evaluations are kept decomposed
+	struct BoneTransform
+	{
+		glm::vec3 m_translation;
+		glm::quat m_orientation;
+		glm::vec3 m_scale;
+	};
+
+	static constexpr uint32_t NEVER_EVALUATED = -1;
+	struct SharedPose
+	{
+		Key m_key;
+		uint32_t m_boneCount = 0; // from the key
+		uint32_t m_userCount = 0;
+		uint32_t m_lastReleaseFrameNumber = 0;
+		std::atomic<uint32_t> m_lastUpdateFrameNumber = NEVER_EVALUATED;
+
+		// Update rate, see AnimationLODScheduler
+		uint32_t m_staggerId = 0;
+		std::atomic<uint32_t> m_requestedUpdatePeriod = AnimationLODScheduler::NEVER_UPDATE; // smallest period requested by the users since the last update
+		uint32_t m_updatePeriod = AnimationLODScheduler::NEVER_UPDATE;
+		uint32_t m_lastEvaluationFrameNumber = NEVER_EVALUATED;
+		uint32_t m_previousEvaluationFrameNumber = NEVER_EVALUATED;
+
+		// Written by the single user in charge of the evaluation (see tryBeginUpdate), from an animation job.
+		// Other users must not read them while the jobs run: they copy what they need on the main thread before the jobs of the next frame are queued
+		AnimationCursor m_cursor;
+		std::vector<BoneInfoCPU> m_bonesInfoCPU; // model space, each user applies its own transform
+		std::vector<BoneInfoCPU> m_previousBonesInfoCPU;
+		std::vector<BoneInfoGPU> m_lastBonesInfoGPU; // only filled when interpolating between updates
+		std::vector<BoneTransform> m_lastBoneTransforms; // decomposed from m_lastBonesInfoGPU
+		std::vector<BoneTransform> m_previousBoneTransforms;
+		bool m_isLastEvaluationKept = false; // written to m_lastBonesInfoGPU and decomposed, evaluations uploaded directly aren't
+		bool m_isPreviousEvaluationKept = false;
+		float m_uploadedInterpolationFactor = 1.0f; // factor of the last bones uploaded, CPU positions use it to match what is displayed
+		Wolf::ResourceUniqueOwner<Wolf::Buffer> m_bonesBuffer;
+		Wolf::ResourceUniqueOwner<Wolf::DescriptorSet> m_descriptorSet;
+	};
+
+	// 'initializeSharedPose' is called when no pose exists for this key, it must create the GPU resources
+	SharedPose* acquire(const Key& key, const std::function<void(SharedPose&)>& initializeSharedPose);
+	void release(SharedPose* sharedPose, uint32_t currentFrameNumber);
+
+	// Users request the update period they need before calling tryBeginUpdate(), the pose is updated at the fastest rate requested
+	static void requestUpdatePeriod(SharedPose* sharedPose, uint32_t updatePeriod);
+	// Returns true for a single caller per frame (a single caller ever for frozen poses), this caller is in charge of the update
+	bool tryBeginUpdate(SharedPose* sharedPose, uint32_t currentFrameNumber);
+	// Called by the caller in charge of the update, returns true if the bones must be evaluated this frame. Previous evaluation is kept for interpolation
+	bool beginEvaluation(SharedPose* sharedPose, uint32_t currentFrameNumber);
+	// Between 2 evaluations, bones displayed move from the previous evaluation to the last one. Returns false when there's nothing new to upload
+	static bool computeInterpolationFactor(const SharedPose& sharedPose, uint32_t currentFrameNumber, float& outFactor);
+	// Called by the evaluating job after writing m_lastBonesInfoGPU
+	static void decomposeLastEvaluation(SharedPose& sharedPose);
+	static void interpolateBones(const SharedPose& sharedPose, float factor, BoneInfoGPU* outBonesInfoGPU);
+	// Displayed pose is one update period behind the last evaluation when interpolating, CPU positions follow the same delay
+	static glm::vec3 computeUploadedBonePosition(const SharedPose& sharedPose, uint32_t boneIdx);
+
+	// GPU can still read the bones buffer for a few frames after the last user left
+	void releaseUnusedPoses(uint32_t currentFrameNumber, uint32_t framesBeforeRelease);
+	void clear();
+
+	[[nodiscard]] uint32_t getSharedPoseCount() const;
+	[[nodiscard]] uint32_t getUserCount() const;
+	[[nodiscard]] uint32_t getEvaluationCount() const { return m_evaluationCount; } // since last call to resetStats()
+	[[nodiscard]] uint32_t getSkippedEvaluationCount() const { return m_skippedEvaluationCount; } // updates skipped because of the update period
+	void resetStats() { m_evaluationCount = 0; m_skippedEvaluationCount = 0; }
+
+private:
+	struct KeyHash
+	{
+		size_t operator()(const Key& key) const;
+	};
+
+	mutable std::mutex m_mutex;
+	std::unordered_map<Key, std::unique_ptr<SharedPose>, KeyHash> m_sharedPoses;
+	std::atomic<uint32_t> m_evaluationCount = 0;
+	std::atomic<uint32_t> m_skippedEvaluationCount = 0;
+};
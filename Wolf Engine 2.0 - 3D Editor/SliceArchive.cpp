@@ -0,0 +1,267 @@
+#include "SliceArchive.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include <Debug.h>
+
+SliceArchive::Writer::Writer(const std::string& filename, uint64_t hash, const std::vector<MipInfo>& mips, uint32_t blockSize, bool allowCompression)
+	: m_filename(filename), m_hash(hash), m_mips(mips), m_blockSize(blockSize), m_allowCompression(allowCompression)
+{
+	uint32_t sliceCount;
+	computeMipFirstSliceIndices(m_mips, m_mipFirstSliceIndices, sliceCount);
+	m_entries.resize(sliceCount);
+
+	m_file.open(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!m_file.is_open())
+	{
+		Wolf::Debug::sendError("Can't create slice archive " + filename);
+		return;
+	}
+
+	// Header stays empty until finalize()
+	const uint64_t indexTableEnd = computeIndexTableOffset(static_cast<uint32_t>(m_mips.size())) + m_entries.size() * sizeof(SliceEntry);
+	const std::vector<char> zeros(indexTableEnd, 0);
+	m_file.write(zeros.data(), static_cast<std::streamsize>(zeros.size()));
+	m_endOffset = alignOffset(indexTableEnd);
+}
+
+void SliceArchive::Writer::writeSlice(uint32_t mipLevel, uint32_t sliceX, uint32_t sliceY, const uint8_t* data, uint32_t size)
+{
+	if (mipLevel >= m_mips.size() || sliceX >= m_mips[mipLevel].m_sliceCountX || sliceY >= m_mips[mipLevel].m_sliceCountY)
+	{
+		Wolf::Debug::sendError("Slice is out of archive range");
+		return;
+	}
+
+	SliceEntry entry;
+	entry.m_size = size;
+	entry.m_storedSize = size;
+
+	const uint8_t* storedData = data;
+	std::vector<uint8_t> compressedData;
+	if (m_allowCompression)
+	{
+		const uint32_t compressedSize = compressBlockRunLength(data, size, m_blockSize, compressedData);
+		if (compressedSize < size)
+		{
+			entry.m_compression = SliceCompression::BLOCK_RUN_LENGTH;
+			entry.m_storedSize = compressedSize;
+			storedData = compressedData.data();
+		}
+	}
+
+	const uint32_t sliceIdx = m_mipFirstSliceIndices[mipLevel] + sliceY * m_mips[mipLevel].m_sliceCountX + sliceX;
+
+	std::lock_guard lock(m_mutex);
+
+	// Slices are stored in index order so an archive doesn't depend on which slice finished first. Slices arriving early wait in memory
+	if (sliceIdx != m_nextSliceIdx)
+	{
+		if (sliceIdx < m_nextSliceIdx || m_pendingSlices.contains(sliceIdx))
+		{
+			Wolf::Debug::sendError("Slice is written twice to archive " + m_filename);
+			return;
+		}
+
+		PendingSlice& pendingSlice = m_pendingSlices[sliceIdx];
+		pendingSlice.m_entry = entry;
+		pendingSlice.m_storedData.assign(storedData, storedData + entry.m_storedSize);
+		return;
+	}
+
+	appendSlice(entry, storedData);
+	for (auto it = m_pendingSlices.find(m_nextSliceIdx); it != m_pendingSlices.end(); it = m_pendingSlices.find(m_nextSliceIdx))
+	{
+		appendSlice(it->second.m_entry, it->second.m_storedData.data());
+		m_pendingSlices.erase(it);
+	}
+}
+
+void SliceArchive::Writer::appendSlice(SliceEntry entry, const uint8_t* storedData)
+{
+	entry.m_offset = m_endOffset;
+	m_file.seekp(static_cast<std::streamoff>(entry.m_offset));
+	m_file.write(reinterpret_cast<const char*>(storedData), entry.m_storedSize);
+	m_endOffset = alignOffset(entry.m_offset + entry.m_storedSize);
+
+	m_entries[m_nextSliceIdx] = entry;
+	m_nextSliceIdx++;
+}
+
+bool SliceArchive::Writer::finalize()
+{
+	std::lock_guard lock(m_mutex);
+
+	if (m_nextSliceIdx != m_entries.size())
+	{
+		Wolf::Debug::sendError("Slice archive " + m_filename + " is missing slices");
+		return false;
+	}
+
+	m_file.seekp(sizeof(Header));
+	m_file.write(reinterpret_cast<const char*>(m_mips.data()), static_cast<std::streamsize>(m_mips.size() * sizeof(MipInfo)));
+	m_file.write(reinterpret_cast<const char*>(m_entries.data()), static_cast<std::streamsize>(m_entries.size() * sizeof(SliceEntry)));
+	m_file.flush();
+
+	Header header{ MAGIC, VERSION, m_hash, static_cast<uint32_t>(m_mips.size()), m_blockSize };
+	m_file.seekp(0);
+	m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	m_file.close();
+
+	return !m_file.fail();
+}
+
+SliceArchive::Reader::Reader(const std::string& filename)
+{
+	m_file.open(filename, std::ios::in | std::ios::binary);
+	if (!m_file.is_open())
+		return;
+
+	Header header{};
+	m_file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!m_file || header.m_magic != MAGIC || header.m_version != VERSION)
+		return;
+
+	m_hash = header.m_hash;
+	m_blockSize = header.m_blockSize;
+
+	m_mips.resize(header.m_mipCount);
+	m_file.read(reinterpret_cast<char*>(m_mips.data()), static_cast<std::streamsize>(m_mips.size() * sizeof(MipInfo)));
+
+	uint32_t sliceCount;
+	computeMipFirstSliceIndices(m_mips, m_mipFirstSliceIndices, sliceCount);
+	m_entries.resize(sliceCount);
+	m_file.read(reinterpret_cast<char*>(m_entries.data()), static_cast<std::streamsize>(m_entries.size() * sizeof(SliceEntry)));
+
+	m_isValid = static_cast<bool>(m_file);
+}
+
+const SliceArchive::SliceEntry* SliceArchive::Reader::getSliceEntry(uint32_t mipLevel, uint32_t sliceX, uint32_t sliceY) const
+{
+	if (mipLevel >= m_mips.size() || sliceX >= m_mips[mipLevel].m_sliceCountX || sliceY >= m_mips[mipLevel].m_sliceCountY)
+		return nullptr;
+
+	return &m_entries[m_mipFirstSliceIndices[mipLevel] + sliceY * m_mips[mipLevel].m_sliceCountX + sliceX];
+}
+
+bool SliceArchive::Reader::readSlice(uint32_t mipLevel, uint32_t sliceX, uint32_t sliceY, std::vector<uint8_t>& outData) const
+{
+	const SliceEntry* entry = getSliceEntry(mipLevel, sliceX, sliceY);
+	if (!m_isValid || !entry || entry->m_offset == 0)
+		return false;
+
+	std::vector<uint8_t> compressedData;
+	std::vector<uint8_t>& storedData = entry->m_compression == SliceCompression::NONE ? outData : compressedData;
+	storedData.resize(entry->m_storedSize);
+	{
+		std::lock_guard lock(m_mutex);
+
+		m_file.clear();
+		m_file.seekg(static_cast<std::streamoff>(entry->m_offset));
+		m_file.read(reinterpret_cast<char*>(storedData.data()), entry->m_storedSize);
+		if (!m_file)
+			return false;
+	}
+
+	if (entry->m_compression == SliceCompression::BLOCK_RUN_LENGTH)
+	{
+		outData.resize(entry->m_size);
+		return uncompressBlockRunLength(compressedData.data(), entry->m_storedSize, m_blockSize, entry->m_size, outData.data());
+	}
+
+	return entry->m_compression == SliceCompression::NONE;
+}
+
+bool SliceArchive::readHash(const std::string& filename, uint64_t& outHash)
+{
+	std::ifstream input(filename, std::ios::in | std::ios::binary);
+	if (!input.is_open())
+		return false;
+
+	Header header{};
+	input.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!input || header.m_magic != MAGIC || header.m_version != VERSION)
+		return false;
+
+	outHash = header.m_hash;
+	return true;
+}
+
+// Stored as a sequence of [uint16_t run length][block]
+uint32_t SliceArchive::compressBlockRunLength(const uint8_t* data, uint32_t size, uint32_t blockSize, std::vector<uint8_t>& outData)
+{
+	outData.clear();
+	if (blockSize == 0 || size % blockSize != 0)
+		return std::numeric_limits<uint32_t>::max();
+
+	const uint32_t blockCount = size / blockSize;
+	uint32_t blockIdx = 0;
+	while (blockIdx < blockCount)
+	{
+		const uint8_t* block = data + static_cast<size_t>(blockIdx) * blockSize;
+
+		uint16_t runLength = 1;
+		while (blockIdx + runLength < blockCount && runLength < std::numeric_limits<uint16_t>::max() &&
+			memcmp(block, data + static_cast<size_t>(blockIdx + runLength) * blockSize, blockSize) == 0)
+		{
+			runLength++;
+		}
+
+		// No need to go further once it's not smaller
+		if (outData.size() + sizeof(runLength) + blockSize >= size)
+			return std::numeric_limits<uint32_t>::max();
+
+		const size_t writeOffset = outData.size();
+		outData.resize(writeOffset + sizeof(runLength) + blockSize);
+		memcpy(&outData[writeOffset], &runLength, sizeof(runLength));
+		memcpy(&outData[writeOffset + sizeof(runLength)], block, blockSize);
+
+		blockIdx += runLength;
+	}
+
+	return static_cast<uint32_t>(outData.size());
+}
+
+bool SliceArchive::uncompressBlockRunLength(const uint8_t* data, uint32_t storedSize, uint32_t blockSize, uint32_t size, uint8_t* outData)
+{
+	uint32_t readOffset = 0;
+	uint32_t writeOffset = 0;
+	while (readOffset + sizeof(uint16_t) + blockSize <= storedSize)
+	{
+		uint16_t runLength;
+		memcpy(&runLength, data + readOffset, sizeof(runLength));
+		const uint8_t* block = data + readOffset + sizeof(runLength);
+		readOffset += sizeof(runLength) + blockSize;
+
+		if (writeOffset + static_cast<uint64_t>(runLength) * blockSize > size)
+			return false;
+
+		// Run is filled by doubling the already written part, blocks are small and runs can cover a whole slice
+		const uint32_t runSize = runLength * blockSize;
+		uint8_t* run = outData + writeOffset;
+		uint32_t filledSize = std::min(blockSize, runSize);
+		memcpy(run, block, filledSize);
+		while (filledSize < runSize)
+		{
+			const uint32_t copySize = std::min(filledSize, runSize - filledSize);
+			memcpy(run + filledSize, run, copySize);
+			filledSize += copySize;
+		}
+		writeOffset += runSize;
+	}
+
+	return readOffset == storedSize && writeOffset == size;
+}
+
+void SliceArchive::computeMipFirstSliceIndices(const std::vector<MipInfo>& mips, std::vector<uint32_t>& outMipFirstSliceIndices, uint32_t& outSliceCount)
+{
+	outMipFirstSliceIndices.resize(mips.size());
+	outSliceCount = 0;
+	for (uint32_t mipLevel = 0; mipLevel < mips.size(); ++mipLevel)
+	{
+		outMipFirstSliceIndices[mipLevel] = outSliceCount;
+		outSliceCount += mips[mipLevel].m_sliceCountX * mips[mipLevel].m_sliceCountY;
+	}
+}
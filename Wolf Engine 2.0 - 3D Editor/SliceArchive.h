@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+#include <string>
+#include <vector>
+
+// Virtual texture slices of an image packed in a single file, instead of one "mipN_sliceX_sliceY.bin" file per slice.
+// Layout: header, index table (one entry per slice, ordered by mip, then slice Y, then slice X), slice data.
+// Slice data starts at offsets aligned to ALIGNMENT so slices can be read directly or from a memory mapping of the file.
+// The header is written last: an interrupted build leaves an archive which is never considered valid.
+class SliceArchive
+{
+public:
+	static constexpr uint32_t MAGIC = 0x53545657; // "WVTS"
+	static constexpr uint32_t VERSION = 1;
+	static constexpr uint64_t ALIGNMENT = 4096;
+	static constexpr const char* FILENAME = "slices.pack";
+
+	enum class SliceCompression : uint32_t
+	{
+		NONE,
+		BLOCK_RUN_LENGTH // runs of identical blocks (BC block or pixel), uniform areas are common in roughness/metalness/AO maps
+	};
+
+	struct MipInfo
+	{
+		uint32_t m_sliceCountX;
+		uint32_t m_sliceCountY;
+	};
+
+	struct SliceEntry
+	{
+		uint64_t m_offset = 0; // 0 when the slice hasn't been written
+		uint32_t m_storedSize = 0;
+		uint32_t m_size = 0; // after decompression
+		SliceCompression m_compression = SliceCompression::NONE;
+		uint32_t m_padding = 0;
+	};
+
+	class Writer
+	{
+	public:
+		// 'blockSize' is the size in bytes of the unit runs are made of, 'allowCompression' = false stores all slices as they are
+		Writer(const std::string& filename, uint64_t hash, const std::vector<MipInfo>& mips, uint32_t blockSize, bool allowCompression);
+
+		// Slices can be written in any order, calls are serialized. They are stored in index order, the archive is the same whatever the write order
+		void writeSlice(uint32_t mipLevel, uint32_t sliceX, uint32_t sliceY, const uint8_t* data, uint32_t size);
+		// Writes the index and the header, returns false if a slice is missing
+		bool finalize();
+
+	private:
+		void appendSlice(SliceEntry entry, const uint8_t* storedData);
+
+		struct PendingSlice
+		{
+			SliceEntry m_entry;
+			std::vector<uint8_t> m_storedData;
+		};
+
+		std::mutex m_mutex;
+		std::fstream m_file;
+		std::string m_filename;
+		uint64_t m_hash;
+		std::vector<MipInfo> m_mips;
+		std::vector<uint32_t> m_mipFirstSliceIndices;
+		std::vector<SliceEntry> m_entries;
+		uint32_t m_blockSize;
+		bool m_allowCompression;
+		uint64_t m_endOffset = 0;
+		uint32_t m_nextSliceIdx = 0;
+		std::unordered_map<uint32_t, PendingSlice> m_pendingSlices; // written before the slices preceding them
+	};
+
+	class Reader
+	{
+	public:
+		explicit Reader(const std::string& filename);
+
+		[[nodiscard]] bool isValid() const { return m_isValid; }
+		[[nodiscard]] uint64_t getHash() const { return m_hash; }
+		[[nodiscard]] uint32_t getMipCount() const { return static_cast<uint32_t>(m_mips.size()); }
+		[[nodiscard]] const MipInfo& getMipInfo(uint32_t mipLevel) const { return m_mips[mipLevel]; }
+		[[nodiscard]] const SliceEntry* getSliceEntry(uint32_t mipLevel, uint32_t sliceX, uint32_t sliceY) const; // nullptr if out of range
+
+		// Thread safe, returns false if the slice doesn't exist or can't be read
+		bool readSlice(uint32_t mipLevel, uint32_t sliceX, uint32_t sliceY, std::vector<uint8_t>& outData) const;
+
+	private:
+		mutable std::mutex m_mutex;
+		mutable std::ifstream m_file;
+		bool m_isValid = false;
+		uint64_t m_hash = 0;
+		uint32_t m_blockSize = 0;
+		std::vector<MipInfo> m_mips;
+		std::vector<uint32_t> m_mipFirstSliceIndices;
+		std::vector<SliceEntry> m_entries;
+	};
+
+	// Reads the header only, returns false if the file doesn't exist or is not a complete archive
+	static bool readHash(const std::string& filename, uint64_t& outHash);
+
+	static uint32_t compressBlockRunLength(const uint8_t* data, uint32_t size, uint32_t blockSize, std::vector<uint8_t>& outData); // returns stored size
+	static bool uncompressBlockRunLength(const uint8_t* data, uint32_t storedSize, uint32_t blockSize, uint32_t size, uint8_t* outData);
+
+private:
+	struct Header
+	{
+		uint32_t m_magic;
+		uint32_t m_version;
+		uint64_t m_hash;
+		uint32_t m_mipCount;
+		uint32_t m_blockSize;
+	};
+
+	static uint64_t computeIndexTableOffset(uint32_t mipCount) { return sizeof(Header) + mipCount * sizeof(MipInfo); }
+	static uint64_t alignOffset(uint64_t offset) { return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT; }
+	static void computeMipFirstSliceIndices(const std::vector<MipInfo>& mips, std::vector<uint32_t>& outMipFirstSliceIndices, uint32_t& outSliceCount);
+};
@@ -0,0 +1,131 @@
+#include "SliceCacheManifest.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include <Debug.h>
+
+bool SliceCacheManifest::Parameters::isLayoutCompatible(const Parameters& other) const
+{
+	return m_codeHash == other.m_codeHash && m_width == other.m_width && m_height == other.m_height && m_mipCount == other.m_mipCount && m_pageSize == other.m_pageSize &&
+		m_borderSize == other.m_borderSize && m_blockSize == other.m_blockSize && m_isPacked == other.m_isPacked;
+}
+
+SliceCacheManifest::SliceCacheManifest(const Parameters& parameters, uint32_t sliceCount) : m_parameters(parameters)
+{
+	m_slices.resize(sliceCount);
+}
+
+bool SliceCacheManifest::load(const std::string& filename)
+{
+	std::ifstream input(filename, std::ios::in | std::ios::binary);
+	if (!input.is_open())
+		return false;
+
+	uint32_t magic = 0, version = 0, isComplete = 0, sliceCount = 0;
+	input.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+	input.read(reinterpret_cast<char*>(&version), sizeof(version));
+	if (!input || magic != MAGIC || version != VERSION)
+		return false;
+
+	input.read(reinterpret_cast<char*>(&m_parameters), sizeof(m_parameters));
+	input.read(reinterpret_cast<char*>(&isComplete), sizeof(isComplete));
+	input.read(reinterpret_cast<char*>(&sliceCount), sizeof(sliceCount));
+	if (!input)
+		return false;
+
+	m_slices.resize(sliceCount);
+	input.read(reinterpret_cast<char*>(m_slices.data()), static_cast<std::streamsize>(m_slices.size() * sizeof(SliceInfo)));
+	m_isComplete = isComplete != 0;
+
+	return static_cast<bool>(input);
+}
+
+bool SliceCacheManifest::save(const std::string& filename) const
+{
+	const std::string temporaryFilename = filename + ".tmp";
+	{
+		std::ofstream output(temporaryFilename, std::ios::out | std::ios::binary | std::ios::trunc);
+
+		const uint32_t isComplete = m_isComplete ? 1 : 0;
+		const uint32_t sliceCount = static_cast<uint32_t>(m_slices.size());
+		output.write(reinterpret_cast<const char*>(&MAGIC), sizeof(MAGIC));
+		output.write(reinterpret_cast<const char*>(&VERSION), sizeof(VERSION));
+		output.write(reinterpret_cast<const char*>(&m_parameters), sizeof(m_parameters));
+		output.write(reinterpret_cast<const char*>(&isComplete), sizeof(isComplete));
+		output.write(reinterpret_cast<const char*>(&sliceCount), sizeof(sliceCount));
+		output.write(reinterpret_cast<const char*>(m_slices.data()), static_cast<std::streamsize>(m_slices.size() * sizeof(SliceInfo)));
+
+		if (!output)
+		{
+			Wolf::Debug::sendError("Failed to write slice cache manifest " + temporaryFilename);
+			return false;
+		}
+	}
+
+	std::error_code errorCode;
+	std::filesystem::rename(temporaryFilename, filename, errorCode);
+	if (errorCode)
+	{
+		Wolf::Debug::sendError("Failed to rename slice cache manifest " + temporaryFilename + ": " + errorCode.message());
+		return false;
+	}
+
+	return true;
+}
+
+bool SliceCacheManifest::isComplete() const
+{
+	if (!m_isComplete)
+		return false;
+
+	for (const SliceInfo& sliceInfo : m_slices)
+	{
+		if (!sliceInfo.m_isBuilt)
+			return false;
+	}
+	return true;
+}
+
+void SliceCacheManifest::computeSourceFileInfo(const std::string& sourceFilePath, uint64_t& outSize, int64_t& outLastWriteTime)
+{
+	outSize = 0;
+	outLastWriteTime = 0;
+
+	std::error_code errorCode;
+	if (!std::filesystem::is_regular_file(sourceFilePath, errorCode))
+		return;
+
+	outSize = std::filesystem::file_size(sourceFilePath, errorCode);
+	outLastWriteTime = std::filesystem::last_write_time(sourceFilePath, errorCode).time_since_epoch().count();
+}
+
+// FNV-1a on 8 bytes words, slices are hundreds of KB and hashing must stay far cheaper than compressing them
+uint64_t SliceCacheManifest::computeHash(const void* data, size_t size)
+{
+	constexpr uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ull;
+	constexpr uint64_t FNV_PRIME = 0x100000001b3ull;
+
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	uint64_t hash = FNV_OFFSET_BASIS ^ size;
+
+	size_t offset = 0;
+	for (; offset + sizeof(uint64_t) <= size; offset += sizeof(uint64_t))
+	{
+		uint64_t word;
+		memcpy(&word, bytes + offset, sizeof(word));
+		hash = (hash ^ word) * FNV_PRIME;
+	}
+	for (; offset < size; ++offset)
+	{
+		hash = (hash ^ bytes[offset]) * FNV_PRIME;
+	}
+
+	// Final mix so all bits of the last words reach the high bits
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdull;
+	hash ^= hash >> 33;
+
+	return hash;
+}
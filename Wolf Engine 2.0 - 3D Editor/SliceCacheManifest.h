@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Describes a virtual texture sliced cache: what it has been built from and every slice it contains.
+// Cache validation reads this single file instead of the slices. When the source or a slice changes, only slices whose source pixels differ,
+// or whose stored data doesn't match its hash anymore, are rebuilt.
+class SliceCacheManifest
+{
+public:
+	static constexpr const char* FILENAME = "manifest.bin";
+	static constexpr uint32_t MAGIC = 0x4d545657; // "WVTM"
+	static constexpr uint32_t VERSION = 3; // 2 had no m_isPacked
+
+	struct Parameters
+	{
+		uint64_t m_codeHash = 0; // ImageFormatter::HASH
+		uint64_t m_sourceFileSize = 0; // 0 when there's no source file
+		int64_t m_sourceLastWriteTime = 0;
+		uint32_t m_width = 0;
+		uint32_t m_height = 0;
+		uint32_t m_mipCount = 0;
+		uint32_t m_pageSize = 0;
+		uint32_t m_borderSize = 0;
+		uint32_t m_blockSize = 0;
+		uint32_t m_isPacked = 0;
+		uint32_t m_padding = 0;
+
+		bool operator==(const Parameters& other) const = default;
+		// Slices built with 'other' can be reused if their source pixels didn't change
+		[[nodiscard]] bool isLayoutCompatible(const Parameters& other) const;
+	};
+
+	struct SliceInfo
+	{
+		uint64_t m_sourceHash = 0; // source pixels of the slice, borders included
+		uint64_t m_contentHash = 0; // data stored for the slice, without the loose file header
+		uint32_t m_size = 0;
+		uint32_t m_isBuilt = 0;
+	};
+
+	SliceCacheManifest() = default;
+	SliceCacheManifest(const Parameters& parameters, uint32_t sliceCount);
+
+	bool load(const std::string& filename); // returns false if the file is missing or not a manifest
+	bool save(const std::string& filename) const; // written to a temporary file and renamed, a manifest on disk is never partially written
+
+	// Slices are ordered by mip, then slice Y, then slice X, as in SliceArchive
+	[[nodiscard]] const Parameters& getParameters() const { return m_parameters; }
+	[[nodiscard]] uint32_t getSliceCount() const { return static_cast<uint32_t>(m_slices.size()); }
+	[[nodiscard]] const SliceInfo& getSliceInfo(uint32_t sliceIdx) const { return m_slices[sliceIdx]; }
+	void setSliceInfo(uint32_t sliceIdx, const SliceInfo& sliceInfo) { m_slices[sliceIdx] = sliceInfo; } // slices are set from different threads, one thread per slice
+	// Complete once every slice is built, a manifest is saved incomplete while slices are rewritten so an interrupted build is detected
+	void setIsComplete(bool isComplete) { m_isComplete = isComplete; }
+	[[nodiscard]] bool isComplete() const;
+
+	static void computeSourceFileInfo(const std::string& sourceFilePath, uint64_t& outSize, int64_t& outLastWriteTime);
+	static uint64_t computeHash(const void* data, size_t size);
+
+private:
+	Parameters m_parameters;
+	std::vector<SliceInfo> m_slices;
+	bool m_isComplete = false;
+};
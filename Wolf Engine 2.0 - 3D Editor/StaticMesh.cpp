@@ -137,15 +137,23 @@ bool StaticMesh::getMeshesToRender(std::vector<DrawManager::DrawMeshInfo>& outLi
 	return true;
 }
 
-bool StaticMesh::getInstancesForRayTracedWorld(std::vector<RayTracedWorldManager::RayTracedWorldInfo::InstanceInfo>& instanceInfos)
+bool StaticMesh::getInstancesForRayTracedWorld(std::vector<RayTracedWorldManager::RayTracedWorldInfo::InstanceInfo>& instanceInfos, float blasBuildPriority, AssetId& outPendingBLASAssetId)
 {
 	PROFILE_FUNCTION
 
 	if (!m_assetManager->isMeshLoaded(m_modelAssetId))
 		return false;
 
-	RayTracedWorldManager::RayTracedWorldInfo::InstanceInfo instanceInfo { m_assetManager->getBLAS(m_modelAssetId, m_rayTracedWorldLOD, m_rayTracedWorldLODType), m_transform,
-		m_assetManager->getMaterialIdx(m_modelAssetId), m_assetManager->getMesh(m_modelAssetId) };
+	Wolf::NullableResourceNonOwner<Wolf::BottomLevelAccelerationStructure> bottomLevelAccelerationStructure = m_assetManager->getBLAS(m_modelAssetId, m_rayTracedWorldLOD, m_rayTracedWorldLODType,
+		blasBuildPriority);
+	if (!bottomLevelAccelerationStructure)
+	{
+		outPendingBLASAssetId = m_modelAssetId; // BLAS build is scheduled
+		return false;
+	}
+
+	RayTracedWorldManager::RayTracedWorldInfo::InstanceInfo instanceInfo { bottomLevelAccelerationStructure, m_transform, m_assetManager->getMaterialIdx(m_modelAssetId),
+		m_assetManager->getMesh(m_modelAssetId) };
 
 	if (m_rayTracedWorldLOD > 0)
 	{
@@ -230,6 +238,14 @@ Wolf::BoundingSphere StaticMesh::getBoundingSphere() const
 	return Wolf::BoundingSphere();
 }
 
+uint32_t StaticMesh::getFirstMaterialGPUIdx() const
+{
+	if (m_assetManager->isMeshLoaded(m_modelAssetId))
+		return m_assetManager->getMaterialIdx(m_modelAssetId);
+
+	return 0;
+}
+
 void StaticMesh::onMeshAssetChanged()
 {
 	if (static_cast<std::string>(m_meshAssetParam) == "")
@@ -338,9 +338,9 @@ bool SurfaceCoatingEmitterComponent::getMeshesToRender(std::vector<DrawManager::
     return true;
 }
 
-bool SurfaceCoatingEmitterComponent::getInstancesForRayTracedWorld(std::vector<RayTracedWorldManager::RayTracedWorldInfo::InstanceInfo>& instanceInfos)
+bool SurfaceCoatingEmitterComponent::getInstancesForRayTracedWorld(std::vector<RayTracedWorldManager::RayTracedWorldInfo::InstanceInfo>& instanceInfos, float blasBuildPriority, AssetId& outPendingBLASAssetId)
 {
-    return EditorModelInterface::getInstancesForRayTracedWorld(instanceInfos);
+    return EditorModelInterface::getInstancesForRayTracedWorld(instanceInfos, blasBuildPriority, outPendingBLASAssetId);
 }
 
 bool SurfaceCoatingEmitterComponent::getMeshesForPhysics(std::vector<EditorPhysicsManager::PhysicsMeshInfo>& outList)
@@ -359,6 +359,14 @@ Wolf::BoundingSphere SurfaceCoatingEmitterComponent::getBoundingSphere() const
     return Wolf::BoundingSphere(aabb.getCenter(), aabb.getSize().x * 0.5f);
 }
 
+void SurfaceCoatingEmitterComponent::getMaterialGPUIndices(std::vector<uint32_t>& outMaterialGPUIndices) const
+{
+    for (uint32_t i = 0; i < m_patternImages.size(); ++i)
+    {
+        outMaterialGPUIndices.push_back(m_patternImages[i].getMaterialIdx());
+    }
+}
+
 Wolf::ResourceNonOwner<Wolf::Image> SurfaceCoatingEmitterComponent::getDepthImage()
 {
     return m_depthImage.createNonOwnerResource();
@@ -30,11 +30,12 @@ public:
     void saveCustom() const override {}
 
     bool getMeshesToRender(std::vector<DrawManager::DrawMeshInfo>& outList) override;
-    bool getInstancesForRayTracedWorld(std::vector<RayTracedWorldManager::RayTracedWorldInfo::InstanceInfo>& instanceInfos) override;
+    bool getInstancesForRayTracedWorld(std::vector<RayTracedWorldManager::RayTracedWorldInfo::InstanceInfo>& instanceInfos, float blasBuildPriority, AssetId& outPendingBLASAssetId) override;
     bool getMeshesForPhysics(std::vector<EditorPhysicsManager::PhysicsMeshInfo>& outList) override;
 
     Wolf::AABB getAABB() const override;
     Wolf::BoundingSphere getBoundingSphere() const override;
+    void getMaterialGPUIndices(std::vector<uint32_t>& outMaterialGPUIndices) const override;
 
     [[nodiscard]] Wolf::ResourceNonOwner<Wolf::Image> getDepthImage();
     [[nodiscard]] Wolf::ResourceNonOwner<Wolf::Image> getPatchBoundsImage();
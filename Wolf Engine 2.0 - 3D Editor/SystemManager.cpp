@@ -4,12 +4,14 @@
 #include <chrono>
 #include <fstream>
 #include <iostream>
+#include <limits>
 
 #include <CPUMemoryDebug.h>
 #include <GPUMemoryDebug.h>
 #include <JSONReader.h>
 #include <ProfilerCommon.h>
 
+#include "BlockEncoder.h"
 #include "GraphicSettingsFakeEntity.h"
 #include "RuntimeContext.h"
 #include "Vertex2DTextured.h"
@@ -17,6 +19,11 @@
 SystemManager::SystemManager()
 {
 	m_configuration.reset(new EditorConfiguration("config/editor.ini"));
+	if (m_configuration->getUseEngineBlockEncoder())
+		BlockEncoder::setBackend(BlockEncoder::Backend::ENGINE);
+	else if (m_configuration->getCompareBlockEncoderWithEngine())
+		BlockEncoder::setBackend(BlockEncoder::Backend::COMPARE_WITH_ENGINE);
+	m_shaderSnippetCache.reset(new ShaderSnippetCache(m_configuration->getCacheFolderPath() + "/shaderSnippets.bin"));
 	m_editorParams.reset(new EditorParams(1920, 1080));
 	m_editorPushDataToGPU.reset(new EditorGPUDataTransfersManager);
 
@@ -70,6 +77,23 @@ SystemManager::SystemManager()
 		},
 		m_editorPushDataToGPU.createNonOwnerResource(), m_bufferPoolInterface));
 	m_renderer->setResourceManager(m_assetManager.createNonOwnerResource());
+	if (m_rayTracedWorldManager)
+	{
+		m_assetManager->setIsBLASInUseCallback([this](const Wolf::BottomLevelAccelerationStructure* bottomLevelAccelerationStructure)
+		{
+			return m_rayTracedWorldManager->isBLASInUse(bottomLevelAccelerationStructure);
+		});
+		m_assetManager->setBLASBuiltCallback([this](AssetId assetId)
+		{
+			std::lock_guard lock(m_rayTracedWorldDirtyEntitiesMutex);
+			auto it = m_rayTracedWorldEntitiesWaitingForBLAS.find(assetId);
+			if (it == m_rayTracedWorldEntitiesWaitingForBLAS.end())
+				return;
+
+			m_rayTracedWorldDirtyEntities.insert(it->second.begin(), it->second.end());
+			m_rayTracedWorldEntitiesWaitingForBLAS.erase(it);
+		});
+	}
 
 	m_getEntityFromLoadingPathCallback = [this](const std::string& entityLoadingPath)
 	{
@@ -82,6 +106,18 @@ SystemManager::SystemManager()
 		return Wolf::NullableResourceNonOwner<Entity>();
 	};
 	
+	m_animationSystem.reset(new AnimationSystem(m_renderer->getUpdateGPUBuffersPass()));
+	Wolf::ResourceNonOwner<AnimationLODScheduler> animationLODScheduler = m_animationSystem->getLODScheduler();
+	if (!m_configuration->getAnimationLODTiers().empty())
+	{
+		std::vector<AnimationLODScheduler::Tier> animationLODTiers;
+		if (AnimationLODScheduler::parseTiers(m_configuration->getAnimationLODTiers(), animationLODTiers))
+			animationLODScheduler->setTiers(animationLODTiers);
+		else
+			Wolf::Debug::sendError("Invalid animation LOD tiers: " + m_configuration->getAnimationLODTiers());
+	}
+	animationLODScheduler->setUpdateOffScreen(m_configuration->getUpdateOffScreenAnimations());
+	animationLODScheduler->setInterpolateBetweenUpdates(m_configuration->getInterpolateAnimationUpdates());
 	m_entityContainer.reset(new EntityContainer);
 	m_componentInstancier.reset(new ComponentInstancier(m_wolfInstance->getMaterialsManager(), m_renderer.createNonOwnerResource<RenderingPipelineInterface>(),
 		m_getEntityFromLoadingPathCallback,
@@ -90,7 +126,8 @@ SystemManager::SystemManager()
 		m_wolfInstance->getPhysicsManager(),
 		m_entityContainer.createNonOwnerResource(),
 		m_bufferPoolInterface,
-		[this](ComponentInterface* componentInterface, const std::string& filepath) { return addEntity(filepath, componentInterface->getEntity()->getLoadingPath()); }));
+		[this](ComponentInterface* componentInterface, const std::string& filepath) { return addEntity(filepath, componentInterface->getEntity()->getLoadingPath()); },
+		m_animationSystem.createNonOwnerResource()));
 	
 	if (!m_configuration->getDefaultScene().empty())
 	{
@@ -145,6 +182,8 @@ void SystemManager::run()
 	}
 
 	m_wolfInstance->waitIdle();
+	m_renderer->flushPendingReadbacks();
+	m_shaderSnippetCache->save();
 
 	m_editorPushDataToGPU->clear();
 	m_renderer->clear();
@@ -414,10 +453,37 @@ void SystemManager::openVRAMTrackingPageJSCallback(const ultralight::JSObject& t
 
 	std::string outFileName = "reports/GPU_" + m_currentSceneName + "_" + oss.str() + ".json";
 	Wolf::GPUMemoryDebug::dumpJSON(outFileName);
+	// The GPU report is written by the engine, staging statistics go in their own report loaded along with it by the viewer
+	writeStagingReport("reports/Staging_" + m_currentSceneName + "_" + oss.str() + ".json");
 
 	system("start reports/viewer/vramTrackingViewer.html");
 }
 
+void SystemManager::writeStagingReport(const std::string& reportFileName) const
+{
+	UpdateGPUBuffersPass::StagingStatistics stagingStatistics;
+	m_renderer->getUpdateGPUBuffersPass()->getStagingStatistics(stagingStatistics);
+
+	std::ofstream outFile(reportFileName);
+	if (!outFile.is_open())
+	{
+		Wolf::Debug::sendError("Can't write staging report " + reportFileName);
+		return;
+	}
+
+	outFile << "{\n";
+	outFile << "\t\"type\": \"staging\",\n";
+	outFile << "\t\"allocatedBytes\": " << stagingStatistics.m_allocatedBytes << ",\n";
+	outFile << "\t\"usedBytes\": " << stagingStatistics.m_usedBytes << ",\n";
+	outFile << "\t\"peakAllocatedBytes\": " << stagingStatistics.m_peakAllocatedBytes << ",\n";
+	outFile << "\t\"peakUsedBytes\": " << stagingStatistics.m_peakUsedBytes << ",\n";
+	outFile << "\t\"budget\": " << stagingStatistics.m_budget << ",\n";
+	outFile << "\t\"pageCount\": " << stagingStatistics.m_pageCount << ",\n";
+	outFile << "\t\"overBudgetAllocationCount\": " << stagingStatistics.m_overBudgetAllocationCount << ",\n";
+	outFile << "\t\"releasedPageCount\": " << stagingStatistics.m_releasedPageCount << "\n";
+	outFile << "}\n";
+}
+
 void SystemManager::openSystemRAMTrackingPageJSCallback(const ultralight::JSObject& thisObject, const ultralight::JSArgs& args)
 {
 	auto now = std::chrono::system_clock::now();
@@ -962,6 +1028,18 @@ void SystemManager::goToSelectedEntity() const
 void SystemManager::removeSelectedEntity()
 {
 	Wolf::ResourceNonOwner<Entity>* selectedEntity = m_selectedEntity.release();
+	if (m_rayTracedWorldManager)
+	{
+		Entity* entityToRemove = selectedEntity->operator->();
+		m_rayTracedWorldManager->removeInstances(reinterpret_cast<uint64_t>(entityToRemove));
+		m_rayTracedWorldDirtyEntitiesMutex.lock();
+		m_rayTracedWorldDirtyEntities.erase(entityToRemove);
+		for (auto& [assetId, waitingEntities] : m_rayTracedWorldEntitiesWaitingForBLAS)
+		{
+			std::erase(waitingEntities, entityToRemove);
+		}
+		m_rayTracedWorldDirtyEntitiesMutex.unlock();
+	}
 	m_entityContainer->removeEntity(selectedEntity->operator->());
 	delete selectedEntity;
 
@@ -1061,6 +1139,8 @@ void SystemManager::updateBeforeFrame()
 
 	m_wolfInstance->getCameraList().addCameraForThisFrame(m_camera.get(), CommonCameraIndices::CAMERA_IDX_MAIN);
 	m_camera->setAspect(m_editorParams->getAspect());
+	m_animationSystem->beginFrame(Wolf::g_runtimeContext->getCurrentCPUFrameNumber(), m_camera->getViewMatrix(), m_camera->getProjectionMatrix());
+	requestTextureResolutions();
 
 	m_renderer->update(m_wolfInstance.get());
 
@@ -1096,6 +1176,15 @@ void SystemManager::updateBeforeFrame()
 		m_wolfInstance->setWindowPos(static_cast<float>(winX) + (cursoXPos - m_lastWindowDraggingX), static_cast<float>(winY) + (cursorYPos - m_lastWindowDraggingY));
 	}
 
+	// Animation jobs are queued first, threads take them one by one and move to entities when none is left
+	// Entities can read bones while jobs still run, AnimatedMesh::getBonePosition() returns the previous evaluation
+	m_animationSystem->collectJobs(globalTimer);
+	const uint32_t animationThreadCount = std::min(m_animationSystem->getJobCount(), THREAD_COUNT_BEFORE_FRAME);
+	for (uint32_t i = 0; i < animationThreadCount; ++i)
+	{
+		m_wolfInstance->addJobBeforeFrame([this]() { m_animationSystem->runJobs(); });
+	}
+
 	uint32_t startRange = 0;
 	uint32_t elementCountPerThread = static_cast<uint32_t>(allEntities.size()) / THREAD_COUNT_BEFORE_FRAME;
 	for (uint32_t i = 0; i < THREAD_COUNT_BEFORE_FRAME; ++i)
@@ -1118,27 +1207,44 @@ void SystemManager::updateBeforeFrame()
 
 	m_wolfInstance->addJobBeforeFrame([this, renderList]() { m_debugRenderingManager->addMeshesToRenderList(renderList); }, true);
 
-	m_wolfInstance->addJobBeforeFrame([this, &allEntities]()
+	m_wolfInstance->addJobBeforeFrame([this, viewMatrix = m_camera->getViewMatrix()]()
 	{
-		if (m_rayTracedWorldBuildNeeded)
+		if (m_rayTracedWorldManager)
 		{
-			RayTracedWorldManager::RayTracedWorldInfo tlasInfo;
-
-			bool errorEncountered = false;
-			for (Wolf::ResourceUniqueOwner<Entity>& entity : allEntities)
+			std::vector<Entity*> dirtyEntities;
+			m_rayTracedWorldDirtyEntitiesMutex.lock();
+			dirtyEntities.assign(m_rayTracedWorldDirtyEntities.begin(), m_rayTracedWorldDirtyEntities.end());
+			m_rayTracedWorldDirtyEntities.clear();
+			m_rayTracedWorldDirtyEntitiesMutex.unlock();
+
+			std::vector<RayTracedWorldManager::RayTracedWorldInfo::InstanceInfo> instances;
+			for (Entity* entity : dirtyEntities)
 			{
-				if (!entity->getInstancesForRayTracedWorld(tlasInfo.m_instances))
+				instances.clear();
+				const Wolf::BoundingSphere boundingSphere = entity->getBoundingSphere();
+				const float blasBuildPriority = BLASBuildScheduler::computeVisibilityPriority(viewMatrix, boundingSphere.getCenter(), boundingSphere.getRadius());
+				AssetId pendingBLASAssetId = NO_ASSET;
+				if (!entity->getInstancesForRayTracedWorld(instances, blasBuildPriority, pendingBLASAssetId))
 				{
-					errorEncountered = true;
-					break;
+					m_rayTracedWorldDirtyEntitiesMutex.lock();
+					if (pendingBLASAssetId != NO_ASSET)
+					{
+						// Made dirty again by the BLAS built callback
+						m_rayTracedWorldEntitiesWaitingForBLAS[pendingBLASAssetId].push_back(entity);
+					}
+					else
+					{
+						// Not ready yet (mesh may still be loading), try again next frame
+						m_rayTracedWorldDirtyEntities.insert(entity);
+					}
+					m_rayTracedWorldDirtyEntitiesMutex.unlock();
+					continue;
 				}
-			}
 
-			if (!tlasInfo.m_instances.empty() && !errorEncountered)
-			{
-				m_rayTracedWorldManager->requestBuild(tlasInfo);
-				m_rayTracedWorldBuildNeeded = false;
+				m_rayTracedWorldManager->setInstances(reinterpret_cast<uint64_t>(entity), instances);
 			}
+
+			m_rayTracedWorldManager->requestBuild();
 		}
 	}, true);
 
@@ -1189,6 +1295,14 @@ void SystemManager::loadScene()
 	m_debugRenderingManager->clearBeforeFrame();
 
 	m_selectedEntity.reset(nullptr);
+	if (m_rayTracedWorldManager)
+	{
+		m_rayTracedWorldManager->clearInstances();
+		m_rayTracedWorldDirtyEntitiesMutex.lock();
+		m_rayTracedWorldDirtyEntities.clear();
+		m_rayTracedWorldEntitiesWaitingForBLAS.clear();
+		m_rayTracedWorldDirtyEntitiesMutex.unlock();
+	}
 	m_entityContainer->clear();
 
 	m_drawManager->clear();
@@ -1315,11 +1429,13 @@ Entity* SystemManager::addEntity(const std::string& filePath, const std::string&
 			m_entityChanged = true;
 			m_entityChangedMutex.unlock();
 		},
-		[this](Entity*)
+		[this](Entity* entity)
 		{
 			if (g_editorConfiguration->getEnableRayTracing())
 			{
-				m_rayTracedWorldBuildNeeded = true;
+				m_rayTracedWorldDirtyEntitiesMutex.lock();
+				m_rayTracedWorldDirtyEntities.insert(entity);
+				m_rayTracedWorldDirtyEntitiesMutex.unlock();
 			}
 		},
 		m_getEntityFromLoadingPathCallback);
@@ -1350,7 +1466,9 @@ Entity* SystemManager::addEntity(const std::string& filePath, const std::string&
 
 	if (g_editorConfiguration->getEnableRayTracing())
 	{
-		m_rayTracedWorldBuildNeeded = true;
+		m_rayTracedWorldDirtyEntitiesMutex.lock();
+		m_rayTracedWorldDirtyEntities.insert(newEntity);
+		m_rayTracedWorldDirtyEntitiesMutex.unlock();
 	}
 
 	return newEntity;
@@ -1409,6 +1527,47 @@ void SystemManager::updateUISelectedEntity() const
 	m_wolfInstance->evaluateUserInterfaceScript("refreshWindowSize()");
 }
 
+void SystemManager::requestTextureResolutions()
+{
+	// Streamed levels follow the camera slowly anyway, no need to go through all entities each frame
+	if (Wolf::g_runtimeContext->getCurrentCPUFrameNumber() % TEXTURE_RESOLUTION_REQUEST_PERIOD != 0)
+		return;
+
+	PROFILE_SCOPED("Request texture resolutions")
+
+	const glm::mat4& viewMatrix = m_camera->getViewMatrix();
+	// Pixel diameter of a sphere is radius / distance * projection[1][1] * render height
+	const float pixelsPerRadiusOverDistance = std::abs(m_camera->getProjectionMatrix()[1][1]) * static_cast<float>(m_editorParams->getRenderHeight());
+
+	std::vector<uint32_t> materialGPUIndices;
+	const std::vector<Wolf::ResourceUniqueOwner<Entity>>& allEntities = m_entityContainer->getEntities();
+	for (const Wolf::ResourceUniqueOwner<Entity>& entity : allEntities)
+	{
+		if (!entity->hasModelComponent())
+			continue;
+
+		materialGPUIndices.clear();
+		entity->getMaterialGPUIndices(materialGPUIndices);
+		std::erase(materialGPUIndices, MaterialEditor::DEFAULT_MATERIAL_IDX);
+		if (materialGPUIndices.empty())
+			continue;
+
+		const Wolf::BoundingSphere boundingSphere = entity->getBoundingSphere();
+		const float distance = glm::length(glm::vec3(viewMatrix * glm::vec4(boundingSphere.getCenter(), 1.0f)));
+
+		// Camera inside the sphere, the surface can cover the whole screen
+		uint32_t resolution = std::numeric_limits<uint32_t>::max();
+		if (distance > boundingSphere.getRadius())
+		{
+			resolution = static_cast<uint32_t>(std::ceil(boundingSphere.getRadius() / distance * pixelsPerRadiusOverDistance));
+		}
+		for (const uint32_t materialGPUIdx : materialGPUIndices)
+		{
+			m_assetManager->requestMaterialTextureResolution(materialGPUIdx, resolution);
+		}
+	}
+}
+
 void SystemManager::exportScene()
 {
 	// TODO
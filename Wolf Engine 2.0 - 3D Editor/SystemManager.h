@@ -1,5 +1,8 @@
 #pragma once
 
+#include <unordered_map>
+#include <unordered_set>
+
 #include <FirstPersonCamera.h>
 #include <WolfEngine.h>
 
@@ -11,6 +14,7 @@
 #include "GameContext.h"
 #include "RayTracedWorldManager.h"
 #include "RenderingPipeline.h"
+#include "ShaderSnippetCache.h"
 #include "AssetManager.h"
 #include "EditorGPUDataTransfersManager.h"
 
@@ -52,6 +56,7 @@ private:
 	ultralight::JSValue getVRAMRequestedJSCallback(const ultralight::JSObject& thisObject, const ultralight::JSArgs& args);
 	void openVRAMTrackingPageJSCallback(const ultralight::JSObject& thisObject, const ultralight::JSArgs& args);
 	void openSystemRAMTrackingPageJSCallback(const ultralight::JSObject& thisObject, const ultralight::JSArgs& args);
+	void writeStagingReport(const std::string& reportFileName) const;
 	ultralight::JSValue pickFileJSCallback(const ultralight::JSObject& thisObject, const ultralight::JSArgs& args);
 	ultralight::JSValue pickFolderJSCallback(const ultralight::JSObject& thisObject, const ultralight::JSArgs& args) const;
 	ultralight::JSValue getRenderHeightJSCallback(const ultralight::JSObject& thisObject, const ultralight::JSArgs& args) const;
@@ -91,10 +96,14 @@ private:
 	void removeSelectedEntity();
 	void updateUISelectedEntity() const;
 
+	static constexpr uint32_t TEXTURE_RESOLUTION_REQUEST_PERIOD = 8; // in frames
+	void requestTextureResolutions();
+
 	Wolf::ResourceUniqueOwner<EditorGPUDataTransfersManager> m_editorPushDataToGPU; // Needs to be deleted after wolf instance
 	std::unique_ptr<Wolf::WolfEngine> m_wolfInstance;
 	Wolf::ResourceUniqueOwner<RayTracedWorldManager> m_rayTracedWorldManager; // Needs to be deleted after renderer
 	Wolf::ResourceUniqueOwner<EditorConfiguration> m_configuration; // Needs to be deleted after asset manager
+	Wolf::ResourceUniqueOwner<ShaderSnippetCache> m_shaderSnippetCache; // Needs to be deleted after renderer
 	Wolf::ResourceUniqueOwner<AssetManager> m_assetManager; // Needs to be deleted after renderer
 	Wolf::ResourceUniqueOwner<RenderingPipeline> m_renderer;
 	Wolf::NullableResourceNonOwner<Wolf::BufferPoolInterface> m_bufferPoolInterface;
@@ -115,11 +124,14 @@ private:
 	std::mutex m_contextMutex;
 	std::vector<GameContext> m_gameContexts;
 	bool m_entitySelectionRequested = false;
+	Wolf::ResourceUniqueOwner<AnimationSystem> m_animationSystem; // Needs to be deleted after entities
 	Wolf::ResourceUniqueOwner<EntityContainer> m_entityContainer;
 	Wolf::ResourceUniqueOwner<ComponentInstancier> m_componentInstancier;
 	std::unique_ptr<Wolf::FirstPersonCamera> m_camera;
 	Wolf::ResourceUniqueOwner<DrawManager> m_drawManager;
-	bool m_rayTracedWorldBuildNeeded = false;
+	std::unordered_set<Entity*> m_rayTracedWorldDirtyEntities; // entities whose ray traced world instances must be updated
+	std::unordered_map<AssetId, std::vector<Entity*>> m_rayTracedWorldEntitiesWaitingForBLAS; // made dirty again once the BLAS of the asset is built
+	std::mutex m_rayTracedWorldDirtyEntitiesMutex; // also protects entities waiting for BLAS
 	Wolf::ResourceUniqueOwner<EditorPhysicsManager> m_editorPhysicsManager;
 
 	std::unique_ptr<EditorParams> m_editorParams;
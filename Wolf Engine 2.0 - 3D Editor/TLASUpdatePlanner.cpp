@@ -0,0 +1,82 @@
+#include "TLASUpdatePlanner.h"
+
+#include <algorithm>
+#include <limits>
+
+TLASUpdatePlanner::UpdateType TLASUpdatePlanner::computeUpdateType(const std::vector<Instance>& instances)
+{
+	bool structureChanged = m_rebuildRequested || instances.size() != m_currentInstances.size();
+	bool transformChanged = false;
+	for (size_t i = 0; i < instances.size() && !structureChanged; ++i)
+	{
+		if (instances[i].m_geometryKey != m_currentInstances[i].m_geometryKey)
+		{
+			structureChanged = true;
+		}
+		else if (instances[i].m_transform != m_currentInstances[i].m_transform)
+		{
+			transformChanged = true;
+		}
+	}
+
+	m_currentInstances = instances;
+
+	if (!structureChanged)
+	{
+		if (!transformChanged)
+			return UpdateType::NONE;
+
+		m_estimatedDegradation = computeDegradation(instances);
+		if (m_estimatedDegradation <= m_maxRefitDegradation)
+		{
+			m_refitCountSinceRebuild++;
+			return UpdateType::REFIT;
+		}
+	}
+
+	m_instancesAtLastRebuild = instances;
+	m_sceneDiagonalAtLastRebuild = computeSceneDiagonal(instances);
+	m_estimatedDegradation = 0.0f;
+	m_refitCountSinceRebuild = 0;
+	m_rebuildRequested = false;
+
+	return UpdateType::REBUILD;
+}
+
+float TLASUpdatePlanner::computeSceneDiagonal(const std::vector<Instance>& instances)
+{
+	if (instances.empty())
+		return 1.0f;
+
+	glm::vec3 minPosition(std::numeric_limits<float>::max());
+	glm::vec3 maxPosition(-std::numeric_limits<float>::max());
+	for (const Instance& instance : instances)
+	{
+		const glm::vec3 position(instance.m_transform[3]);
+		minPosition = glm::min(minPosition, position);
+		maxPosition = glm::max(maxPosition, position);
+	}
+
+	// Instance extents are unknown here, avoid a null diagonal when all instances are at the same place
+	return std::max(glm::length(maxPosition - minPosition), 1.0f);
+}
+
+float TLASUpdatePlanner::computeDegradation(const std::vector<Instance>& instances) const
+{
+	// Mean displacement since last rebuild, rotation / scale changes are approximated with the change of the basis vectors
+	float totalDisplacement = 0.0f;
+	for (size_t i = 0; i < instances.size(); ++i)
+	{
+		const glm::mat4& transform = instances[i].m_transform;
+		const glm::mat4& transformAtRebuild = m_instancesAtLastRebuild[i].m_transform;
+
+		float displacement = glm::length(glm::vec3(transform[3] - transformAtRebuild[3])) / m_sceneDiagonalAtLastRebuild;
+		for (uint32_t axis = 0; axis < 3; ++axis)
+		{
+			displacement += glm::length(glm::vec3(transform[axis] - transformAtRebuild[axis])) / 3.0f;
+		}
+		totalDisplacement += displacement;
+	}
+
+	return totalDisplacement / static_cast<float>(std::max(instances.size(), static_cast<size_t>(1)));
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Decides how the top level acceleration structure must be updated when the ray traced world changes:
+// - NONE: nothing changed
+// - REFIT: only transforms changed, the TLAS can be updated in place
+// - REBUILD: instances have been added, removed or have changed geometry, or refits have degraded the TLAS too much
+// Refit quality is estimated by how far instances have moved since last rebuild, relatively to the scene size at that time.
+class TLASUpdatePlanner
+{
+public:
+	enum class UpdateType { NONE, REFIT, REBUILD };
+
+	struct Instance
+	{
+		uint64_t m_geometryKey; // any change in geometry, material or BLAS must change this key
+		glm::mat4 m_transform;
+	};
+
+	static constexpr float DEFAULT_MAX_REFIT_DEGRADATION = 0.1f;
+
+	// Returns the update needed to go from the previous call's instances to these and records them as the current state
+	UpdateType computeUpdateType(const std::vector<Instance>& instances);
+	void requestRebuild() { m_rebuildRequested = true; }
+	void setMaxRefitDegradation(float maxRefitDegradation) { m_maxRefitDegradation = maxRefitDegradation; }
+
+	[[nodiscard]] float getEstimatedDegradation() const { return m_estimatedDegradation; }
+	[[nodiscard]] uint32_t getRefitCountSinceRebuild() const { return m_refitCountSinceRebuild; }
+
+private:
+	static float computeSceneDiagonal(const std::vector<Instance>& instances);
+	float computeDegradation(const std::vector<Instance>& instances) const;
+
+	std::vector<Instance> m_currentInstances;
+	std::vector<Instance> m_instancesAtLastRebuild;
+	float m_sceneDiagonalAtLastRebuild = 1.0f;
+
+	float m_maxRefitDegradation = DEFAULT_MAX_REFIT_DEGRADATION;
+	float m_estimatedDegradation = 0.0f;
+	uint32_t m_refitCountSinceRebuild = 0;
+	bool m_rebuildRequested = true;
+};
@@ -0,0 +1,193 @@
+#include "TextureResidencyManager.h"
+
+#include <iterator>
+#include <queue>
+
+TextureResidencyManager::TextureResidencyManager(uint64_t memoryBudget, uint64_t maxImageAllocation, uint64_t maxStreamedBytesPerFrame)
+	: m_memoryBudget(memoryBudget), m_maxImageAllocation(maxImageAllocation), m_maxStreamedBytesPerFrame(maxStreamedBytesPerFrame)
+{
+}
+
+uint32_t TextureResidencyManager::registerImage(const Key& key, uint32_t width, uint32_t height, const std::vector<uint64_t>& levelSizes)
+{
+	unregisterImage(key);
+
+	const uint32_t levelCount = static_cast<uint32_t>(levelSizes.size());
+	const uint32_t tailFirstMip = computeTailFirstMip(width, height, levelCount);
+
+	uint64_t allocatedSize = 0;
+	for (uint32_t mipLevel = tailFirstMip; mipLevel < levelCount; ++mipLevel)
+		allocatedSize += levelSizes[mipLevel];
+	const uint64_t residentSize = allocatedSize;
+
+	uint32_t firstAllocatedMip = tailFirstMip;
+	while (firstAllocatedMip > 0 && allocatedSize + levelSizes[firstAllocatedMip - 1] <= m_maxImageAllocation)
+	{
+		firstAllocatedMip--;
+		allocatedSize += levelSizes[firstAllocatedMip];
+	}
+
+	Entry& entry = m_entries[computeHash(key)];
+	entry.m_key = key;
+	entry.m_levelSizes = levelSizes;
+	entry.m_maxExtent = std::max(width, height);
+	entry.m_firstAllocatedMip = firstAllocatedMip;
+	entry.m_tailFirstMip = tailFirstMip;
+	entry.m_firstResidentMip = tailFirstMip;
+	entry.m_firstWantedMip = 0;
+	entry.m_hasBeenRequested = false;
+	entry.m_registrationIdx = m_nextRegistrationIdx++;
+
+	m_allocatedMemory += allocatedSize;
+	m_residentMemory += residentSize;
+
+	return firstAllocatedMip;
+}
+
+void TextureResidencyManager::unregisterImage(const Key& key)
+{
+	auto it = m_entries.find(computeHash(key));
+	if (it != m_entries.end())
+		removeEntry(it);
+}
+
+void TextureResidencyManager::removeAsset(uint32_t assetId)
+{
+	for (auto it = m_entries.begin(); it != m_entries.end();)
+	{
+		auto nextIt = std::next(it);
+		if (it->second.m_key.m_assetId == assetId)
+			removeEntry(it);
+		it = nextIt;
+	}
+}
+
+void TextureResidencyManager::clear()
+{
+	m_entries.clear();
+	m_allocatedMemory = 0;
+	m_residentMemory = 0;
+}
+
+void TextureResidencyManager::requestResolution(const Key& key, uint32_t resolution, uint32_t frameNumber)
+{
+	auto it = m_entries.find(computeHash(key));
+	if (it == m_entries.end())
+		return;
+
+	Entry& entry = it->second;
+	const uint32_t levelCount = static_cast<uint32_t>(entry.m_levelSizes.size());
+
+	// Smallest level still covering the requested resolution
+	uint32_t firstWantedMip = 0;
+	while (firstWantedMip + 1 < levelCount && std::max(entry.m_maxExtent >> (firstWantedMip + 1), 1u) >= resolution)
+		firstWantedMip++;
+
+	// Several users can request the same image during a frame, the largest resolution wins
+	if (entry.m_lastRequestFrameNumber == frameNumber && entry.m_hasBeenRequested)
+		firstWantedMip = std::min(firstWantedMip, entry.m_firstWantedMip);
+
+	entry.m_firstWantedMip = firstWantedMip;
+	entry.m_lastRequestFrameNumber = frameNumber;
+	entry.m_hasBeenRequested = true;
+}
+
+void TextureResidencyManager::popLevelsToStream(std::vector<StreamRequest>& outRequests)
+{
+	struct Candidate
+	{
+		uint64_t m_size;
+		Entry* m_entry;
+	};
+	// Smallest first, then most recently requested, then oldest registration
+	auto isStreamedAfter = [](const Candidate& a, const Candidate& b)
+		{
+			if (a.m_size != b.m_size)
+				return a.m_size > b.m_size;
+			if (a.m_entry->m_lastRequestFrameNumber != b.m_entry->m_lastRequestFrameNumber)
+				return a.m_entry->m_lastRequestFrameNumber < b.m_entry->m_lastRequestFrameNumber;
+			return a.m_entry->m_registrationIdx > b.m_entry->m_registrationIdx;
+		};
+	std::priority_queue<Candidate, std::vector<Candidate>, decltype(isStreamedAfter)> candidates(isStreamedAfter);
+
+	for (auto& [hash, entry] : m_entries)
+	{
+		if (entry.m_firstResidentMip > computeFirstMipToStream(entry))
+			candidates.push({ entry.m_levelSizes[entry.m_firstResidentMip - 1], &entry });
+	}
+
+	uint64_t streamedBytes = 0;
+	while (!candidates.empty())
+	{
+		const Candidate candidate = candidates.top();
+		if (!outRequests.empty() && streamedBytes + candidate.m_size > m_maxStreamedBytesPerFrame)
+			break;
+		// Other candidates are at least as big
+		if (m_residentMemory + candidate.m_size > m_memoryBudget)
+			break;
+		candidates.pop();
+
+		Entry& entry = *candidate.m_entry;
+		entry.m_firstResidentMip--;
+		outRequests.push_back({ entry.m_key, entry.m_firstResidentMip });
+		streamedBytes += candidate.m_size;
+		m_residentMemory += candidate.m_size;
+
+		if (entry.m_firstResidentMip > computeFirstMipToStream(entry))
+			candidates.push({ entry.m_levelSizes[entry.m_firstResidentMip - 1], &entry });
+	}
+}
+
+void TextureResidencyManager::evictUnwantedLevels()
+{
+	for (auto& [hash, entry] : m_entries)
+	{
+		const uint32_t firstKeptMip = std::min(entry.m_firstWantedMip, entry.m_tailFirstMip);
+		for (; entry.m_firstResidentMip < firstKeptMip; ++entry.m_firstResidentMip)
+			m_residentMemory -= entry.m_levelSizes[entry.m_firstResidentMip];
+	}
+}
+
+uint32_t TextureResidencyManager::getPendingLevelCount() const
+{
+	uint32_t pendingLevelCount = 0;
+	for (const auto& [hash, entry] : m_entries)
+	{
+		const uint32_t firstMipToStream = computeFirstMipToStream(entry);
+		if (entry.m_firstResidentMip > firstMipToStream)
+			pendingLevelCount += entry.m_firstResidentMip - firstMipToStream;
+	}
+	return pendingLevelCount;
+}
+
+uint32_t TextureResidencyManager::getFirstAllocatedMip(const Key& key) const
+{
+	auto it = m_entries.find(computeHash(key));
+	return it != m_entries.end() ? it->second.m_firstAllocatedMip : 0;
+}
+
+uint32_t TextureResidencyManager::getFirstResidentMip(const Key& key) const
+{
+	auto it = m_entries.find(computeHash(key));
+	return it != m_entries.end() ? it->second.m_firstResidentMip : 0;
+}
+
+uint32_t TextureResidencyManager::computeTailFirstMip(uint32_t width, uint32_t height, uint32_t levelCount)
+{
+	uint32_t tailFirstMip = 0;
+	while (tailFirstMip + 1 < levelCount && std::max(std::max(width, height) >> tailFirstMip, 1u) > TAIL_MAX_EXTENT)
+		tailFirstMip++;
+	return tailFirstMip;
+}
+
+void TextureResidencyManager::removeEntry(std::unordered_map<uint64_t, Entry>::iterator it)
+{
+	const Entry& entry = it->second;
+	for (uint32_t mipLevel = entry.m_firstAllocatedMip; mipLevel < entry.m_levelSizes.size(); ++mipLevel)
+	{
+		m_allocatedMemory -= entry.m_levelSizes[mipLevel];
+		if (mipLevel >= entry.m_firstResidentMip)
+			m_residentMemory -= entry.m_levelSizes[mipLevel];
+	}
+	m_entries.erase(it);
+}
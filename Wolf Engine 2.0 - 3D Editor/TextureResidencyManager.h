@@ -0,0 +1,88 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Decides which mip levels of streamed images are allocated and which ones hold their real pixels.
+// Levels are allocated when the image is registered and allocations can't change afterwards: images stay bound to their texture sets, which the engine can't rebind.
+// Each image allocates at most 'maxImageAllocation' so no image gets a share of memory at the expense of the ones registered after it, top levels over it are left out.
+// The tail (levels up to TAIL_MAX_EXTENT) is always allocated and loaded with the image so materials can be drawn right away.
+// The memory budget bounds resident levels: allocated levels are streamed in over the next frames, smallest first across all images, up to the resolution requested
+// for each image and while they fit in the budget. When the requested resolution of an image falls, its levels above it are evicted and their memory goes back to the budget.
+// Evicted levels keep their last pixels on GPU, as allocations don't shrink, and are read again if they are requested later.
+// Only bookkeeping is done here, owners read and upload the levels.
+class TextureResidencyManager
+{
+public:
+	static constexpr uint32_t TAIL_MAX_EXTENT = 128;
+
+	struct Key
+	{
+		uint32_t m_assetId;
+		uint32_t m_format; // Wolf::Format
+	};
+
+	TextureResidencyManager(uint64_t memoryBudget, uint64_t maxImageAllocation, uint64_t maxStreamedBytesPerFrame);
+
+	// 'levelSizes' are the byte sizes of each level, full resolution first. Returns the first allocated level, levels from the tail are resident (see getFirstResidentMip)
+	uint32_t registerImage(const Key& key, uint32_t width, uint32_t height, const std::vector<uint64_t>& levelSizes);
+	void unregisterImage(const Key& key);
+	void removeAsset(uint32_t assetId);
+	void clear();
+
+	// 'resolution' is the largest size, in texels, the image is displayed at. Levels bigger than needed aren't streamed, images are streamed up to full resolution until a request is made.
+	// Requests of the same frame are merged, the largest resolution is kept
+	void requestResolution(const Key& key, uint32_t resolution, uint32_t frameNumber);
+
+	struct StreamRequest
+	{
+		Key m_key;
+		uint32_t m_mipLevel;
+	};
+	// Smallest levels first until 'maxStreamedBytesPerFrame' is reached, at least one level is returned so streaming always progresses. Levels which don't fit in the memory budget wait.
+	// Returned levels are considered resident, the caller must upload them
+	void popLevelsToStream(std::vector<StreamRequest>& outRequests);
+	// Resident levels above the requested resolutions are given back to the memory budget, called once the requests of a frame are merged. The tail is never evicted
+	void evictUnwantedLevels();
+
+	void setBudget(uint64_t memoryBudget, uint64_t maxStreamedBytesPerFrame) { m_memoryBudget = memoryBudget; m_maxStreamedBytesPerFrame = maxStreamedBytesPerFrame; }
+	[[nodiscard]] uint64_t getMemoryBudget() const { return m_memoryBudget; }
+	[[nodiscard]] uint64_t getAllocatedMemory() const { return m_allocatedMemory; }
+	[[nodiscard]] uint64_t getResidentMemory() const { return m_residentMemory; } // allocated levels holding their real pixels, tails included
+	[[nodiscard]] uint32_t getPendingLevelCount() const; // wanted levels not resident yet, including the ones waiting for budget
+	[[nodiscard]] bool contains(const Key& key) const { return m_entries.contains(computeHash(key)); }
+	[[nodiscard]] uint32_t getFirstAllocatedMip(const Key& key) const;
+	[[nodiscard]] uint32_t getFirstResidentMip(const Key& key) const;
+
+	static uint32_t computeTailFirstMip(uint32_t width, uint32_t height, uint32_t levelCount);
+
+private:
+	static uint64_t computeHash(const Key& key) { return (static_cast<uint64_t>(key.m_assetId) << 32) | key.m_format; }
+
+	struct Entry
+	{
+		Key m_key;
+		std::vector<uint64_t> m_levelSizes;
+		uint32_t m_maxExtent; // largest side of the full resolution
+		uint32_t m_firstAllocatedMip;
+		uint32_t m_tailFirstMip;
+		uint32_t m_firstResidentMip;
+		uint32_t m_firstWantedMip; // from the requested resolution
+		uint32_t m_lastRequestFrameNumber = 0;
+		bool m_hasBeenRequested = false;
+		uint64_t m_registrationIdx; // older images first when levels have the same size
+	};
+	[[nodiscard]] uint32_t computeFirstMipToStream(const Entry& entry) const { return std::max(entry.m_firstAllocatedMip, entry.m_firstWantedMip); }
+	void removeEntry(std::unordered_map<uint64_t, Entry>::iterator it);
+
+	std::unordered_map<uint64_t, Entry> m_entries;
+	uint64_t m_nextRegistrationIdx = 0;
+
+	uint64_t m_memoryBudget;
+	uint64_t m_maxImageAllocation;
+	uint64_t m_maxStreamedBytesPerFrame;
+	uint64_t m_allocatedMemory = 0;
+	uint64_t m_residentMemory = 0;
+};
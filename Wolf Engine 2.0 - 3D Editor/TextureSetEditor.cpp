@@ -149,6 +149,7 @@ uint32_t TextureSetEditor::getTextureSetIdx() const
 Wolf::MaterialsGPUManager::TextureSetInfo TextureSetEditor::computeTextureSetInfo()
 {
 	Wolf::MaterialsGPUManager::TextureSetInfo r{};
+	m_textureImages.clear();
 
 	if (m_shadingMode == static_cast<uint32_t>(Wolf::MaterialsGPUManager::MaterialInfo::ShadingMode::GGX) || m_shadingMode == static_cast<uint32_t>(Wolf::MaterialsGPUManager::MaterialInfo::ShadingMode::AnisoGGX))
 	{
@@ -167,24 +168,27 @@ Wolf::MaterialsGPUManager::TextureSetInfo TextureSetEditor::computeTextureSetInf
 		}
 		outputLayout.albedoCompression = m_enableAlpha ? Wolf::ImageCompression::Compression::BC3 : Wolf::ImageCompression::Compression::BC1;
 		outputLayout.normalCompression = Wolf::ImageCompression::Compression::BC5;
+		outputLayout.compressionQuality = static_cast<TextureSetLoader::CompressionQuality>(static_cast<uint32_t>(m_compressionQuality));
 
 		TextureSetLoader textureSetLoader(textureSetFileInfo, outputLayout, true, m_assetManager, m_textureSetAssetId);
 
 		if (AssetId assetId = textureSetLoader.getImageAssetId(0); assetId != NO_ASSET)
 		{
-			r.images[0] = m_assetManager->getImage(assetId, Wolf::Format::BC1_RGB_SRGB_BLOCK);
+			r.images[0] = m_assetManager->getImage(assetId, textureSetLoader.getImageFormat(0));
 			r.slicesFolders[0] = m_assetManager->getImageSlicesFolder(assetId);
+			m_textureImages.emplace_back(assetId, textureSetLoader.getImageFormat(0));
 		}
 
 		if (AssetId assetId = textureSetLoader.getImageAssetId(1); assetId != NO_ASSET)
 		{
-			r.images[1] = m_assetManager->getImage(assetId, Wolf::Format::BC5_UNORM_BLOCK);
+			r.images[1] = m_assetManager->getImage(assetId, textureSetLoader.getImageFormat(1));
 			r.slicesFolders[1] = m_assetManager->getImageSlicesFolder(assetId);
+			m_textureImages.emplace_back(assetId, textureSetLoader.getImageFormat(1));
 		}
 
 		if (AssetId assetId = textureSetLoader.getImageAssetId(2); assetId != NO_ASSET)
 		{
-			r.images[2] = m_assetManager->getCombinedImage(assetId, Wolf::Format::BC3_UNORM_BLOCK);
+			r.images[2] = m_assetManager->getCombinedImage(assetId, textureSetLoader.getImageFormat(2));
 			r.slicesFolders[2] = m_assetManager->getCombinedImageSlicesFolder(assetId);
 		}
 
@@ -200,6 +204,8 @@ Wolf::MaterialsGPUManager::TextureSetInfo TextureSetEditor::computeTextureSetInf
 		TextureSetLoader textureSetLoader(materialFileInfo, m_assetManager);
 		r.images[0] = m_assetManager->getImage(textureSetLoader.getImageAssetId(0), Wolf::Format::R8G8B8A8_UNORM);
 		r.images[1] = m_assetManager->getImage(textureSetLoader.getImageAssetId(1), Wolf::Format::R8G8B8A8_UNORM);
+		m_textureImages.emplace_back(textureSetLoader.getImageAssetId(0), Wolf::Format::R8G8B8A8_UNORM);
+		m_textureImages.emplace_back(textureSetLoader.getImageAssetId(1), Wolf::Format::R8G8B8A8_UNORM);
 	}
 	else if (m_shadingMode == static_cast<uint32_t>(Wolf::MaterialsGPUManager::MaterialInfo::ShadingMode::AlphaOnly))
 	{
@@ -209,17 +215,40 @@ Wolf::MaterialsGPUManager::TextureSetInfo TextureSetEditor::computeTextureSetInf
 
 		TextureSetLoader textureSetLoader(materialFileInfo, m_assetManager);
 		r.images[0] = m_assetManager->getImage(textureSetLoader.getImageAssetId(0), Wolf::Format::R8G8B8A8_UNORM);
+		m_textureImages.emplace_back(textureSetLoader.getImageAssetId(0), Wolf::Format::R8G8B8A8_UNORM);
 	}
 
 	return r;
 }
 
+void TextureSetEditor::requestTextureResolution(uint32_t resolution) const
+{
+	// Texture is repeated 'scale' times over the surface
+	if (m_samplingMode == static_cast<uint32_t>(Wolf::MaterialsGPUManager::TextureSetInfo::SamplingMode::TEXTURE_COORDS))
+	{
+		const glm::vec2 textureCoordsScale = static_cast<glm::vec2>(m_textureCoordsScale);
+		resolution = static_cast<uint32_t>(static_cast<float>(resolution) * std::max(std::max(textureCoordsScale.x, textureCoordsScale.y), 1.0f));
+	}
+
+	// Combined images aren't streamed
+	for (const auto& [imageAssetId, format] : m_textureImages)
+	{
+		m_assetManager->requestImageResolution(imageAssetId, format, resolution);
+	}
+}
+
 void TextureSetEditor::onShadingModeChanged()
 {
 	notifySubscribers(0);
 	m_shadingModeChanged = true;
 }
 
+void TextureSetEditor::onCompressionQualityChanged()
+{
+	m_textureChanged = true;
+	notifySubscribers();
+}
+
 void TextureSetEditor::updateAssetId(AssetId& outAssetId , EditorParamString& param)
 {
 	if (static_cast<std::string>(param) == "")
@@ -36,6 +36,8 @@ public:
 	void getAllVisibleParams(std::vector<EditorParamInterface*>& out) const;
 
 	uint32_t getTextureSetIdx() const;
+	// 'resolution' is the on screen size of a surface using the texture set, images are requested at that size times the texture coordinates scale
+	void requestTextureResolution(uint32_t resolution) const;
 
 	std::string getAlbedoPath() const { return m_albedoPathParam; }
 	std::string getNormalPath() const { return m_normalPathParam; }
@@ -60,6 +62,7 @@ private:
 	AssetId m_textureSetAssetId;
 
 	Wolf::MaterialsGPUManager::TextureSetInfo computeTextureSetInfo();
+	std::vector<std::pair<AssetId, Wolf::Format>> m_textureImages; // images (not combined) bound by the last computeTextureSetInfo
 
 	void onShadingModeChanged();
 
@@ -102,6 +105,9 @@ private:
 	EditorParamBool m_enableAlpha = EditorParamBool("Enable alpha",TAB, "Alpha", [this]() { /* TODO */ });
 	EditorParamString m_alphaPathParam = EditorParamString("Alpha map", TAB, "Alpha", [this]() { onAlphaAssetChanged(); }, EditorParamString::ParamStringType::ASSET);
 
+	void onCompressionQualityChanged();
+	EditorParamEnum m_compressionQuality = EditorParamEnum({ "Standard (BC1/BC3)", "High (BC7)" }, "Compression quality", TAB, "Compression", [this]() { onCompressionQualityChanged(); });
+
 	EditorParamEnum m_shadingMode = EditorParamEnum(Wolf::MaterialsGPUManager::MaterialInfo::SHADING_MODE_STRING_LIST, "Shading Mode", TAB, "Shading", [this]() { onShadingModeChanged(); }, false, true);
 
 	EditorParamUInt m_textureSetIdx = EditorParamUInt("Texture set index", TAB, "Debug", 0, 1000, EditorParamUInt::ParamUIntType::NUMBER, false, true);
@@ -121,7 +127,7 @@ private:
 	bool m_changeTriplanarScaleRequested = false;
 	EditorParamVector3 m_triplanarScale = EditorParamVector3("Scale", TAB, "Triplanar", 0.0f, 8.0f, [this]() { onTriplanarScaleChanged(); });
 
-	std::array<EditorParamInterface*, 6> m_shadingModeGGXParams
+	std::array<EditorParamInterface*, 7> m_shadingModeGGXParams
 	{
 		&m_albedoPathParam,
 		&m_normalPathParam,
@@ -129,9 +135,10 @@ private:
 		&m_metalnessParam,
 		&m_aoParam,
 		&m_enableAlpha,
+		&m_compressionQuality,
 	};
 
-	std::array<EditorParamInterface*, 7> m_shadingModeGGXAnisoParams
+	std::array<EditorParamInterface*, 8> m_shadingModeGGXAnisoParams
 	{
 		&m_albedoPathParam,
 		&m_normalPathParam,
@@ -140,6 +147,7 @@ private:
 		&m_aoParam,
 		&m_anisoStrengthParam,
 		&m_enableAlpha,
+		&m_compressionQuality,
 	};
 
 	std::array<EditorParamInterface*, 2> m_shadingModeSixWaysLightingParams
@@ -170,7 +178,7 @@ private:
 		&m_triplanarScale
 	};
 
-	std::array<EditorParamInterface*, 15> m_allParams =
+	std::array<EditorParamInterface*, 16> m_allParams =
 	{
 		&m_albedoPathParam,
 		&m_normalPathParam,
@@ -182,6 +190,7 @@ private:
 		&m_sixWaysLightmap1,
 		&m_enableAlpha,
 		&m_alphaPathParam,
+		&m_compressionQuality,
 		&m_shadingMode,
 		&m_samplingMode,
 		&m_textureCoordsScale,
@@ -2,6 +2,8 @@
 
 #include <filesystem>
 
+#include <Configuration.h>
+
 #include "AssetManager.h"
 #include "ImageFileLoader.h"
 #include "Timer.h"
@@ -11,8 +13,19 @@ TextureSetLoader::TextureSetLoader(const TextureSetAssetsInfoGGX& textureSet, co
 	Wolf::Debug::sendInfo("Loading texture set " + textureSet.m_name);
 	Wolf::Timer globalTimer("Loading texture set " + textureSet.m_name);
 
+	// Virtual texture atlases have a fixed format per texture
+	bool useHighQualityCompression = outputLayout.compressionQuality == CompressionQuality::HIGH;
+	if (useHighQualityCompression && Wolf::g_configuration->getUseVirtualTexture())
+	{
+		Wolf::Debug::sendWarning("High quality compression is not available with virtual texture, texture set " + textureSet.m_name + " uses standard compression");
+		useHighQualityCompression = false;
+	}
+
+	std::vector<std::pair<AssetId, AssetImageInterface::LoadingRequest>> loadingRequests;
+
 	// Albedo
 	m_imageAssetIds[0] = textureSet.m_albedoAssetId;
+	m_imageFormats[0] = useHighQualityCompression ? Wolf::Format::BC7_SRGB_BLOCK : Wolf::Format::BC1_RGB_SRGB_BLOCK;
 	if (textureSet.m_albedoAssetId != NO_ASSET)
 	{
 		if (outputLayout.albedoCompression != DEFAULT_ALBEDO_COMPRESSION)
@@ -22,14 +35,16 @@ TextureSetLoader::TextureSetLoader(const TextureSetAssetsInfoGGX& textureSet, co
 
 
 		AssetImageInterface::LoadingRequest loadingRequest{};
-		loadingRequest.m_format = Wolf::Format::BC1_RGB_SRGB_BLOCK;
+		loadingRequest.m_format = m_imageFormats[0];
 		loadingRequest.m_loadMips = true;
 		loadingRequest.m_canBeVirtualized = true;
-		assetManager->requestImageLoading(textureSet.m_albedoAssetId, loadingRequest, true);
+		loadingRequest.m_streamMips = !g_editorConfiguration->getDisableTextureStreaming();
+		loadingRequests.emplace_back(textureSet.m_albedoAssetId, loadingRequest);
 	}
 
 	// Normal
 	m_imageAssetIds[1] = textureSet.m_normalAssetId;
+	m_imageFormats[1] = Wolf::Format::BC5_UNORM_BLOCK;
 	if (textureSet.m_normalAssetId != NO_ASSET)
 	{
 		if (outputLayout.normalCompression != DEFAULT_NORMAL_COMPRESSION)
@@ -41,7 +56,8 @@ TextureSetLoader::TextureSetLoader(const TextureSetAssetsInfoGGX& textureSet, co
 		loadingRequest.m_format = Wolf::Format::BC5_UNORM_BLOCK;
 		loadingRequest.m_loadMips = true;
 		loadingRequest.m_canBeVirtualized = true;
-		assetManager->requestImageLoading(textureSet.m_normalAssetId, loadingRequest, true);
+		loadingRequest.m_streamMips = !g_editorConfiguration->getDisableTextureStreaming();
+		loadingRequests.emplace_back(textureSet.m_normalAssetId, loadingRequest);
 	}
 
 
@@ -84,50 +100,77 @@ TextureSetLoader::TextureSetLoader(const TextureSetAssetsInfoGGX& textureSet, co
 			combinedImageEditor->setAssetId(channelIdx, channelAssetsId[channelIdx]);
 		}
 
+		// Not BC4 even when roughness is the only channel: materials read all 4 channels and BC4 samples alpha (anisotropy strength) as 1 where missing channels are stored as 0
+		m_imageFormats[2] = useHighQualityCompression ? Wolf::Format::BC7_UNORM_BLOCK : Wolf::Format::BC3_UNORM_BLOCK;
+
 		AssetImageInterface::LoadingRequest loadingRequest{};
-		loadingRequest.m_format = Wolf::Format::BC3_UNORM_BLOCK;
+		loadingRequest.m_format = m_imageFormats[2];
 		loadingRequest.m_loadMips = true;
 		loadingRequest.m_canBeVirtualized = true;
-		assetManager->requestCombinedImageLoading(m_imageAssetIds[2], loadingRequest, true);
+		loadingRequests.emplace_back(m_imageAssetIds[2], loadingRequest);
 	}
 	else
 	{
 		m_imageAssetIds[2] = NO_ASSET;
 	}
+
+	// Sources are independent, their caches are built concurrently. Loading then only reads caches, in the same order as before
+	assetManager->createMissingImageCaches(loadingRequests);
+	for (const auto& [assetId, loadingRequest] : loadingRequests)
+	{
+		if (assetId == m_imageAssetIds[2])
+			assetManager->requestCombinedImageLoading(assetId, loadingRequest, true);
+		else
+			assetManager->requestImageLoading(assetId, loadingRequest, true);
+	}
 }
 
 TextureSetLoader::TextureSetLoader(const TextureSetAssetsInfoSixWayLighting& textureSet, const Wolf::ResourceReference<AssetManager>& assetManager)
 {
+	std::vector<std::pair<AssetId, AssetImageInterface::LoadingRequest>> loadingRequests;
+
 	m_imageAssetIds[0] = textureSet.m_tex0AssetId;
+	m_imageFormats[0] = Wolf::Format::R8G8B8A8_UNORM;
 	if (textureSet.m_tex0AssetId != NO_ASSET)
 	{
 		AssetImageInterface::LoadingRequest loadingRequest{};
 		loadingRequest.m_format = Wolf::Format::R8G8B8A8_UNORM;
 		loadingRequest.m_loadMips = true;
 		loadingRequest.m_canBeVirtualized = true;
-		assetManager->requestImageLoading(textureSet.m_tex0AssetId, loadingRequest, true);
+		loadingRequest.m_streamMips = !g_editorConfiguration->getDisableTextureStreaming();
+		loadingRequests.emplace_back(textureSet.m_tex0AssetId, loadingRequest);
 	}
 
 	m_imageAssetIds[1] = textureSet.m_tex1AssetId;
+	m_imageFormats[1] = Wolf::Format::R8G8B8A8_UNORM;
 	if (textureSet.m_tex1AssetId != NO_ASSET)
 	{
 		AssetImageInterface::LoadingRequest loadingRequest{};
 		loadingRequest.m_format = Wolf::Format::R8G8B8A8_UNORM;
 		loadingRequest.m_loadMips = true;
 		loadingRequest.m_canBeVirtualized = true;
-		assetManager->requestImageLoading(textureSet.m_tex1AssetId, loadingRequest, true);
+		loadingRequest.m_streamMips = !g_editorConfiguration->getDisableTextureStreaming();
+		loadingRequests.emplace_back(textureSet.m_tex1AssetId, loadingRequest);
+	}
+
+	assetManager->createMissingImageCaches(loadingRequests);
+	for (const auto& [assetId, loadingRequest] : loadingRequests)
+	{
+		assetManager->requestImageLoading(assetId, loadingRequest, true);
 	}
 }
 
 TextureSetLoader::TextureSetLoader(const TextureSetAssetInfoAlphaOnly& textureSet, const Wolf::ResourceReference<AssetManager>& assetManager)
 {
 	m_imageAssetIds[0] = textureSet.m_alphaMapAssetId;
+	m_imageFormats[0] = Wolf::Format::R8G8B8A8_UNORM;
 	if (textureSet.m_alphaMapAssetId != NO_ASSET)
 	{
 		AssetImageInterface::LoadingRequest loadingRequest{};
 		loadingRequest.m_format = Wolf::Format::R8G8B8A8_UNORM;
 		loadingRequest.m_loadMips = true;
 		loadingRequest.m_canBeVirtualized = true;
+		loadingRequest.m_streamMips = !g_editorConfiguration->getDisableTextureStreaming();
 		assetManager->requestImageLoading(textureSet.m_alphaMapAssetId, loadingRequest, true);
 	}
 }
\ No newline at end of file
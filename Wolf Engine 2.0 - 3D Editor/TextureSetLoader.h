@@ -18,10 +18,17 @@ public:
 		EACH_TEXTURE_A_FILE
 	};
 
+	enum class CompressionQuality
+	{
+		STANDARD, // BC1 albedo, BC3 combined image
+		HIGH // BC7 albedo and combined image, not available with virtual texture
+	};
+
 	struct OutputLayout
 	{
 		Wolf::ImageCompression::Compression albedoCompression;
 		Wolf::ImageCompression::Compression normalCompression;
+		CompressionQuality compressionQuality = CompressionQuality::STANDARD;
 	};
 
 	static constexpr Wolf::ImageCompression::Compression DEFAULT_ALBEDO_COMPRESSION = Wolf::ImageCompression::Compression::BC1;
@@ -83,9 +90,11 @@ public:
 
 	[[nodiscard]] const std::string& getOutputSlicesFolder(uint32_t idx) const { return m_outputFolders[idx]; }
 	[[nodiscard]] AssetId getImageAssetId(uint32_t idx) const { return m_imageAssetIds[idx]; }
+	[[nodiscard]] Wolf::Format getImageFormat(uint32_t idx) const { return m_imageFormats[idx]; }
 
 private:
 	std::array<AssetId, Wolf::MaterialsGPUManager::TEXTURE_COUNT_PER_TEXTURE_SET> m_imageAssetIds;
+	std::array<Wolf::Format, Wolf::MaterialsGPUManager::TEXTURE_COUNT_PER_TEXTURE_SET> m_imageFormats{};
 	std::array<std::string, Wolf::MaterialsGPUManager::TEXTURE_COUNT_PER_TEXTURE_SET> m_outputFolders;
 	bool m_useCache;
 };
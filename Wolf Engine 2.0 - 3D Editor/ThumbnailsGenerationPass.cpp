@@ -4,12 +4,14 @@
 #include <stb_image_write.h>
 
 #include <CameraList.h>
+#include <Configuration.h>
 #include <DebugMarker.h>
 #include <FrameBuffer.h>
 #include <GraphicCameraInterface.h>
 #include <Image.h>
 #include <Pipeline.h>
 #include <RenderPass.h>
+#include <RuntimeContext.h>
 
 #include "AnimationHelper.h"
 #include "CommonLayouts.h"
@@ -24,7 +26,8 @@ ThumbnailsGenerationPass::ThumbnailsGenerationPass()
 void ThumbnailsGenerationPass::clear()
 {
 	m_pendingRequests.clear();
-	m_currentRequests.clear();
+	if (m_readbackQueue)
+		m_readbackQueue->clear();
 }
 
 void ThumbnailsGenerationPass::initializeResources(const Wolf::InitializationContext& context)
@@ -57,9 +60,15 @@ void ThumbnailsGenerationPass::initializeResources(const Wolf::InitializationCon
 	createCopyInfo.mipLevelCount = 1;
 	createCopyInfo.imageTiling = VK_IMAGE_TILING_LINEAR;
 	createCopyInfo.memoryProperty = Wolf::ImageMemoryProperty::HOST;
-	m_copyImage.reset(Wolf::Image::createImage(createCopyInfo));
-	m_copyImage->setImageLayout({ Wolf::ImageLayout::TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, 0, 1,
-		Wolf::ImageLayout::UNDEFINED });
+	const uint32_t readbackSlotCount = Wolf::g_configuration->getMaxCachedFrames();
+	m_readbackQueue.reset(new AsyncReadbackQueue(readbackSlotCount, Wolf::g_configuration->getMaxCachedFrames()));
+	m_copyImages.resize(readbackSlotCount);
+	for (std::unique_ptr<Wolf::Image>& copyImage : m_copyImages)
+	{
+		copyImage.reset(Wolf::Image::createImage(createCopyInfo));
+		copyImage->setImageLayout({ Wolf::ImageLayout::TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, 0, 1,
+			Wolf::ImageLayout::UNDEFINED });
+	}
 
 	m_renderPass.reset(Wolf::RenderPass::createRenderPass({ color, depth }));
 	m_commandBuffer.reset(Wolf::CommandBuffer::createCommandBuffer(Wolf::QueueType::GRAPHIC, false));
@@ -134,12 +143,17 @@ void ThumbnailsGenerationPass::initializeResources(const Wolf::InitializationCon
 	descriptorSetGenerator.setUniformBuffer(0, *m_uniformBuffer);
 	m_descriptorSet->update(descriptorSetGenerator.getDescriptorSetCreateInfo());
 
-	m_animationDescriptorSet.reset(Wolf::DescriptorSet::createDescriptorSet(*m_animationDescriptorSetLayout));
-	Wolf::DescriptorSetGenerator animationsDescriptorSetGenerator(m_animationDescriptorSetGenerator.getDescriptorLayouts());
 	static constexpr uint32_t MAX_BONE_COUNT = 1024;
-	m_bonesBuffer.reset(Wolf::Buffer::createBuffer(MAX_BONE_COUNT * sizeof(glm::mat4), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
-	animationsDescriptorSetGenerator.setBuffer(0, *m_bonesBuffer);
-	m_animationDescriptorSet->update(animationsDescriptorSetGenerator.getDescriptorSetCreateInfo());
+	m_animationDescriptorSets.resize(readbackSlotCount);
+	m_bonesBuffers.resize(readbackSlotCount);
+	for (uint32_t slotIdx = 0; slotIdx < readbackSlotCount; ++slotIdx)
+	{
+		m_animationDescriptorSets[slotIdx].reset(Wolf::DescriptorSet::createDescriptorSet(*m_animationDescriptorSetLayout));
+		Wolf::DescriptorSetGenerator animationsDescriptorSetGenerator(m_animationDescriptorSetGenerator.getDescriptorLayouts());
+		m_bonesBuffers[slotIdx].reset(Wolf::Buffer::createBuffer(MAX_BONE_COUNT * sizeof(glm::mat4), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
+		animationsDescriptorSetGenerator.setBuffer(0, *m_bonesBuffers[slotIdx]);
+		m_animationDescriptorSets[slotIdx]->update(animationsDescriptorSetGenerator.getDescriptorSetCreateInfo());
+	}
 }
 
 void ThumbnailsGenerationPass::resize(const Wolf::InitializationContext& context)
@@ -154,66 +168,65 @@ uint32_t ThumbnailsGenerationPass::computeTotalImageToDraw(const Request& reques
 	return std::max(static_cast<uint32_t>((maxTimer * 1000.0f) / DELAY_BETWEEN_ICON_FRAMES_MS), 1u);
 }
 
-void ThumbnailsGenerationPass::record(const Wolf::RecordContext& context)
+void ThumbnailsGenerationPass::writeOutput(const Request& request, uint32_t readbackSlotIdx)
 {
-	if (!m_currentRequests.empty())
-	{
-		Request& previousRequest = m_currentRequests.front();
+	const std::unique_ptr<Wolf::Image>& copyImage = m_copyImages[readbackSlotIdx];
 
-		// TODO: This is not very elegant, we should try the next frame if data is not ready instead of blocking the frame
-		context.m_graphicAPIManager->waitIdle();
+	const void* outputBytes = copyImage->map();
+	VkSubresourceLayout copyResourceLayout;
+	copyImage->getResourceLayout(copyResourceLayout);
 
-		const void* outputBytes = m_copyImage->map();
-		VkSubresourceLayout copyResourceLayout;
-		m_copyImage->getResourceLayout(copyResourceLayout);
+	if (!request.m_animationData)
+	{
+		stbi_write_png(request.m_outputFullFilepath.c_str(), OUTPUT_SIZE, OUTPUT_SIZE, 4, outputBytes, static_cast<int>(copyResourceLayout.rowPitch));
+	}
+	else
+	{
+		uint32_t totalImagesToDraw = computeTotalImageToDraw(request);
 
-		if (!previousRequest.m_animationData)
+		if (request.m_imageLeftToDraw == totalImagesToDraw - 1)
 		{
-			stbi_write_png(previousRequest.m_outputFullFilepath.c_str(), OUTPUT_SIZE, OUTPUT_SIZE, 4, outputBytes, static_cast<int>(copyResourceLayout.rowPitch));
-		}
-		else
-		{
-			uint32_t totalImagesToDraw = computeTotalImageToDraw(previousRequest);
+			static constexpr int quality = 10;
+			static constexpr bool useGlobalColorMap = true;
+			static constexpr int loop = 0;
+			static constexpr int preAllocSize = useGlobalColorMap ? OUTPUT_SIZE * OUTPUT_SIZE * 3 * 3 : OUTPUT_SIZE * OUTPUT_SIZE * 3;
 
-			if (previousRequest.m_imageLeftToDraw == totalImagesToDraw - 1)
+			if (!m_gifEncoder.open(request.m_outputFullFilepath, OUTPUT_SIZE, OUTPUT_SIZE, quality, useGlobalColorMap, loop, preAllocSize))
 			{
-				static constexpr int quality = 10;
-				static constexpr bool useGlobalColorMap = true;
-				static constexpr int loop = 0;
-				static constexpr int preAllocSize = useGlobalColorMap ? OUTPUT_SIZE * OUTPUT_SIZE * 3 * 3 : OUTPUT_SIZE * OUTPUT_SIZE * 3;
-
-				if (!m_gifEncoder.open(previousRequest.m_outputFullFilepath, OUTPUT_SIZE, OUTPUT_SIZE, quality, useGlobalColorMap, loop, preAllocSize))
-				{
-					Wolf::Debug::sendError("Error when opening gif file");
-				}
+				Wolf::Debug::sendError("Error when opening gif file");
 			}
+		}
 
-			std::vector<uint8_t> data(static_cast<size_t>(OUTPUT_SIZE) * OUTPUT_SIZE * 4);
-			for (size_t i = 0; i < OUTPUT_SIZE; ++i)
-			{
-				memcpy(&data[i * OUTPUT_SIZE * 4], &static_cast<const uint8_t*>(outputBytes)[i * copyResourceLayout.rowPitch], static_cast<size_t>(OUTPUT_SIZE) * 4);
-			}
-			m_gifEncoder.push(GifEncoder::PIXEL_FORMAT_RGBA, data.data(), OUTPUT_SIZE, OUTPUT_SIZE, static_cast<uint32_t>(DELAY_BETWEEN_ICON_FRAMES_MS) / 10);
-
-			if (previousRequest.m_imageLeftToDraw == 0)
-			{
-				if (!m_gifEncoder.close())
-				{
-					Wolf::Debug::sendError("Error when closing gif file");
-				}
-			}
+		std::vector<uint8_t> data(static_cast<size_t>(OUTPUT_SIZE) * OUTPUT_SIZE * 4);
+		for (size_t i = 0; i < OUTPUT_SIZE; ++i)
+		{
+			memcpy(&data[i * OUTPUT_SIZE * 4], &static_cast<const uint8_t*>(outputBytes)[i * copyResourceLayout.rowPitch], static_cast<size_t>(OUTPUT_SIZE) * 4);
 		}
+		m_gifEncoder.push(GifEncoder::PIXEL_FORMAT_RGBA, data.data(), OUTPUT_SIZE, OUTPUT_SIZE, static_cast<uint32_t>(DELAY_BETWEEN_ICON_FRAMES_MS) / 10);
 
-		if (previousRequest.m_imageLeftToDraw == 0)
+		if (request.m_imageLeftToDraw == 0)
 		{
-			previousRequest.m_onGeneratedCallback();
+			if (!m_gifEncoder.close())
+			{
+				Wolf::Debug::sendError("Error when closing gif file");
+			}
 		}
+	}
 
-		m_copyImage->unmap();
-		m_currentRequests.pop_front();
+	if (request.m_imageLeftToDraw == 0)
+	{
+		request.m_onGeneratedCallback();
 	}
 
-	if (m_pendingRequests.empty())
+	copyImage->unmap();
+}
+
+void ThumbnailsGenerationPass::record(const Wolf::RecordContext& context)
+{
+	// Results of previous frames are written once the GPU is done with them, instead of waiting for the whole device to be idle
+	m_readbackQueue->processCompletedReadbacks(Wolf::g_runtimeContext->getCurrentCPUFrameNumber());
+
+	if (m_pendingRequests.empty() || !m_readbackQueue->isSlotAvailable())
 	{
 		m_drawRecordedThisFrame = false;
 		return;
@@ -227,6 +240,13 @@ void ThumbnailsGenerationPass::record(const Wolf::RecordContext& context)
 		request.m_imageLeftToDraw = 1;
 	}
 
+	Request requestToWrite = request;
+	requestToWrite.m_imageLeftToDraw--;
+	const uint32_t readbackSlotIdx = m_readbackQueue->reserveSlot(Wolf::g_runtimeContext->getCurrentCPUFrameNumber(), [this, requestToWrite](uint32_t slotIdx)
+	{
+		writeOutput(requestToWrite, slotIdx);
+	});
+
 	UniformBufferData uniformBufferData{};
 	uniformBufferData.firstMaterialIdx = request.m_firstMaterialIdx;
 	m_uniformBuffer->transferCPUMemory(&uniformBufferData, sizeof(UniformBufferData));
@@ -240,9 +260,9 @@ void ThumbnailsGenerationPass::record(const Wolf::RecordContext& context)
 		std::vector<BoneInfoCPU> bonesInfoCPU(boneCount);
 
 		computeBonesInfo(request.m_animationData->m_rootBones.data(), glm::mat4(1.0f), (static_cast<float>(totalImagesToDraw - request.m_imageLeftToDraw) * DELAY_BETWEEN_ICON_FRAMES_MS) / 1000.0f,
-			glm::mat4(1.0f), bonesInfoGPU, bonesInfoCPU);
+			glm::mat4(1.0f), bonesInfoGPU.data(), bonesInfoCPU);
 
-		m_bonesBuffer->transferCPUMemory(bonesInfoGPU.data(), static_cast<uint32_t>(bonesInfoGPU.size() * sizeof(BoneInfoGPU)));
+		m_bonesBuffers[readbackSlotIdx]->transferCPUMemory(bonesInfoGPU.data(), static_cast<uint32_t>(bonesInfoGPU.size() * sizeof(BoneInfoGPU)));
 	}
 
 	m_commandBuffer->beginCommandBuffer();
@@ -270,7 +290,7 @@ void ThumbnailsGenerationPass::record(const Wolf::RecordContext& context)
 	m_commandBuffer->bindDescriptorSet(m_descriptorSet.createConstNonOwnerResource(), 2, *pipeline);
 	if (request.m_animationData)
 	{
-		m_commandBuffer->bindDescriptorSet(m_animationDescriptorSet.createConstNonOwnerResource(), 3, *pipeline);
+		m_commandBuffer->bindDescriptorSet(m_animationDescriptorSets[readbackSlotIdx].createConstNonOwnerResource(), 3, *pipeline);
 	}
 	request.m_mesh->draw(*m_commandBuffer, CommonCameraIndices::CAMERA_IDX_THUMBNAIL_GENERATION);
 
@@ -290,11 +310,11 @@ void ThumbnailsGenerationPass::record(const Wolf::RecordContext& context)
 	copyRegion.dstSubresource.layerCount = 1;
 	copyRegion.dstOffset = { 0, 0, 0 };
 
-	Wolf::Extent3D extent = m_copyImage->getExtent();
+	Wolf::Extent3D extent = m_copyImages[readbackSlotIdx]->getExtent();
 	copyRegion.extent = { extent.width, extent.height, extent.depth };
 
 	m_renderTargetImage->setImageLayoutWithoutOperation(Wolf::ImageLayout::TRANSFER_SRC_OPTIMAL); // at this point, render pass should have set final layout
-	m_copyImage->recordCopyGPUImage(*m_renderTargetImage, copyRegion, *m_commandBuffer);
+	m_copyImages[readbackSlotIdx]->recordCopyGPUImage(*m_renderTargetImage, copyRegion, *m_commandBuffer);
 
 	Wolf::DebugMarker::endRegion(m_commandBuffer.get());
 
@@ -303,7 +323,6 @@ void ThumbnailsGenerationPass::record(const Wolf::RecordContext& context)
 	m_drawRecordedThisFrame = true;
 
 	request.m_imageLeftToDraw--;
-	m_currentRequests.push_back(request);
 	if (request.m_imageLeftToDraw == 0)
 	{
 		m_pendingRequests.pop_front();
@@ -335,6 +354,12 @@ void ThumbnailsGenerationPass::addCameraForThisFrame(Wolf::CameraList& cameraLis
 	cameraList.addCameraForThisFrame(m_camera.get(), CommonCameraIndices::CAMERA_IDX_THUMBNAIL_GENERATION);
 }
 
+void ThumbnailsGenerationPass::flushPendingReadbacks()
+{
+	if (m_readbackQueue)
+		m_readbackQueue->processAllReadbacks();
+}
+
 ThumbnailsGenerationPass::Request::Request(Wolf::ResourceNonOwner<Wolf::Mesh> mesh, Wolf::NullableResourceNonOwner<AnimationData> animationData, uint32_t firstMaterialIdx, std::string outputFullFilepath,
 	const std::function<void()>& onGeneratedCallback, const glm::mat4& viewMatrix)
 	: m_mesh(mesh), m_animationData(animationData), m_firstMaterialIdx(firstMaterialIdx), m_outputFullFilepath(std::move(outputFullFilepath)), m_onGeneratedCallback(onGeneratedCallback), m_viewMatrix(viewMatrix)
@@ -9,6 +9,7 @@
 #include <Mesh.h>
 #include <ShaderParser.h>
 
+#include "AsyncReadbackQueue.h"
 #include "SkeletonVertex.h"
 
 class ThumbnailsGenerationPass : public Wolf::CommandRecordBase
@@ -27,6 +28,7 @@ public:
 	void submit(const Wolf::SubmitContext& context) override;
 
 	void addCameraForThisFrame(Wolf::CameraList& cameraList) const;
+	void flushPendingReadbacks(); // device must be idle
 
 	class Request
 	{
@@ -48,19 +50,22 @@ public:
 
 private:
 	static uint32_t computeTotalImageToDraw(const Request& request);
+	void writeOutput(const Request& request, uint32_t readbackSlotIdx);
 
 	static constexpr Wolf::Format OUTPUT_FORMAT = Wolf::Format::R8G8B8A8_UNORM;
 
 	std::deque<Request> m_pendingRequests;
-	std::deque<Request> m_currentRequests;
 	bool m_drawRecordedThisFrame = false;
 
 	std::unique_ptr<Wolf::RenderPass> m_renderPass;
 	std::unique_ptr<Wolf::FrameBuffer> m_frameBuffer;
 	std::unique_ptr<Wolf::Image> m_renderTargetImage;
-	std::unique_ptr<Wolf::Image> m_copyImage;
 	std::unique_ptr<Wolf::Image> m_depthImage;
 
+	// Output is read back asynchronously, one copy image per readback slot
+	std::unique_ptr<AsyncReadbackQueue> m_readbackQueue;
+	std::vector<std::unique_ptr<Wolf::Image>> m_copyImages;
+
 
 
 	std::unique_ptr<Wolf::ShaderParser> m_fragmentShaderParser;
@@ -80,8 +85,8 @@ private:
 
 	Wolf::DescriptorSetLayoutGenerator m_animationDescriptorSetGenerator;
 	Wolf::ResourceUniqueOwner<Wolf::DescriptorSetLayout> m_animationDescriptorSetLayout;
-	Wolf::ResourceUniqueOwner<Wolf::DescriptorSet> m_animationDescriptorSet;
-	Wolf::ResourceUniqueOwner<Wolf::Buffer> m_bonesBuffer;
+	std::vector<Wolf::ResourceUniqueOwner<Wolf::DescriptorSet>> m_animationDescriptorSets; // one per readback slot as bones are written while previous frames are in flight
+	std::vector<Wolf::ResourceUniqueOwner<Wolf::Buffer>> m_bonesBuffers;
 
 	std::unique_ptr<Wolf::FirstPersonCamera> m_camera;
 
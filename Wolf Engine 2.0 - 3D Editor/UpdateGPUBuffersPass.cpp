@@ -1,5 +1,10 @@
 #include "UpdateGPUBuffersPass.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
 #include <Configuration.h>
 #include <DebugMarker.h>
 #include <ProfilerCommon.h>
@@ -7,13 +12,27 @@
 
 #include <GPUDataTransfersManager.h>
 
+#include "EditorConfiguration.h"
+
 void UpdateGPUBuffersPass::initializeResources(const Wolf::InitializationContext& context)
 {
 	m_commandBuffer.reset(Wolf::CommandBuffer::createCommandBuffer(Wolf::QueueType::TRANSFER, false));
 	createSemaphores(context, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, false);
 
-	m_currentRequestsQueues.resize(Wolf::g_configuration->getMaxCachedFrames());
-	m_stagingBufferPool.reset(new StagingBufferPool(268'435'456));
+	m_stagingBufferPool.reset(new StagingBufferPool(STAGING_PAGE_SIZE, g_editorConfiguration->getStagingMemoryBudget()));
+
+	const uint32_t maxCachedFrames = Wolf::g_configuration->getMaxCachedFrames();
+	m_requestArenas.resize(maxCachedFrames + 1);
+	for (Wolf::ResourceUniqueOwner<RequestArena>& requestArena : m_requestArenas)
+	{
+		requestArena.reset(new RequestArena);
+	}
+	m_addRequestArenaIdx = 0;
+	m_currentRequestArenaIndices.resize(maxCachedFrames);
+	for (uint32_t i = 0; i < maxCachedFrames; ++i)
+	{
+		m_currentRequestArenaIndices[i] = i + 1;
+	}
 }
 
 void UpdateGPUBuffersPass::resize(const Wolf::InitializationContext& context)
@@ -25,25 +44,27 @@ void UpdateGPUBuffersPass::record(const Wolf::RecordContext& context)
 {
 	PROFILE_FUNCTION
 
-	m_stagingBufferPool->garbageCollect();
-
 	uint32_t requestQueueIdx = Wolf::g_runtimeContext->getCurrentCPUFrameNumber() % Wolf::g_configuration->getMaxCachedFrames();
 
-	m_addRequestQueueMutex.lock();
 	{
-		{
-			PROFILE_SCOPED("Swap requests")
-			m_currentRequestsQueues[requestQueueIdx].swap(m_addRequestsQueue);
-		}
-		{
-			PROFILE_SCOPED("Clear add queue")
-			m_addRequestsQueue.clear();
-		}
+		PROFILE_SCOPED("Swap request arenas")
+
+		// Requests of this arena have been recorded 'maxCachedFrames' ago, the GPU is done with them
+		const uint32_t recycledArenaIdx = m_currentRequestArenaIndices[requestQueueIdx];
+		m_requestArenas[recycledArenaIdx]->reset();
 
+		m_currentRequestArenaIndices[requestQueueIdx] = m_addRequestArenaIdx.exchange(recycledArenaIdx);
 	}
-	m_addRequestQueueMutex.unlock();
 
-	if (m_currentRequestsQueues[requestQueueIdx].empty())
+	m_stagingBufferPool->garbageCollect();
+
+	const RequestArena& currentRequests = *m_requestArenas[m_currentRequestArenaIndices[requestQueueIdx]];
+	{
+		PROFILE_SCOPED("Wait for request writers")
+		currentRequests.waitForWriters();
+	}
+
+	if (currentRequests.size() == 0)
 	{
 		m_transferRecordedThisFrame = false;
 		return;
@@ -53,10 +74,37 @@ void UpdateGPUBuffersPass::record(const Wolf::RecordContext& context)
 
 	Wolf::DebugMarker::beginRegion(m_commandBuffer.get(), Wolf::DebugMarker::renderPassDebugColor, "Update GPU buffers pass");
 
-	for (uint32_t i = 0; i < m_currentRequestsQueues[requestQueueIdx].size(); ++i)
+	// Fills are not merged, copies to a buffer filled this frame are then recorded in submission order
+	m_filledBufferKeys.clear();
+	for (uint32_t i = 0; i < currentRequests.size(); ++i)
+	{
+		if (currentRequests[i].isFill())
+			m_filledBufferKeys.push_back(currentRequests[i].getOutputBufferKey());
+	}
+
+	m_uploadCoalescer.clear();
+	for (uint32_t i = 0; i < currentRequests.size(); ++i)
 	{
-		const Wolf::ResourceUniqueOwner<InternalRequest>& request = m_currentRequestsQueues[requestQueueIdx][i];
-		request->recordCommands(m_commandBuffer.get());
+		const InternalRequest& request = currentRequests[i];
+		if (request.isCopyToBuffer() && std::find(m_filledBufferKeys.begin(), m_filledBufferKeys.end(), request.getOutputBufferKey()) == m_filledBufferKeys.end())
+		{
+			m_uploadCoalescer.addWrite(request.computeWrite(i));
+		}
+		else
+		{
+			request.recordCommands(m_commandBuffer.get());
+		}
+	}
+
+	{
+		PROFILE_SCOPED("Coalesce copies")
+		m_coalescedCopies.clear();
+		m_uploadCoalescer.computeCopies(m_coalescedCopies);
+	}
+
+	for (const UploadCoalescer::Write& copy : m_coalescedCopies)
+	{
+		currentRequests[copy.m_requestIdx].recordCopyToBufferRange(m_commandBuffer.get(), copy.m_srcOffset, copy.m_dstOffset, copy.m_size);
 	}
 
 	Wolf::DebugMarker::endRegion(m_commandBuffer.get());
@@ -78,8 +126,51 @@ void UpdateGPUBuffersPass::submit(const Wolf::SubmitContext& context)
 
 void UpdateGPUBuffersPass::clear()
 {
-	m_addRequestsQueue.clear();
-	m_currentRequestsQueues.clear();
+	for (Wolf::ResourceUniqueOwner<RequestArena>& requestArena : m_requestArenas)
+	{
+		requestArena->reset();
+	}
+}
+
+void UpdateGPUBuffersPass::InternalRequest::initialize(const Request& request, const Wolf::ResourceNonOwner<StagingBufferPool>& stagingBufferPool)
+{
+	if (const void* data = request.getData())
+	{
+		void* stagingData = initializeCopy(request, stagingBufferPool);
+		memcpy(stagingData, data, request.getSize());
+	}
+	else
+	{
+		m_request = request;
+		m_stagingBufferPool = stagingBufferPool;
+		m_stagingBufferPoolInstance = { 0, 0, 0 };
+		m_mode = Mode::FILL;
+
+		if (m_request.getResourceType() != Request::ResourceType::BUFFER)
+		{
+			Wolf::Debug::sendCriticalError("Fill request must be for a buffer");
+		}
+	}
+}
+
+void* UpdateGPUBuffersPass::InternalRequest::initializeCopy(const Request& request, const Wolf::ResourceNonOwner<StagingBufferPool>& stagingBufferPool)
+{
+	m_request = request;
+	m_stagingBufferPool = stagingBufferPool;
+	m_mode = Mode::COPY;
+
+	m_stagingBufferPoolInstance = m_stagingBufferPool->allocate(m_request.getSize(), 0 /* unused */, 0 /* unused */);
+	return m_stagingBufferPool->getMappedData(m_stagingBufferPoolInstance);
+}
+
+void UpdateGPUBuffersPass::InternalRequest::release()
+{
+	// Fills don't allocate staging memory, they are the only requests without size
+	if (m_stagingBufferPoolInstance.m_bufferSize > 0)
+	{
+		m_stagingBufferPool->deallocate(m_stagingBufferPoolInstance);
+		m_stagingBufferPoolInstance = { 0, 0, 0 };
+	}
 }
 
 void UpdateGPUBuffersPass::InternalRequest::recordCommands(const Wolf::CommandBuffer* commandBuffer) const
@@ -110,15 +201,33 @@ void UpdateGPUBuffersPass::InternalRequest::recordCommands(const Wolf::CommandBu
 }
 
 void UpdateGPUBuffersPass::InternalRequest::recordCopyToBuffer(const Wolf::CommandBuffer* commandBuffer) const
+{
+	recordCopyToBufferRange(commandBuffer, m_stagingBufferPoolInstance.m_bufferOffset, m_request.getOutputOffset(), m_request.getSize());
+}
+
+void UpdateGPUBuffersPass::InternalRequest::recordCopyToBufferRange(const Wolf::CommandBuffer* commandBuffer, uint64_t srcOffset, uint64_t dstOffset, uint64_t size) const
 {
 	Wolf::Buffer::BufferCopy bufferCopy{};
-	bufferCopy.srcOffset = m_stagingBufferPoolInstance.m_bufferOffset;
-	bufferCopy.dstOffset = m_request.getOutputOffset();
-	bufferCopy.size = m_request.getSize();
+	bufferCopy.srcOffset = srcOffset;
+	bufferCopy.dstOffset = dstOffset;
+	bufferCopy.size = size;
 
 	m_request.getOutputBuffer()->recordTransferGPUMemory(commandBuffer, *m_stagingBufferPool->getBuffer(m_stagingBufferPoolInstance), bufferCopy);
 }
 
+UploadCoalescer::Write UpdateGPUBuffersPass::InternalRequest::computeWrite(uint32_t requestIdx) const
+{
+	UploadCoalescer::Write write{};
+	write.m_dstKey = getOutputBufferKey();
+	write.m_dstOffset = m_request.getOutputOffset();
+	write.m_size = m_request.getSize();
+	write.m_srcKey = m_stagingBufferPoolInstance.m_bufferIdx;
+	write.m_srcOffset = m_stagingBufferPoolInstance.m_bufferOffset;
+	write.m_requestIdx = requestIdx;
+
+	return write;
+}
+
 void UpdateGPUBuffersPass::InternalRequest::recordFillBuffer(const Wolf::CommandBuffer* commandBuffer) const
 {
 	Wolf::Buffer::BufferFill bufferFill{};
@@ -151,111 +260,295 @@ void UpdateGPUBuffersPass::addRequestBeforeFrame(const Request& request)
 {
 	PROFILE_FUNCTION
 
-	InternalRequest* newInternalRequest = new InternalRequest(request, m_stagingBufferPool.createNonOwnerResource());
-	m_addRequestQueueMutex.lock();
-	m_addRequestsQueue.emplace_back(newInternalRequest);
-	m_addRequestQueueMutex.unlock();
+	RequestArena* requestArena = RequestArena::acquireForWrite(m_requestArenas, m_addRequestArenaIdx);
+	requestArena->allocate().initialize(request, m_stagingBufferPool.createNonOwnerResource());
+	requestArena->endWrite();
 }
 
-UpdateGPUBuffersPass::StagingBufferPool::StagingBufferPool(uint32_t poolSize) : m_poolSize(poolSize)
+UpdateGPUBuffersPass::Reservation UpdateGPUBuffersPass::reserveBufferUploadBeforeFrame(uint32_t size, const Wolf::ResourceNonOwner<Wolf::Buffer>& outputBuffer, uint32_t outputOffset)
 {
-	allocateNewBuffer();
+	PROFILE_FUNCTION
+
+	Reservation reservation;
+	reservation.m_requestArena = RequestArena::acquireForWrite(m_requestArenas, m_addRequestArenaIdx);
+	reservation.m_size = size;
+
+	// Data will be written by the caller directly in staging memory
+	const Request request(static_cast<const void*>(nullptr), size, outputBuffer, outputOffset);
+	reservation.m_data = reservation.m_requestArena->allocate().initializeCopy(request, m_stagingBufferPool.createNonOwnerResource());
+
+	return reservation;
 }
 
-Wolf::BufferPoolInterface::BufferPoolInstance UpdateGPUBuffersPass::StagingBufferPool::allocate(uint32_t requestedSize, Wolf::Buffer::BufferUsageFlags usageFlags, uint32_t itemSize)
+void UpdateGPUBuffersPass::commitReservation(Reservation& reservation)
 {
-	if (requestedSize > m_poolSize)
+	if (!reservation.isValid())
 	{
-		Wolf::Debug::sendCriticalError("Requested size is too big to fit in staging buffer");
+		Wolf::Debug::sendError("Committing an invalid reservation");
+		return;
 	}
 
-	BufferPoolInstance r{};
+	reservation.m_requestArena->endWrite();
+	reservation = Reservation();
+}
 
-	m_mutex.lock();
+UpdateGPUBuffersPass::RequestArena* UpdateGPUBuffersPass::RequestArena::acquireForWrite(const std::vector<Wolf::ResourceUniqueOwner<RequestArena>>& requestArenas,
+	const std::atomic<uint32_t>& addRequestArenaIdx)
+{
+	// The add arena can be swapped by 'record' between the index read and the writer registration, retry on the new one in this case
+	while (true)
+	{
+		const uint32_t arenaIdx = addRequestArenaIdx.load();
+		RequestArena* requestArena = requestArenas[arenaIdx].get();
+		requestArena->beginWrite();
 
-	r.m_bufferIdx = 0;
-	bool spaceFound = false;
-	while (!spaceFound && r.m_bufferIdx < m_buffers.size())
+		if (addRequestArenaIdx.load() == arenaIdx)
+			return requestArena;
+
+		requestArena->endWrite();
+	}
+}
+
+UpdateGPUBuffersPass::RequestArena::~RequestArena()
+{
+	reset();
+	for (std::atomic<InternalRequest*>& chunk : m_chunks)
 	{
-		OwningBuffer& buffer = m_buffers[r.m_bufferIdx];
+		delete[] chunk.load();
+	}
+	for (const InternalRequest* chunk : m_overflowChunks)
+	{
+		delete[] chunk;
+	}
+}
 
-		uint32_t allocationOffset = buffer.m_currentAllocatedOffset;
-		buffer.m_currentAllocatedOffset += requestedSize;
+void UpdateGPUBuffersPass::RequestArena::waitForWriters() const
+{
+	// Requests are written in a few microseconds, a long wait means a reservation has been forgotten
+	static constexpr std::chrono::seconds WRITER_TIMEOUT(5);
 
-		if (buffer.m_currentAllocatedOffset > buffer.m_buffer->getSize())
+	const auto startTime = std::chrono::steady_clock::now();
+	bool isTimeoutReported = false;
+	while (m_writerCount.load() != 0)
+	{
+		if (!isTimeoutReported && std::chrono::steady_clock::now() - startTime > WRITER_TIMEOUT)
 		{
-			if (buffer.m_currentDeletedOffset < requestedSize)
-			{
-				r.m_bufferIdx++;
-				continue;
-			}
-
-			allocationOffset = buffer.m_currentAllocatedOffset = 0;
-			buffer.m_currentDeletedOffset = 0;
+			Wolf::Debug::sendCriticalError("Still waiting for " + std::to_string(m_writerCount.load()) + " GPU buffer request writer(s) after " + std::to_string(WRITER_TIMEOUT.count()) +
+				"s, a reservation has probably not been committed");
+			isTimeoutReported = true;
 		}
-		r.m_bufferOffset = allocationOffset;
-		r.m_bufferSize = requestedSize;
+		std::this_thread::yield();
+	}
+}
 
-		spaceFound = true;
+UpdateGPUBuffersPass::InternalRequest& UpdateGPUBuffersPass::RequestArena::allocate()
+{
+	const uint32_t requestIdx = m_requestCount.fetch_add(1);
+	const uint32_t chunkIdx = requestIdx / CHUNK_SIZE;
+	if (chunkIdx >= LOCK_FREE_CHUNK_COUNT)
+	{
+		// Request spike, overflow chunks are kept as well so later frames of the same size don't allocate
+		std::lock_guard lock(m_chunkAllocationMutex);
+		const uint32_t overflowChunkIdx = chunkIdx - LOCK_FREE_CHUNK_COUNT;
+		while (m_overflowChunks.size() <= overflowChunkIdx)
+		{
+			m_overflowChunks.push_back(new InternalRequest[CHUNK_SIZE]);
+		}
+		return m_overflowChunks[overflowChunkIdx][requestIdx % CHUNK_SIZE];
 	}
 
-	if (!spaceFound)
+	InternalRequest* chunk = m_chunks[chunkIdx].load();
+	if (!chunk)
 	{
-		r.m_bufferIdx = m_buffers.size();
-		allocateNewBuffer();
-		m_buffers[r.m_bufferIdx].m_currentAllocatedOffset += requestedSize;
-		r.m_bufferOffset = 0;
-		r.m_bufferSize = requestedSize;
+		// Only happens the first time the arena grows to this size, chunks are then kept
+		std::lock_guard lock(m_chunkAllocationMutex);
+		chunk = m_chunks[chunkIdx].load();
+		if (!chunk)
+		{
+			chunk = new InternalRequest[CHUNK_SIZE];
+			m_chunks[chunkIdx].store(chunk);
+		}
 	}
 
-	m_buffers[r.m_bufferIdx].m_activeAllocations++;
+	return chunk[requestIdx % CHUNK_SIZE];
+}
+
+void UpdateGPUBuffersPass::RequestArena::reset()
+{
+	const uint32_t requestCount = m_requestCount.load();
+	for (uint32_t i = 0; i < requestCount; ++i)
+	{
+		getChunk(i / CHUNK_SIZE)[i % CHUNK_SIZE].release();
+	}
+	m_requestCount = 0;
+}
+
+UpdateGPUBuffersPass::StagingBufferPool::StagingBufferPool(uint32_t pageSize, uint64_t budget) : m_pageSize(pageSize), m_budget(budget)
+{
+	allocateNewBuffer(0, m_pageSize);
+}
 
-	m_mutex.unlock();
+UpdateGPUBuffersPass::StagingBufferPool::~StagingBufferPool()
+{
+	for (OwningBuffer& owningBuffer : m_buffers)
+	{
+		if (owningBuffer.m_mappedData)
+			owningBuffer.m_buffer->unmap();
+	}
+}
+
+Wolf::BufferPoolInterface::BufferPoolInstance UpdateGPUBuffersPass::StagingBufferPool::allocate(uint32_t requestedSize, Wolf::Buffer::BufferUsageFlags usageFlags, uint32_t itemSize)
+{
+	// Empty requests still take the alignment, every allocation then has a size and is released (see InternalRequest::release)
+	const uint32_t alignedSize = std::max((requestedSize + ALLOCATION_ALIGNMENT - 1) / ALLOCATION_ALIGNMENT * ALLOCATION_ALIGNMENT, ALLOCATION_ALIGNMENT);
+
+	BufferPoolInstance r{};
+	while (!tryAllocateInActiveBuffer(alignedSize, r))
+	{
+		makeSpaceForAllocation(alignedSize);
+	}
+
+	m_usedBytes.fetch_add(alignedSize);
 
 	return r;
 }
 
-void UpdateGPUBuffersPass::StagingBufferPool::deallocate(const BufferPoolInstance& bufferPoolInstance)
+bool UpdateGPUBuffersPass::StagingBufferPool::tryAllocateInActiveBuffer(uint32_t requestedSize, BufferPoolInstance& outBufferPoolInstance)
 {
-	OwningBuffer& owningBuffer = m_buffers[bufferPoolInstance.m_bufferIdx];
+	const uint32_t bufferIdx = m_activeBufferIdx.load();
+	OwningBuffer& buffer = m_buffers[bufferIdx];
 
-	m_mutex.lock();
-	owningBuffer.m_currentDeletedOffset = std::max(owningBuffer.m_currentDeletedOffset, bufferPoolInstance.m_bufferOffset + bufferPoolInstance.m_bufferSize);
-	if (owningBuffer.m_currentDeletedOffset > owningBuffer.m_buffer->getSize())
+	// Register the allocation before checking the buffer is still the active one, this prevents release and reset
+	buffer.m_activeAllocations.fetch_add(1);
+	if (m_activeBufferIdx.load() != bufferIdx)
 	{
-		Wolf::Debug::sendCriticalError("It shouldn't happen");
+		buffer.m_activeAllocations.fetch_sub(1);
+		return false;
 	}
-	if (owningBuffer.m_activeAllocations == 0)
+
+	const uint32_t allocationOffset = buffer.m_currentAllocatedOffset.fetch_add(requestedSize);
+	if (static_cast<uint64_t>(allocationOffset) + requestedSize > buffer.m_size)
 	{
-		Wolf::Debug::sendCriticalError("Active allocations should not be zero");
+		buffer.m_activeAllocations.fetch_sub(1);
+		return false;
+	}
+
+	outBufferPoolInstance.m_bufferIdx = bufferIdx;
+	outBufferPoolInstance.m_bufferOffset = allocationOffset;
+	outBufferPoolInstance.m_bufferSize = requestedSize;
+
+	return true;
+}
+
+void UpdateGPUBuffersPass::StagingBufferPool::makeSpaceForAllocation(uint32_t requestedSize)
+{
+	std::lock_guard lock(m_mutex);
+
+	const uint32_t activeBufferIdx = m_activeBufferIdx.load();
+	OwningBuffer& activeBuffer = m_buffers[activeBufferIdx];
+	if (static_cast<uint64_t>(activeBuffer.m_currentAllocatedOffset.load()) + requestedSize <= activeBuffer.m_size)
+		return; // another thread already made space
+
+	// Reuse the smallest empty page which fits, the active one included
+	uint32_t bestBufferIdx = MAX_BUFFER_COUNT;
+	uint32_t firstFreeSlotIdx = MAX_BUFFER_COUNT;
+	for (uint32_t bufferIdx = 0; bufferIdx < MAX_BUFFER_COUNT; ++bufferIdx)
+	{
+		OwningBuffer& buffer = m_buffers[bufferIdx];
+		if (!buffer.m_mappedData)
+		{
+			firstFreeSlotIdx = std::min(firstFreeSlotIdx, bufferIdx);
+			continue;
+		}
+
+		if (buffer.m_activeAllocations.load() != 0 || buffer.m_size < requestedSize)
+			continue;
+
+		if (bestBufferIdx == MAX_BUFFER_COUNT || buffer.m_size < m_buffers[bestBufferIdx].m_size)
+			bestBufferIdx = bufferIdx;
 	}
-	owningBuffer.m_activeAllocations--;
 
-	if (owningBuffer.m_activeAllocations == 0)
+	if (bestBufferIdx != MAX_BUFFER_COUNT)
 	{
-		owningBuffer.m_currentDeletedOffset = owningBuffer.m_currentAllocatedOffset = 0;
+		OwningBuffer& buffer = m_buffers[bestBufferIdx];
+		buffer.m_currentAllocatedOffset = 0;
+		buffer.m_idleFrameCount = 0;
+		m_activeBufferIdx = bestBufferIdx;
+		return;
+	}
+
+	if (firstFreeSlotIdx == MAX_BUFFER_COUNT)
+	{
+		Wolf::Debug::sendCriticalError("Too many staging pages");
+		return;
+	}
+
+	// Requests bigger than a page get a dedicated one, released as soon as it's idle
+	const uint32_t newBufferSize = std::max(m_pageSize, requestedSize);
+	if (m_allocatedBytes.load() + newBufferSize > m_budget.load())
+	{
+		// Uploads can't be delayed here as the caller data may not live until next frame. Producers which can wait check 'canStageWithinBudget' (ex: mip streaming)
+		if (m_overBudgetAllocationCount.fetch_add(1) == 0)
+			Wolf::Debug::sendWarning("Staging memory budget exceeded, uploads should be spread over more frames");
+	}
+
+	allocateNewBuffer(firstFreeSlotIdx, newBufferSize);
+	m_activeBufferIdx = firstFreeSlotIdx;
+}
+
+void UpdateGPUBuffersPass::StagingBufferPool::deallocate(const BufferPoolInstance& bufferPoolInstance)
+{
+	OwningBuffer& owningBuffer = m_buffers[bufferPoolInstance.m_bufferIdx];
+
+	if (bufferPoolInstance.m_bufferOffset + bufferPoolInstance.m_bufferSize > owningBuffer.m_size)
+	{
+		Wolf::Debug::sendCriticalError("It shouldn't happen");
 	}
 
-	m_mutex.unlock();
+	if (owningBuffer.m_activeAllocations.fetch_sub(1) == 0)
+	{
+		Wolf::Debug::sendCriticalError("Active allocations should not be zero");
+	}
+	m_usedBytes.fetch_sub(bufferPoolInstance.m_bufferSize);
 }
 
 void UpdateGPUBuffersPass::StagingBufferPool::garbageCollect()
 {
-	m_mutex.lock();
+	std::lock_guard lock(m_mutex);
+
+	// Only written here, under the mutex
+	m_peakAllocatedBytes = std::max(m_peakAllocatedBytes.load(), m_allocatedBytes.load());
+	m_peakUsedBytes = std::max(m_peakUsedBytes.load(), m_usedBytes.load());
 
-	for (int32_t i = m_buffers.size() - 1; i >= 0; i--)
+	// Keep one spare page to avoid creating a new page each time the active one is full
+	bool spareBufferKept = false;
+	const uint32_t activeBufferIdx = m_activeBufferIdx.load();
+	for (uint32_t bufferIdx = 0; bufferIdx < MAX_BUFFER_COUNT; ++bufferIdx)
 	{
-		OwningBuffer& owningBuffer = m_buffers[i];
+		OwningBuffer& owningBuffer = m_buffers[bufferIdx];
+		if (!owningBuffer.m_mappedData || bufferIdx == activeBufferIdx)
+			continue;
 
-		if (owningBuffer.m_activeAllocations == 0)
+		if (owningBuffer.m_activeAllocations.load() != 0)
 		{
-			m_buffers.erase(m_buffers.begin() + i);
+			owningBuffer.m_idleFrameCount = 0;
+			continue;
+		}
+
+		owningBuffer.m_idleFrameCount++;
+
+		const bool isDedicated = owningBuffer.m_size > m_pageSize;
+		if (!isDedicated && !spareBufferKept)
+		{
+			spareBufferKept = true;
+			continue;
 		}
-		else
-			break; // don't delete previous indices as this index will change
-	}
 
-	m_mutex.unlock();
+		if (isDedicated || isOverBudget() || owningBuffer.m_idleFrameCount > IDLE_FRAMES_BEFORE_RELEASE)
+		{
+			releaseBuffer(bufferIdx);
+		}
+	}
 }
 
 Wolf::ResourceNonOwner<Wolf::Buffer> UpdateGPUBuffersPass::StagingBufferPool::getBuffer(const BufferPoolInstance& bufferPoolInstance)
@@ -263,9 +556,53 @@ Wolf::ResourceNonOwner<Wolf::Buffer> UpdateGPUBuffersPass::StagingBufferPool::ge
 	return m_buffers[bufferPoolInstance.m_bufferIdx].m_buffer.createNonOwnerResource();
 }
 
-void UpdateGPUBuffersPass::StagingBufferPool::allocateNewBuffer()
+bool UpdateGPUBuffersPass::StagingBufferPool::canAllocateWithinBudget(uint32_t requestedSize) const
 {
-	OwningBuffer& owningBuffer = m_buffers.emplace_back();
-	owningBuffer.m_buffer.reset(Wolf::Buffer::createBuffer(m_poolSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
+	const OwningBuffer& activeBuffer = m_buffers[m_activeBufferIdx.load()];
+	if (static_cast<uint64_t>(activeBuffer.m_currentAllocatedOffset.load()) + requestedSize <= activeBuffer.m_size)
+		return true;
+
+	// Nothing pending, the upload goes through so levels bigger than the budget are still streamed
+	if (m_usedBytes.load() == 0)
+		return true;
+
+	// Conservative: idle pages which could be reused aren't considered, they are released by the garbage collection while over budget
+	return m_allocatedBytes.load() + std::max(m_pageSize, requestedSize) <= m_budget.load();
+}
+
+void UpdateGPUBuffersPass::StagingBufferPool::getStatistics(StagingStatistics& outStatistics) const
+{
+	outStatistics.m_allocatedBytes = m_allocatedBytes.load();
+	outStatistics.m_usedBytes = m_usedBytes.load();
+	outStatistics.m_peakAllocatedBytes = std::max(m_peakAllocatedBytes.load(), outStatistics.m_allocatedBytes);
+	outStatistics.m_peakUsedBytes = std::max(m_peakUsedBytes.load(), outStatistics.m_usedBytes);
+	outStatistics.m_budget = m_budget.load();
+	outStatistics.m_pageCount = static_cast<uint32_t>(std::count_if(m_buffers.begin(), m_buffers.end(), [](const OwningBuffer& owningBuffer) { return owningBuffer.m_mappedData != nullptr; }));
+	outStatistics.m_overBudgetAllocationCount = m_overBudgetAllocationCount.load();
+	outStatistics.m_releasedPageCount = m_releasedBufferCount.load();
+}
+
+void UpdateGPUBuffersPass::StagingBufferPool::allocateNewBuffer(uint32_t bufferIdx, uint32_t size)
+{
+	OwningBuffer& owningBuffer = m_buffers[bufferIdx];
+	owningBuffer.m_buffer.reset(Wolf::Buffer::createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
 	owningBuffer.m_buffer->setName("Staging buffer for data copy (UpdateGPUBuffersPass::StagingBufferPool::m_buffer)");
+	owningBuffer.m_mappedData = static_cast<uint8_t*>(owningBuffer.m_buffer->map());
+	owningBuffer.m_size = size;
+	owningBuffer.m_currentAllocatedOffset = 0;
+	owningBuffer.m_idleFrameCount = 0;
+
+	m_allocatedBytes.fetch_add(size);
+}
+
+void UpdateGPUBuffersPass::StagingBufferPool::releaseBuffer(uint32_t bufferIdx)
+{
+	OwningBuffer& owningBuffer = m_buffers[bufferIdx];
+	owningBuffer.m_buffer->unmap();
+	owningBuffer.m_mappedData = nullptr;
+	owningBuffer.m_buffer.reset(nullptr);
+
+	m_allocatedBytes.fetch_sub(owningBuffer.m_size);
+	owningBuffer.m_size = 0;
+	m_releasedBufferCount++;
 }
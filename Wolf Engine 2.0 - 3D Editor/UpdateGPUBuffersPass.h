@@ -1,5 +1,9 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <mutex>
+
 #include <glm/glm.hpp>
 
 #include <CommandRecordBase.h>
@@ -9,6 +13,7 @@
 #include <ResourceUniqueOwner.h>
 
 #include "BufferPoolInterface.h"
+#include "UploadCoalescer.h"
 
 class UpdateGPUBuffersPass : public Wolf::CommandRecordBase
 {
@@ -78,11 +83,59 @@ public:
 	};
 	void addRequestBeforeFrame(const Request& request);
 
+	struct StagingStatistics
+	{
+		uint64_t m_allocatedBytes = 0; // host memory currently held by staging pages
+		uint64_t m_usedBytes = 0; // bytes of pending uploads
+		uint64_t m_peakAllocatedBytes = 0;
+		uint64_t m_peakUsedBytes = 0;
+		uint64_t m_budget = 0;
+		uint32_t m_pageCount = 0;
+		uint32_t m_overBudgetAllocationCount = 0;
+		uint32_t m_releasedPageCount = 0;
+	};
+	void getStagingStatistics(StagingStatistics& outStatistics) const { m_stagingBufferPool->getStatistics(outStatistics); }
+	void setStagingBudget(uint64_t budget) { m_stagingBufferPool->setBudget(budget); }
+	// Uploads which can be delayed (streaming) are only added when this is true, other uploads always get staging memory even over budget
+	[[nodiscard]] bool canStageWithinBudget(uint32_t size) const { return m_stagingBufferPool->canAllocateWithinBudget(size); }
+
+private:
+	static constexpr uint32_t STAGING_PAGE_SIZE = 33'554'432;
+
+	class RequestArena;
+
+public:
+	// Gives direct access to staging memory, the caller writes the data in place instead of copying it from its own storage.
+	// Every reservation must be committed before the end of the 'before frame' step: the frame record waits for all of them,
+	// a reservation which is never committed blocks the render thread (an error is reported if the wait gets too long).
+	class Reservation
+	{
+	public:
+		Reservation() = default;
+
+		[[nodiscard]] void* getData() const { return m_data; }
+		template <typename T> [[nodiscard]] T* getDataAs() const { return static_cast<T*>(m_data); }
+		[[nodiscard]] uint32_t getSize() const { return m_size; }
+		[[nodiscard]] bool isValid() const { return m_requestArena != nullptr; }
+
+	private:
+		friend UpdateGPUBuffersPass;
+
+		void* m_data = nullptr;
+		uint32_t m_size = 0;
+		RequestArena* m_requestArena = nullptr;
+	};
+	[[nodiscard]] Reservation reserveBufferUploadBeforeFrame(uint32_t size, const Wolf::ResourceNonOwner<Wolf::Buffer>& outputBuffer, uint32_t outputOffset);
+	void commitReservation(Reservation& reservation);
+
 private:
+	// Host coherent memory split in pages, each page is a linear allocator reset once all its allocations have been released.
+	// Allocations are released when the frame which used them is finished on GPU (see request arenas).
 	class StagingBufferPool : public Wolf::BufferPoolInterface
 	{
 	public:
-		StagingBufferPool(uint32_t poolSize);
+		StagingBufferPool(uint32_t pageSize, uint64_t budget);
+		~StagingBufferPool();
 
 		[[nodiscard]] BufferPoolInstance allocate(uint32_t requestedSize, Wolf::Buffer::BufferUsageFlags usageFlags, uint32_t itemSize) override;
 		void deallocate(const BufferPoolInstance& bufferPoolInstance) override;
@@ -90,22 +143,48 @@ private:
 		void garbageCollect();
 
 		Wolf::ResourceNonOwner<Wolf::Buffer> getBuffer(const BufferPoolInstance& bufferPoolInstance) override;
+		[[nodiscard]] void* getMappedData(const BufferPoolInstance& bufferPoolInstance) const { return m_buffers[bufferPoolInstance.m_bufferIdx].m_mappedData + bufferPoolInstance.m_bufferOffset; }
+
+		void setBudget(uint64_t budget) { m_budget = budget; }
+		[[nodiscard]] bool isOverBudget() const { return m_allocatedBytes.load() > m_budget.load(); }
+		[[nodiscard]] bool canAllocateWithinBudget(uint32_t requestedSize) const;
+		void getStatistics(StagingStatistics& outStatistics) const;
 
 	private:
-		void allocateNewBuffer();
+		static constexpr uint32_t MAX_BUFFER_COUNT = 64;
+		static constexpr uint32_t ALLOCATION_ALIGNMENT = 16; // enough for all texel block sizes
+		static constexpr uint32_t IDLE_FRAMES_BEFORE_RELEASE = 120;
+
+		bool tryAllocateInActiveBuffer(uint32_t requestedSize, BufferPoolInstance& outBufferPoolInstance);
+		void makeSpaceForAllocation(uint32_t requestedSize);
+		void allocateNewBuffer(uint32_t bufferIdx, uint32_t size);
+		void releaseBuffer(uint32_t bufferIdx);
 
-		uint32_t m_poolSize;
+		uint32_t m_pageSize;
+		std::atomic<uint64_t> m_budget;
 
 		struct OwningBuffer
 		{
 			Wolf::ResourceUniqueOwner<Wolf::Buffer> m_buffer;
-			uint32_t m_currentAllocatedOffset = 0;
-			uint32_t m_currentDeletedOffset = 0;
+			uint8_t* m_mappedData = nullptr; // host coherent, kept mapped for the buffer lifetime
+			uint32_t m_size = 0;
+			std::atomic<uint32_t> m_currentAllocatedOffset = 0;
 
-			uint32_t m_activeAllocations = 0;
+			std::atomic<uint32_t> m_activeAllocations = 0;
+			uint32_t m_idleFrameCount = 0;
 		};
-		std::vector<OwningBuffer> m_buffers;
-		std::mutex m_mutex;
+		// Fixed-size so the active buffer can be accessed without lock while another one is created or destroyed
+		std::array<OwningBuffer, MAX_BUFFER_COUNT> m_buffers;
+		std::atomic<uint32_t> m_activeBufferIdx = 0;
+		std::mutex m_mutex; // only locked when the active buffer is full and for garbage collection
+
+		// Statistics
+		std::atomic<uint64_t> m_allocatedBytes = 0;
+		std::atomic<uint64_t> m_usedBytes = 0;
+		std::atomic<uint64_t> m_peakAllocatedBytes = 0;
+		std::atomic<uint64_t> m_peakUsedBytes = 0;
+		std::atomic<uint32_t> m_overBudgetAllocationCount = 0;
+		std::atomic<uint32_t> m_releasedBufferCount = 0;
 	};
 	Wolf::ResourceUniqueOwner<StagingBufferPool> m_stagingBufferPool;
 
@@ -113,39 +192,23 @@ private:
 	{
 	public:
 		InternalRequest() = default;
-		explicit InternalRequest(const Request& request, const Wolf::ResourceNonOwner<StagingBufferPool>& stagingBufferPool) : m_request(request), m_stagingBufferPool(stagingBufferPool)
-		{
-			if (const void* data = m_request.getData())
-			{
-				m_stagingBufferPoolInstance = m_stagingBufferPool->allocate(m_request.getSize(), 0 /* unused */, 0 /* unused */);
-				m_stagingBufferPool->getBuffer(m_stagingBufferPoolInstance)->transferCPUMemory(data, m_request.getSize(), m_stagingBufferPoolInstance.m_bufferOffset);
-
-				m_mode = Mode::COPY;
-			}
-			else
-			{
-				m_mode = Mode::FILL;
-
-				if (m_request.getResourceType() != Request::ResourceType::BUFFER)
-				{
-					Wolf::Debug::sendCriticalError("Fill request must be for a buffer");
-				}
-			}
-		}
 		InternalRequest(const InternalRequest& other) = delete;
-		~InternalRequest()
-		{
-			if (m_stagingBufferPoolInstance.m_bufferSize > 0)
-			{
-				m_stagingBufferPool->deallocate(m_stagingBufferPoolInstance);
-			}
-		}
+
+		void initialize(const Request& request, const Wolf::ResourceNonOwner<StagingBufferPool>& stagingBufferPool);
+		[[nodiscard]] void* initializeCopy(const Request& request, const Wolf::ResourceNonOwner<StagingBufferPool>& stagingBufferPool);
+		void release();
 
 		void recordCommands(const Wolf::CommandBuffer* commandBuffer) const;
+		void recordCopyToBufferRange(const Wolf::CommandBuffer* commandBuffer, uint64_t srcOffset, uint64_t dstOffset, uint64_t size) const;
+
+		[[nodiscard]] bool isFill() const { return m_mode == Mode::FILL; }
+		[[nodiscard]] bool isCopyToBuffer() const { return m_mode == Mode::COPY && m_request.getResourceType() == Request::ResourceType::BUFFER; }
+		[[nodiscard]] uint64_t getOutputBufferKey() const { return reinterpret_cast<uint64_t>(&*m_request.getOutputBuffer()); }
+		[[nodiscard]] UploadCoalescer::Write computeWrite(uint32_t requestIdx) const;
 
 	private:
 		enum class Mode { COPY, FILL };
-		Mode m_mode;
+		Mode m_mode = Mode::COPY;
 
 		void recordCopyToBuffer(const Wolf::CommandBuffer* commandBuffer) const;
 		void recordFillBuffer(const Wolf::CommandBuffer* commandBuffer) const;
@@ -153,14 +216,53 @@ private:
 
 		Request m_request;
 
-		Wolf::ResourceNonOwner<StagingBufferPool> m_stagingBufferPool;
+		Wolf::NullableResourceNonOwner<StagingBufferPool> m_stagingBufferPool;
 		Wolf::BufferPoolInterface::BufferPoolInstance m_stagingBufferPoolInstance = { 0, 0, 0};
 	};
 
-	Wolf::DynamicResourceUniqueOwnerArray<InternalRequest, 4> m_addRequestsQueue;
-	std::mutex m_addRequestQueueMutex;
-	Wolf::DynamicStableArray<Wolf::DynamicResourceUniqueOwnerArray<InternalRequest, 4>, 2> m_currentRequestsQueues;
+	// Request records are stored in chunks which are kept from one frame to another, adding a request only costs an atomic increment.
+	// Past the lock-free chunks, requests go to overflow chunks allocated under the mutex so a frame never runs out of requests
+	class RequestArena
+	{
+	public:
+		RequestArena() = default;
+		RequestArena(const RequestArena&) = delete;
+		~RequestArena();
+
+		void beginWrite() { m_writerCount.fetch_add(1); }
+		void endWrite() { m_writerCount.fetch_sub(1); }
+		void waitForWriters() const;
+
+		[[nodiscard]] InternalRequest& allocate();
+		[[nodiscard]] static RequestArena* acquireForWrite(const std::vector<Wolf::ResourceUniqueOwner<RequestArena>>& requestArenas, const std::atomic<uint32_t>& addRequestArenaIdx);
+		[[nodiscard]] uint32_t size() const { return m_requestCount.load(); }
+		[[nodiscard]] const InternalRequest& operator[](uint32_t idx) const { return getChunk(idx / CHUNK_SIZE)[idx % CHUNK_SIZE]; }
+
+		void reset();
+
+	private:
+		static constexpr uint32_t CHUNK_SIZE = 256;
+		static constexpr uint32_t LOCK_FREE_CHUNK_COUNT = 256;
+
+		// Only called once writers of the requests are done
+		[[nodiscard]] InternalRequest* getChunk(uint32_t chunkIdx) const { return chunkIdx < LOCK_FREE_CHUNK_COUNT ? m_chunks[chunkIdx].load() : m_overflowChunks[chunkIdx - LOCK_FREE_CHUNK_COUNT]; }
+
+		std::array<std::atomic<InternalRequest*>, LOCK_FREE_CHUNK_COUNT> m_chunks{};
+		std::vector<InternalRequest*> m_overflowChunks; // protected by the mutex while requests are added
+		std::mutex m_chunkAllocationMutex;
+		std::atomic<uint32_t> m_requestCount = 0;
+		std::atomic<uint32_t> m_writerCount = 0;
+	};
+
+	// One arena receives new requests, the others are waiting for their frame to be finished on GPU
+	std::vector<Wolf::ResourceUniqueOwner<RequestArena>> m_requestArenas;
+	std::atomic<uint32_t> m_addRequestArenaIdx = 0;
+	std::vector<uint32_t> m_currentRequestArenaIndices;
+
+	// Copies to buffers are merged before being recorded
+	UploadCoalescer m_uploadCoalescer;
+	std::vector<UploadCoalescer::Write> m_coalescedCopies;
+	std::vector<uint64_t> m_filledBufferKeys;
 
 	bool m_transferRecordedThisFrame = false;
 };
-
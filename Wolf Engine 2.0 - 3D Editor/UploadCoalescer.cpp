@@ -0,0 +1,112 @@
+#include "UploadCoalescer.h"
+
+#include <algorithm>
+
+void UploadCoalescer::addWrite(const Write& write)
+{
+	if (write.m_size == 0)
+		return;
+
+	m_writes.push_back(write);
+}
+
+void UploadCoalescer::computeCopies(std::vector<Write>& outCopies)
+{
+	m_droppedByteCount = 0;
+
+	const size_t firstCopyIdx = outCopies.size();
+
+	// Stable sort keeps submission order for each destination
+	m_sortedWrites.assign(m_writes.begin(), m_writes.end());
+	std::stable_sort(m_sortedWrites.begin(), m_sortedWrites.end(), [](const Write& a, const Write& b) { return a.m_dstKey < b.m_dstKey; });
+
+	size_t destinationStartIdx = 0;
+	while (destinationStartIdx < m_sortedWrites.size())
+	{
+		size_t destinationEndIdx = destinationStartIdx;
+		while (destinationEndIdx < m_sortedWrites.size() && m_sortedWrites[destinationEndIdx].m_dstKey == m_sortedWrites[destinationStartIdx].m_dstKey)
+			destinationEndIdx++;
+
+		// Walk writes from the latest to the oldest and only keep parts not covered by a later write
+		m_coveredRanges.clear();
+		m_pieces.clear();
+		for (size_t i = destinationEndIdx; i-- > destinationStartIdx;)
+		{
+			const Write& write = m_sortedWrites[i];
+			const uint64_t writeStart = write.m_dstOffset;
+			const uint64_t writeEnd = write.m_dstOffset + write.m_size;
+
+			auto addPiece = [&](uint64_t pieceStart, uint64_t pieceEnd)
+			{
+				Write piece = write;
+				piece.m_dstOffset = pieceStart;
+				piece.m_size = pieceEnd - pieceStart;
+				piece.m_srcOffset = write.m_srcOffset + (pieceStart - writeStart);
+				m_pieces.push_back(piece);
+			};
+
+			// First covered range which may intersect the write
+			auto it = m_coveredRanges.upper_bound(writeStart);
+			if (it != m_coveredRanges.begin() && std::prev(it)->second > writeStart)
+				--it;
+
+			uint64_t cursor = writeStart;
+			while (it != m_coveredRanges.end() && it->first < writeEnd)
+			{
+				if (it->first > cursor)
+					addPiece(cursor, it->first);
+				cursor = std::max(cursor, it->second);
+				++it;
+			}
+			if (cursor < writeEnd)
+				addPiece(cursor, writeEnd);
+
+			// Insert the write in covered ranges, merging with the ranges it touches
+			uint64_t mergedStart = writeStart;
+			uint64_t mergedEnd = writeEnd;
+			auto mergeIt = m_coveredRanges.upper_bound(writeStart);
+			if (mergeIt != m_coveredRanges.begin() && std::prev(mergeIt)->second >= writeStart)
+				--mergeIt;
+			while (mergeIt != m_coveredRanges.end() && mergeIt->first <= writeEnd)
+			{
+				mergedStart = std::min(mergedStart, mergeIt->first);
+				mergedEnd = std::max(mergedEnd, mergeIt->second);
+				mergeIt = m_coveredRanges.erase(mergeIt);
+			}
+			m_coveredRanges[mergedStart] = mergedEnd;
+		}
+
+		// Pieces don't overlap anymore, sort them by destination offset and merge the contiguous ones
+		std::sort(m_pieces.begin(), m_pieces.end(), [](const Write& a, const Write& b) { return a.m_dstOffset < b.m_dstOffset; });
+		for (const Write& piece : m_pieces)
+		{
+			if (outCopies.size() > firstCopyIdx)
+			{
+				Write& previousCopy = outCopies.back();
+				if (previousCopy.m_dstKey == piece.m_dstKey && previousCopy.m_srcKey == piece.m_srcKey &&
+					previousCopy.m_dstOffset + previousCopy.m_size == piece.m_dstOffset && previousCopy.m_srcOffset + previousCopy.m_size == piece.m_srcOffset)
+				{
+					previousCopy.m_size += piece.m_size;
+					continue;
+				}
+			}
+			outCopies.push_back(piece);
+		}
+
+		destinationStartIdx = destinationEndIdx;
+	}
+
+	uint64_t inputByteCount = 0;
+	for (const Write& write : m_writes)
+		inputByteCount += write.m_size;
+	uint64_t outputByteCount = 0;
+	for (size_t i = firstCopyIdx; i < outCopies.size(); ++i)
+		outputByteCount += outCopies[i].m_size;
+	m_droppedByteCount = inputByteCount - outputByteCount;
+}
+
+void UploadCoalescer::clear()
+{
+	m_writes.clear();
+	m_droppedByteCount = 0;
+}
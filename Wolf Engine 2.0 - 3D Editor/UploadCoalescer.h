@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+// Merges buffer writes of a frame into the minimal set of copies:
+// - bytes overwritten by a later write of the same frame are not copied
+// - writes contiguous in both source and destination are merged into a single copy
+// Output doesn't contain any overlapping destination range so copies can be recorded in any order
+class UploadCoalescer
+{
+public:
+	struct Write
+	{
+		uint64_t m_dstKey; // identifies the destination buffer
+		uint64_t m_dstOffset;
+		uint64_t m_size;
+		uint64_t m_srcKey; // identifies the source buffer
+		uint64_t m_srcOffset;
+		uint32_t m_requestIdx; // index of the request this write (or the first merged one) comes from
+	};
+
+	// Writes must be added in submission order
+	void addWrite(const Write& write);
+	void computeCopies(std::vector<Write>& outCopies);
+	void clear();
+
+	[[nodiscard]] uint32_t getInputWriteCount() const { return static_cast<uint32_t>(m_writes.size()); }
+	[[nodiscard]] uint64_t getDroppedByteCount() const { return m_droppedByteCount; }
+
+private:
+	std::vector<Write> m_writes;
+	std::map<uint64_t, uint64_t> m_coveredRanges; // start -> end of ranges written by later writes, reused across computations
+	std::vector<Write> m_sortedWrites; // scratch, reused across computations
+	std::vector<Write> m_pieces; // scratch, reused across computations
+	uint64_t m_droppedByteCount = 0;
+};
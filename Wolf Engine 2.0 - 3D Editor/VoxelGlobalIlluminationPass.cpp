@@ -1,6 +1,5 @@
 #include "VoxelGlobalIlluminationPass.h"
 
-#include <fstream>
 #include <random>
 
 #include <DebugMarker.h>
@@ -12,6 +11,7 @@
 #include <ShaderParser.h>
 
 #include "CommonLayouts.h"
+#include "ShaderSnippetCache.h"
 
 VoxelGlobalIlluminationPass::VoxelGlobalIlluminationPass(const Wolf::ResourceNonOwner<UpdateRayTracedWorldPass>& updateRayTracedWorldPass, const Wolf::ResourceNonOwner<RayTracedWorldManager>& rayTracedWorldManager)
 : m_updateRayTracedWorldPass(updateRayTracedWorldPass), m_rayTracedWorldManager(rayTracedWorldManager)
@@ -153,19 +153,7 @@ void VoxelGlobalIlluminationPass::addShaderCode(Wolf::ShaderParser::ShaderCodeTo
 {
     PROFILE_FUNCTION
 
-    std::ifstream inFile("Shaders/voxelGI/output/readGlobalIrradiance.glsl");
-    std::string line;
-    while (std::getline(inFile, line))
-    {
-        const std::string& descriptorSlotToken = "@VOXEL_GI_DESCRIPTOR_SLOT";
-        size_t descriptorSlotTokenPos = line.find(descriptorSlotToken);
-        while (descriptorSlotTokenPos != std::string::npos)
-        {
-            line.replace(descriptorSlotTokenPos, descriptorSlotToken.length(), std::to_string(bindingSlot));
-            descriptorSlotTokenPos = line.find(descriptorSlotToken);
-        }
-        inOutShaderCodeToAdd.codeString += line + '\n';
-    }
+    g_shaderSnippetCache->appendSnippet("Shaders/voxelGI/output/readGlobalIrradiance.glsl", { { "@VOXEL_GI_DESCRIPTOR_SLOT", std::to_string(bindingSlot) } }, inOutShaderCodeToAdd.codeString);
 }
 
 void VoxelGlobalIlluminationPass::createVoxelGrid()
@@ -1,15 +1,18 @@
+// A GPU report can be loaded along with the staging report written at the same time
 document.getElementById('jsonInput').addEventListener('change', function(e) {
-    const reader = new FileReader();
-    reader.onload = function(event) {
+    Promise.all(Array.from(e.target.files).map(file => file.text())).then(texts => {
         try {
-            const data = JSON.parse(event.target.result);
+            const reports = texts.map(text => JSON.parse(text));
+            const data = reports.find(report => report.type !== "staging");
+            if (data) {
+                data.staging = reports.find(report => report.type === "staging");
+            }
             renderData(data);
         } catch (err) {
             console.error("Error parsing JSON:", err);
             alert("Failed to load JSON file. Check console for details.");
         }
-    };
-    reader.readAsText(e.target.files[0]);
+    });
 });
 
 window.addEventListener('DOMContentLoaded', () => {
@@ -138,6 +141,7 @@ function setStandbyMode() {
     document.getElementById('totalAllocated').textContent = "0.00 MB";
     document.getElementById('totalRequested').textContent = "0.00 MB";
     document.getElementById('efficiency').textContent = "0%";
+    document.getElementById('stagingUsage').textContent = "-";
 }
 
 function renderData(data) {
@@ -156,6 +160,15 @@ function renderData(data) {
     const efficiency = data.totalAllocated > 0 ? (data.totalRequested / data.totalAllocated) * 100 : 0;
     document.getElementById('efficiency').textContent = efficiency.toFixed(1) + "%";
 
+    const stagingUsage = document.getElementById('stagingUsage');
+    if (data.staging) {
+        const toMB = (bytes) => (bytes / 1024 / 1024).toFixed(2);
+        stagingUsage.textContent = `${toMB(data.staging.usedBytes)} / ${toMB(data.staging.allocatedBytes)} MB (peak ${toMB(data.staging.peakAllocatedBytes)} MB, budget ${toMB(data.staging.budget)} MB, ${data.staging.pageCount} pages)`;
+        stagingUsage.style.color = data.staging.overBudgetAllocationCount > 0 ? "hsl(0, 100%, 50%)" : "";
+    } else {
+        stagingUsage.textContent = "-";
+    }
+
     const map = document.getElementById('memoryMap');
     const tbody = document.querySelector('#resourceTable tbody');
     map.innerHTML = '';